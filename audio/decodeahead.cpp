@@ -0,0 +1,274 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/decodeahead.h"
+
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/singleton.h"
+#include "common/system.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+namespace Audio {
+class DecodeAheadManager;
+}
+
+namespace Common {
+DECLARE_SINGLETON(Audio::DecodeAheadManager);
+}
+
+namespace Audio {
+
+enum {
+	kDecodeAheadTimerInterval = 10000,
+	kMinRingFrames = 1024
+};
+
+/**
+ * Keeps track of the live decode ahead streams and fills them from a single
+ * timer proc. The TimerManager can only remove procs by function, so the
+ * streams share one proc instead of installing their own.
+ */
+class DecodeAheadManager : public Common::Singleton<DecodeAheadManager> {
+public:
+	void add(DecodeAheadAudioStream *stream);
+	void remove(DecodeAheadAudioStream *stream);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DecodeAheadManager() : _timerInstalled(false) {}
+
+	static void timerProc(void *refCon);
+	void fillAll();
+
+	Common::Mutex _mutex;
+	Common::Array<DecodeAheadAudioStream *> _streams;
+	bool _timerInstalled;
+};
+
+void DecodeAheadManager::add(DecodeAheadAudioStream *stream) {
+	Common::StackLock lock(_mutex);
+	_streams.push_back(stream);
+
+	if (!_timerInstalled && g_system->getTimerManager())
+		_timerInstalled = g_system->getTimerManager()->installTimerProc(timerProc, kDecodeAheadTimerInterval, this, "DecodeAhead");
+}
+
+void DecodeAheadManager::remove(DecodeAheadAudioStream *stream) {
+	Common::StackLock lock(_mutex);
+	for (uint i = 0; i < _streams.size(); ++i) {
+		if (_streams[i] == stream) {
+			_streams.remove_at(i);
+			break;
+		}
+	}
+}
+
+void DecodeAheadManager::timerProc(void *refCon) {
+	((DecodeAheadManager *)refCon)->fillAll();
+}
+
+void DecodeAheadManager::fillAll() {
+	_mutex.lock();
+	Common::Array<DecodeAheadAudioStream *> streams = _streams;
+	_mutex.unlock();
+
+	for (uint i = 0; i < streams.size(); ++i) {
+		DecodeAheadAudioStream *stream = streams[i];
+
+		// Only start filling a stream while it is still registered. The
+		// stream lock is taken before dropping ours, so a stream being
+		// destroyed waits for the fill to end instead of racing it.
+		_mutex.lock();
+		bool live = false;
+		for (uint j = 0; j < _streams.size() && !live; ++j)
+			live = (_streams[j] == stream);
+		if (live)
+			stream->_streamMutex.lock();
+		_mutex.unlock();
+
+		if (live) {
+			stream->fillLocked();
+			stream->_streamMutex.unlock();
+		}
+	}
+}
+
+DecodeAheadAudioStream::DecodeAheadAudioStream(SeekableAudioStream *stream, uint lookaheadMs, DisposeAfterUse::Flag disposeAfterUse)
+	: _stream(stream, disposeAfterUse), _stereo(stream->isStereo()), _rate(stream->getRate()),
+	  _readPos(0), _writePos(0), _streamEnded(false),
+	  _seekCount(0), _seekWritePos(0), _appliedSeekCount(0),
+	  _underruns(0), _underrunSamples(0) {
+
+	const uint channels = _stereo ? 2 : 1;
+	const uint frames = MAX<uint>(kMinRingFrames, (uint)((uint64)lookaheadMs * _rate / 1000));
+	_ringSize = frames * channels;
+	_ring = new int16[_ringSize];
+
+	fill();
+	DecodeAheadManager::instance().add(this);
+}
+
+DecodeAheadAudioStream::~DecodeAheadAudioStream() {
+	DecodeAheadManager::instance().remove(this);
+
+	// Wait for a fill which started before we were removed
+	_streamMutex.lock();
+	_streamMutex.unlock();
+
+	if (_underruns)
+		debug(3, "DecodeAheadAudioStream: %d underruns, %d samples missing", _underruns, _underrunSamples);
+
+	delete[] _ring;
+}
+
+void DecodeAheadAudioStream::fill() {
+	Common::StackLock lock(_streamMutex);
+	fillLocked();
+}
+
+void DecodeAheadAudioStream::fillLocked() {
+	const uint channels = _stereo ? 2 : 1;
+
+	while (!_streamEnded) {
+		const uint32 readPos = _readPos;
+		Common::memoryBarrier();
+		const uint32 writePos = _writePos;
+
+		// Decode into the free space up to the end of the ring buffer;
+		// the wrapped around part follows in the next iteration.
+		const uint32 offset = writePos % _ringSize;
+		uint32 count = MIN<uint32>(_ringSize - (writePos - readPos), _ringSize - offset);
+		count -= count % channels;
+		if (!count)
+			break;
+
+		const int decoded = _stream->readBuffer(_ring + offset, count);
+		if (decoded > 0) {
+			// Publish the samples only after they have been written
+			Common::memoryBarrier();
+			_writePos = writePos + decoded;
+		}
+		if (decoded < (int)count) {
+			if (_stream->endOfData()) {
+				Common::memoryBarrier();
+				_streamEnded = true;
+			}
+			break;
+		}
+	}
+}
+
+int DecodeAheadAudioStream::readRing(int16 *buffer, int numSamples) {
+	const uint32 writePos = _writePos;
+	Common::memoryBarrier();
+	const uint32 readPos = _readPos;
+
+	const uint32 count = MIN<uint32>(numSamples, writePos - readPos);
+	const uint32 offset = readPos % _ringSize;
+	const uint32 first = MIN<uint32>(count, _ringSize - offset);
+	memcpy(buffer, _ring + offset, first * sizeof(int16));
+	memcpy(buffer + first, _ring, (count - first) * sizeof(int16));
+
+	// Hand the space back only after the samples have been copied out
+	Common::memoryBarrier();
+	_readPos = readPos + count;
+	return count;
+}
+
+void DecodeAheadAudioStream::applySeek() {
+	const uint32 seekCount = _seekCount;
+	if (seekCount == _appliedSeekCount)
+		return;
+
+	// Skip the samples decoded before the seek. A later seek may already
+	// have moved the position on, which only drops samples that seek makes
+	// stale anyway. Samples past it may have been read already, though.
+	Common::memoryBarrier();
+	const uint32 seekWritePos = _seekWritePos;
+	if ((int32)(seekWritePos - _readPos) > 0)
+		_readPos = seekWritePos;
+	_appliedSeekCount = seekCount;
+}
+
+int DecodeAheadAudioStream::readBuffer(int16 *buffer, const int numSamples) {
+	applySeek();
+
+	const int samples = readRing(buffer, numSamples);
+	if (samples == numSamples)
+		return samples;
+
+	if (_streamEnded) {
+		// The last samples may have been published since the read above
+		Common::memoryBarrier();
+		return samples + readRing(buffer + samples, numSamples - samples);
+	}
+
+	// The ring buffer ran dry. Waiting for the decoder would stall the
+	// mixer, so hand out what there is; the rest of the buffer stays silent.
+	_underruns++;
+	_underrunSamples += numSamples - samples;
+	return samples;
+}
+
+bool DecodeAheadAudioStream::endOfData() const {
+	return _streamEnded && _readPos == _writePos && _seekCount == _appliedSeekCount;
+}
+
+bool DecodeAheadAudioStream::seek(const Timestamp &where) {
+	Common::StackLock lock(_streamMutex);
+	const bool result = _stream->seek(where);
+
+	// Everything decoded so far is stale now
+	_seekWritePos = _writePos;
+	_streamEnded = false;
+	Common::memoryBarrier();
+	_seekCount = _seekCount + 1;
+	return result;
+}
+
+Timestamp DecodeAheadAudioStream::getLength() const {
+	Common::StackLock lock(_streamMutex);
+	return _stream->getLength();
+}
+
+SeekableAudioStream *makeDecodeAheadStream(SeekableAudioStream *stream, uint lookaheadMs, DisposeAfterUse::Flag disposeAfterUse) {
+	if (!stream || !lookaheadMs)
+		return stream;
+
+	return new DecodeAheadAudioStream(stream, lookaheadMs, disposeAfterUse);
+}
+
+SeekableAudioStream *makeConfiguredDecodeAheadStream(SeekableAudioStream *stream) {
+	if (!stream || !ConfMan.hasKey("decode_ahead"))
+		return stream;
+
+	const int lookaheadMs = ConfMan.getInt("decode_ahead");
+	if (lookaheadMs <= 0)
+		return stream;
+
+	return makeDecodeAheadStream(stream, lookaheadMs);
+}
+
+} // End of namespace Audio
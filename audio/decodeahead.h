@@ -0,0 +1,132 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_DECODEAHEAD_H
+#define AUDIO_DECODEAHEAD_H
+
+#include "audio/audiostream.h"
+
+#include "common/mutex.h"
+#include "common/types.h"
+
+namespace Audio {
+
+/**
+ * A wrapper around a SeekableAudioStream which decodes ahead of playback.
+ *
+ * The wrapped stream is decoded into a ring buffer by a timer proc, so slow
+ * decodes (the start of a FLAC frame, an MP3 resync, ...) happen outside
+ * the mixer callback. The mixer side reads the ring buffer without taking
+ * any lock. When the ring buffer runs dry, it hands out what there is and
+ * counts an underrun rather than waiting for the decoder.
+ */
+class DecodeAheadAudioStream : public SeekableAudioStream {
+public:
+	/**
+	 * Create a decode ahead stream. The ring buffer is filled once right
+	 * away, so playback starts without an underrun.
+	 *
+	 * @param stream          the stream to decode ahead
+	 * @param lookaheadMs     length of the ring buffer in milliseconds
+	 * @param disposeAfterUse whether to delete the stream along with this one
+	 */
+	DecodeAheadAudioStream(SeekableAudioStream *stream, uint lookaheadMs, DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::YES);
+	~DecodeAheadAudioStream();
+
+	int readBuffer(int16 *buffer, const int numSamples);
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const;
+
+	bool seek(const Timestamp &where);
+	Timestamp getLength() const;
+
+	/**
+	 * Decode into the ring buffer until it is full or the wrapped stream
+	 * ends. Called by the decode ahead timer proc.
+	 */
+	void fill();
+
+	/** Number of readBuffer() calls which found the ring buffer short. */
+	uint32 getUnderruns() const { return _underruns; }
+
+	/** Number of samples which were missing when the ring buffer ran dry. */
+	uint32 getUnderrunSamples() const { return _underrunSamples; }
+
+private:
+	friend class DecodeAheadManager;
+
+	void fillLocked();
+	int readRing(int16 *buffer, int numSamples);
+	void applySeek();
+
+	Common::DisposablePtr<SeekableAudioStream> _stream;
+	const bool _stereo;
+	const int _rate;
+
+	/** Guards the wrapped stream; held while decoding and seeking. */
+	Common::Mutex _streamMutex;
+
+	int16 *_ring;
+	uint32 _ringSize;
+
+	// Positions in samples, counting up and wrapping at 2^32. The write
+	// position is only changed by the decoding side, the read position
+	// only by the reading side.
+	volatile uint32 _readPos;
+	volatile uint32 _writePos;
+	volatile bool _streamEnded;
+
+	// Seeks discard the ring buffer up to the write position at the time
+	// of the seek; the reading side applies that when it sees a new count.
+	volatile uint32 _seekCount;
+	volatile uint32 _seekWritePos;
+	uint32 _appliedSeekCount;
+
+	uint32 _underruns;
+	uint32 _underrunSamples;
+};
+
+/**
+ * Wrap a stream into a DecodeAheadAudioStream.
+ *
+ * @param stream          the stream to decode ahead
+ * @param lookaheadMs     length of the ring buffer in milliseconds;
+ *                        0 returns the stream itself
+ * @param disposeAfterUse whether to delete the stream along with the wrapper
+ * @return the new stream, or 0 if stream was 0
+ */
+SeekableAudioStream *makeDecodeAheadStream(SeekableAudioStream *stream, uint lookaheadMs, DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::YES);
+
+/**
+ * Wrap a freshly created decoder stream according to the "decode_ahead"
+ * setting, the lookahead in milliseconds. The stream is returned as is
+ * when the setting is 0 or unset.
+ *
+ * This is used by the MP3, Ogg Vorbis and FLAC factories, so all streams
+ * made by them decode ahead once the setting is enabled.
+ */
+SeekableAudioStream *makeConfiguredDecodeAheadStream(SeekableAudioStream *stream);
+
+} // End of namespace Audio
+
+#endif
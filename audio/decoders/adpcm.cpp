@@ -63,29 +63,18 @@ bool ADPCMStream::rewind() {
 	return true;
 }
 
+uint32 ADPCMStream::readInput(uint32 bytes) {
+	const int32 pos = _stream->pos();
+	if (pos >= _endpos)
+		return 0;
 
-#pragma mark -
-
+	bytes = MIN<uint32>(bytes, MIN<uint32>(kInputBufferSize, _endpos - pos));
+	return _stream->read(_inputBuffer, bytes);
+}
 
-int Oki_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
-	int samples;
-	byte data;
-
-	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
-		if (_decodedSampleCount == 0) {
-			data = _stream->readByte();
-			_decodedSamples[0] = decodeOKI((data >> 4) & 0x0f);
-			_decodedSamples[1] = decodeOKI((data >> 0) & 0x0f);
-			_decodedSampleCount = 2;
-		}
 
-		// (1 - (count - 1)) ensures that _decodedSamples acts as a FIFO of depth 2
-		buffer[samples] = _decodedSamples[1 - (_decodedSampleCount - 1)];
-		_decodedSampleCount--;
-	}
+#pragma mark -
 
-	return samples;
-}
 
 static const int16 okiStepSize[49] = {
 	   16,   17,   19,   21,   23,   25,   28,   31,
@@ -97,43 +86,108 @@ static const int16 okiStepSize[49] = {
 	 1552
 };
 
-// Decode Linear to ADPCM
-int16 Oki_ADPCMStream::decodeOKI(byte code) {
-	int16 diff, E, samp;
-
-	E = (2 * (code & 0x7) + 1) * okiStepSize[_status.ima_ch[0].stepIndex] / 8;
-	diff = (code & 0x08) ? -E : E;
-	samp = _status.ima_ch[0].last + diff;
+static inline int16 decodeOKISample(int32 &last, int32 &stepIndex, byte code) {
+	const int32 E = (2 * (code & 0x7) + 1) * okiStepSize[stepIndex] / 8;
+	const int32 diff = (code & 0x08) ? -E : E;
 	// Clip the values to +/- 2^11 (supposed to be 12 bits)
-	samp = CLIP<int16>(samp, -2048, 2047);
+	const int32 samp = CLIP<int32>(last + diff, -2048, 2047);
 
-	_status.ima_ch[0].last = samp;
-	_status.ima_ch[0].stepIndex += _stepAdjustTable[code];
-	_status.ima_ch[0].stepIndex = CLIP<int32>(_status.ima_ch[0].stepIndex, 0, ARRAYSIZE(okiStepSize) - 1);
+	last = samp;
+	stepIndex = CLIP<int32>(stepIndex + ADPCMStream::_stepAdjustTable[code], 0, ARRAYSIZE(okiStepSize) - 1);
 
 	// * 16 effectively converts 12-bit input to 16-bit output
 	return samp * 16;
 }
 
+// Decode Linear to ADPCM
+int16 Oki_ADPCMStream::decodeOKI(byte code) {
+	return decodeOKISample(_status.ima_ch[0].last, _status.ima_ch[0].stepIndex, code);
+}
+
+int Oki_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
+	int samples = 0;
+
+	// The second half of the last byte read is handed out first
+	if (_decodedSampleCount && samples < numSamples) {
+		buffer[samples++] = _decodedSamples[1];
+		_decodedSampleCount = 0;
+	}
+
+	while (samples < numSamples) {
+		const uint32 bytes = readInput((numSamples - samples + 1) / 2);
+		if (!bytes)
+			break;
+
+		int32 last = _status.ima_ch[0].last;
+		int32 stepIndex = _status.ima_ch[0].stepIndex;
+		for (uint32 i = 0; i < bytes; i++) {
+			const byte data = _inputBuffer[i];
+			buffer[samples++] = decodeOKISample(last, stepIndex, (data >> 4) & 0x0f);
+			const int16 second = decodeOKISample(last, stepIndex, data & 0x0f);
+			if (samples < numSamples) {
+				buffer[samples++] = second;
+			} else {
+				_decodedSamples[1] = second;
+				_decodedSampleCount = 1;
+			}
+		}
+		_status.ima_ch[0].last = last;
+		_status.ima_ch[0].stepIndex = stepIndex;
+	}
+
+	return samples;
+}
+
 
 #pragma mark -
 
 
+static inline int16 decodeIMASample(int32 &last, int32 &stepIndex, byte code) {
+	const int32 E = (2 * (code & 0x7) + 1) * Ima_ADPCMStream::_imaTable[stepIndex] / 8;
+	const int32 diff = (code & 0x08) ? -E : E;
+	const int32 samp = CLIP<int32>(last + diff, -32768, 32767);
+
+	last = samp;
+	stepIndex = CLIP<int32>(stepIndex + ADPCMStream::_stepAdjustTable[code], 0, ARRAYSIZE(Ima_ADPCMStream::_imaTable) - 1);
+
+	return samp;
+}
+
 int DVI_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
-	int samples;
-	byte data;
-
-	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
-		if (_decodedSampleCount == 0) {
-			data = _stream->readByte();
-			_decodedSamples[0] = decodeIMA((data >> 4) & 0x0f, 0);
-			_decodedSamples[1] = decodeIMA((data >> 0) & 0x0f, _channels == 2 ? 1 : 0);
-			_decodedSampleCount = 2;
-		}
+	int samples = 0;
+
+	// The second half of the last byte read is handed out first
+	if (_decodedSampleCount && samples < numSamples) {
+		buffer[samples++] = _decodedSamples[1];
+		_decodedSampleCount = 0;
+	}
 
-		// (1 - (count - 1)) ensures that _decodedSamples acts as a FIFO of depth 2
-		buffer[samples] = _decodedSamples[1 - (_decodedSampleCount - 1)];
-		_decodedSampleCount--;
+	// The high nibble belongs to the left, the low one to the right
+	// channel. Mono streams use the same state for both.
+	const int second = (_channels == 2) ? 1 : 0;
+
+	while (samples < numSamples) {
+		const uint32 bytes = readInput((numSamples - samples + 1) / 2);
+		if (!bytes)
+			break;
+
+		int32 last[2] = { _status.ima_ch[0].last, _status.ima_ch[1].last };
+		int32 stepIndex[2] = { _status.ima_ch[0].stepIndex, _status.ima_ch[1].stepIndex };
+		for (uint32 i = 0; i < bytes; i++) {
+			const byte data = _inputBuffer[i];
+			buffer[samples++] = decodeIMASample(last[0], stepIndex[0], (data >> 4) & 0x0f);
+			const int16 sample = decodeIMASample(last[second], stepIndex[second], data & 0x0f);
+			if (samples < numSamples) {
+				buffer[samples++] = sample;
+			} else {
+				_decodedSamples[1] = sample;
+				_decodedSampleCount = 1;
+			}
+		}
+		for (int i = 0; i < 2; i++) {
+			_status.ima_ch[i].last = last[i];
+			_status.ima_ch[i].stepIndex = stepIndex[i];
+		}
 	}
 
 	return samples;
@@ -209,43 +263,86 @@ int Apple_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 #pragma mark -
 
 
+/**
+ * Decode the eight samples in the four bytes of one channel in a group of
+ * an MS IMA block, storing them every stride samples.
+ */
+static inline void decodeMSImaGroup(int16 *dst, int stride, const byte *src, int32 &last, int32 &stepIndex) {
+	for (int j = 0; j < 4; j++) {
+		dst[(j * 2) * stride] = decodeIMASample(last, stepIndex, src[j] & 0x0f);
+		dst[(j * 2 + 1) * stride] = decodeIMASample(last, stepIndex, (src[j] >> 4) & 0x0f);
+	}
+}
+
 int MSIma_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 	// Need to write at least one sample per channel
 	assert((numSamples % _channels) == 0);
 
+	// Each group holds four bytes, i.e. eight samples, per channel
+	const uint32 groupSize = _channels * 4;
+	const int groupSamples = _channels * 8;
+
 	int samples = 0;
 
-	while (samples < numSamples && !_stream->eos() && _stream->pos() < _endpos) {
-		if (_blockPos[0] == _blockAlign) {
+	while (samples < numSamples) {
+		// Hand out what is left of a group decoded before
+		if (_samplesLeft[0] != 0) {
 			for (int i = 0; i < _channels; i++) {
-				// read block header
-				_status.ima_ch[i].last = _stream->readSint16LE();
-				_status.ima_ch[i].stepIndex = _stream->readSint16LE();
+				buffer[samples + i] = _buffer[i][8 - _samplesLeft[i]];
+				_samplesLeft[i]--;
 			}
 
-			_blockPos[0] = _channels * 4;
+			samples += _channels;
+			continue;
 		}
 
-		// Decode a set of samples
-		for (int i = 0; i < _channels; i++) {
-			// The stream encodes four bytes per channel at a time
-			for (int j = 0; j < 4; j++) {
-				byte data = _stream->readByte();
-				_blockPos[0]++;
-				_buffer[i][j * 2] = decodeIMA(data & 0x0f, i);
-				_buffer[i][j * 2 + 1] = decodeIMA((data >> 4) & 0x0f, i);
-				_samplesLeft[i] += 2;
+		if (_blockPos[0] >= _blockAlign) {
+			if (readInput(groupSize) < groupSize)
+				break;
+
+			for (int i = 0; i < _channels; i++) {
+				// read block header
+				_status.ima_ch[i].last = (int16)READ_LE_UINT16(_inputBuffer + i * 4);
+				_status.ima_ch[i].stepIndex = CLIP<int32>((int16)READ_LE_UINT16(_inputBuffer + i * 4 + 2), 0, ARRAYSIZE(_imaTable) - 1);
 			}
+
+			_blockPos[0] = groupSize;
+			continue;
 		}
 
-		while (samples < numSamples && _samplesLeft[0] != 0) {
-			for (int i = 0; i < _channels; i++) {
-				buffer[samples + i] = _buffer[i][8 - _samplesLeft[i]];
-				_samplesLeft[i]--;
+		// Decode as many whole groups as the output has room for straight
+		// into it. If it has none, one group is decoded into _buffer.
+		uint32 groups = (numSamples - samples) / groupSamples;
+		groups = MIN<uint32>(groups, (_blockAlign - _blockPos[0]) / groupSize);
+		groups = MIN<uint32>(groups, kInputBufferSize / groupSize);
+		const bool direct = (groups != 0);
+		if (!direct)
+			groups = 1;
+
+		groups = readInput(groups * groupSize) / groupSize;
+		if (!groups)
+			break;
+		_blockPos[0] += groups * groupSize;
+
+		const byte *src = _inputBuffer;
+		for (int i = 0; i < _channels; i++) {
+			int32 last = _status.ima_ch[i].last;
+			int32 stepIndex = _status.ima_ch[i].stepIndex;
+
+			if (direct) {
+				for (uint32 g = 0; g < groups; g++)
+					decodeMSImaGroup(buffer + samples + g * groupSamples + i, _channels, src + g * groupSize + i * 4, last, stepIndex);
+			} else {
+				decodeMSImaGroup(_buffer[i], 1, src + i * 4, last, stepIndex);
+				_samplesLeft[i] = 8;
 			}
 
-			samples += _channels;
+			_status.ima_ch[i].last = last;
+			_status.ima_ch[i].stepIndex = stepIndex;
 		}
+
+		if (direct)
+			samples += groups * groupSamples;
 	}
 
 	return samples;
@@ -268,63 +365,99 @@ static const int MSADPCMAdaptationTable[] = {
 	768, 614, 512, 409, 307, 230, 230, 230
 };
 
-int16 MS_ADPCMStream::decodeMS(ADPCMChannelStatus *c, byte code) {
+template<typename ChannelStatus>
+static inline int16 decodeMSSample(ChannelStatus &c, byte code) {
 	int32 predictor;
 
-	predictor = (((c->sample1) * (c->coeff1)) + ((c->sample2) * (c->coeff2))) / 256;
-	predictor += (signed)((code & 0x08) ? (code - 0x10) : (code)) * c->delta;
+	predictor = (((c.sample1) * (c.coeff1)) + ((c.sample2) * (c.coeff2))) / 256;
+	predictor += (signed)((code & 0x08) ? (code - 0x10) : (code)) * c.delta;
 
 	predictor = CLIP<int32>(predictor, -32768, 32767);
 
-	c->sample2 = c->sample1;
-	c->sample1 = predictor;
-	c->delta = (MSADPCMAdaptationTable[(int)code] * c->delta) >> 8;
+	c.sample2 = c.sample1;
+	c.sample1 = predictor;
+	c.delta = (MSADPCMAdaptationTable[(int)code] * c.delta) >> 8;
 
-	if (c->delta < 16)
-		c->delta = 16;
+	if (c.delta < 16)
+		c.delta = 16;
 
 	return (int16)predictor;
 }
 
+int16 MS_ADPCMStream::decodeMS(ADPCMChannelStatus *c, byte code) {
+	return decodeMSSample(*c, code);
+}
+
 int MS_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
-	int samples;
-	byte data;
+	int samples = 0;
 	int i;
 
-	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
-		if (_decodedSampleCount == 0) {
-			if (_blockPos[0] == _blockAlign) {
-				// read block header
-				for (i = 0; i < _channels; i++) {
-					_status.ch[i].predictor = CLIP(_stream->readByte(), (byte)0, (byte)6);
-					_status.ch[i].coeff1 = MSADPCMAdaptCoeff1[_status.ch[i].predictor];
-					_status.ch[i].coeff2 = MSADPCMAdaptCoeff2[_status.ch[i].predictor];
-				}
+	while (samples < numSamples) {
+		// Hand out the block header or the second half of a byte first
+		if (_decodedSampleCount) {
+			buffer[samples++] = _decodedSamples[_decodedSamplePos++];
+			_decodedSampleCount--;
+			continue;
+		}
 
-				for (i = 0; i < _channels; i++)
-					_status.ch[i].delta = _stream->readSint16LE();
+		_decodedSamplePos = 0;
 
-				for (i = 0; i < _channels; i++)
-					_status.ch[i].sample1 = _stream->readSint16LE();
+		if (_blockPos[0] >= _blockAlign) {
+			const uint32 headerSize = _channels * 7;
+			if (readInput(headerSize) < headerSize)
+				break;
 
-				for (i = 0; i < _channels; i++)
-					_decodedSamples[_decodedSampleCount++] = _status.ch[i].sample2 = _stream->readSint16LE();
+			// read block header
+			const byte *header = _inputBuffer;
+			for (i = 0; i < _channels; i++) {
+				_status.ch[i].predictor = CLIP(header[i], (byte)0, (byte)6);
+				_status.ch[i].coeff1 = MSADPCMAdaptCoeff1[_status.ch[i].predictor];
+				_status.ch[i].coeff2 = MSADPCMAdaptCoeff2[_status.ch[i].predictor];
+			}
+			header += _channels;
 
-				for (i = 0; i < _channels; i++)
-					_decodedSamples[_decodedSampleCount++] = _status.ch[i].sample1;
+			for (i = 0; i < _channels; i++, header += 2)
+				_status.ch[i].delta = (int16)READ_LE_UINT16(header);
 
-				_blockPos[0] = _channels * 7;
-			} else {
-				data = _stream->readByte();
-				_blockPos[0]++;
-				_decodedSamples[_decodedSampleCount++] = decodeMS(&_status.ch[0], (data >> 4) & 0x0f);
-				_decodedSamples[_decodedSampleCount++] = decodeMS(&_status.ch[_channels - 1], data & 0x0f);
-			}
+			for (i = 0; i < _channels; i++, header += 2)
+				_status.ch[i].sample1 = (int16)READ_LE_UINT16(header);
+
+			for (i = 0; i < _channels; i++, header += 2)
+				_decodedSamples[_decodedSampleCount++] = _status.ch[i].sample2 = (int16)READ_LE_UINT16(header);
+
+			for (i = 0; i < _channels; i++)
+				_decodedSamples[_decodedSampleCount++] = _status.ch[i].sample1;
+
+			_blockPos[0] = headerSize;
+			continue;
 		}
 
-		// (1 - (count - 1)) ensures that _decodedSamples acts as a FIFO of depth 2
-		buffer[samples] = _decodedSamples[1 - (_decodedSampleCount - 1)];
-		_decodedSampleCount--;
+		// Each byte holds two samples, the high nibble comes first. If only
+		// one more sample fits, the other one is kept for the next call.
+		uint32 bytes = MIN<uint32>((numSamples - samples) / 2, _blockAlign - _blockPos[0]);
+		if (!bytes)
+			bytes = 1;
+
+		bytes = readInput(bytes);
+		if (!bytes)
+			break;
+		_blockPos[0] += bytes;
+
+		ADPCMChannelStatus left = _status.ch[0];
+		ADPCMChannelStatus right = _status.ch[_channels - 1];
+		ADPCMChannelStatus &second = (_channels == 2) ? right : left;
+		for (uint32 j = 0; j < bytes; j++) {
+			const byte data = _inputBuffer[j];
+			buffer[samples++] = decodeMSSample(left, (data >> 4) & 0x0f);
+			const int16 sample = decodeMSSample(second, data & 0x0f);
+			if (samples < numSamples)
+				buffer[samples++] = sample;
+			else
+				_decodedSamples[_decodedSampleCount++] = sample;
+		}
+		_status.ch[0] = left;
+		if (_channels == 2)
+			_status.ch[1] = right;
 	}
 
 	return samples;
@@ -422,15 +555,7 @@ const int16 Ima_ADPCMStream::_imaTable[89] = {
 };
 
 int16 Ima_ADPCMStream::decodeIMA(byte code, int channel) {
-	int32 E = (2 * (code & 0x7) + 1) * _imaTable[_status.ima_ch[channel].stepIndex] / 8;
-	int32 diff = (code & 0x08) ? -E : E;
-	int32 samp = CLIP<int32>(_status.ima_ch[channel].last + diff, -32768, 32767);
-
-	_status.ima_ch[channel].last = samp;
-	_status.ima_ch[channel].stepIndex += _stepAdjustTable[code];
-	_status.ima_ch[channel].stepIndex = CLIP<int32>(_status.ima_ch[channel].stepIndex, 0, ARRAYSIZE(_imaTable) - 1);
-
-	return samp;
+	return decodeIMASample(_status.ima_ch[channel].last, _status.ima_ch[channel].stepIndex, code);
 }
 
 RewindableAudioStream *makeADPCMStream(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 size, ADPCMType type, int rate, int channels, uint32 blockAlign) {
@@ -57,8 +57,25 @@ protected:
 		} ima_ch[2];
 	} _status;
 
+	enum {
+		/** Size of the buffer the compressed data is read into */
+		kInputBufferSize = 1024
+	};
+
+	byte _inputBuffer[kInputBufferSize];
+
 	virtual void reset();
 
+	/**
+	 * Read compressed data into _inputBuffer with a single stream read.
+	 * No more than fits into the buffer and no data past the end of the
+	 * ADPCM stream is read.
+	 *
+	 * @param bytes		the number of bytes wanted
+	 * @return			the number of bytes read
+	 */
+	uint32 readInput(uint32 bytes);
+
 public:
 	ADPCMStream(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 size, int rate, int channels, uint32 blockAlign);
 
@@ -166,6 +183,8 @@ public:
 		_samplesLeft[1] = 0;
 	}
 
+	virtual bool endOfData() const { return (_stream->eos() || _stream->pos() >= _endpos) && (_samplesLeft[0] == 0); }
+
 	virtual int readBuffer(int16 *buffer, const int numSamples);
 
 	void reset() {
@@ -198,6 +217,8 @@ protected:
 	void reset() {
 		ADPCMStream::reset();
 		memset(&_status, 0, sizeof(_status));
+		_decodedSampleCount = 0;
+		_decodedSamplePos = 0;
 	}
 
 public:
@@ -207,6 +228,7 @@ public:
 			error("MS_ADPCMStream(): blockAlign isn't specified for MS ADPCM");
 		memset(&_status, 0, sizeof(_status));
 		_decodedSampleCount = 0;
+		_decodedSamplePos = 0;
 	}
 
 	virtual bool endOfData() const { return (_stream->eos() || _stream->pos() >= _endpos) && (_decodedSampleCount == 0); }
@@ -218,6 +240,7 @@ protected:
 
 private:
 	uint8 _decodedSampleCount;
+	uint8 _decodedSamplePos;
 	int16 _decodedSamples[4];
 };
 
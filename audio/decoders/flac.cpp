@@ -33,6 +33,7 @@
 #include "common/util.h"
 
 #include "audio/audiostream.h"
+#include "audio/decodeahead.h"
 
 #define FLAC__NO_DLL // that MS-magic gave me headaches - just link the library you like
 #include <FLAC/export.h>
@@ -734,7 +735,7 @@ SeekableAudioStream *makeFLACStream(
 		delete s;
 		return 0;
 	} else {
-		return s;
+		return makeConfiguredDecodeAheadStream(s);
 	}
 }
 
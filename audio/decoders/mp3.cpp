@@ -31,6 +31,7 @@
 #include "common/util.h"
 
 #include "audio/audiostream.h"
+#include "audio/decodeahead.h"
 
 #include <mad.h>
 
@@ -360,7 +361,7 @@ SeekableAudioStream *makeMP3Stream(
 		delete s;
 		return 0;
 	} else {
-		return s;
+		return makeConfiguredDecodeAheadStream(s);
 	}
 }
 
@@ -37,7 +37,6 @@
 #include "common/math.h"
 #include "common/rdft.h"
 #include "common/stream.h"
-#include "common/memstream.h"
 #include "common/bitstream.h"
 #include "common/textconsole.h"
 
@@ -1886,8 +1885,8 @@ void QDM2Stream::init_tone_level_dequantization(Common::BitStream *gb, int lengt
 void QDM2Stream::process_subpacket_9(QDM2SubPNode *node) {
 	int i, j, k, n, ch, run, level, diff;
 
-	Common::MemoryReadStream d(node->packet->data, node->packet->size*8);
-	Common::BitStream32LELSB gb(&d);
+	Common::BitStreamMemoryStream d(node->packet->data, node->packet->size);
+	Common::BitStreamMemory32LELSB gb(&d);
 
 	n = coeff_per_sb_for_avg[_coeffPerSbSelect][QDM2_SB_USED(_subSampling) - 1] + 1; // same as averagesomething function
 
@@ -1920,8 +1919,8 @@ void QDM2Stream::process_subpacket_9(QDM2SubPNode *node) {
  * @param length    packet length in bits
  */
 void QDM2Stream::process_subpacket_10(QDM2SubPNode *node, int length) {
-	Common::MemoryReadStream d(((node == NULL) ? _emptyBuffer : node->packet->data), ((node == NULL) ? 0 : node->packet->size*8));
-	Common::BitStream32LELSB gb(&d);
+	Common::BitStreamMemoryStream d(((node == NULL) ? _emptyBuffer : node->packet->data), ((node == NULL) ? 0 : node->packet->size));
+	Common::BitStreamMemory32LELSB gb(&d);
 
 	if (length != 0) {
 		init_tone_level_dequantization(&gb, length);
@@ -1938,8 +1937,8 @@ void QDM2Stream::process_subpacket_10(QDM2SubPNode *node, int length) {
  * @param length    packet length in bit
  */
 void QDM2Stream::process_subpacket_11(QDM2SubPNode *node, int length) {
-	Common::MemoryReadStream d(((node == NULL) ? _emptyBuffer : node->packet->data), ((node == NULL) ? 0 : node->packet->size*8));
-	Common::BitStream32LELSB gb(&d);
+	Common::BitStreamMemoryStream d(((node == NULL) ? _emptyBuffer : node->packet->data), ((node == NULL) ? 0 : node->packet->size));
+	Common::BitStreamMemory32LELSB gb(&d);
 
 	if (length >= 32) {
 		int c = gb.getBits(13);
@@ -1959,8 +1958,8 @@ void QDM2Stream::process_subpacket_11(QDM2SubPNode *node, int length) {
  * @param length    packet length in bits
  */
 void QDM2Stream::process_subpacket_12(QDM2SubPNode *node, int length) {
-	Common::MemoryReadStream d(((node == NULL) ? _emptyBuffer : node->packet->data), ((node == NULL) ? 0 : node->packet->size*8));
-	Common::BitStream32LELSB gb(&d);
+	Common::BitStreamMemoryStream d(((node == NULL) ? _emptyBuffer : node->packet->data), ((node == NULL) ? 0 : node->packet->size));
+	Common::BitStreamMemory32LELSB gb(&d);
 
 	synthfilt_build_sb_samples(&gb, length, 8, QDM2_SB_USED(_subSampling));
 }
@@ -2014,8 +2013,8 @@ void QDM2Stream::qdm2_decode_super_block(void) {
 
 	average_quantized_coeffs(); // average elements in quantized_coeffs[max_ch][10][8]
 
-	Common::MemoryReadStream *d = new Common::MemoryReadStream(_compressedData, _packetSize*8);
-	Common::BitStream *gb = new Common::BitStream32LELSB(d);
+	Common::BitStreamMemoryStream *d = new Common::BitStreamMemoryStream(_compressedData, _packetSize);
+	Common::BitStream *gb = new Common::BitStreamMemory32LELSB(d);
 	//qdm2_decode_sub_packet_header
 	header.type = gb->getBits(8);
 
@@ -2048,8 +2047,8 @@ void QDM2Stream::qdm2_decode_super_block(void) {
 
 	delete gb;
 	delete d;
-	d = new Common::MemoryReadStream(header.data, header.size*8);
-	gb = new Common::BitStream32LELSB(d);
+	d = new Common::BitStreamMemoryStream(header.data, header.size);
+	gb = new Common::BitStreamMemory32LELSB(d);
 
 	if (header.type == 2 || header.type == 4 || header.type == 5) {
 		int csum = 257 * gb->getBits(8) + 2 * gb->getBits(8);
@@ -2081,8 +2080,8 @@ void QDM2Stream::qdm2_decode_super_block(void) {
 			// seek to next block
 			delete gb;
 			delete d;
-			d = new Common::MemoryReadStream(header.data, header.size*8);
-			gb = new Common::BitStream32LELSB(d);
+			d = new Common::BitStreamMemoryStream(header.data, header.size);
+			gb = new Common::BitStreamMemory32LELSB(d);
 			gb->skip(next_index*8);
 
 			if (next_index >= header.size)
@@ -2291,8 +2290,8 @@ void QDM2Stream::qdm2_decode_fft_packets(void) {
 			return;
 
 		// decode FFT tones
-		Common::MemoryReadStream d(packet->data, packet->size*8);
-		Common::BitStream32LELSB gb(&d);
+		Common::BitStreamMemoryStream d(packet->data, packet->size);
+		Common::BitStreamMemory32LELSB gb(&d);
 
 		if (packet->type >= 32 && packet->type < 48 && !fft_subpackets[packet->type - 16])
 			unknown_flag = 1;
@@ -28,6 +28,12 @@
 #include "audio/audiostream.h"
 #include "audio/decoders/raw.h"
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace Audio {
 
 // This used to be an inline template function, but
@@ -38,6 +44,66 @@ namespace Audio {
 #define READ_ENDIAN_SAMPLE(is16Bit, isUnsigned, ptr, isLE) \
 	((is16Bit ? (isLE ? READ_LE_UINT16(ptr) : READ_BE_UINT16(ptr)) : (*ptr << 8)) ^ (isUnsigned ? 0x8000 : 0))
 
+/**
+ * Convert raw samples to native 16 bit signed ones. 16 bit samples are
+ * converted in place, so src has to be the same as dst for them.
+ */
+template<bool is16Bit, bool isUnsigned, bool isLE>
+static void convertSamples(int16 *dst, const byte *src, int count) {
+	int i = 0;
+
+	if (is16Bit) {
+#ifdef SCUMM_LITTLE_ENDIAN
+		const bool swap = !isLE;
+#else
+		const bool swap = isLE;
+#endif
+		if (!swap && !isUnsigned)
+			return;
+
+#if defined(__wasm_simd128__)
+		const v128_t sign = wasm_i16x8_splat(isUnsigned ? (int16)0x8000 : 0);
+		for (; i + 8 <= count; i += 8) {
+			v128_t v = wasm_v128_load(dst + i);
+			if (swap)
+				v = wasm_v128_or(wasm_i16x8_shl(v, 8), wasm_u16x8_shr(v, 8));
+			wasm_v128_store(dst + i, wasm_v128_xor(v, sign));
+		}
+#elif defined(__SSE2__)
+		const __m128i sign = _mm_set1_epi16(isUnsigned ? (int16)0x8000 : 0);
+		for (; i + 8 <= count; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(dst + i));
+			if (swap)
+				v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(v, sign));
+		}
+#endif
+
+		for (; i < count; i++)
+			dst[i] = READ_ENDIAN_SAMPLE(is16Bit, isUnsigned, (src + i * 2), isLE);
+	} else {
+#if defined(__wasm_simd128__)
+		const v128_t sign = wasm_i16x8_splat(isUnsigned ? (int16)0x8000 : 0);
+		for (; i + 16 <= count; i += 16) {
+			const v128_t v = wasm_v128_load(src + i);
+			wasm_v128_store(dst + i, wasm_v128_xor(wasm_i16x8_shl(wasm_u16x8_extend_low_u8x16(v), 8), sign));
+			wasm_v128_store(dst + i + 8, wasm_v128_xor(wasm_i16x8_shl(wasm_u16x8_extend_high_u8x16(v), 8), sign));
+		}
+#elif defined(__SSE2__)
+		const __m128i sign = _mm_set1_epi16(isUnsigned ? (int16)0x8000 : 0);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= count; i += 16) {
+			const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(_mm_unpacklo_epi8(zero, v), sign));
+			_mm_storeu_si128((__m128i *)(dst + i + 8), _mm_xor_si128(_mm_unpackhi_epi8(zero, v), sign));
+		}
+#endif
+
+		for (; i < count; i++)
+			dst[i] = READ_ENDIAN_SAMPLE(is16Bit, isUnsigned, (src + i), isLE);
+	}
+}
+
 
 #pragma mark -
 #pragma mark --- RawStream ---
@@ -51,9 +117,12 @@ class RawStream : public SeekableAudioStream {
 public:
 	RawStream(int rate, bool stereo, DisposeAfterUse::Flag disposeStream, Common::SeekableReadStream *stream)
 		: _rate(rate), _isStereo(stereo), _playtime(0, rate), _stream(stream, disposeStream), _endOfData(false), _buffer(0) {
-		// Setup our buffer for readBuffer
-		_buffer = new byte[kSampleBufferLength * (is16Bit ? 2 : 1)];
-		assert(_buffer);
+		// Setup our buffer for readBuffer. 16 bit samples are read
+		// straight into the output buffer, so only 8 bit ones need it.
+		if (!is16Bit) {
+			_buffer = new byte[kSampleBufferLength];
+			assert(_buffer);
+		}
 
 		// Calculate the total playtime of the stream
 		_playtime = Timestamp(0, _stream->size() / (_isStereo ? 2 : 1) / (is16Bit ? 2 : 1), rate);
@@ -79,7 +148,7 @@ private:
 	Common::DisposablePtr<Common::SeekableReadStream> _stream; ///< Stream to read data from
 	bool _endOfData;                                           ///< Whether the stream end has been reached
 
-	byte *_buffer;                                             ///< Buffer used in readBuffer
+	byte *_buffer;                                             ///< Buffer used in readBuffer for 8 bit samples
 	enum {
 		/**
 		 * How many samples we can buffer at once.
@@ -91,12 +160,13 @@ private:
 	};
 
 	/**
-	 * Fill the temporary sample buffer used in readBuffer.
+	 * Read raw samples from the stream.
 	 *
+	 * @param dst Buffer to read the samples into.
 	 * @param maxSamples Maximum samples to read.
 	 * @return actual count of samples read.
 	 */
-	int fillBuffer(int maxSamples);
+	int fillBuffer(byte *dst, int maxSamples);
 };
 
 template<bool is16Bit, bool isUnsigned, bool isLE>
@@ -104,8 +174,10 @@ int RawStream<is16Bit, isUnsigned, isLE>::readBuffer(int16 *buffer, const int nu
 	int samplesLeft = numSamples;
 
 	while (samplesLeft > 0) {
-		// Try to read up to "samplesLeft" samples.
-		int len = fillBuffer(samplesLeft);
+		// Try to read up to "samplesLeft" samples. 16 bit samples are
+		// read into the caller's buffer and converted in place.
+		byte *src = is16Bit ? (byte *)buffer : _buffer;
+		int len = fillBuffer(src, is16Bit ? samplesLeft : MIN<int>(kSampleBufferLength, samplesLeft));
 
 		// In case we were not able to read any samples
 		// we will stop reading here.
@@ -115,26 +187,17 @@ int RawStream<is16Bit, isUnsigned, isLE>::readBuffer(int16 *buffer, const int nu
 		// Adjust the samples left to read.
 		samplesLeft -= len;
 
-		// Copy the data to the caller's buffer.
-		const byte *src = _buffer;
-		while (len-- > 0) {
-			*buffer++ = READ_ENDIAN_SAMPLE(is16Bit, isUnsigned, src, isLE);
-			src += (is16Bit ? 2 : 1);
-		}
+		// Convert the data in the caller's buffer.
+		convertSamples<is16Bit, isUnsigned, isLE>(buffer, src, len);
+		buffer += len;
 	}
 
 	return numSamples - samplesLeft;
 }
 
 template<bool is16Bit, bool isUnsigned, bool isLE>
-int RawStream<is16Bit, isUnsigned, isLE>::fillBuffer(int maxSamples) {
+int RawStream<is16Bit, isUnsigned, isLE>::fillBuffer(byte *dst, int maxSamples) {
 	int bufferedSamples = 0;
-	byte *dst = _buffer;
-
-	// We can only read up to "kSampleBufferLength" samples
-	// so we take this into consideration, when trying to
-	// read up to maxSamples.
-	maxSamples = MIN<int>(kSampleBufferLength, maxSamples);
 
 	// We will only read up to maxSamples
 	while (maxSamples > 0 && !endOfData()) {
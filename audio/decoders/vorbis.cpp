@@ -35,6 +35,7 @@
 #include "common/util.h"
 
 #include "audio/audiostream.h"
+#include "audio/decodeahead.h"
 
 #ifdef USE_TREMOR
 #ifdef USE_TREMOLO
@@ -248,7 +249,7 @@ SeekableAudioStream *makeVorbisStream(
 		delete s;
 		return 0;
 	} else {
-		return s;
+		return makeConfiguredDecodeAheadStream(s);
 	}
 }
 
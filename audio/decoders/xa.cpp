@@ -43,6 +43,25 @@ private:
 
 	void seekToPos(uint pos);
 
+	enum {
+		/** Size of a block: the predictor and shift, the flags and 28 nibbles */
+		kBlockSize = 16,
+		/** Number of blocks read from the stream at a time */
+		kBufferBlocks = 64
+	};
+
+	byte _buffer[kBlockSize * kBufferBlocks];
+	uint _bufferStart;	///< Stream position of the start of _buffer
+	uint _bufferPos;	///< Position of the next block in _buffer
+	uint _bufferSize;	///< Number of bytes in _buffer
+
+	/**
+	 * Return the next block, refilling the buffer from the stream when it
+	 * runs out. A block cut short by the end of the stream is padded with
+	 * zeros.
+	 */
+	const byte *nextBlock();
+
 	byte _predictor;
 	double _samples[28];
 	byte _samplesRemaining;
@@ -60,6 +79,8 @@ XAStream::XAStream(Common::SeekableReadStream *stream, int rate, DisposeAfterUse
 	_rate = rate;
 	_loopPoint = 0;
 	_endOfData = false;
+	_bufferStart = stream->pos();
+	_bufferPos = _bufferSize = 0;
 }
 
 
@@ -95,18 +116,21 @@ int XAStream::readBuffer(int16 *buffer, const int numSamples) {
 	while (samplesDecoded < numSamples) {
 		byte i = 0;
 
-		_predictor = _stream->readByte();
+		const uint blockPos = _bufferStart + _bufferPos;
+		const byte *block = nextBlock();
+
+		_predictor = block[0];
 		byte shift = _predictor & 0xf;
 		_predictor >>= 4;
 
-		byte flags = _stream->readByte();
+		byte flags = block[1];
 		if (flags == 3) {
 			// Loop
 			seekToPos(_loopPoint);
 			continue;
 		} else if (flags == 6) {
 			// Set loop point
-			_loopPoint = _stream->pos() - 2;
+			_loopPoint = blockPos;
 		} else if (flags == 7) {
 			// End of stream
 			_endOfData = true;
@@ -114,7 +138,7 @@ int XAStream::readBuffer(int16 *buffer, const int numSamples) {
 		}
 
 		for (i = 0; i < 28; i += 2) {
-			byte d = _stream->readByte();
+			byte d = block[2 + i / 2];
 			int16 s = (d & 0xf) << 12;
 			if (s & 0x8000)
 				s |= 0xffff0000;
@@ -125,25 +149,49 @@ int XAStream::readBuffer(int16 *buffer, const int numSamples) {
 			_samples[i + 1] = (double)(s >> shift);
 		}
 
+		const double coeff1 = s_xaDataTable[_predictor][0];
+		const double coeff2 = s_xaDataTable[_predictor][1];
+		double s1 = _s1;
+		double s2 = _s2;
 		for (i = 0; i < 28 && samplesDecoded < numSamples; i++) {
-			_samples[i] = _samples[i] + _s1 * s_xaDataTable[_predictor][0] + _s2 * s_xaDataTable[_predictor][1];
-			_s2 = _s1;
-			_s1 = _samples[i];
-			int16 d = (int) (_samples[i] + 0.5);
-			buffer[samplesDecoded] = d;
-			samplesDecoded++;
+			_samples[i] = _samples[i] + s1 * coeff1 + s2 * coeff2;
+			s2 = s1;
+			s1 = _samples[i];
+			buffer[samplesDecoded++] = (int) (_samples[i] + 0.5);
 		}
+		_s1 = s1;
+		_s2 = s2;
 
 		if (i != 28)
 			_samplesRemaining = 28 - i;
 
-		if (_stream->pos() >= _stream->size())
+		if (_bufferStart + _bufferPos >= (uint)_stream->size())
 			_endOfData = true;
 	}
 
 	return samplesDecoded;
 }
 
+const byte *XAStream::nextBlock() {
+	if (_bufferPos + kBlockSize > _bufferSize) {
+		// Keep the start of a block cut short by the end of the buffer
+		const uint left = _bufferSize - _bufferPos;
+		memmove(_buffer, _buffer + _bufferPos, left);
+		_bufferStart += _bufferPos;
+		_bufferSize = left + _stream->read(_buffer + left, sizeof(_buffer) - left);
+		_bufferPos = 0;
+
+		if (_bufferSize < kBlockSize) {
+			memset(_buffer + _bufferSize, 0, kBlockSize - _bufferSize);
+			_bufferSize = kBlockSize;
+		}
+	}
+
+	const byte *block = _buffer + _bufferPos;
+	_bufferPos += kBlockSize;
+	return block;
+}
+
 bool XAStream::rewind() {
 	seekToPos(0);
 	return true;
@@ -151,6 +199,8 @@ bool XAStream::rewind() {
 
 void XAStream::seekToPos(uint pos) {
 	_stream->seek(pos);
+	_bufferStart = pos;
+	_bufferPos = _bufferSize = 0;
 	_samplesRemaining = 0;
 	_predictor = 0;
 	_s1 = _s2 = 0.0;
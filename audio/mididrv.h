@@ -119,6 +119,22 @@ public:
 	 */
 	virtual void sysEx(const byte *msg, uint16 length) { }
 
+	/**
+	 * Output a packed midi command which is due the given number of
+	 * microseconds after the current timer callback of the driver.
+	 *
+	 * This may only be called from within that timer callback. Drivers
+	 * which render their own audio apply the command at the matching
+	 * sample; all others send it right away.
+	 */
+	virtual void sendDelayed(uint32 b, uint32 delayUs) { send(b); }
+
+	/**
+	 * Transmit a sysEx which is due the given number of microseconds
+	 * after the current timer callback. See sendDelayed() and sysEx().
+	 */
+	virtual void sysExDelayed(const byte *msg, uint16 length, uint32 delayUs) { sysEx(msg, length); }
+
 	// TODO: Document this.
 	virtual void metaEvent(byte type, byte *data, uint16 length) { }
 };
@@ -42,6 +42,8 @@ _autoLoop(false),
 _smartJump(false),
 _centerPitchWheelOnUnload(false),
 _sendSustainOffOnNotesOff(false),
+_sampleAccurate(false),
+_eventDelay(-1),
 _numTracks(0),
 _activeTrack(255),
 _abortParse(0) {
@@ -67,11 +69,24 @@ void MidiParser::property(int prop, int value) {
 	case mpSendSustainOffOnNotesOff:
 		_sendSustainOffOnNotesOff = (value != 0);
 		break;
+	case mpSampleAccurate:
+		_sampleAccurate = (value != 0);
+		break;
 	}
 }
 
 void MidiParser::sendToDriver(uint32 b) {
-	_driver->send(b);
+	if (_eventDelay >= 0)
+		_driver->sendDelayed(b, _eventDelay);
+	else
+		_driver->send(b);
+}
+
+void MidiParser::sysExToDriver(const byte *msg, uint16 length) {
+	if (_eventDelay >= 0)
+		_driver->sysExDelayed(msg, length, _eventDelay);
+	else
+		_driver->sysEx(msg, length);
 }
 
 void MidiParser::setTempo(uint32 tempo) {
@@ -179,6 +194,7 @@ void MidiParser::onTimer() {
 		for (i = ARRAYSIZE(_hangingNotes); i; --i, ++ptr) {
 			if (ptr->timeLeft) {
 				if (ptr->timeLeft <= _timerRate) {
+					_eventDelay = _sampleAccurate ? (int32)ptr->timeLeft : -1;
 					sendToDriver(0x80 | ptr->channel, ptr->note, 0);
 					ptr->timeLeft = 0;
 					--_hangingNotesCount;
@@ -201,16 +217,20 @@ void MidiParser::onTimer() {
 		if (info.event < 0x80) {
 			warning("Bad command or running status %02X", info.event);
 			_position._playPos = 0;
+			_eventDelay = -1;
 			return;
 		}
 
+		if (_sampleAccurate)
+			_eventDelay = (eventTime > _position._playTime) ? (int32)(eventTime - _position._playTime) : 0;
+
 		if (info.event == 0xF0) {
 			// SysEx event
 			// Check for trailing 0xF7 -- if present, remove it.
 			if (info.ext.data[info.length-1] == 0xF7)
-				_driver->sysEx(info.ext.data, (uint16)info.length-1);
+				sysExToDriver(info.ext.data, (uint16)info.length-1);
 			else
-				_driver->sysEx(info.ext.data, (uint16)info.length);
+				sysExToDriver(info.ext.data, (uint16)info.length);
 		} else if (info.event == 0xFF) {
 			// META event
 			if (info.ext.type == 0x2F) {
@@ -223,6 +243,7 @@ void MidiParser::onTimer() {
 					stopPlaying();
 					_driver->metaEvent(info.ext.type, info.ext.data, (uint16)info.length);
 				}
+				_eventDelay = -1;
 				return;
 			} else if (info.ext.type == 0x51) {
 				if (info.length >= 3) {
@@ -248,6 +269,7 @@ void MidiParser::onTimer() {
 			parseNextEvent(_nextEvent);
 		}
 	}
+	_eventDelay = -1;
 
 	if (!_abortParse) {
 		_position._playTime = endTime;
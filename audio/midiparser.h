@@ -278,6 +278,8 @@ protected:
 	bool   _smartJump;      ///< Support smart expiration of hanging notes when jumping
 	bool   _centerPitchWheelOnUnload;  ///< Center the pitch wheels when unloading a song
 	bool   _sendSustainOffOnNotesOff;   ///< Send a sustain off on a notes off event, stopping hanging notes
+	bool   _sampleAccurate; ///< Pass the offset of each event within the timer interval on to the driver
+	int32  _eventDelay;     ///< Offset in microseconds of the event being dispatched, or -1 outside of onTimer()
 	byte  *_tracks[120];    ///< Multi-track MIDI formats are supported, up to 120 tracks.
 	byte   _numTracks;     ///< Count of total tracks for multi-track MIDI formats. 1 for single-track formats.
 	byte   _activeTrack;   ///< Keeps track of the currently active track, in multi-track formats.
@@ -302,6 +304,7 @@ protected:
 	void sendToDriver(byte status, byte firstOp, byte secondOp) {
 		sendToDriver(status | ((uint32)firstOp << 8) | ((uint32)secondOp << 16));
 	}
+	void sysExToDriver(const byte *msg, uint16 length);
 
 	/**
 	 * Platform independent BE uint32 read-and-advance.
@@ -363,7 +366,15 @@ public:
 		 * Sends a sustain off event when a notes off event is triggered.
 		 * Stops hanging notes.
 		 */
-		 mpSendSustainOffOnNotesOff = 5
+		 mpSendSustainOffOnNotesOff = 5,
+
+		/**
+		 * Hands events to the driver together with their offset inside
+		 * the current timer interval, instead of sending them all at the
+		 * start of it. Drivers which render their own audio use this to
+		 * place events at the exact sample.
+		 */
+		mpSampleAccurate = 6
 	};
 
 public:
@@ -20,11 +20,14 @@
  *
  */
 
+#include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
 #include "audio/mixer_intern.h"
+#include "audio/mixer_bus.h"
 #include "audio/rate.h"
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
@@ -46,20 +49,32 @@ public:
 	~Channel();
 
 	/**
-	 * Mixes the channel's samples into the given buffer.
+	 * Mixes the channel's samples into the given bus.
 	 *
-	 * @param data buffer where to mix the data
-	 * @param len  number of sample *pairs*. So a value of
-	 *             10 means that the buffer contains twice 10 sample, each
-	 *             16 bits, for a total of 40 bytes.
+	 * @param bus    the bus to mix into, see mixToBus()
+	 * @param buffer scratch buffer for the samples of the channel, of
+	 *               the same length as the bus
+	 * @param len    number of sample *pairs*
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int32 *bus, int16 *buffer, uint len);
 
 	/**
-	 * Queries whether the channel is still playing or not.
+	 * Queries whether the channel is still playing or not. The channel
+	 * plays on until the rate converter has given out its remaining
+	 * output.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isFinished() const { return _stream->endOfStream() && _drained; }
+
+	/**
+	 * Asks the mixer callback to stop mixing the channel.
+	 */
+	void requestStop() { _stopRequested = true; }
+
+	/**
+	 * Queries whether the channel was asked to stop.
+	 */
+	bool isStopRequested() const { return _stopRequested; }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -130,6 +145,11 @@ public:
 	 */
 	Mixer::SoundType getType() const { return _type; }
 
+	/**
+	 * Queries the channel's mixing statistics.
+	 */
+	const MixerImpl::ChannelStats &getStats() const { return _stats; }
+
 	/**
 	 * Sets the channel's sound handle.
 	 *
@@ -146,6 +166,8 @@ private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
 	bool _permanent;
+	volatile bool _stopRequested;
+	bool _drained;
 	int _pauseLevel;
 	int _id;
 
@@ -165,6 +187,8 @@ private:
 
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
+
+	MixerImpl::ChannelStats _stats;
 };
 
 #pragma mark -
@@ -173,17 +197,43 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _mixPassMutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _numSlots(0), _maxChannels(DEFAULT_MAX_CHANNELS), _stolenChannels(0), _channelPool(sizeof(Channel)),
+	  _mixPass(0), _bus(0), _channelBuffer(0), _bufferSize(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		_channels[i] = 0;
+	for (int i = 0; i != MAX_CHANNEL_CHUNKS; i++)
+		_mixChunks[i] = 0;
+
+	static const char *const priorityKeys[] = { "plain_priority", "music_priority", "sfx_priority", "speech_priority" };
+	_soundTypeSettings[kSFXSoundType].priority = 0;
+	_soundTypeSettings[kPlainSoundType].priority = 1;
+	_soundTypeSettings[kMusicSoundType].priority = 2;
+	_soundTypeSettings[kSpeechSoundType].priority = 3;
+
+	for (int i = 0; i < ARRAYSIZE(priorityKeys); i++) {
+		if (ConfMan.hasKey(priorityKeys[i]))
+			_soundTypeSettings[i].priority = ConfMan.getInt(priorityKeys[i]);
+	}
+
+	if (ConfMan.hasKey("mixer_channels"))
+		_maxChannels = CLIP<int>(ConfMan.getInt("mixer_channels"), 1, MAX_CHANNELS);
 }
 
 MixerImpl::~MixerImpl() {
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		delete _channels[i];
+	for (uint i = 0; i < _channels.size(); i++) {
+		if (_channels[i])
+			deleteChannel(_channels[i]);
+	}
+	for (uint i = 0; i < _stoppedChannels.size(); i++)
+		deleteChannel(_stoppedChannels[i]);
+
+	for (int i = 0; i != MAX_CHANNEL_CHUNKS; i++)
+		delete[] _mixChunks[i];
+
+	free(_bus);
+	free(_channelBuffer);
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -194,29 +244,160 @@ uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
+void MixerImpl::deleteChannel(Channel *chan) {
+	chan->~Channel();
+	_channelPool.freeChunk(chan);
+}
+
+int MixerImpl::allocSlot() {
+	for (uint i = 0; i < _channels.size(); i++) {
+		// Slots of stopped channels stay in use until the callback lets go
+		if (_channels[i] == 0 && mixSlot(i) == 0)
+			return i;
+	}
+
+	if (_numSlots == MAX_SLOTS)
+		return -1;
+
+	// Add another chunk of slots. The callback only looks at it once
+	// _numSlots has been increased.
+	const uint chunk = _numSlots / CHANNEL_CHUNK_SIZE;
+	_mixChunks[chunk] = new Channel *volatile[CHANNEL_CHUNK_SIZE];
+	for (int i = 0; i != CHANNEL_CHUNK_SIZE; i++)
+		_mixChunks[chunk][i] = 0;
+
+	const int index = _numSlots;
+	_channels.resize(_numSlots + CHANNEL_CHUNK_SIZE);
+	for (uint i = index; i < _channels.size(); i++)
+		_channels[i] = 0;
+
+	Common::memoryBarrier();
+	_numSlots += CHANNEL_CHUNK_SIZE;
+
+	return index;
+}
+
+int MixerImpl::findStealableChannel(SoundType type) const {
+	int victim = -1;
+
+	for (uint i = 0; i < _channels.size(); i++) {
+		const Channel *chan = _channels[i];
+		if (!chan || chan->isPermanent())
+			continue;
+
+		const int priority = _soundTypeSettings[chan->getType()].priority;
+		if (priority > _soundTypeSettings[type].priority)
+			continue;
+
+		// Take the lowest priority, and of those the sound which started first
+		if (victim == -1) {
+			victim = i;
+		} else {
+			const int victimPriority = _soundTypeSettings[_channels[victim]->getType()].priority;
+			if (priority < victimPriority ||
+				(priority == victimPriority && chan->getHandle()._val / MAX_SLOTS < _channels[victim]->getHandle()._val / MAX_SLOTS))
+				victim = i;
+		}
+	}
+
+	return victim;
+}
+
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
-	int index = -1;
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
-			index = i;
-			break;
+	reclaimChannels();
+
+	if (getChannelCount() >= _maxChannels) {
+		const int victim = findStealableChannel(chan->getType());
+		if (victim == -1) {
+			warning("MixerImpl::out of mixer slots");
+			deleteChannel(chan);
+			return;
 		}
+
+		debug(5, "MixerImpl: Stopping sound %d of type %d to make room", _channels[victim]->getId(), _channels[victim]->getType());
+		removeChannel(victim);
+		_stolenChannels++;
 	}
+
+	const int index = allocSlot();
 	if (index == -1) {
 		warning("MixerImpl::out of mixer slots");
-		delete chan;
+		deleteChannel(chan);
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
-	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	chanHandle._val = index + (_handleSeed * MAX_SLOTS);
 
 	chan->setHandle(chanHandle);
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	// Publish the channel to the callback only after it is set up
+	_channels[index] = chan;
+	Common::memoryBarrier();
+	mixSlot(index) = chan;
+}
+
+Channel *MixerImpl::findChannel(SoundHandle handle) {
+	reclaimChannels();
+
+	const uint index = handle._val % MAX_SLOTS;
+	if (index >= _channels.size() || !_channels[index] || _channels[index]->getHandle()._val != handle._val)
+		return 0;
+
+	return _channels[index];
+}
+
+void MixerImpl::removeChannel(int index) {
+	Channel *chan = _channels[index];
+	_channels[index] = 0;
+
+	if (mixSlot(index) != chan) {
+		// The callback let go of it already
+		deleteChannel(chan);
+		return;
+	}
+
+	chan->requestStop();
+	_stoppedChannels.push_back(chan);
+}
+
+void MixerImpl::reclaimChannels() {
+	Common::memoryBarrier();
+
+	for (uint i = 0; i < _channels.size(); i++) {
+		if (_channels[i] && mixSlot(i) != _channels[i]) {
+			// Finished playing
+			const ChannelStats &stats = _channels[i]->getStats();
+			debug(5, "MixerImpl: Sound %d finished, %d frames mixed, %d underruns", _channels[i]->getId(), stats.framesMixed, stats.underruns);
+			deleteChannel(_channels[i]);
+			_channels[i] = 0;
+		}
+	}
+
+	for (uint i = 0; i < _stoppedChannels.size(); ) {
+		Channel *chan = _stoppedChannels[i];
+		if (mixSlot(chan->getHandle()._val % MAX_SLOTS) != chan) {
+			deleteChannel(chan);
+			_stoppedChannels.remove_at(i);
+		} else {
+			i++;
+		}
+	}
+}
+
+void MixerImpl::waitForMixPass() {
+	Common::memoryBarrier();
+
+	const uint32 pass = _mixPass;
+	if (!(pass & 1))
+		return;
+
+	// The callback holds the pass mutex until the end of the pass, unless
+	// this is the callback thread itself
+	Common::StackLock passLock(_mixPassMutex);
 }
 
 void MixerImpl::playStream(
@@ -237,9 +418,11 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+	reclaimChannels();
+
 	// Prevent duplicate sounds
 	if (id != -1) {
-		for (int i = 0; i != NUM_CHANNELS; i++)
+		for (uint i = 0; i < _channels.size(); i++)
 			if (_channels[i] != 0 && _channels[i]->getId() == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
@@ -258,7 +441,7 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new (_channelPool) Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -267,7 +450,9 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
+	Common::StackLock passLock(_mixPassMutex);
+	_mixPass++;
+	Common::memoryBarrier();
 
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
@@ -277,64 +462,84 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+	if (len > _bufferSize) {
+		free(_bus);
+		free(_channelBuffer);
+		_bus = (int32 *)malloc(2 * len * sizeof(int32));
+		_channelBuffer = (int16 *)malloc(2 * len * sizeof(int16));
+		_bufferSize = len;
+
+		if (!_bus || !_channelBuffer)
+			error("MixerImpl::mixCallback: Cannot allocate mixing buffers");
+	}
+
+	memset(_bus, 0, 2 * len * sizeof(int32));
 
 	// mix all channels
 	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
-			}
+	const uint numSlots = _numSlots;
+	Common::memoryBarrier();
+	for (uint i = 0; i < numSlots; i++) {
+		Channel *chan = mixSlot(i);
+		if (!chan)
+			continue;
+
+		if (chan->isStopRequested() || chan->isFinished()) {
+			// Let go of the channel, it is deleted on the engine side
+			Common::memoryBarrier();
+			mixSlot(i) = 0;
+		} else if (!chan->isPaused()) {
+			tmp = chan->mix(_bus, _channelBuffer, len);
+
+			if (tmp > res)
+				res = tmp;
 		}
+	}
+
+	convertBus(buf, _bus, len);
+
+	Common::memoryBarrier();
+	_mixPass++;
 
 	return res;
 }
 
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+	for (uint i = 0; i < _channels.size(); i++) {
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			removeChannel(i);
 	}
+	waitForMixPass();
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+	for (uint i = 0; i < _channels.size(); i++) {
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			removeChannel(i);
 	}
+	waitForMixPass();
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!findChannel(handle))
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	removeChannel(handle._val % MAX_SLOTS);
+	waitForMixPass();
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= type && type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
+	for (uint i = 0; i < _channels.size(); ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
 			_channels[i]->notifyGlobalVolChange();
 	}
@@ -348,37 +553,31 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->setVolume(volume);
+	Channel *chan = findChannel(handle);
+	if (chan)
+		chan->setVolume(volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return 0;
+	Common::StackLock lock(_mutex);
 
-	return _channels[index]->getVolume();
+	Channel *chan = findChannel(handle);
+	return chan ? chan->getVolume() : 0;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->setBalance(balance);
+	Channel *chan = findChannel(handle);
+	if (chan)
+		chan->setBalance(balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return 0;
+	Common::StackLock lock(_mutex);
 
-	return _channels[index]->getBalance();
+	Channel *chan = findChannel(handle);
+	return chan ? chan->getBalance() : 0;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -388,16 +587,17 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Channel *chan = findChannel(handle);
+	if (!chan)
 		return Timestamp(0, _sampleRate);
 
-	return _channels[index]->getElapsedTime();
+	return chan->getElapsedTime();
 }
 
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
+	reclaimChannels();
+	for (uint i = 0; i < _channels.size(); i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
 		}
@@ -406,7 +606,8 @@ void MixerImpl::pauseAll(bool paused) {
 
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
+	reclaimChannels();
+	for (uint i = 0; i < _channels.size(); i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
 			return;
@@ -418,16 +619,15 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->pause(paused);
+	Channel *chan = findChannel(handle);
+	if (chan)
+		chan->pause(paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	reclaimChannels();
+	for (uint i = 0; i < _channels.size(); i++)
 		if (_channels[i] && _channels[i]->getId() == id)
 			return true;
 	return false;
@@ -435,21 +635,19 @@ bool MixerImpl::isSoundIDActive(int id) {
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
-	return 0;
+	Channel *chan = findChannel(handle);
+	return chan ? chan->getId() : 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return findChannel(handle) != 0;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	reclaimChannels();
+	for (uint i = 0; i < _channels.size(); i++)
 		if (_channels[i] && _channels[i]->getType() == type)
 			return true;
 	return false;
@@ -470,7 +668,7 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].volume = volume;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
+	for (uint i = 0; i < _channels.size(); ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
 			_channels[i]->notifyGlobalVolChange();
 	}
@@ -482,6 +680,46 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 	return _soundTypeSettings[type].volume;
 }
 
+bool MixerImpl::getChannelStats(SoundHandle handle, ChannelStats &stats) {
+	Common::StackLock lock(_mutex);
+
+	Channel *chan = findChannel(handle);
+	if (!chan)
+		return false;
+
+	stats = chan->getStats();
+	return true;
+}
+
+uint MixerImpl::getChannelCount() {
+	Common::StackLock lock(_mutex);
+	reclaimChannels();
+
+	uint count = 0;
+	for (uint i = 0; i < _channels.size(); i++)
+		if (_channels[i])
+			count++;
+	return count;
+}
+
+void MixerImpl::setMaxChannels(uint count) {
+	Common::StackLock lock(_mutex);
+	_maxChannels = CLIP<uint>(count, 1, MAX_CHANNELS);
+}
+
+void MixerImpl::setSoundTypePriority(SoundType type, int priority) {
+	assert(0 <= type && type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
+	_soundTypeSettings[type].priority = priority;
+}
+
+int MixerImpl::getSoundTypePriority(SoundType type) const {
+	assert(0 <= type && type < ARRAYSIZE(_soundTypeSettings));
+
+	return _soundTypeSettings[type].priority;
+}
+
 
 #pragma mark -
 #pragma mark --- Channel implementations ---
@@ -489,13 +727,15 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
                  DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
-    : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
+    : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _stopRequested(false), _drained(false), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
+	memset(&_stats, 0, sizeof(_stats));
+
 	// Get a rate converter instance
 	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
 }
@@ -595,21 +835,47 @@ Timestamp Channel::getElapsedTime() {
 	return ts;
 }
 
-int Channel::mix(int16 *data, uint len) {
+int Channel::mix(int32 *bus, int16 *buffer, uint len) {
 	assert(_stream);
 
-	int res = 0;
+	const bool endOfData = _stream->endOfData();
+	if (endOfData && !_stream->endOfStream()) {
+		_stats.underruns++;
+		return 0;
+	}
 
-	if (_stream->endOfData()) {
-		// TODO: call drain method
-	} else {
-		assert(_converter);
-		_samplesConsumed = _samplesDecoded;
-		_mixerTimeStamp = g_system->getMillis();
-		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
-		_samplesDecoded += res;
+	assert(_converter);
+	_samplesConsumed = _samplesDecoded;
+	_mixerTimeStamp = g_system->getMillis();
+	_pauseTime = 0;
+
+	// Convert at full volume, volume and balance are applied on the bus
+#ifdef OUTPUT_UNSIGNED_AUDIO
+	for (uint i = 0; i < 2 * len; ++i)
+		buffer[i] = (int16)0x8000;
+#else
+	memset(buffer, 0, 2 * len * sizeof(int16));
+#endif
+	int res = endOfData ? 0 : _converter->flow(*_stream, buffer, len, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+
+	// Once the stream is over, flush what the converter still holds
+	if ((uint)res < len && _stream->endOfStream()) {
+		const int drained = _converter->drain(buffer + 2 * res, len - res, Mixer::kMaxMixerVolume);
+		if ((uint)drained < len - res)
+			_drained = true;
+		res += drained;
 	}
+#ifdef OUTPUT_UNSIGNED_AUDIO
+	for (int i = 0; i < 2 * res; ++i)
+		buffer[i] ^= 0x8000;
+#endif
+
+	mixToBus(bus, buffer, res, _volL, _volR);
+	_samplesDecoded += res;
+
+	_stats.framesMixed += res;
+	if ((uint)res < len && !_stream->endOfStream())
+		_stats.underruns++;
 
 	return res;
 }
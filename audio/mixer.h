@@ -277,6 +277,39 @@ public:
 	 * @return the output sample rate in Hz
 	 */
 	virtual uint getOutputRate() const = 0;
+
+	/** Per channel statistics, updated while the channel is mixed. */
+	struct ChannelStats {
+		/** Sample pairs mixed */
+		uint32 framesMixed;
+		/** Mixer callbacks in which the stream ran out of data */
+		uint32 underruns;
+	};
+
+	/**
+	 * Get the mixing statistics of a channel.
+	 *
+	 * @return false if the handle is not active
+	 */
+	virtual bool getChannelStats(SoundHandle handle, ChannelStats &stats) = 0;
+
+	/**
+	 * Set the number of channels which may play at once. The default can
+	 * be set with the "mixer_channels" config key.
+	 */
+	virtual void setMaxChannels(uint count) = 0;
+	virtual uint getMaxChannels() const = 0;
+
+	/**
+	 * Set the priority of a sound type. When all channels are in use, a
+	 * new sound replaces a sound of a type with the same or a lower
+	 * priority. By default speech goes over music, which goes over plain
+	 * sounds, which go over sound effects. The defaults can be changed
+	 * with the "speech_priority", "music_priority", "plain_priority" and
+	 * "sfx_priority" config keys.
+	 */
+	virtual void setSoundTypePriority(SoundType type, int priority) = 0;
+	virtual int getSoundTypePriority(SoundType type) const = 0;
 };
 
 
@@ -0,0 +1,113 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/mixer_bus.h"
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Audio {
+
+// The bus holds samples scaled by the volume, so one unit of output is
+// kMaxMixerVolume units on the bus.
+enum {
+	kBusShift = 8,
+	kBusRound = 1 << (kBusShift - 1)
+};
+
+void mixToBus(int32 *bus, const int16 *src, uint frames, uint16 volL, uint16 volR) {
+	if (!volL && !volR)
+		return;
+
+	uint samples = frames * 2;
+
+#if defined(__wasm_simd128__)
+	const v128_t vol = wasm_i32x4_make(volL, volR, volL, volR);
+	for (; samples >= 8; samples -= 8, src += 8, bus += 8) {
+		const v128_t in = wasm_v128_load(src);
+		wasm_v128_store(bus, wasm_i32x4_add(wasm_v128_load(bus), wasm_i32x4_mul(wasm_i32x4_extend_low_i16x8(in), vol)));
+		wasm_v128_store(bus + 4, wasm_i32x4_add(wasm_v128_load(bus + 4), wasm_i32x4_mul(wasm_i32x4_extend_high_i16x8(in), vol)));
+	}
+#elif defined(__SSE2__)
+	// Volumes are at most 256, so the 32 bit products are put together
+	// from the low and high halves of 16 bit multiplications.
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+	for (; samples >= 8; samples -= 8, src += 8, bus += 8) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)src);
+		const __m128i lo = _mm_mullo_epi16(in, vol);
+		const __m128i hi = _mm_mulhi_epi16(in, vol);
+		_mm_storeu_si128((__m128i *)bus, _mm_add_epi32(_mm_loadu_si128((const __m128i *)bus), _mm_unpacklo_epi16(lo, hi)));
+		_mm_storeu_si128((__m128i *)(bus + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(bus + 4)), _mm_unpackhi_epi16(lo, hi)));
+	}
+#endif
+
+	for (; samples >= 2; samples -= 2, src += 2, bus += 2) {
+		bus[0] += src[0] * (int32)volL;
+		bus[1] += src[1] * (int32)volR;
+	}
+}
+
+void convertBus(int16 *dst, const int32 *bus, uint frames) {
+	uint samples = frames * 2;
+
+#if defined(__wasm_simd128__)
+	const v128_t round = wasm_i32x4_splat(kBusRound);
+	for (; samples >= 8; samples -= 8, bus += 8, dst += 8) {
+		const v128_t a = wasm_i32x4_shr(wasm_i32x4_add(wasm_v128_load(bus), round), kBusShift);
+		const v128_t b = wasm_i32x4_shr(wasm_i32x4_add(wasm_v128_load(bus + 4), round), kBusShift);
+		v128_t out = wasm_i16x8_narrow_i32x4(a, b);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		out = wasm_v128_xor(out, wasm_i16x8_splat((int16)0x8000));
+#endif
+		wasm_v128_store(dst, out);
+	}
+#elif defined(__SSE2__)
+	const __m128i round = _mm_set1_epi32(kBusRound);
+	for (; samples >= 8; samples -= 8, bus += 8, dst += 8) {
+		const __m128i a = _mm_srai_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i *)bus), round), kBusShift);
+		const __m128i b = _mm_srai_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i *)(bus + 4)), round), kBusShift);
+		__m128i out = _mm_packs_epi32(a, b);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		out = _mm_xor_si128(out, _mm_set1_epi16((int16)0x8000));
+#endif
+		_mm_storeu_si128((__m128i *)dst, out);
+	}
+#endif
+
+	for (; samples > 0; --samples) {
+		int32 val = (*bus++ + kBusRound) >> kBusShift;
+		if (val > 32767)
+			val = 32767;
+		else if (val < -32768)
+			val = -32768;
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		*dst++ = (int16)val ^ 0x8000;
+#else
+		*dst++ = (int16)val;
+#endif
+	}
+}
+
+} // End of namespace Audio
@@ -0,0 +1,64 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_MIXER_BUS_H
+#define AUDIO_MIXER_BUS_H
+
+#include "common/scummsys.h"
+
+namespace Audio {
+
+/**
+ * @file
+ * Kernels of the mixing bus used by MixerImpl.
+ *
+ * Channels are accumulated into a bus of 32 bit stereo sample pairs, which
+ * holds the samples scaled by the channel volume (0 - Mixer::kMaxMixerVolume)
+ * without any intermediate clipping. The bus is rounded and saturated to 16
+ * bit once, after all channels have been mixed in.
+ */
+
+/**
+ * Add the given stereo samples to the bus, scaled by the left and right
+ * channel volume.
+ *
+ * @param bus		the bus to mix into
+ * @param src		stereo 16 bit samples
+ * @param frames	number of sample pairs
+ * @param volL		volume of the left channel, 0 - Mixer::kMaxMixerVolume
+ * @param volR		volume of the right channel, 0 - Mixer::kMaxMixerVolume
+ */
+void mixToBus(int32 *bus, const int16 *src, uint frames, uint16 volL, uint16 volR);
+
+/**
+ * Convert the bus into 16 bit output samples, honoring
+ * OUTPUT_UNSIGNED_AUDIO.
+ *
+ * @param dst		output buffer for the stereo samples
+ * @param bus		the bus to convert
+ * @param frames	number of sample pairs
+ */
+void convertBus(int16 *dst, const int32 *bus, uint frames);
+
+} // End of namespace Audio
+
+#endif
@@ -24,6 +24,8 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
+#include "common/memorypool.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
 
@@ -42,6 +44,16 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * The mixer callback does not take any lock. Channels are handed over to it
+ * through a slot table, see _mixChunks, and are deleted on the engine side
+ * once the callback has let go of them. Changes of the volume, balance or
+ * pause state of a channel are picked up by the callback as they happen.
+ *
+ * The slot table grows as needed, up to MAX_SLOTS. Once the configured
+ * number of channels is playing, a new sound replaces the oldest sound of
+ * the lowest priority sound type, as long as that priority is not higher
+ * than its own, see setSoundTypePriority().
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -51,25 +63,77 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		/** Number of slots added to the slot table at a time */
+		CHANNEL_CHUNK_SIZE = 16,
+		/** Hard limit of the number of playing channels */
+		MAX_CHANNELS = 256,
+		/**
+		 * Size limit of the slot table. The spare chunk holds the stopped
+		 * channels which the callback did not let go of yet, so a sound
+		 * replacing another one finds a slot even at MAX_CHANNELS.
+		 */
+		MAX_SLOTS = MAX_CHANNELS + CHANNEL_CHUNK_SIZE,
+		MAX_CHANNEL_CHUNKS = MAX_SLOTS / CHANNEL_CHUNK_SIZE,
+		/** Default limit of the number of playing channels */
+		DEFAULT_MAX_CHANNELS = 32
 	};
 
+	/** Serializes the engine side calls, the mixer callback never takes it */
 	Common::Mutex _mutex;
 
+	/**
+	 * Held by the mixer callback during a pass. The engine side only takes
+	 * it to wait for a running pass, see waitForMixPass().
+	 */
+	Common::Mutex _mixPassMutex;
+
 	const uint _sampleRate;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
 	struct SoundTypeSettings {
-		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
+		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume), priority(0) {}
 
 		bool mute;
 		int volume;
+		int priority;
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
-	Channel *_channels[NUM_CHANNELS];
 
+	/** Channels as seen by the engine side, indexed by slot */
+	Common::Array<Channel *> _channels;
+
+	/**
+	 * Channels as seen by the mixer callback, in chunks of
+	 * CHANNEL_CHUNK_SIZE slots. A slot is only set by the engine side while
+	 * it is empty, and only cleared by the callback once it does not use
+	 * the channel anymore. Chunks are only added, and published by
+	 * increasing _numSlots.
+	 */
+	Channel *volatile *_mixChunks[MAX_CHANNEL_CHUNKS];
+	volatile uint _numSlots;
+
+	/** Limit of the number of playing channels */
+	uint _maxChannels;
+	/** Number of sounds which were stopped to make room for another one */
+	uint32 _stolenChannels;
+
+	/** Storage of the Channel objects */
+	Common::MemoryPool _channelPool;
+
+	/** Stopped channels which the mixer callback still has to let go of */
+	Common::Array<Channel *> _stoppedChannels;
+
+	/** Incremented when entering and when leaving the mixer callback */
+	volatile uint32 _mixPass;
+
+	/** 32 bit mixing bus, see mixToBus() */
+	int32 *_bus;
+	/** Buffer the channels are rendered into before being mixed */
+	int16 *_channelBuffer;
+	/** Size of the buffers in sample pairs */
+	uint _bufferSize;
 
 public:
 
@@ -118,14 +182,61 @@ public:
 
 	virtual uint getOutputRate() const;
 
+	virtual bool getChannelStats(SoundHandle handle, ChannelStats &stats);
+
+	/** Set the number of channels which may play at once, at most MAX_CHANNELS. */
+	virtual void setMaxChannels(uint count);
+	virtual uint getMaxChannels() const { return _maxChannels; }
+
+	virtual void setSoundTypePriority(SoundType type, int priority);
+	virtual int getSoundTypePriority(SoundType type) const;
+
+	/** Number of playing channels. */
+	uint getChannelCount();
+
+	/** Number of sounds which were stopped to make room for another one. */
+	uint32 getStolenChannelCount() const { return _stolenChannels; }
+
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/** Get the channel of a handle, or 0 if it stopped or finished playing. */
+	Channel *findChannel(SoundHandle handle);
+
+	/** Slot of the mixer callback belonging to the given index. */
+	Channel *volatile &mixSlot(uint index) { return _mixChunks[index / CHANNEL_CHUNK_SIZE][index % CHANNEL_CHUNK_SIZE]; }
+
+	/** Get an unused slot, growing the slot table if needed, or -1. */
+	int allocSlot();
+
+	/**
+	 * Find the channel to replace by a new sound of the given type, or -1
+	 * if none is allowed to be replaced.
+	 */
+	int findStealableChannel(SoundType type) const;
+
+	void deleteChannel(Channel *chan);
+
+	/** Remove a channel on the engine side and hand it to the callback for stopping. */
+	void removeChannel(int index);
+
+	/** Delete the channels which finished playing or were stopped. */
+	void reclaimChannels();
+
+	/**
+	 * Wait until a running mixer callback has finished its pass, so that
+	 * streams of stopped channels are not accessed anymore. Returns right
+	 * away when called from within the callback, e.g. by a stream, as the
+	 * pass mutex is recursive.
+	 */
+	void waitForMixPass();
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
 	 * the backend (e.g. from an audio mixing thread). All the actual mixing
-	 * work is done from here.
+	 * work is done from here. It never blocks on the engine side calls,
+	 * other than the ones waiting for the pass it is about to start.
 	 *
 	 * @param samples Sample buffer, in which stereo 16-bit samples will be stored.
 	 * @param len Length of the provided buffer to fill (in bytes, should be divisible by 4).
@@ -2,6 +2,7 @@ MODULE := audio
 
 MODULE_OBJS := \
 	audiostream.o \
+	decodeahead.o \
 	fmopl.o \
 	mididrv.o \
 	midiparser_qt.o \
@@ -10,6 +11,7 @@ MODULE_OBJS := \
 	midiparser.o \
 	midiplayer.o \
 	mixer.o \
+	mixer_bus.o \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
@@ -38,6 +40,7 @@ MODULE_OBJS := \
 	mods/tfmx.o \
 	softsynth/adlib.o \
 	softsynth/cms.o \
+	softsynth/emumidi.o \
 	softsynth/opl/dbopl.o \
 	softsynth/opl/dosbox.o \
 	softsynth/opl/mame.o \
@@ -50,6 +53,7 @@ MODULE_OBJS := \
 	softsynth/appleiigs.o \
 	softsynth/fluidsynth.o \
 	softsynth/mt32.o \
+	softsynth/mt32cache.o \
 	softsynth/eas.o \
 	softsynth/pcspk.o \
 	softsynth/sid.o \
@@ -31,10 +31,17 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/algorithm.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace Audio {
 
 
@@ -328,12 +335,259 @@ public:
 };
 
 
+#pragma mark -
+
+
+enum {
+	/** Length of the filter of each phase of the sinc resampler */
+	SINC_TAPS = 16,
+	/** Largest number of phases, i.e. output rate / gcd(input rate, output rate) */
+	SINC_MAX_PHASES = 1024,
+	/** Fixed point precision of the coefficients */
+	SINC_COEF_BITS = 14
+};
+
+/** Zeroth order modified Bessel function of the first kind, for the Kaiser window. */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+/**
+ * Compute the coefficients of a polyphase filter for upsampling by
+ * 'phases' and downsampling by 'step'. They are stored per phase in
+ * reverse order, so that a phase is applied as a dot product with the
+ * input samples in their natural order. The caller frees them.
+ */
+static int16 *makeSincCoefficients(uint phases, uint step) {
+	const uint length = SINC_TAPS * phases;
+	int16 *coefs = (int16 *)malloc(length * sizeof(int16));
+	double *filter = (double *)malloc(length * sizeof(double));
+	if (!coefs || !filter)
+		error("makeSincCoefficients: Cannot allocate %d coefficients", length);
+
+	// Low pass at 90% of the lower Nyquist frequency, in units of the
+	// upsampled rate, with a Kaiser window
+	const double cutoff = 0.9 * MIN(1.0, (double)phases / step) / phases;
+	const double center = (length - 1) / 2.0;
+	const double beta = 7.0;
+	for (uint j = 0; j < length; j++) {
+		const double x = (j - center) * cutoff;
+		const double sinc = (x == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+		const double r = (j - center) / center;
+		filter[j] = sinc * besselI0(beta * sqrt(MAX(0.0, 1.0 - r * r))) / besselI0(beta);
+	}
+
+	// Normalize every phase to unity gain, so that a constant signal stays
+	// constant whatever the phase
+	for (uint p = 0; p < phases; p++) {
+		double sum = 0.0;
+		for (int k = 0; k < SINC_TAPS; k++)
+			sum += filter[k * phases + p];
+
+		for (int k = 0; k < SINC_TAPS; k++) {
+			const double c = filter[k * phases + p] / sum * (1 << SINC_COEF_BITS);
+			coefs[p * SINC_TAPS + SINC_TAPS - 1 - k] = (int16)CLIP<double>(floor(c + 0.5), -32768, 32767);
+		}
+	}
+
+	free(filter);
+	return coefs;
+}
+
+/** Apply one phase of the filter to SINC_TAPS input samples. */
+static inline int sincDot(const int16 *coefs, const int16 *in) {
+#if defined(__wasm_simd128__)
+	const v128_t sum = wasm_i32x4_add(
+		wasm_i32x4_dot_i16x8(wasm_v128_load(coefs), wasm_v128_load(in)),
+		wasm_i32x4_dot_i16x8(wasm_v128_load(coefs + 8), wasm_v128_load(in + 8)));
+	return wasm_i32x4_extract_lane(sum, 0) + wasm_i32x4_extract_lane(sum, 1) +
+	       wasm_i32x4_extract_lane(sum, 2) + wasm_i32x4_extract_lane(sum, 3);
+#elif defined(__SSE2__)
+	__m128i sum = _mm_add_epi32(
+		_mm_madd_epi16(_mm_loadu_si128((const __m128i *)coefs), _mm_loadu_si128((const __m128i *)in)),
+		_mm_madd_epi16(_mm_loadu_si128((const __m128i *)(coefs + 8)), _mm_loadu_si128((const __m128i *)(in + 8))));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+#else
+	int sum = 0;
+	for (int k = 0; k < SINC_TAPS; k++)
+		sum += coefs[k] * in[k];
+	return sum;
+#endif
+}
+
+/**
+ * Audio rate converter based on a windowed sinc filter, applied as a
+ * polyphase filter bank. Each output sample is the dot product of
+ * SINC_TAPS input samples with the coefficients of its phase.
+ *
+ * The input is read in blocks and kept per channel, so that the samples
+ * a phase is applied to are contiguous in memory. Once the input has
+ * ended, drain() feeds the filter with silence to flush the samples still
+ * in the history and the tail of the filter.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	enum {
+		HISTORY_SIZE = SINC_TAPS - 1 + INTERMEDIATE_BUFFER_SIZE
+	};
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** Input samples per channel, the oldest SINC_TAPS - 1 being kept from the last block */
+	st_sample_t history[stereo ? 2 : 1][HISTORY_SIZE];
+	uint historyLen;
+	/** Position of the first input sample of the current output sample */
+	uint pos;
+	/** Samples of silence still to be fed by drain() */
+	uint tail;
+
+	int16 *coefs;
+	uint phases;
+	/** Current phase and its increment per output sample */
+	uint phase, phaseInc;
+	/** Whole input samples to advance per output sample */
+	uint advance;
+
+	/** Read more input into the history, or silence if input is 0. */
+	bool refill(AudioStream *input);
+
+	int convert(AudioStream *input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
+	static st_sample_t filter(const int16 *c, const st_sample_t *in) {
+		return (st_sample_t)CLIP<int>((sincDot(c, in) + (1 << (SINC_COEF_BITS - 1))) >> SINC_COEF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate);
+	~SincRateConverter() {
+		free(coefs);
+	}
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return convert(&input, obuf, osamp, vol_l, vol_r);
+	}
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return convert(0, obuf, osamp, vol, vol);
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	const st_rate_t divisor = Common::gcd(inrate, outrate);
+	phases = outrate / divisor;
+	const uint step = inrate / divisor;
+	assert(phases <= SINC_MAX_PHASES);
+
+	coefs = makeSincCoefficients(phases, step);
+	phase = 0;
+	phaseInc = step % phases;
+	advance = step / phases;
+
+	// Start with silence as the input preceding the stream
+	memset(history, 0, sizeof(history));
+	historyLen = SINC_TAPS - 1;
+	pos = 0;
+
+	// The filter reaches SINC_TAPS - 1 samples back, so the last input
+	// sample is fully out once that much silence followed it
+	tail = SINC_TAPS - 1;
+}
+
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream *input) {
+	// Move the samples still needed to the front
+	const uint kept = historyLen - MIN(pos, historyLen);
+	for (int c = 0; c < (stereo ? 2 : 1); c++)
+		memmove(history[c], history[c] + historyLen - kept, kept * sizeof(st_sample_t));
+	pos -= historyLen - kept;
+	historyLen = kept;
+
+	const int space = MIN<int>(HISTORY_SIZE - historyLen, INTERMEDIATE_BUFFER_SIZE / (stereo ? 2 : 1));
+
+	if (!input) {
+		const uint len = MIN<uint>(space, tail);
+		if (!len)
+			return false;
+
+		for (int c = 0; c < (stereo ? 2 : 1); c++)
+			memset(history[c] + historyLen, 0, len * sizeof(st_sample_t));
+		historyLen += len;
+		tail -= len;
+		return true;
+	}
+
+	const int len = input->readBuffer(inBuf, space * (stereo ? 2 : 1));
+	if (len <= 0)
+		return false;
+
+	const st_sample_t *in = inBuf;
+	for (int i = 0; i < len / (stereo ? 2 : 1); i++) {
+		history[0][historyLen] = *in++;
+		if (stereo)
+			history[1][historyLen] = *in++;
+		historyLen++;
+	}
+
+	return true;
+}
+
+template<bool stereo, bool reverseStereo>
+int SincRateConverter<stereo, reverseStereo>::convert(AudioStream *input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	while (obuf < oend) {
+		// Make sure all samples of the filter are there
+		while (pos + SINC_TAPS > historyLen) {
+			if (!refill(input))
+				return (obuf - ostart) / 2;
+		}
+
+		const int16 *c = coefs + phase * SINC_TAPS;
+		st_sample_t out0, out1;
+		out0 = filter(c, history[0] + pos);
+		out1 = (stereo ? filter(c, history[1] + pos) : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+
+		// Increment input position
+		pos += advance;
+		phase += phaseInc;
+		if (phase >= phases) {
+			phase -= phases;
+			pos++;
+		}
+	}
+	return (obuf - ostart) / 2;
+}
+
+
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0) {
+		if (quality == kRateConverterAuto)
+			quality = (outrate >= 44100) ? kRateConverterHighQuality : kRateConverterFast;
+
+		if (quality == kRateConverterHighQuality && outrate / Common::gcd(inrate, outrate) <= SINC_MAX_PHASES) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate);
+		} else if ((inrate % outrate) == 0) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -346,14 +600,14 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, quality);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, quality);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, quality);
 }
 
 } // End of namespace Audio
@@ -75,10 +75,31 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Write the output still held by the converter, once the input has
+	 * ended.
+	 *
+	 * @return Number of sample pairs written into the buffer, less than
+	 *         osamp once the converter is empty.
+	 */
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+enum RateConverterQuality {
+	/** High quality for output rates of 44100 Hz and more, fast otherwise */
+	kRateConverterAuto,
+	/** Linear interpolation resp. dropping of samples */
+	kRateConverterFast,
+	/** Windowed sinc filter, where the ratio of the rates permits it */
+	kRateConverterHighQuality
+};
+
+/**
+ * Create a RateConverter for the given rates. The ARM optimized converters
+ * do not offer the high quality filter, so they ignore the quality.
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false,
+                                 RateConverterQuality quality = kRateConverterAuto);
 
 } // End of namespace Audio
 
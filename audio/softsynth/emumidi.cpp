@@ -0,0 +1,169 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/emumidi.h"
+
+uint32 MidiDriver_Emulated::delayToSamples(uint32 delayUs) const {
+	uint32 delay = (uint32)(((uint64)delayUs * getRate()) / 1000000);
+
+	// Events are never held back past the next timer callback, so a
+	// parser whose timer rate does not match ours cannot pile them up.
+	const uint32 maxDelay = _samplesPerTick >> FIXP_SHIFT;
+	if (delay > maxDelay)
+		delay = maxDelay;
+
+	return delay;
+}
+
+MidiDriver_Emulated::DelayedEvent *MidiDriver_Emulated::queueDelayedEvent(uint32 time) {
+	if (_delayedEventHead && _delayedEventCount == kMaxDelayedEvents) {
+		memmove(_delayedEvents, _delayedEvents + _delayedEventHead, (_delayedEventCount - _delayedEventHead) * sizeof(DelayedEvent));
+		_delayedEventCount -= _delayedEventHead;
+		_delayedEventHead = 0;
+	}
+	if (_delayedEventCount == kMaxDelayedEvents)
+		return 0;
+
+	// Keep the queue sorted by time. Events with the same time stay in
+	// the order in which they were sent.
+	int pos = _delayedEventCount;
+	while (pos > _delayedEventHead && (int32)(_delayedEvents[pos - 1].time - time) > 0) {
+		_delayedEvents[pos] = _delayedEvents[pos - 1];
+		--pos;
+	}
+	++_delayedEventCount;
+
+	DelayedEvent *event = &_delayedEvents[pos];
+	event->time = time;
+	event->b = 0;
+	event->sysExOffset = 0;
+	event->sysExLength = 0;
+	return event;
+}
+
+void MidiDriver_Emulated::dispatchDelayedEvents(bool all) {
+	while (_delayedEventHead < _delayedEventCount) {
+		const DelayedEvent &event = _delayedEvents[_delayedEventHead];
+		if (!all && (int32)(event.time - _samplePos) > 0)
+			break;
+
+		++_delayedEventHead;
+		if (event.sysExLength)
+			sysEx(_delayedSysEx + event.sysExOffset, event.sysExLength);
+		else
+			send(event.b);
+	}
+
+	if (_delayedEventHead == _delayedEventCount) {
+		_delayedEventHead = _delayedEventCount = 0;
+		_delayedSysExUsed = 0;
+	}
+}
+
+void MidiDriver_Emulated::sendDelayed(uint32 b, uint32 delayUs) {
+	if (!_inTimerCallback) {
+		send(b);
+		return;
+	}
+
+	const uint32 delay = delayToSamples(delayUs);
+	if (!delay && _delayedEventHead == _delayedEventCount) {
+		send(b);
+		return;
+	}
+
+	DelayedEvent *event = queueDelayedEvent(_samplePos + delay);
+	if (!event) {
+		dispatchDelayedEvents(true);
+		send(b);
+		return;
+	}
+	event->b = b;
+}
+
+void MidiDriver_Emulated::sysExDelayed(const byte *msg, uint16 length, uint32 delayUs) {
+	if (!_inTimerCallback || !length) {
+		sysEx(msg, length);
+		return;
+	}
+
+	const uint32 delay = delayToSamples(delayUs);
+	if (!delay && _delayedEventHead == _delayedEventCount) {
+		sysEx(msg, length);
+		return;
+	}
+
+	DelayedEvent *event = 0;
+	if (_delayedSysExUsed + length <= kDelayedSysExSize)
+		event = queueDelayedEvent(_samplePos + delay);
+	if (!event) {
+		dispatchDelayedEvents(true);
+		sysEx(msg, length);
+		return;
+	}
+
+	memcpy(_delayedSysEx + _delayedSysExUsed, msg, length);
+	event->sysExOffset = _delayedSysExUsed;
+	event->sysExLength = length;
+	_delayedSysExUsed += length;
+}
+
+int MidiDriver_Emulated::readBuffer(int16 *data, const int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+	int step;
+
+	do {
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		// Split the block at the next delayed event, so it takes effect
+		// at the sample it was scheduled for.
+		dispatchDelayedEvents(false);
+		if (_delayedEventHead < _delayedEventCount) {
+			const uint32 due = _delayedEvents[_delayedEventHead].time - _samplePos;
+			if ((uint32)step > due)
+				step = due;
+		}
+
+		generateSamples(data, step);
+		_samplePos += step;
+
+		_nextTick -= step << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			_inTimerCallback = true;
+			if (_timerProc)
+				(*_timerProc)(_timerParam);
+
+			onTimer();
+			_inTimerCallback = false;
+
+			_nextTick += _samplesPerTick;
+		}
+
+		data += step * stereoFactor;
+		len -= step;
+	} while (len);
+
+	return numSamples;
+}
@@ -43,6 +43,34 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	enum {
+		kMaxDelayedEvents = 128,
+		kDelayedSysExSize = 1024
+	};
+
+	/**
+	 * A midi event which was handed over with a delay from the timer
+	 * callback and is waiting for its sample position to be reached.
+	 */
+	struct DelayedEvent {
+		uint32 time;         ///< Due sample position
+		uint32 b;            ///< Packed midi command, unused for sysEx
+		uint16 sysExOffset;  ///< Offset of the sysEx data in _delayedSysEx
+		uint16 sysExLength;  ///< Length of the sysEx data, 0 for commands
+	};
+
+	DelayedEvent _delayedEvents[kMaxDelayedEvents];
+	int _delayedEventHead;
+	int _delayedEventCount;
+	byte _delayedSysEx[kDelayedSysExSize];
+	int _delayedSysExUsed;
+	uint32 _samplePos;
+	bool _inTimerCallback;
+
+	uint32 delayToSamples(uint32 delayUs) const;
+	DelayedEvent *queueDelayedEvent(uint32 time);
+	void dispatchDelayedEvents(bool all);
+
 protected:
 	int _baseFreq;
 
@@ -57,6 +85,11 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
+		_delayedEventHead(0),
+		_delayedEventCount(0),
+		_delayedSysExUsed(0),
+		_samplePos(0),
+		_inTimerCallback(false),
 		_baseFreq(250) {
 	}
 
@@ -72,6 +105,10 @@ public:
 
 		_samplesPerTick = (d << FIXP_SHIFT) + (r << FIXP_SHIFT) / _baseFreq;
 
+		_delayedEventHead = _delayedEventCount = 0;
+		_delayedSysExUsed = 0;
+		_samplePos = 0;
+
 		return 0;
 	}
 
@@ -86,35 +123,11 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
-	// AudioStream API
-	virtual int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
+	virtual void sendDelayed(uint32 b, uint32 delayUs);
+	virtual void sysExDelayed(const byte *msg, uint16 length, uint32 delayUs);
 
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
-
-			generateSamples(data, step);
-
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
-
-				onTimer();
-
-				_nextTick += _samplesPerTick;
-			}
-
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
-
-		return numSamples;
-	}
+	// AudioStream API
+	virtual int readBuffer(int16 *data, const int numSamples);
 
 	virtual bool endOfData() const {
 		return false;
@@ -220,6 +220,9 @@ int MidiDriver_MT32::open() {
 	_synth->setOutputGain(1.0f * gain);
 	_synth->setReverbOutputGain(0.68f * gain);
 
+	if (ConfMan.hasKey("mt32_render_threads"))
+		_synth->setRenderThreadCount(ConfMan.getInt("mt32_render_threads"));
+
 	_initializing = false;
 
 	if (screenFormat.bytesPerPixel > 1)
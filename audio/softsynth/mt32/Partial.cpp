@@ -44,6 +44,8 @@ Partial::Partial(Synth *useSynth, int useDebugPartialNum) :
 	ownerPart = -1;
 	poly = NULL;
 	pair = NULL;
+	deactivationPending = false;
+	slaveDeactivationPending = false;
 }
 
 Partial::~Partial() {
@@ -243,18 +245,22 @@ unsigned long Partial::generateSamples(Bit16s *partialBuf, unsigned long length)
 	}
 	alreadyOutputed = true;
 
+	bool ringModulating = hasRingModulatingSlave();
 	for (sampleNum = 0; sampleNum < length; sampleNum++) {
 		if (!tva->isPlaying() || !la32Pair.isActive(LA32PartialPair::MASTER)) {
-			deactivate();
+			deactivationPending = true;
 			break;
 		}
 		la32Pair.generateNextSample(LA32PartialPair::MASTER, getAmpValue(), tvp->nextPitch(), getCutoffValue());
-		if (hasRingModulatingSlave()) {
+		if (ringModulating) {
 			la32Pair.generateNextSample(LA32PartialPair::SLAVE, pair->getAmpValue(), pair->tvp->nextPitch(), pair->getCutoffValue());
 			if (!pair->tva->isPlaying() || !la32Pair.isActive(LA32PartialPair::SLAVE)) {
-				pair->deactivate();
+				// The slave stops contributing right away, exactly as if it had been deactivated here
+				la32Pair.deactivate(LA32PartialPair::SLAVE);
+				ringModulating = false;
+				slaveDeactivationPending = true;
 				if (mixType == 2) {
-					deactivate();
+					deactivationPending = true;
 					break;
 				}
 			}
@@ -266,6 +272,19 @@ unsigned long Partial::generateSamples(Bit16s *partialBuf, unsigned long length)
 	return renderedSamples;
 }
 
+void Partial::applyDeferredDeactivation() {
+	if (slaveDeactivationPending) {
+		slaveDeactivationPending = false;
+		if (pair != NULL) {
+			pair->deactivate();
+		}
+	}
+	if (deactivationPending) {
+		deactivationPending = false;
+		deactivate();
+	}
+}
+
 bool Partial::hasRingModulatingSlave() const {
 	return pair != NULL && structurePosition == 0 && (mixType == 1 || mixType == 2);
 }
@@ -63,6 +63,12 @@ private:
 	// TODO: This should be owned by PartialPair
 	LA32PartialPair la32Pair;
 
+	// Set by generateSamples() when this partial or its ring modulating slave has finished.
+	// The deactivation itself touches the Poly and Part shared with other partials,
+	// so it is left to applyDeferredDeactivation() once the render run is over.
+	bool deactivationPending;
+	bool slaveDeactivationPending;
+
 	Bit32u getAmpValue();
 	Bit32u getCutoffValue();
 
@@ -105,6 +111,10 @@ public:
 
 	// This function writes mono sample output to the provided buffer, and returns the number of samples written
 	unsigned long generateSamples(Bit16s *partialBuf, unsigned long length);
+
+	// Deactivates this partial and/or its slave if generateSamples() found they finished.
+	// Must be called after each render run, in partial order, from the rendering thread.
+	void applyDeferredDeactivation();
 };
 
 }
@@ -249,4 +249,11 @@ const Partial *PartialManager::getPartial(unsigned int partialNum) const {
 	return partialTable[partialNum];
 }
 
+Partial *PartialManager::getPartial(unsigned int partialNum) {
+	if (partialNum > MT32EMU_MAX_PARTIALS - 1) {
+		return NULL;
+	}
+	return partialTable[partialNum];
+}
+
 }
@@ -0,0 +1,79 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011, 2012, 2013 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mt32emu.h"
+#include "PartialRenderPool.h"
+
+namespace MT32Emu {
+
+PartialRenderPool::PartialRenderPool() {
+	taskCount = 0;
+	taskLength = 0;
+	buffers = new float[MT32EMU_MAX_PARTIALS * 2 * MAX_SAMPLES_PER_RUN];
+}
+
+PartialRenderPool::~PartialRenderPool() {
+	delete[] buffers;
+}
+
+unsigned int PartialRenderPool::setThreadCount(unsigned int count) {
+	if (count > MAX_RENDER_THREADS) {
+		count = MAX_RENDER_THREADS;
+	}
+	return workers.setThreadCount(count);
+}
+
+unsigned int PartialRenderPool::getThreadCount() const {
+	return workers.getThreadCount();
+}
+
+void PartialRenderPool::render(Partial **partials, unsigned int count, Bit32u length) {
+	for (unsigned int i = 0; i < count; i++) {
+		tasks[i] = partials[i];
+	}
+	taskCount = count;
+	taskLength = length;
+
+	if (count > 1 && workers.run(renderTasks, this)) {
+		return;
+	}
+	for (unsigned int i = 0; i < count; i++) {
+		taskOutput[i] = tasks[i]->produceOutput(&buffers[2 * i * MAX_SAMPLES_PER_RUN], &buffers[(2 * i + 1) * MAX_SAMPLES_PER_RUN], length);
+	}
+}
+
+void PartialRenderPool::renderTasks(void *pool, unsigned int thread) {
+	PartialRenderPool *renderPool = (PartialRenderPool *)pool;
+	unsigned int threadCount = renderPool->getThreadCount();
+	for (unsigned int i = thread; i < renderPool->taskCount; i += threadCount) {
+		renderPool->taskOutput[i] = renderPool->tasks[i]->produceOutput(&renderPool->buffers[2 * i * MAX_SAMPLES_PER_RUN], &renderPool->buffers[(2 * i + 1) * MAX_SAMPLES_PER_RUN], renderPool->taskLength);
+	}
+}
+
+bool PartialRenderPool::hasOutput(unsigned int index) const {
+	return taskOutput[index];
+}
+
+const float *PartialRenderPool::getLeftBuffer(unsigned int index) const {
+	return &buffers[2 * index * MAX_SAMPLES_PER_RUN];
+}
+
+const float *PartialRenderPool::getRightBuffer(unsigned int index) const {
+	return &buffers[(2 * index + 1) * MAX_SAMPLES_PER_RUN];
+}
+
+}
@@ -0,0 +1,66 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011, 2012, 2013 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_PARTIALRENDERPOOL_H
+#define MT32EMU_PARTIALRENDERPOOL_H
+
+#include "common/workerpool.h"
+
+namespace MT32Emu {
+
+class Partial;
+
+// Renders a set of partials on a pool of worker threads.
+// Each partial is rendered into its own buffer, so the caller can mix them in partial order
+// afterwards and get output bit-identical to rendering them serially.
+class PartialRenderPool {
+private:
+	Common::WorkerPool workers;
+
+	Partial *tasks[MT32EMU_MAX_PARTIALS];
+	bool taskOutput[MT32EMU_MAX_PARTIALS];
+	unsigned int taskCount;
+	Bit32u taskLength;
+
+	// MT32EMU_MAX_PARTIALS pairs of left and right buffers, MAX_SAMPLES_PER_RUN floats each
+	float *buffers;
+
+	// Renders every getThreadCount()-th task starting with the given thread's index
+	static void renderTasks(void *pool, unsigned int thread);
+
+public:
+	PartialRenderPool();
+	~PartialRenderPool();
+
+	// Sets the number of threads rendering partials, including the calling one.
+	// Returns the number actually used, which is 1 where threads are not available.
+	unsigned int setThreadCount(unsigned int count);
+	unsigned int getThreadCount() const;
+
+	// Renders the given partials, blocking until all are done.
+	// Deactivations are left pending, see Partial::applyDeferredDeactivation().
+	void render(Partial **partials, unsigned int count, Bit32u length);
+
+	// Whether the partial at the given index of the last render() produced output, and where
+	bool hasOutput(unsigned int index) const;
+	const float *getLeftBuffer(unsigned int index) const;
+	const float *getRightBuffer(unsigned int index) const;
+};
+
+}
+
+#endif
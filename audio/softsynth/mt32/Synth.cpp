@@ -26,6 +26,7 @@
 #include "mt32emu.h"
 #include "mmath.h"
 #include "PartialManager.h"
+#include "PartialRenderPool.h"
 
 #if MT32EMU_USE_REVERBMODEL == 1
 #include "AReverbModel.h"
@@ -177,12 +178,14 @@ Synth::Synth(ReportHandler *useReportHandler) {
 	setOutputGain(1.0f);
 	setReverbOutputGain(0.68f);
 	partialManager = NULL;
+	renderPool = NULL;
 	memset(parts, 0, sizeof(parts));
 	renderedSampleCount = 0;
 }
 
 Synth::~Synth() {
 	close(); // Make sure we're closed and everything is freed
+	delete renderPool;
 	for (int i = 0; i < 4; i++) {
 		delete reverbModels[i];
 	}
@@ -1433,51 +1436,93 @@ void Synth::renderStreams(Bit16s *nonReverbLeft, Bit16s *nonReverbRight, Bit16s
 	}
 }
 
-// FIXME: Using more temporary buffers than we need to
-void Synth::doRenderStreams(Bit16s *nonReverbLeft, Bit16s *nonReverbRight, Bit16s *reverbDryLeft, Bit16s *reverbDryRight, Bit16s *reverbWetLeft, Bit16s *reverbWetRight, Bit32u len) {
-	clearFloats(&tmpBufMixLeft[0], &tmpBufMixRight[0], len);
-	if (!reverbEnabled) {
-		for (unsigned int i = 0; i < MT32EMU_MAX_PARTIALS; i++) {
-			if (partialManager->produceOutput(i, &tmpBufPartialLeft[0], &tmpBufPartialRight[0], len)) {
-				mix(&tmpBufMixLeft[0], &tmpBufPartialLeft[0], len);
-				mix(&tmpBufMixRight[0], &tmpBufPartialRight[0], len);
+unsigned int Synth::setRenderThreadCount(unsigned int count) {
+	if (count <= 1) {
+		delete renderPool;
+		renderPool = NULL;
+		return 1;
+	}
+	if (renderPool == NULL) {
+		renderPool = new PartialRenderPool();
+	}
+	unsigned int threadCount = renderPool->setThreadCount(count);
+	if (threadCount == 1) {
+		delete renderPool;
+		renderPool = NULL;
+	}
+	return threadCount;
+}
+
+unsigned int Synth::getRenderThreadCount() const {
+	return renderPool != NULL ? renderPool->getThreadCount() : 1;
+}
+
+// Mixes the output of the given partials into tmpBufMix in partial order.
+// If prerendered, the render pool has already rendered them as its tasks firstTask onwards.
+void Synth::mixPartials(Partial **partials, unsigned int count, bool prerendered, unsigned int firstTask, Bit32u len) {
+	for (unsigned int i = 0; i < count; i++) {
+		if (prerendered) {
+			if (renderPool->hasOutput(firstTask + i)) {
+				mix(&tmpBufMixLeft[0], renderPool->getLeftBuffer(firstTask + i), len);
+				mix(&tmpBufMixRight[0], renderPool->getRightBuffer(firstTask + i), len);
 			}
+		} else if (partials[i]->produceOutput(&tmpBufPartialLeft[0], &tmpBufPartialRight[0], len)) {
+			mix(&tmpBufMixLeft[0], &tmpBufPartialLeft[0], len);
+			mix(&tmpBufMixRight[0], &tmpBufPartialRight[0], len);
 		}
-		if (nonReverbLeft != NULL) {
-			la32FloatToBit16sFunc(nonReverbLeft, &tmpBufMixLeft[0], len, outputGain);
+		partials[i]->applyDeferredDeactivation();
+	}
+}
+
+// FIXME: Using more temporary buffers than we need to
+void Synth::doRenderStreams(Bit16s *nonReverbLeft, Bit16s *nonReverbRight, Bit16s *reverbDryLeft, Bit16s *reverbDryRight, Bit16s *reverbWetLeft, Bit16s *reverbWetRight, Bit32u len) {
+	// Rendering a partial never changes whether another one plays or goes to reverb, since
+	// deactivations are deferred until it has been mixed. So all partials to render can be
+	// picked up front: dry ones first, then reverberated ones, each in partial order.
+	// Ring modulating slaves are rendered by their masters.
+	Partial *renderPartials[MT32EMU_MAX_PARTIALS];
+	Partial *reverbPartials[MT32EMU_MAX_PARTIALS];
+	unsigned int dryCount = 0;
+	unsigned int reverbCount = 0;
+	for (unsigned int i = 0; i < MT32EMU_MAX_PARTIALS; i++) {
+		Partial *partial = partialManager->getPartial(i);
+		if (!partial->isActive() || partial->isRingModulatingSlave()) {
+			continue;
 		}
-		if (nonReverbRight != NULL) {
-			la32FloatToBit16sFunc(nonReverbRight, &tmpBufMixRight[0], len, outputGain);
+		if (reverbEnabled && partial->shouldReverb()) {
+			reverbPartials[reverbCount++] = partial;
+		} else {
+			renderPartials[dryCount++] = partial;
 		}
+	}
+	for (unsigned int i = 0; i < reverbCount; i++) {
+		renderPartials[dryCount + i] = reverbPartials[i];
+	}
+
+	// The pool renders every partial into its own buffer; mixing those in the same order
+	// as the serial path keeps the float sums, and so the output, bit-identical.
+	bool pooled = renderPool != NULL && dryCount + reverbCount > 1;
+	if (pooled) {
+		renderPool->render(renderPartials, dryCount + reverbCount, len);
+	}
+
+	clearFloats(&tmpBufMixLeft[0], &tmpBufMixRight[0], len);
+	mixPartials(&renderPartials[0], dryCount, pooled, 0, len);
+	if (nonReverbLeft != NULL) {
+		la32FloatToBit16sFunc(nonReverbLeft, &tmpBufMixLeft[0], len, outputGain);
+	}
+	if (nonReverbRight != NULL) {
+		la32FloatToBit16sFunc(nonReverbRight, &tmpBufMixRight[0], len, outputGain);
+	}
+
+	if (!reverbEnabled) {
 		clearIfNonNull(reverbDryLeft, len);
 		clearIfNonNull(reverbDryRight, len);
 		clearIfNonNull(reverbWetLeft, len);
 		clearIfNonNull(reverbWetRight, len);
 	} else {
-		for (unsigned int i = 0; i < MT32EMU_MAX_PARTIALS; i++) {
-			if (!partialManager->shouldReverb(i)) {
-				if (partialManager->produceOutput(i, &tmpBufPartialLeft[0], &tmpBufPartialRight[0], len)) {
-					mix(&tmpBufMixLeft[0], &tmpBufPartialLeft[0], len);
-					mix(&tmpBufMixRight[0], &tmpBufPartialRight[0], len);
-				}
-			}
-		}
-		if (nonReverbLeft != NULL) {
-			la32FloatToBit16sFunc(nonReverbLeft, &tmpBufMixLeft[0], len, outputGain);
-		}
-		if (nonReverbRight != NULL) {
-			la32FloatToBit16sFunc(nonReverbRight, &tmpBufMixRight[0], len, outputGain);
-		}
-
 		clearFloats(&tmpBufMixLeft[0], &tmpBufMixRight[0], len);
-		for (unsigned int i = 0; i < MT32EMU_MAX_PARTIALS; i++) {
-			if (partialManager->shouldReverb(i)) {
-				if (partialManager->produceOutput(i, &tmpBufPartialLeft[0], &tmpBufPartialRight[0], len)) {
-					mix(&tmpBufMixLeft[0], &tmpBufPartialLeft[0], len);
-					mix(&tmpBufMixRight[0], &tmpBufPartialRight[0], len);
-				}
-			}
-		}
+		mixPartials(&renderPartials[dryCount], reverbCount, pooled, dryCount, len);
 		if (reverbDryLeft != NULL) {
 			la32FloatToBit16sFunc(reverbDryLeft, &tmpBufMixLeft[0], len, outputGain);
 		}
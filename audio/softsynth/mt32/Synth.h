@@ -25,6 +25,7 @@ namespace MT32Emu {
 class TableInitialiser;
 class Partial;
 class PartialManager;
+class PartialRenderPool;
 class Part;
 class ROMImage;
 
@@ -311,6 +312,9 @@ private:
 	PartialManager *partialManager;
 	Part *parts[9];
 
+	// Only allocated once more than one render thread is requested
+	PartialRenderPool *renderPool;
+
 	// FIXME: We can reorganise things so that we don't need all these separate tmpBuf, tmp and prerender buffers.
 	// This should be rationalised when things have stabilised a bit (if prerender buffers don't die in the mean time).
 
@@ -344,6 +348,7 @@ private:
 	void copyPrerender(Bit16s *nonReverbLeft, Bit16s *nonReverbRight, Bit16s *reverbDryLeft, Bit16s *reverbDryRight, Bit16s *reverbWetLeft, Bit16s *reverbWetRight, Bit32u pos, Bit32u len);
 	void checkPrerender(Bit16s *nonReverbLeft, Bit16s *nonReverbRight, Bit16s *reverbDryLeft, Bit16s *reverbDryRight, Bit16s *reverbWetLeft, Bit16s *reverbWetRight, Bit32u &pos, Bit32u &len);
 	void doRenderStreams(Bit16s *nonReverbLeft, Bit16s *nonReverbRight, Bit16s *reverbDryLeft, Bit16s *reverbDryRight, Bit16s *reverbWetLeft, Bit16s *reverbWetRight, Bit32u len);
+	void mixPartials(Partial **partials, unsigned int count, bool prerendered, unsigned int firstTask, Bit32u len);
 
 	void playAddressedSysex(unsigned char channel, const Bit8u *sysex, Bit32u len);
 	void readSysex(unsigned char channel, const Bit8u *sysex, Bit32u len) const;
@@ -414,6 +419,13 @@ public:
 	// Sets output gain factor for the reverb wet output. setOutputGain() doesn't change reverb output gain.
 	void setReverbOutputGain(float);
 
+	// Sets the number of threads rendering partials, including the one calling render().
+	// The output does not depend on the thread count.
+	// Returns the number actually used, which is 1 where threads are not available (see MT32EMU_USE_THREADS).
+	// Note that with more than one thread, ReportHandler::onPartialStateChanged() may be called from the worker threads.
+	unsigned int setRenderThreadCount(unsigned int count);
+	unsigned int getRenderThreadCount() const;
+
 	// Renders samples to the specified output stream.
 	// The length is in frames, not bytes (in 16-bit stereo,
 	// one frame is 4 bytes).
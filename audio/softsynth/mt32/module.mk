@@ -11,6 +11,7 @@ MODULE_OBJS := \
 	Part.o \
 	Partial.o \
 	PartialManager.o \
+	PartialRenderPool.o \
 	Poly.o \
 	ROMInfo.o \
 	Synth.o \
@@ -79,6 +79,18 @@
 // 1: Use legacy accurate wave generator based on float computations
 #define MT32EMU_ACCURATE_WG 0
 
+// 0: Partials are always rendered serially
+// 1: Partials may be rendered on a pool of worker threads, see Synth::setRenderThreadCount()
+// Threads are only available where configure found POSIX threads (USE_PTHREADS).
+#include "common/scummsys.h"
+#ifndef MT32EMU_USE_THREADS
+#ifdef USE_PTHREADS
+#define MT32EMU_USE_THREADS 1
+#else
+#define MT32EMU_USE_THREADS 0
+#endif
+#endif
+
 namespace MT32Emu
 {
 // The higher this number, the more memory will be used, but the more samples can be processed in one run -
@@ -95,6 +107,9 @@ const unsigned int MAX_SAMPLES_PER_RUN = 4096;
 // abruptly and potentially cause a pop/crackle in the audio output.
 // This value must be >= 1.
 const unsigned int MAX_PRERENDER_SAMPLES = 1024;
+
+// The maximum number of threads rendering partials, including the one calling Synth::render().
+const unsigned int MAX_RENDER_THREADS = 8;
 }
 
 #include "Structures.h"
@@ -0,0 +1,500 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef USE_MT32EMU
+
+#include "audio/softsynth/mt32cache.h"
+#include "audio/softsynth/mt32/mt32emu.h"
+#include "audio/softsynth/mt32/ROMInfo.h"
+
+#include "audio/audiostream.h"
+#include "audio/mididrv.h"
+#include "audio/midiparser.h"
+#include "audio/decoders/raw.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/endian.h"
+#include "common/file.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/savefile.h"
+#include "common/substream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Audio {
+
+namespace {
+
+enum {
+	kCacheTag = MKTAG('M', 'T', '3', 'R'),
+	kCacheVersion = 1,
+	kHeaderSize = 20,
+
+	// The parser is ticked every 4 ms, which is exactly 128 frames at the
+	// 32 kHz output rate, so MIDI events land on the same frames on every
+	// render.
+	kTickMicros = 4000,
+	kTickFrames = 128,
+
+	// Reverb and release tail kept after the MIDI data ends.
+	kTailFrames = 2 * MT32RenderCache::kOutputRate,
+
+	// XMIDI FOR/NEXT loops can repeat forever; cut such tracks off.
+	kMaxFrames = 15 * 60 * MT32RenderCache::kOutputRate,
+
+	// Work done by the render thread between checks for close().
+	kSliceFrames = 4096
+};
+
+/**
+ * Forwards the parser output to an offline Synth, or drops it when only
+ * measuring the track length.
+ */
+class MidiDriver_RenderCache : public MidiDriver_BASE {
+public:
+	MidiDriver_RenderCache(MT32Emu::Synth *synth) : _synth(synth) {}
+
+	void send(uint32 b) {
+		if (_synth)
+			_synth->playMsg(b);
+	}
+
+	void sysEx(const byte *msg, uint16 length) {
+		if (!_synth)
+			return;
+		if (msg[0] == 0xf0)
+			_synth->playSysex(msg, length);
+		else
+			_synth->playSysexWithoutFraming(msg, length);
+	}
+
+private:
+	MT32Emu::Synth *_synth;
+};
+
+void silentXMidiCallback(byte, void *) {
+}
+
+} // End of anonymous namespace
+
+MT32RenderCache::MT32RenderCache()
+	: _quit(false), _threaded(false), _controlFile(0), _pcmFile(0), _controlROM(0), _pcmROM(0),
+	  _synth(0), _gain(100), _isOpen(false) {
+}
+
+MT32RenderCache::~MT32RenderCache() {
+	close();
+}
+
+bool MT32RenderCache::open() {
+	if (_isOpen)
+		return true;
+
+	_controlFile = new Common::File();
+	_pcmFile = new Common::File();
+	if ((!_controlFile->open("MT32_CONTROL.ROM") && !_controlFile->open("CM32L_CONTROL.ROM")) ||
+	    (!_pcmFile->open("MT32_PCM.ROM") && !_pcmFile->open("CM32L_PCM.ROM"))) {
+		close();
+		return false;
+	}
+
+	_controlROM = MT32Emu::ROMImage::makeROMImage(_controlFile);
+	_pcmROM = MT32Emu::ROMImage::makeROMImage(_pcmFile);
+	if (!_controlROM->getROMInfo() || !_pcmROM->getROMInfo()) {
+		close();
+		return false;
+	}
+
+	_romId = Common::String(_controlROM->getROMInfo()->sha1Digest) + _pcmROM->getROMInfo()->sha1Digest;
+	_gain = ConfMan.getInt("midi_gain");
+	_synth = new MT32Emu::Synth();
+
+	_isOpen = true;
+	_quit = false;
+	_threaded = (_renderThread.setThreadCount(2) == 2) && _renderThread.start(renderMain, this);
+	return true;
+}
+
+void MT32RenderCache::close() {
+	if (_threaded) {
+		_condition.lock();
+		_quit = true;
+		_condition.notifyAll();
+		_condition.unlock();
+
+		_renderThread.wait();
+		_threaded = false;
+	}
+	_isOpen = false;
+
+	// The render thread is gone, so the jobs are ours
+	while (!_jobs.empty()) {
+		Job *job = _jobs.front();
+		_jobs.pop_front();
+		if (job->out) {
+			finishJob(job, false);
+			g_system->getSavefileManager()->removeSavefile(job->name);
+		}
+		destroyJob(job);
+	}
+
+	delete _synth;
+	_synth = 0;
+
+	if (_controlROM)
+		MT32Emu::ROMImage::freeROMImage(_controlROM);
+	_controlROM = 0;
+	if (_pcmROM)
+		MT32Emu::ROMImage::freeROMImage(_pcmROM);
+	_pcmROM = 0;
+
+	delete _controlFile;
+	_controlFile = 0;
+	delete _pcmFile;
+	_pcmFile = 0;
+}
+
+void MT32RenderCache::addSysEx(const byte *msg, uint16 length) {
+	_sysEx.push_back(length & 0xFF);
+	_sysEx.push_back(length >> 8);
+	for (uint16 i = 0; i < length; ++i)
+		_sysEx.push_back(msg[i]);
+}
+
+void MT32RenderCache::clearSysEx() {
+	_sysEx.clear();
+}
+
+Common::String MT32RenderCache::makeCacheName(const byte *data, uint32 size, MusicFormat format) const {
+	Common::MemoryReadStream dataStream(data, size);
+	Common::MemoryReadStream sysExStream(_sysEx.empty() ? 0 : &_sysEx[0], _sysEx.size());
+	Common::String key = Common::String::format("%s:%s:%s:%d:%d:%d",
+		Common::computeStreamMD5AsString(dataStream).c_str(), Common::computeStreamMD5AsString(sysExStream).c_str(),
+		_romId.c_str(), _gain, (int)format, (int)kCacheVersion);
+
+	Common::MemoryReadStream keyStream((const byte *)key.c_str(), key.size());
+	return "mt32-" + Common::computeStreamMD5AsString(keyStream) + ".pcm";
+}
+
+bool MT32RenderCache::isQueued(const Common::String &name) {
+	_condition.lock();
+	bool queued = false;
+	for (Common::List<Job *>::const_iterator i = _jobs.begin(); i != _jobs.end(); ++i) {
+		if ((*i)->name == name) {
+			queued = true;
+			break;
+		}
+	}
+	_condition.unlock();
+
+	return queued;
+}
+
+SeekableAudioStream *MT32RenderCache::openEntry(const Common::String &name, uint32 &loopEnd) {
+	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(name);
+	if (!in)
+		return 0;
+
+	uint32 tag = in->readUint32BE();
+	uint32 version = in->readUint32LE();
+	uint32 rate = in->readUint32LE();
+	uint32 frames = in->readUint32LE();
+	loopEnd = in->readUint32LE();
+
+	// Renders which failed leave their file behind; drop it, so that the
+	// track is rendered again
+	if (in->err() || tag != kCacheTag || version != kCacheVersion || !rate ||
+	    loopEnd > frames || (uint32)in->size() < kHeaderSize + frames * 4) {
+		warning("MT32RenderCache: Removing invalid cache file '%s'", name.c_str());
+		delete in;
+		g_system->getSavefileManager()->removeSavefile(name);
+		return 0;
+	}
+
+	Common::SeekableSubReadStream *pcm = new Common::SeekableSubReadStream(in, kHeaderSize, kHeaderSize + frames * 4, DisposeAfterUse::YES);
+	return makeRawStream(pcm, rate, FLAG_16BITS | FLAG_STEREO | FLAG_LITTLE_ENDIAN);
+}
+
+AudioStream *MT32RenderCache::makeStream(const byte *data, uint32 size, MusicFormat format, bool loop) {
+	if (!_isOpen)
+		return 0;
+
+	// A track being rendered is incomplete
+	Common::String name = makeCacheName(data, size, format);
+	if (isQueued(name))
+		return 0;
+
+	uint32 loopEnd;
+	SeekableAudioStream *stream = openEntry(name, loopEnd);
+	if (!stream)
+		return 0;
+
+	debug(3, "MT32RenderCache: Streaming '%s' (loop end %d)", name.c_str(), loopEnd);
+
+	if (loop && loopEnd > 0)
+		return new SubLoopingAudioStream(stream, 0, Timestamp(0, stream->getRate()), Timestamp(0, loopEnd, stream->getRate()));
+
+	return stream;
+}
+
+bool MT32RenderCache::isCached(const byte *data, uint32 size, MusicFormat format) {
+	if (!_isOpen)
+		return false;
+
+	Common::String name = makeCacheName(data, size, format);
+	if (isQueued(name))
+		return false;
+
+	uint32 loopEnd;
+	SeekableAudioStream *stream = openEntry(name, loopEnd);
+	delete stream;
+	return stream != 0;
+}
+
+void MT32RenderCache::prepare(const byte *data, uint32 size, MusicFormat format) {
+	if (!_isOpen || isCached(data, size, format))
+		return;
+
+	Common::String name = makeCacheName(data, size, format);
+	if (isQueued(name))
+		return;
+
+	// The savefile manager is only used from the engine side, so the file
+	// is created here and filled in by the render thread
+	Common::OutSaveFile *out = g_system->getSavefileManager()->openForSaving(name);
+	if (!out) {
+		warning("MT32RenderCache: Could not create cache file '%s'", name.c_str());
+		return;
+	}
+
+	Job *job = new Job();
+	job->name = name;
+	job->data = new byte[size];
+	memcpy(job->data, data, size);
+	job->size = size;
+	job->format = format;
+	job->sysEx = _sysEx;
+	job->loopEnd = 0;
+	job->frames = 0;
+	job->rendered = 0;
+	job->started = false;
+	job->driver = 0;
+	job->parser = 0;
+	job->out = out;
+
+	_condition.lock();
+	_jobs.push_back(job);
+	_condition.notifyAll();
+	_condition.unlock();
+}
+
+bool MT32RenderCache::isBusy() {
+	_condition.lock();
+	bool busy = !_jobs.empty();
+	_condition.unlock();
+
+	return busy;
+}
+
+bool MT32RenderCache::renderSlice(uint32 frames) {
+	int16 buffer[kTickFrames * 2];
+	byte output[kTickFrames * 4];
+
+	_renderLock.lock();
+	while (frames > 0) {
+		_condition.lock();
+		Job *job = _jobs.empty() ? 0 : _jobs.front();
+		_condition.unlock();
+
+		if (!job)
+			break;
+
+		if (!job->started && !startJob(job)) {
+			removeJob(job);
+			continue;
+		}
+
+		while (frames > 0 && job->rendered < job->frames) {
+			// The track part is always rendered in whole ticks, so
+			// loopEnd is hit exactly.
+			if (job->rendered < job->loopEnd)
+				job->parser->onTimer();
+
+			uint32 count = MIN<uint32>(kTickFrames, job->frames - job->rendered);
+			_synth->render(buffer, count);
+			for (uint32 i = 0; i < count * 2; ++i)
+				WRITE_LE_UINT16(output + i * 2, buffer[i]);
+			job->out->write(output, count * 4);
+
+			job->rendered += count;
+			frames -= MIN(count, frames);
+		}
+
+		if (job->rendered >= job->frames) {
+			finishJob(job, true);
+			removeJob(job);
+		}
+	}
+	_renderLock.unlock();
+
+	return isBusy();
+}
+
+MidiParser *MT32RenderCache::createParser(Job *job, MidiDriver_BASE *driver) {
+	MidiParser *parser;
+	if (job->format == kFormatXMIDI)
+		parser = MidiParser::createParser_XMIDI(silentXMidiCallback);
+	else
+		parser = MidiParser::createParser_SMF();
+
+	parser->setMidiDriver(driver);
+	parser->setTimerRate(kTickMicros);
+	parser->property(MidiParser::mpAutoLoop, 0);
+	if (!parser->loadMusic(job->data, job->size)) {
+		delete parser;
+		return 0;
+	}
+
+	return parser;
+}
+
+uint32 MT32RenderCache::measureTrack(Job *job) {
+	// Run the parser without a synth to find where the MIDI data ends.
+	MidiDriver_RenderCache silentDriver(0);
+	MidiParser *parser = createParser(job, &silentDriver);
+	if (!parser)
+		return 0;
+
+	uint32 ticks = 0;
+	while (parser->isPlaying() && ticks < kMaxFrames / kTickFrames) {
+		parser->onTimer();
+		++ticks;
+	}
+
+	delete parser;
+	return ticks * kTickFrames;
+}
+
+bool MT32RenderCache::startJob(Job *job) {
+	job->started = true;
+
+	job->loopEnd = measureTrack(job);
+	if (!job->loopEnd) {
+		warning("MT32RenderCache: Could not parse music for '%s'", job->name.c_str());
+		finishJob(job, false);
+		return false;
+	}
+	job->frames = job->loopEnd + kTailFrames;
+
+	if (!_synth->open(*_controlROM, *_pcmROM)) {
+		warning("MT32RenderCache: Could not open the synth");
+		finishJob(job, false);
+		return false;
+	}
+	_synth->setOutputGain(1.0f * _gain / 100.0f);
+	_synth->setReverbOutputGain(0.68f * _gain / 100.0f);
+
+	job->driver = new MidiDriver_RenderCache(_synth);
+
+	// Upload the timbres and patches the game set up for the live driver
+	for (uint i = 0; i + 2 <= job->sysEx.size(); ) {
+		uint16 length = READ_LE_UINT16(&job->sysEx[i]);
+		job->driver->sysEx(&job->sysEx[i + 2], length);
+		i += 2 + length;
+	}
+
+	job->parser = createParser(job, job->driver);
+	if (!job->parser) {
+		finishJob(job, false);
+		return false;
+	}
+
+	job->out->writeUint32BE(kCacheTag);
+	job->out->writeUint32LE(kCacheVersion);
+	job->out->writeUint32LE(kOutputRate);
+	job->out->writeUint32LE(job->frames);
+	job->out->writeUint32LE(job->loopEnd);
+
+	debug(3, "MT32RenderCache: Rendering '%s' (%d frames, loop end %d)", job->name.c_str(), job->frames, job->loopEnd);
+	return true;
+}
+
+void MT32RenderCache::finishJob(Job *job, bool success) {
+	// The parser sends its final note offs on destruction, so it has to go
+	// before the driver and synth.
+	delete job->parser;
+	job->parser = 0;
+	if (job->driver)
+		_synth->close();
+	delete job->driver;
+	job->driver = 0;
+
+	// A failed render leaves an incomplete file, which openEntry() drops
+	if (job->out) {
+		job->out->finalize();
+		success = success && !job->out->err();
+		delete job->out;
+		job->out = 0;
+	}
+
+	if (success)
+		debug(3, "MT32RenderCache: Finished rendering '%s'", job->name.c_str());
+}
+
+void MT32RenderCache::removeJob(Job *job) {
+	_condition.lock();
+	_jobs.remove(job);
+	_condition.unlock();
+
+	destroyJob(job);
+}
+
+void MT32RenderCache::destroyJob(Job *job) {
+	delete[] job->data;
+	delete job;
+}
+
+void MT32RenderCache::renderMain(void *param, uint thread) {
+	MT32RenderCache *cache = (MT32RenderCache *)param;
+
+	cache->_condition.lock();
+	for (;;) {
+		while (!cache->_quit && cache->_jobs.empty())
+			cache->_condition.wait();
+
+		if (cache->_quit)
+			break;
+
+		cache->_condition.unlock();
+		cache->renderSlice(kSliceFrames);
+		cache->_condition.lock();
+	}
+	cache->_condition.unlock();
+}
+
+} // End of namespace Audio
+
+#endif // USE_MT32EMU
@@ -0,0 +1,205 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_SOFTSYNTH_MT32CACHE_H
+#define AUDIO_SOFTSYNTH_MT32CACHE_H
+
+#include "common/scummsys.h"
+
+#ifdef USE_MT32EMU
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/savefile.h"
+#include "common/str.h"
+#include "common/workerpool.h"
+
+namespace Common {
+class File;
+}
+
+namespace MT32Emu {
+class ROMImage;
+class Synth;
+}
+
+class MidiDriver_BASE;
+class MidiParser;
+
+namespace Audio {
+
+class AudioStream;
+class SeekableAudioStream;
+
+/**
+ * Offline render cache for MT-32 music.
+ *
+ * Tracks are synthesized once by the Munt emulator into raw 16 bit stereo
+ * PCM, stored through the savefile manager (which compresses them where
+ * supported) and streamed back afterwards without running the emulator.
+ * This only suits tracks which play on their own; music which engine code
+ * drives while it plays has to use the live driver.
+ *
+ * Cache entries are keyed by the MD5 of the MIDI resource, the SysEx set up
+ * with addSysEx(), the SHA1 of both ROM images, the configured MIDI gain
+ * and the cache format version, so a changed ROM set, gain or timbre bank
+ * simply misses the cache.
+ *
+ * Rendering runs on a thread of its own, so it proceeds in the background
+ * while the game keeps using the live driver. Where threads are not
+ * available, tracks are only rendered by renderSlice().
+ */
+class MT32RenderCache {
+public:
+	enum MusicFormat {
+		kFormatSMF,
+		kFormatXMIDI
+	};
+
+	MT32RenderCache();
+	~MT32RenderCache();
+
+	/**
+	 * Load the ROM images and start the render thread.
+	 * @return true on success, false if the ROMs are missing or unknown
+	 */
+	bool open();
+
+	/**
+	 * Stop the render thread, dropping any unfinished render jobs, and
+	 * release the ROM images.
+	 */
+	void close();
+
+	/**
+	 * Record a SysEx message the game sends before playing its tracks,
+	 * e.g. a timbre or patch upload. The messages recorded are part of the
+	 * cache key and are replayed to the synth before a track is rendered.
+	 */
+	void addSysEx(const byte *msg, uint16 length);
+
+	/** Forget the SysEx messages recorded by addSysEx(). */
+	void clearSysEx();
+
+	/**
+	 * Create a stream for a previously rendered track.
+	 *
+	 * When looping, the stream repeats from the start of the track up to
+	 * the point where the MIDI data ends, as the live parser's autoloop
+	 * would; otherwise the reverb tail rendered past that point is played
+	 * out as well.
+	 *
+	 * @param data   MIDI resource
+	 * @param size   size of the MIDI resource in bytes
+	 * @param format container format of the MIDI resource
+	 * @param loop   whether the track should loop forever
+	 * @return the stream, or 0 if the track is not in the cache
+	 */
+	AudioStream *makeStream(const byte *data, uint32 size, MusicFormat format, bool loop);
+
+	/**
+	 * Check whether a track has already been rendered.
+	 */
+	bool isCached(const byte *data, uint32 size, MusicFormat format);
+
+	/**
+	 * Queue a track for background rendering. Does nothing if the track is
+	 * already cached or queued. The data is copied.
+	 */
+	void prepare(const byte *data, uint32 size, MusicFormat format);
+
+	/**
+	 * Check whether any render jobs are still pending.
+	 */
+	bool isBusy();
+
+	/**
+	 * Render up to the given number of output frames of the pending jobs
+	 * on the calling thread, e.g. to finish rendering behind a loading
+	 * screen. Waits for the slice the render thread is working on.
+	 *
+	 * @return true if jobs are still pending afterwards
+	 */
+	bool renderSlice(uint32 frames);
+
+	/** Output rate of cached tracks; see MidiDriver_MT32. */
+	static const int kOutputRate = 32000;
+
+private:
+	struct Job {
+		Common::String name;
+		byte *data;
+		uint32 size;
+		MusicFormat format;
+		Common::Array<byte> sysEx; ///< Copy of _sysEx when queued.
+
+		uint32 loopEnd;      ///< Frame at which the MIDI data ends.
+		uint32 frames;       ///< Total frames, including the reverb tail.
+		uint32 rendered;     ///< Frames written so far.
+		bool started;
+
+		MidiDriver_BASE *driver;
+		MidiParser *parser;
+		Common::OutSaveFile *out;
+	};
+
+	Common::String makeCacheName(const byte *data, uint32 size, MusicFormat format) const;
+	bool isQueued(const Common::String &name);
+	SeekableAudioStream *openEntry(const Common::String &name, uint32 &loopEnd);
+	MidiParser *createParser(Job *job, MidiDriver_BASE *driver);
+	uint32 measureTrack(Job *job);
+	bool startJob(Job *job);
+	void finishJob(Job *job, bool success);
+	void removeJob(Job *job);
+	void destroyJob(Job *job);
+
+	static void renderMain(void *param, uint thread);
+
+	/** Guards _jobs and _quit, and wakes up the render thread. */
+	Common::WorkerCondition _condition;
+	Common::List<Job *> _jobs;
+	bool _quit;
+
+	/**
+	 * Held while rendering a slice. The front job and the synth belong to
+	 * its holder.
+	 */
+	Common::WorkerCondition _renderLock;
+	Common::WorkerPool _renderThread;
+	bool _threaded;
+
+	/** The messages recorded by addSysEx(), each preceded by its length. */
+	Common::Array<byte> _sysEx;
+
+	Common::File *_controlFile, *_pcmFile;
+	const MT32Emu::ROMImage *_controlROM, *_pcmROM;
+	MT32Emu::Synth *_synth;
+	Common::String _romId;
+	int _gain;
+	bool _isOpen;
+};
+
+} // End of namespace Audio
+
+#endif // USE_MT32EMU
+
+#endif
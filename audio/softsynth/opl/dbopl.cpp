@@ -38,6 +38,12 @@
 
 #ifndef DISABLE_DOSBOX_OPL
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
 namespace OPL {
 namespace DOSBox {
 
@@ -595,6 +601,148 @@ INLINE Bits Operator::GetSample( Bits modulation ) {
 	}
 }
 
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+
+//Wave multiplier for an envelope volume, a silent volume gives 0 which keeps the output 0 too
+static INLINE Bit32s VolumeGain( Bitu vol ) {
+	return ENV_SILENT( vol ) ? 0 : MulTable[ vol >> ENV_EXTRA ];
+}
+
+//Fill gain with the wave multipliers of the next samples, returns false when all of them are silent
+INLINE bool Operator::ForwardGainBlock( Bit32s* gain, Bitu samples ) {
+	const Bit32u level = currentLevel;
+	bool audible = false;
+	Bitu i = 0;
+	while ( i < samples ) {
+		Bit32u add;
+		Bit32s limit;
+		if ( state == OFF || ( state == SUSTAIN && ( reg20 & MASK_SUSTAIN ) ) ) {
+			//Envelope can't change anymore during this block
+			Bit32s mul = VolumeGain( level + ( state == OFF ? ENV_MAX : volume ) );
+			for ( ; i < samples; i++ )
+				gain[ i ] = mul;
+			audible |= ( mul != 0 );
+			break;
+		} else if ( state == DECAY ) {
+			add = decayAdd;
+			limit = sustainLevel;
+		} else if ( state == ATTACK ) {
+			for ( ; i < samples && state == ATTACK; i++ ) {
+				gain[ i ] = VolumeGain( level + TemplateVolume< ATTACK >() );
+				audible |= ( gain[ i ] != 0 );
+			}
+			continue;
+		} else {
+			//Release, or sustain without holding
+			add = releaseAdd;
+			limit = ENV_MAX;
+		}
+		//Run the linear part in locals until it reaches the next state
+		Bit32s cur = volume;
+		Bit32u rate = rateIndex;
+		if ( !add && cur < limit ) {
+			Bit32s mul = VolumeGain( level + cur );
+			for ( ; i < samples; i++ )
+				gain[ i ] = mul;
+			audible |= ( mul != 0 );
+			break;
+		}
+		//If the state doesn't change before the end of the block every volume
+		//follows directly from the rate counter
+		uint64 end = rate + (uint64)add * ( samples - i );
+		Bit32s endVol = cur + (Bit32s)( end >> RATE_SH );
+		if ( endVol < limit ) {
+			volume = endVol;
+			rateIndex = (Bit32u)end & RATE_MASK;
+			//The attenuation only goes up, so a silent operator stays silent
+			if ( ENV_SILENT( level + cur ) ) {
+				for ( ; i < samples; i++ )
+					gain[ i ] = 0;
+				break;
+			}
+			audible = true;
+			uint64 counter = rate;
+			for ( ; i < samples; i++ ) {
+				counter += add;
+				gain[ i ] = VolumeGain( level + cur + (Bit32s)( counter >> RATE_SH ) );
+			}
+			break;
+		}
+		for ( ; i < samples; i++ ) {
+			Bit32u next = rate + add;
+			Bit32s nextVol = cur + ( next >> RATE_SH );
+			if ( nextVol >= limit )
+				break;
+			rate = next & RATE_MASK;
+			cur = nextVol;
+			gain[ i ] = VolumeGain( level + cur );
+			audible |= ( gain[ i ] != 0 );
+		}
+		volume = cur;
+		rateIndex = rate;
+		//Let the regular handler do the state change
+		if ( i < samples ) {
+			gain[ i ] = VolumeGain( level + (this->*volHandler)() );
+			audible |= ( gain[ i ] != 0 );
+			i++;
+		}
+	}
+	return audible;
+}
+
+//Fill index with the wave position of the next samples
+INLINE void Operator::ForwardWaveBlock( Bit32u* index, Bitu samples ) {
+	Bit32u pos = waveIndex;
+	Bit32u add = waveCurrent;
+	Bitu i = 0;
+#if defined(__SSE2__)
+	__m128i vpos = _mm_set_epi32( pos + add * 4, pos + add * 3, pos + add * 2, pos + add );
+	const __m128i vadd = _mm_set1_epi32( add * 4 );
+	for ( ; i + 4 <= samples; i += 4 ) {
+		_mm_storeu_si128( (__m128i *)( index + i ), _mm_srli_epi32( vpos, WAVE_SH ) );
+		vpos = _mm_add_epi32( vpos, vadd );
+	}
+	pos += add * i;
+#elif defined(__wasm_simd128__)
+	v128_t vpos = wasm_i32x4_make( pos + add, pos + add * 2, pos + add * 3, pos + add * 4 );
+	const v128_t vadd = wasm_i32x4_splat( add * 4 );
+	for ( ; i + 4 <= samples; i += 4 ) {
+		wasm_v128_store( index + i, wasm_u32x4_shr( vpos, WAVE_SH ) );
+		vpos = wasm_i32x4_add( vpos, vadd );
+	}
+	pos += add * i;
+#endif
+	for ( ; i < samples; i++ ) {
+		pos += add;
+		index[ i ] = pos >> WAVE_SH;
+	}
+	waveIndex = pos;
+}
+
+//Generate the next samples of this operator, output may be the same buffer as modulation
+INLINE void Operator::GetSampleBlock( Chip* chip, const Bit32s* modulation, Bit32s* output, Bitu samples ) {
+	const Bit32s* gain = chip->blockGain[ 0 ];
+	const Bit32u* index = chip->blockIndex[ 0 ];
+	bool audible = ForwardGainBlock( chip->blockGain[ 0 ], samples );
+	ForwardWaveBlock( chip->blockIndex[ 0 ], samples );
+	if ( !audible ) {
+		memset( output, 0, sizeof( Bit32s ) * samples );
+		return;
+	}
+	//Keep the wave in locals, the output could alias the operator otherwise
+	const Bit16s* base = waveBase;
+	const Bit32u mask = waveMask;
+	if ( modulation ) {
+		for ( Bitu i = 0; i < samples; i++ )
+			output[ i ] = ( base[ ( index[ i ] + modulation[ i ] ) & mask ] * gain[ i ] ) >> MUL_SH;
+	} else {
+		for ( Bitu i = 0; i < samples; i++ )
+			output[ i ] = ( base[ index[ i ] & mask ] * gain[ i ] ) >> MUL_SH;
+	}
+}
+
+#endif
+
 Operator::Operator() {
 	chanData = 0;
 	freqMul = 0;
@@ -911,6 +1059,13 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 		Op( 4 )->Prepare( chip );
 		Op( 5 )->Prepare( chip );
 	}
+	chip->statRendered++;
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+	if ( chip->blockRender && mode != sm2Percussion && mode != sm3Percussion ) {
+		RenderBlock< mode >( chip, samples, output );
+		return ( mode > sm4Start ) ? ( this + 2 ) : ( this + 1 );
+	}
+#endif
 	for ( Bitu i = 0; i < samples; i++ ) {
 		//Early out for percussion handlers
 		if ( mode == sm2Percussion ) {
@@ -1014,6 +1169,132 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 	return 0;
 }
 
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+
+template<SynthMode mode>
+void Channel::RenderBlock( Chip* chip, Bitu total, Bit32s* output ) {
+	Bit32s* first = chip->blockSample[ 0 ];
+	Bit32s* second = chip->blockSample[ 1 ];
+	const Bit32s* gain0 = chip->blockGain[ 0 ];
+	const Bit32s* gain1 = chip->blockGain[ 1 ];
+	const Bit32u* index0 = chip->blockIndex[ 0 ];
+	const Bit32u* index1 = chip->blockIndex[ 1 ];
+	Operator* op0 = Op( 0 );
+	Operator* op1 = Op( 1 );
+	//The second operator is modulated by the first one in these modes
+	const bool chain = ( mode == sm2FM || mode == sm3FM || mode == sm3FMFM || mode == sm3FMAM );
+	//Two operator channels are done with those and mix straight into the output
+	const bool twoOp = ( mode < sm4Start );
+	const Bit32s left = maskLeft;
+	const Bit32s right = maskRight;
+	while ( total > 0 ) {
+		Bitu samples = total < BLOCK_SAMPLES ? total : BLOCK_SAMPLES;
+
+		//The feedback of the first operator has to be done a sample at a time,
+		//do the second operator in the same loop so their work overlaps
+		bool audible0 = op0->ForwardGainBlock( chip->blockGain[ 0 ], samples );
+		op0->ForwardWaveBlock( chip->blockIndex[ 0 ], samples );
+		bool audible1 = op1->ForwardGainBlock( chip->blockGain[ 1 ], samples );
+		op1->ForwardWaveBlock( chip->blockIndex[ 1 ], samples );
+		const Bit16s* base0 = op0->waveBase;
+		const Bit16s* base1 = op1->waveBase;
+		const Bit32u mask0 = op0->waveMask;
+		const Bit32u mask1 = op1->waveMask;
+		const Bit8u shift = feedback;
+		Bit32s old0 = old[0];
+		Bit32s old1 = old[1];
+		if ( twoOp && !audible0 && !audible1 && !old0 && !old1 ) {
+			//Nothing to hear and no feedback left, only the envelopes had to move
+			total -= samples;
+			output += ( mode == sm2AM || mode == sm2FM ) ? samples : samples * 2;
+			continue;
+		}
+		for ( Bitu i = 0; i < samples; i++ ) {
+			//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
+			Bit32s mod = (Bit32u)((old0 + old1)) >> shift;
+			old0 = old1;
+			//Skip the lookups of operators that are silent for the whole block
+			old1 = audible0 ? ( base0[ ( index0[ i ] + mod ) & mask0 ] * gain0[ i ] ) >> MUL_SH : 0;
+			Bitu pos = chain ? index1[ i ] + old0 : index1[ i ];
+			Bit32s next = audible1 ? ( base1[ pos & mask1 ] * gain1[ i ] ) >> MUL_SH : 0;
+			if ( !twoOp ) {
+				first[ i ] = old0;
+				second[ i ] = next;
+				continue;
+			}
+			Bit32s sample = chain ? next : old0 + next;
+			if ( mode == sm2AM || mode == sm2FM ) {
+				output[ i ] += sample;
+			} else {
+				output[ i * 2 + 0 ] += sample & left;
+				output[ i * 2 + 1 ] += sample & right;
+			}
+		}
+		old[0] = old0;
+		old[1] = old1;
+		total -= samples;
+		if ( twoOp ) {
+			output += ( mode == sm2AM || mode == sm2FM ) ? samples : samples * 2;
+			continue;
+		}
+
+		//Then run the remaining operators over the whole block, first ends up with the sample
+		if ( mode == sm3FMFM ) {
+			Op(2)->GetSampleBlock( chip, second, second, samples );
+			Op(3)->GetSampleBlock( chip, second, first, samples );
+		} else if ( mode == sm3AMFM ) {
+			Op(2)->GetSampleBlock( chip, second, second, samples );
+			Op(3)->GetSampleBlock( chip, second, second, samples );
+			for ( Bitu i = 0; i < samples; i++ )
+				first[ i ] += second[ i ];
+		} else if ( mode == sm3FMAM ) {
+			Op(2)->GetSampleBlock( chip, 0, first, samples );
+			Op(3)->GetSampleBlock( chip, first, first, samples );
+			for ( Bitu i = 0; i < samples; i++ )
+				first[ i ] += second[ i ];
+		} else if ( mode == sm3AMAM ) {
+			Op(2)->GetSampleBlock( chip, second, second, samples );
+			for ( Bitu i = 0; i < samples; i++ )
+				first[ i ] += second[ i ];
+			Op(3)->GetSampleBlock( chip, 0, second, samples );
+			for ( Bitu i = 0; i < samples; i++ )
+				first[ i ] += second[ i ];
+		}
+
+		Bitu i = 0;
+#if defined(__SSE2__)
+		const __m128i vleft = _mm_set1_epi32( left );
+		const __m128i vright = _mm_set1_epi32( right );
+		for ( ; i + 4 <= samples; i += 4 ) {
+			__m128i sample = _mm_loadu_si128( (const __m128i *)( first + i ) );
+			__m128i l = _mm_and_si128( sample, vleft );
+			__m128i r = _mm_and_si128( sample, vright );
+			__m128i *out = (__m128i *)( output + i * 2 );
+			_mm_storeu_si128( out, _mm_add_epi32( _mm_loadu_si128( out ), _mm_unpacklo_epi32( l, r ) ) );
+			_mm_storeu_si128( out + 1, _mm_add_epi32( _mm_loadu_si128( out + 1 ), _mm_unpackhi_epi32( l, r ) ) );
+		}
+#elif defined(__wasm_simd128__)
+		const v128_t vleft = wasm_i32x4_splat( left );
+		const v128_t vright = wasm_i32x4_splat( right );
+		for ( ; i + 4 <= samples; i += 4 ) {
+			v128_t sample = wasm_v128_load( first + i );
+			v128_t l = wasm_v128_and( sample, vleft );
+			v128_t r = wasm_v128_and( sample, vright );
+			Bit32s *out = output + i * 2;
+			wasm_v128_store( out, wasm_i32x4_add( wasm_v128_load( out ), wasm_i32x4_shuffle( l, r, 0, 4, 1, 5 ) ) );
+			wasm_v128_store( out + 4, wasm_i32x4_add( wasm_v128_load( out + 4 ), wasm_i32x4_shuffle( l, r, 2, 6, 3, 7 ) ) );
+		}
+#endif
+		for ( ; i < samples; i++ ) {
+			output[ i * 2 + 0 ] += first[ i ] & left;
+			output[ i * 2 + 1 ] += first[ i ] & right;
+		}
+		output += samples * 2;
+	}
+}
+
+#endif
+
 /*
 	Chip
 */
@@ -1024,6 +1305,10 @@ Chip::Chip() {
 	regBD = 0;
 	reg104 = 0;
 	opl3Active = 0;
+	blockRender = true;
+	statSamples = 0;
+	statBlocks = 0;
+	statRendered = 0;
 }
 
 INLINE Bit32u Chip::ForwardNoise() {
@@ -1223,11 +1508,11 @@ void Chip::GenerateBlock2( Bitu total, Bit32s* output ) {
 	while ( total > 0 ) {
 		Bit32u samples = ForwardLFO( total );
 		memset(output, 0, sizeof(Bit32s) * samples);
-		int count = 0;
 		for( Channel* ch = chan; ch < chan + 9; ) {
-			count++;
+			statBlocks++;
 			ch = (ch->*(ch->synthHandler))( this, samples, output );
 		}
+		statSamples += samples;
 		total -= samples;
 		output += samples;
 	}
@@ -1237,11 +1522,11 @@ void Chip::GenerateBlock3( Bitu total, Bit32s* output  ) {
 	while ( total > 0 ) {
 		Bit32u samples = ForwardLFO( total );
 		memset(output, 0, sizeof(Bit32s) * samples * 2);
-		int count = 0;
 		for( Channel* ch = chan; ch < chan + 18; ) {
-			count++;
+			statBlocks++;
 			ch = (ch->*(ch->synthHandler))( this, samples, output );
 		}
+		statSamples += samples;
 		total -= samples;
 		output += samples * 2;
 	}
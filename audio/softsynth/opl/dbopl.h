@@ -91,6 +91,11 @@ enum {
 	SHIFT_KEYCODE = 24
 };
 
+//Maximum amount of samples the block renderer handles in a single pass
+enum {
+	BLOCK_SAMPLES = 64
+};
+
 struct Operator {
 public:
 	//Masks for operator 20 values
@@ -178,6 +183,11 @@ public:
 
 	Bits GetSample( Bits modulation );
 	Bits GetWave( Bitu index, Bitu vol );
+
+	//Block versions of the above, modulation can be 0
+	bool ForwardGainBlock( Bit32s* gain, Bitu samples );
+	void ForwardWaveBlock( Bit32u* index, Bitu samples );
+	void GetSampleBlock( Chip* chip, const Bit32s* modulation, Bit32s* output, Bitu samples );
 public:
 	Operator();
 };
@@ -215,6 +225,9 @@ struct Channel {
 	//Generate blocks of data in specific modes
 	template<SynthMode mode>
 	Channel* BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output );
+	//Generate blocks with the envelopes and waves of each operator forwarded for the whole block
+	template<SynthMode mode>
+	void RenderBlock( Chip* chip, Bitu samples, Bit32s* output );
 	Channel();
 };
 
@@ -253,6 +266,18 @@ struct Chip {
 	Bit8u waveFormMask;
 	//0 or -1 when enabled
 	Bit8s opl3Active;
+	//Use the block renderer for melodic channels, the output is identical
+	bool blockRender;
+
+	//Render statistics: samples generated, channel blocks visited and the ones not skipped as silent
+	Bit32u statSamples;
+	Bit32u statBlocks;
+	Bit32u statRendered;
+
+	//Scratch buffers for the block renderer
+	Bit32s blockGain[ 2 ][ BLOCK_SAMPLES ];
+	Bit32u blockIndex[ 2 ][ BLOCK_SAMPLES ];
+	Bit32s blockSample[ 2 ][ BLOCK_SAMPLES ];
 
 	//Return the maximum amount of samples before and LFO change
 	Bit32u ForwardLFO( Bit32u samples );
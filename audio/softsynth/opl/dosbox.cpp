@@ -31,6 +31,7 @@
 #include "dosbox.h"
 #include "dbopl.h"
 
+#include "common/debug.h"
 #include "common/system.h"
 #include "common/scummsys.h"
 #include "common/util.h"
@@ -143,7 +144,7 @@ uint8 Chip::read() {
 	return ret;
 }
 
-OPL::OPL(Config::OplType type) : _type(type), _rate(0), _emulator(0) {
+OPL::OPL(Config::OplType type) : _type(type), _rate(0), _blockRender(true), _emulator(0) {
 }
 
 OPL::~OPL() {
@@ -151,6 +152,10 @@ OPL::~OPL() {
 }
 
 void OPL::free() {
+	if (_emulator) {
+		const RenderStats stats = getRenderStats();
+		debug(3, "DOSBox OPL: %u samples, %u of %u channel blocks rendered", stats.samples, stats.renderedBlocks, stats.channelBlocks);
+	}
 	delete _emulator;
 	_emulator = 0;
 }
@@ -167,6 +172,7 @@ bool OPL::init(int rate) {
 
 	DBOPL::InitTables();
 	_emulator->Setup(rate);
+	_emulator->blockRender = _blockRender;
 
 	if (_type == Config::kDualOpl2) {
 		// Setup opl3 mode in the hander
@@ -306,6 +312,23 @@ void OPL::dualWrite(uint8 index, uint8 reg, uint8 val) {
 	_emulator->WriteReg(fullReg, val);
 }
 
+void OPL::setBlockRender(bool enable) {
+	_blockRender = enable;
+	if (_emulator)
+		_emulator->blockRender = enable;
+}
+
+OPL::RenderStats OPL::getRenderStats() const {
+	RenderStats stats;
+	memset(&stats, 0, sizeof(stats));
+	if (_emulator) {
+		stats.samples = _emulator->statSamples;
+		stats.channelBlocks = _emulator->statBlocks;
+		stats.renderedBlocks = _emulator->statRendered;
+	}
+	return stats;
+}
+
 void OPL::readBuffer(int16 *buffer, int length) {
 	// For stereo OPL cards, we divide the sample count by 2,
 	// to match stereo AudioStream behavior.
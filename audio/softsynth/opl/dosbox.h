@@ -69,9 +69,20 @@ struct Chip;
 } // end of namespace DBOPL
 
 class OPL : public ::OPL::OPL {
+public:
+	/**
+	 * Counters of the work done by the emulator since init().
+	 */
+	struct RenderStats {
+		uint32 samples;			///< Samples generated
+		uint32 channelBlocks;	///< Channel blocks visited
+		uint32 renderedBlocks;	///< Channel blocks which were not skipped as silent
+	};
+
 private:
 	Config::OplType _type;
 	uint _rate;
+	bool _blockRender;
 
 	DBOPL::Chip *_emulator;
 	Chip _chip[2];
@@ -96,6 +107,14 @@ public:
 
 	void readBuffer(int16 *buffer, int length);
 	bool isStereo() const { return _type != Config::kOpl2; }
+
+	/**
+	 * Select between rendering a channel one sample at a time and the
+	 * block renderer, which is the default. Both give identical output.
+	 */
+	void setBlockRender(bool enable);
+
+	RenderStats getRenderStats() const;
 };
 
 } // End of namespace DOSBox
@@ -28,6 +28,7 @@
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/platform/sdl/sdl.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -61,6 +62,8 @@ sSDL_Surface * sSDL_CreateRGBSurface (Uint32 flags,
 
 	surface->pixels = malloc(surface->h*surface->pitch);
 	memset(surface->pixels, 0, surface->h*surface->pitch);
+	memset(surface->palette, 0, sizeof(surface->palette));
+	memset(&surface->lut, 0, sizeof(surface->lut));
 
 	/* The surface is ready to go */
 	surface->refcount = 1;
@@ -69,7 +72,9 @@ sSDL_Surface * sSDL_CreateRGBSurface (Uint32 flags,
 
 int sSDL_SetColors(sSDL_Surface *screen, SDL_Color *colors, int firstcolor, int ncolors)
 {
-	memcpy(screen->palette, colors+firstcolor, sizeof(SDL_Color)*ncolors);
+	memcpy(screen->palette + firstcolor, colors, sizeof(SDL_Color)*ncolors);
+	// Only the changed range of the lookup table needs to be rebuilt
+	screen->lut.update(&colors->r, firstcolor, ncolors, sizeof(SDL_Color));
 	return 0;
 }
 
@@ -87,16 +92,12 @@ int sSDL_BlitSurface (sSDL_Surface *src, SDL_Rect *srcrect, sSDL_Surface *dst, S
 
 	assert(src->pitch == src->w);
 	assert(dst->pitch == 2*dst->w);
-	for(int y = 0; y < bHeight; ++y)
-		for(int x = 0; x < bWidth; ++x)
-		{
-			unsigned char c = ((unsigned char *)src->pixels)[(y+srcrect->y)*src->pitch+x+srcrect->x];
-			SDL_Color &col = src->palette[c];
-			unsigned short real_color = (((col.r) >> 3) << 11) |
-									(((col.g) >> 2) << 5) |
-									(((col.b) >> 3));
-			((unsigned short *)dst->pixels)[(y+dstrect->y)*dst->w+x+dstrect->x] = real_color;
-		}
+	if (bWidth <= 0 || bHeight <= 0)
+		return 0;
+
+	const byte *s = (const byte *)src->pixels + srcrect->y * src->pitch + srcrect->x;
+	byte *d = (byte *)dst->pixels + dstrect->y * dst->pitch + dstrect->x * 2;
+	src->lut.convertRect<uint16>(d, dst->pitch, s, src->pitch, bWidth, bHeight);
 	return 0;
 }
 
@@ -177,6 +178,33 @@ static const int s_gfxModeSwitchTable[][4] = {
 static int cursorStretch200To240(uint8 *buf, uint32 pitch, int width, int height, int srcX, int srcY, int origSrcY);
 #endif
 
+static const char *const s_profilerStageNames[] = {
+	"prepare",
+	"blit",
+	"scale",
+	"aspect",
+	"mouse",
+	"osd",
+	"present"
+};
+
+/** Count the pixels of a rectangle which differ between src and dst. */
+static uint32 countChangedPixels(const byte *dst, int dstPitch, const byte *src, int srcPitch, int w, int h, int bpp) {
+	uint32 changed = 0;
+	const int rowSize = w * bpp;
+
+	for (; h > 0; --h, dst += dstPitch, src += srcPitch) {
+		if (!memcmp(dst, src, rowSize))
+			continue;
+		for (int x = 0; x < rowSize; x += bpp) {
+			if (memcmp(dst + x, src + x, bpp))
+				changed++;
+		}
+	}
+
+	return changed;
+}
+
 AspectRatio::AspectRatio(int w, int h) {
 	// TODO : Validation and so on...
 	// Currently, we just ensure the program don't instantiate non-supported aspect ratios
@@ -218,12 +246,13 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_overlayVisible(false),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _directPresent(false), _screenChangeCount(0),
 	_mouseVisible(false), _mouseNeedsRedraw(false), _mouseData(0), _mouseSurface(0),
 	_mouseOrigSurface(0), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
 	_paletteDirtyStart(0), _paletteDirtyEnd(0),
 	_screenIsLocked(false),
+	_changedPixels(0), _profiler(s_profilerStageNames, kStageCount), _profilerOSDTime(0),
 	_graphicsMutex(0),
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	_enableFocusRectDebugCode(false), _enableFocusRect(false), _focusRect(),
@@ -636,6 +665,10 @@ bool SurfaceSdlGraphicsManager::setGraphicsMode(int mode) {
 	_transactionDetails.normal1xScaler = (mode == GFX_NORMAL);
 	if (_oldVideoMode.setup && _oldVideoMode.scaleFactor != newScaleFactor)
 		_transactionDetails.needHotswap = true;
+	// Switching between direct presentation and the scalers changes which
+	// intermediate surfaces are needed
+	if (_oldVideoMode.setup && isDirectPresentMode(_oldVideoMode.mode) != isDirectPresentMode(mode))
+		_transactionDetails.needHotswap = true;
 
 	_transactionDetails.needUpdatescreen = true;
 
@@ -801,6 +834,12 @@ static void fixupResolutionForAspectRatio(AspectRatio desiredAspectRatio, int &w
 	height = bestMode->h;
 }
 
+bool SurfaceSdlGraphicsManager::isDirectPresentMode(int mode) const {
+	// The plain 1x/2x/3x scalers only replicate pixels, which can just as
+	// well be done while looking up the palette.
+	return mode == GFX_NORMAL || mode == GFX_DOUBLESIZE || mode == GFX_TRIPLESIZE;
+}
+
 bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	_forceFull = true;
 
@@ -876,20 +915,27 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 		}
 	}
 
+	// In direct present mode the 8 bit game screen is converted and scaled
+	// straight into the 32 bit hardware screen, so the 16 bit intermediate
+	// surfaces used by the scalers are not needed at all.
+	_directPresent = isDirectPresentMode(_videoMode.mode) && _hwscreen->format->BytesPerPixel == 4;
+
 	//
 	// Create the surface used for the graphics in 16 bit before scaling, and also the overlay
 	//
 
-	// Need some extra bytes around when using 2xSaI
-	_tmpscreen = sSDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.screenWidth + 3, _videoMode.screenHeight + 3,
-						16,
-						_hwscreen->format->Rmask,
-						_hwscreen->format->Gmask,
-						_hwscreen->format->Bmask,
-						_hwscreen->format->Amask);
+	if (!_directPresent) {
+		// Need some extra bytes around when using 2xSaI
+		_tmpscreen = sSDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.screenWidth + 3, _videoMode.screenHeight + 3,
+							16,
+							_hwscreen->format->Rmask,
+							_hwscreen->format->Gmask,
+							_hwscreen->format->Bmask,
+							_hwscreen->format->Amask);
 
-	if (_tmpscreen == NULL)
-		error("allocating _tmpscreen failed");
+		if (_tmpscreen == NULL)
+			error("allocating _tmpscreen failed");
+	}
 
 	_overlayscreen = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.overlayWidth, _videoMode.overlayHeight,
 						16,
@@ -913,15 +959,17 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	_overlayFormat.bShift = _overlayscreen->format->Bshift;
 	_overlayFormat.aShift = _overlayscreen->format->Ashift;
 
-	_tmpscreen2 = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.overlayWidth + 3, _videoMode.overlayHeight + 3,
-						16,
-						_hwscreen->format->Rmask,
-						_hwscreen->format->Gmask,
-						_hwscreen->format->Bmask,
-						_hwscreen->format->Amask);
+	if (!_directPresent) {
+		_tmpscreen2 = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.overlayWidth + 3, _videoMode.overlayHeight + 3,
+							16,
+							_hwscreen->format->Rmask,
+							_hwscreen->format->Gmask,
+							_hwscreen->format->Bmask,
+							_hwscreen->format->Amask);
 
-	if (_tmpscreen2 == NULL)
-		error("allocating _tmpscreen2 failed");
+		if (_tmpscreen2 == NULL)
+			error("allocating _tmpscreen2 failed");
+	}
 
 #ifdef USE_OSD
 	_osdSurface = SDL_CreateRGBSurface(SDL_SWSURFACE | SDL_RLEACCEL | SDL_SRCCOLORKEY | SDL_SRCALPHA,
@@ -1002,7 +1050,10 @@ bool SurfaceSdlGraphicsManager::hotswapGFXMode() {
 	SDL_FreeSurface(_hwscreen); _hwscreen = NULL;
 
 	//SDL_FreeSurface(_tmpscreen); _tmpscreen = NULL;
-	SDL_FreeSurface(_tmpscreen2); _tmpscreen2 = NULL;
+	_tmpscreen = NULL;
+	if (_tmpscreen2) {
+		SDL_FreeSurface(_tmpscreen2); _tmpscreen2 = NULL;
+	}
 
 #ifdef USE_OSD
 	// Release the OSD surface
@@ -1045,6 +1096,14 @@ void SurfaceSdlGraphicsManager::updateScreen() {
 	Common::StackLock lock(_graphicsMutex);	// Lock the mutex until this function ends
 
 	internUpdateScreen();
+
+#ifdef USE_OSD
+	// Keep the profiler summary on screen, refreshing it before it fades out
+	if (_profiler.isEnabled() && _osdSurface && SDL_GetTicks() >= _profilerOSDTime) {
+		displayMessageOnOSD(_profiler.getSummary().c_str());
+		_profilerOSDTime = SDL_GetTicks() + kOSDFadeOutDelay / 2;
+	}
+#endif
 }
 
 void SurfaceSdlGraphicsManager::internUpdateScreen() {
@@ -1059,6 +1118,9 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	assert(_hwscreen->map->sw_data != NULL);
 #endif
 
+	_profiler.beginFrame();
+	_profiler.beginStage(kStagePrepare);
+
 	// If the shake position changed, fill the dirty area with blackness
 	if (_currentShakePos != _newShakePos ||
 		(_mouseNeedsRedraw && _mouseBackup.y <= _currentShakePos)) {
@@ -1129,6 +1191,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	if (_mouseNeedsRedraw)
 		undrawMouse();
 
+	flushDirtyRegion();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
@@ -1138,6 +1202,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		_dirtyRectList[0].h = height;
 	}
 
+	_profiler.endStage(kStagePrepare);
+
 	// Only draw anything if necessary
 	if (_numDirtyRects > 0 || _mouseNeedsRedraw) {
 		SDL_Rect *r;
@@ -1145,20 +1211,26 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		uint32 srcPitch, dstPitch;
 		SDL_Rect *lastRect = _dirtyRectList + _numDirtyRects;
 
-		for (r = _dirtyRectList; r != lastRect; ++r) {
-			dst = *r;
-			dst.x++;	// Shift rect by one since 2xSai needs to access the data around
-			dst.y++;	// any pixel to scale it, and we want to avoid mem access crashes.
+		// The direct present path converts from origSurf in the scaling
+		// loop below, so there is nothing to prepare in srcSurf.
+		if (!_directPresent) {
+			Common::FrameProfiler::Scope scope(_profiler, kStageBlit);
+
+			for (r = _dirtyRectList; r != lastRect; ++r) {
+				dst = *r;
+				dst.x++;	// Shift rect by one since 2xSai needs to access the data around
+				dst.y++;	// any pixel to scale it, and we want to avoid mem access crashes.
 
-//			warning("src rect: %d,%d,%d,%d, dst rect: %d,%d,%d,%d\n", r->x, r->y, r->w, r->h, dst.x, dst.y, dst.w, dst.h);
-			if (sSDL_BlitSurface(origSurf, r, srcSurf, &dst) != 0)
-				error("SDL_BlitSurface failed: %s", SDL_GetError());
+//				warning("src rect: %d,%d,%d,%d, dst rect: %d,%d,%d,%d\n", r->x, r->y, r->w, r->h, dst.x, dst.y, dst.w, dst.h);
+				if (sSDL_BlitSurface(origSurf, r, srcSurf, &dst) != 0)
+					error("SDL_BlitSurface failed: %s", SDL_GetError());
+			}
 		}
 
 //		SDL_LockSurface(srcSurf);
 		SDL_LockSurface(_hwscreen);
 
-		srcPitch = srcSurf->pitch;
+		srcPitch = _directPresent ? origSurf->pitch : srcSurf->pitch;
 		dstPitch = _hwscreen->pitch;
 
 		for (r = _dirtyRectList; r != lastRect; ++r) {
@@ -1178,11 +1250,19 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 				if (_videoMode.aspectRatioCorrection && !_overlayVisible)
 					dst_y = real2Aspect(dst_y);
 
-				assert(scalerProc != NULL);
-				//scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-				//	(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 4 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				Common::FrameProfiler::Scope scope(_profiler, kStageScale);
+
+				if (_directPresent) {
+					// Palette lookup, scaling and the 32 bit write in one pass
+					origSurf->lut.convertRectScaled<uint32>((byte *)_hwscreen->pixels + rx1 * 4 + dst_y * dstPitch, dstPitch,
+						(const byte *)origSurf->pixels + r->x + r->y * srcPitch, srcPitch, r->w, dst_h, scale1);
+				} else {
+					assert(scalerProc != NULL);
+					//scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+					//	(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+					scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * 4 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				}
 			}
 
 			r->x = rx1;
@@ -1191,8 +1271,10 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			r->h = dst_h * scale1;
 
 #ifdef USE_SCALERS
-			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible)
+			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible) {
+				Common::FrameProfiler::Scope scope(_profiler, kStageAspect);
 				r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+			}
 #endif
 		}
 //		SDL_UnlockSurface(srcSurf);
@@ -1205,10 +1287,13 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			_dirtyRectList[0].h = effectiveScreenHeight();
 		}
 
+		_profiler.beginStage(kStageMouse);
 		drawMouse();
+		_profiler.endStage(kStageMouse);
 
 #ifdef USE_OSD
 		if (_osdAlpha != SDL_ALPHA_TRANSPARENT) {
+			Common::FrameProfiler::Scope scope(_profiler, kStageOSD);
 			SDL_BlitSurface(_osdSurface, 0, _hwscreen, 0);
 		}
 #endif
@@ -1286,7 +1371,18 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 #endif
 
 		// Finally, blit all our changes to the screen
+		_profiler.beginStage(kStagePresent);
 		SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
+		_profiler.endStage(kStagePresent);
+	}
+
+	_profiler.endFrame(_numDirtyRects, _forceFull);
+
+	if (gDebugLevel >= 2) {
+		const Graphics::DirtyRegion::Stats &stats = _dirtyRegion.getLastStats();
+		debug(2, "Dirty region: %d rects, %d pixels presented, %d pixels changed%s",
+			stats.rects, stats.presentedPixels, _changedPixels, _forceFull ? " (full update)" : "");
+		_changedPixels = 0;
 	}
 
 	_numDirtyRects = 0;
@@ -1343,6 +1439,15 @@ void SurfaceSdlGraphicsManager::copyRectToScreen(const void *buf, int pitch, int
 
 	addDirtyRect(x, y, w, h);
 
+#ifdef USE_RGB_COLOR
+	const int bpp = _screenFormat.bytesPerPixel;
+#else
+	const int bpp = 1;
+#endif
+	if (gDebugLevel >= 2)
+		_changedPixels += countChangedPixels((const byte *)_screen->pixels + y * _screen->pitch + x * bpp, _screen->pitch,
+			(const byte *)buf, pitch, w, h, bpp);
+
 	// Try to lock the screen surface
 //	if (SDL_LockSurface(_screen) == -1)
 //		error("SDL_LockSurface failed: %s", SDL_GetError());
@@ -1442,7 +1547,7 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceFull)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
+	if (realCoordinates && _numDirtyRects == NUM_DIRTY_RECT) {
 		_forceFull = true;
 		return;
 	}
@@ -1485,20 +1590,57 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		h = height - y;
 	}
 
-#ifdef USE_SCALERS
-	if (_videoMode.aspectRatioCorrection && !_overlayVisible && !realCoordinates) {
-		makeRectStretchable(x, y, w, h);
-	}
-#endif
-
 	if (w == width && h == height) {
 		_forceFull = true;
 		return;
 	}
 
-	if (w > 0 && h > 0) {
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (realCoordinates) {
 		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
 
+		r->x = x;
+		r->y = y;
+		r->w = w;
+		r->h = h;
+	} else {
+		// Many small rects, e.g. of actors, are merged with their neighbors
+		// here instead of overflowing the rect list
+		if (_dirtyRegion.getWidth() != width || _dirtyRegion.getHeight() != height)
+			_dirtyRegion.init(width, height, 8, 4);
+		_dirtyRegion.addRect(x, y, w, h);
+	}
+}
+
+void SurfaceSdlGraphicsManager::flushDirtyRegion() {
+	if (_forceFull) {
+		_dirtyRegion.clear();
+		return;
+	}
+
+	// Leave some entries for the mouse cursor, which is added later on
+	const int maxRects = NUM_DIRTY_RECT - _numDirtyRects - 4;
+	if (maxRects <= 0) {
+		_forceFull = true;
+		_dirtyRegion.clear();
+		return;
+	}
+
+	_dirtyRegionRects.clear();
+	_dirtyRegion.flush(_dirtyRegionRects, maxRects);
+
+	for (uint i = 0; i < _dirtyRegionRects.size(); ++i) {
+		const Common::Rect &rect = _dirtyRegionRects[i];
+		int x = rect.left, y = rect.top, w = rect.width(), h = rect.height();
+
+#ifdef USE_SCALERS
+		if (_videoMode.aspectRatioCorrection && !_overlayVisible)
+			makeRectStretchable(x, y, w, h);
+#endif
+
+		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
 		r->x = x;
 		r->y = y;
 		r->w = w;
@@ -1691,8 +1833,13 @@ void SurfaceSdlGraphicsManager::clearOverlay() {
 
 //	SDL_LockSurface(_tmpscreen);
 	SDL_LockSurface(_overlayscreen);
-	_scalerProc((byte *)(_tmpscreen->pixels) + _tmpscreen->pitch + 2, _tmpscreen->pitch,
-	(byte *)_overlayscreen->pixels, _overlayscreen->pitch, _videoMode.screenWidth, _videoMode.screenHeight);
+	if (_directPresent) {
+		_screen->lut.convertRectScaled<uint16>((byte *)_overlayscreen->pixels, _overlayscreen->pitch,
+			(const byte *)_screen->pixels, _screen->pitch, _videoMode.screenWidth, _videoMode.screenHeight, _videoMode.scaleFactor);
+	} else {
+		_scalerProc((byte *)(_tmpscreen->pixels) + _tmpscreen->pitch + 2, _tmpscreen->pitch,
+		(byte *)_overlayscreen->pixels, _overlayscreen->pitch, _videoMode.screenWidth, _videoMode.screenHeight);
+	}
 
 #ifdef USE_SCALERS
 	if (_videoMode.aspectRatioCorrection)
@@ -2327,6 +2474,41 @@ bool SurfaceSdlGraphicsManager::handleScalerHotkeys(Common::KeyCode key) {
 	}
 }
 
+bool SurfaceSdlGraphicsManager::handleProfilerHotkeys(Common::KeyCode key) {
+	// Ctrl-Alt-p toggles the profiler and its summary on the OSD
+	if (key == 'p') {
+		_profiler.setEnabled(!_profiler.isEnabled());
+		_profilerOSDTime = 0;
+#ifdef USE_OSD
+		if (!_profiler.isEnabled())
+			displayMessageOnOSD(_("Profiler disabled"));
+#endif
+		return true;
+	}
+
+	// Ctrl-Alt-t writes the profiled frames as a Chrome trace
+	if (key == 't') {
+		char filename[24];
+
+		for (int n = 0;; n++) {
+			SDL_RWops *file;
+
+			sprintf(filename, "scummvm%05d.json", n);
+			file = SDL_RWFromFile(filename, "r");
+			if (!file)
+				break;
+			SDL_RWclose(file);
+		}
+		if (_profiler.exportTrace(filename))
+			debug("Saved %d profiled frames to '%s'", _profiler.getFrameCount(), filename);
+		else
+			warning("Could not save profiler trace");
+		return true;
+	}
+
+	return false;
+}
+
 bool SurfaceSdlGraphicsManager::isScalerHotkey(const Common::Event &event) {
 	if ((event.kbd.flags & (Common::KBD_CTRL|Common::KBD_ALT)) == (Common::KBD_CTRL|Common::KBD_ALT)) {
 		const bool isNormalNumber = (Common::KEYCODE_1 <= event.kbd.keycode && event.kbd.keycode <= Common::KEYCODE_9);
@@ -2389,11 +2571,16 @@ bool SurfaceSdlGraphicsManager::notifyEvent(const Common::Event &event) {
 
 		// Ctrl-Alt-<key> will change the GFX mode
 		if (event.kbd.hasFlags(Common::KBD_CTRL|Common::KBD_ALT)) {
+			if (handleProfilerHotkeys(event.kbd.keycode))
+				return true;
 			if (handleScalerHotkeys(event.kbd.keycode))
 				return true;
 		}
 
 	case Common::EVENT_KEYUP:
+		if (event.kbd.hasFlags(Common::KBD_CTRL|Common::KBD_ALT) &&
+			(event.kbd.keycode == 'p' || event.kbd.keycode == 't'))
+			return true;
 		return isScalerHotkey(event);
 
 	default:
@@ -25,6 +25,9 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "common/frame-profiler.h"
+#include "graphics/dirty_region.h"
+#include "graphics/palette_lut.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -85,6 +88,9 @@ typedef struct sSDL_Surface {
 
 	SDL_Color palette[256];
 
+	/** palette converted to the destination formats, see sSDL_SetColors */
+	Graphics::PaletteLUT lut;
+
 	/** clipping information */
 	SDL_Rect clip_rect;			/**< Read-only */
 	Uint32 unused1;				/**< for binary compatibility */
@@ -260,6 +266,13 @@ protected:
 
 	ScalerProc *_scalerProc;
 	int _scalerType;
+
+	/**
+	 * Whether the game screen is converted and scaled straight into the
+	 * 32 bit hardware screen, bypassing _tmpscreen. See loadGFXMode().
+	 */
+	bool _directPresent;
+
 	int _transactionMode;
 
 	bool _screenIsLocked;
@@ -276,6 +289,36 @@ protected:
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	/**
+	 * Dirty areas in game resp. overlay coordinates. They are coalesced into
+	 * _dirtyRectList by flushDirtyRegion() at the start of each update.
+	 */
+	Graphics::DirtyRegion _dirtyRegion;
+	Common::Array<Common::Rect> _dirtyRegionRects;
+
+	/**
+	 * Pixels which differed from the screen contents when copied to the
+	 * screen since the last update. Only counted at debug level 2 and up.
+	 */
+	uint32 _changedPixels;
+
+	/** Stages of internUpdateScreen timed by the profiler */
+	enum ProfilerStage {
+		kStagePrepare,	/** < Palette, shake and dirty rect setup */
+		kStageBlit,		/** < Copy into the scaler source surface */
+		kStageScale,	/** < Scaler resp. direct palette conversion */
+		kStageAspect,	/** < Aspect ratio stretching */
+		kStageMouse,	/** < Mouse cursor */
+		kStageOSD,		/** < On screen display */
+		kStagePresent,	/** < SDL_UpdateRects */
+		kStageCount
+	};
+
+	/** Stage timings of internUpdateScreen, toggled with Ctrl-Alt-p */
+	Common::FrameProfiler _profiler;
+	/** When to refresh the profiler summary on the OSD next */
+	uint32 _profilerOSDTime;
+
 	struct MousePos {
 		// The mouse position, using either virtual (game) or real
 		// (overlay) coordinates.
@@ -344,12 +387,16 @@ protected:
 
 	virtual void addDirtyRect(int x, int y, int w, int h, bool realCoordinates = false);
 
+	/** Turn the collected dirty region into entries of _dirtyRectList. */
+	void flushDirtyRegion();
+
 	virtual void drawMouse();
 	virtual void undrawMouse();
 	virtual void blitCursor();
 
 	virtual void internUpdateScreen();
 
+	virtual bool isDirectPresentMode(int mode) const;
 	virtual bool loadGFXMode();
 	virtual void unloadGFXMode();
 	virtual bool hotswapGFXMode();
@@ -363,6 +410,8 @@ protected:
 
 	virtual bool handleScalerHotkeys(Common::KeyCode key);
 	virtual bool isScalerHotkey(const Common::Event &event);
+	/** Ctrl-Alt-p toggles the profiler, Ctrl-Alt-t exports its trace */
+	bool handleProfilerHotkeys(Common::KeyCode key);
 	virtual void setMousePos(int x, int y);
 	virtual void toggleFullScreen();
 	virtual bool saveScreenshot(const char *filename);
@@ -0,0 +1,294 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The benchmark report goes to stdout
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "backends/platform/null/headless-bench.h"
+
+#if defined(USE_NULL_DRIVER)
+
+#include "base/commandLine.h"
+#include "base/plugins.h"
+
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/error.h"
+#include "common/EventRecorder.h"
+#include "common/events.h"
+#include "common/fs.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "engines/engine.h"
+#include "engines/metaengine.h"
+
+namespace {
+
+struct BenchInstance {
+	Engine *engine;
+	EngineStepper *stepper;
+	Common::EventReplaySource *replay;
+
+	bool finished;
+	uint32 nextStep;	///< deadline of the next step
+	uint32 steps;
+	uint32 busyTime;	///< time spent inside the engine
+	uint32 lateTime;	///< total time the steps started after their deadline
+	uint32 lateMax;
+};
+
+void activate(BenchInstance &inst) {
+	// Engines keep a few globals, point them at this instance
+	g_engine = inst.engine;
+	if (inst.replay)
+		g_system->getEventManager()->getEventDispatcher()->registerSource(inst.replay, false);
+}
+
+void deactivate(BenchInstance &inst) {
+	if (inst.replay)
+		g_system->getEventManager()->getEventDispatcher()->unregisterSource(inst.replay);
+}
+
+void finish(BenchInstance &inst) {
+	activate(inst);
+	const Common::Error err = inst.stepper->endSteps();
+	if (err.getCode() != Common::kNoError)
+		warning("Headless bench: instance finished with error: %s", err.getDesc().c_str());
+	deactivate(inst);
+	inst.finished = true;
+}
+
+/** Step the instance which is due first. Returns false once all are finished. */
+bool stepNext(Common::Array<BenchInstance> &instances, uint32 maxSteps, bool fast) {
+	BenchInstance *next = 0;
+	for (uint i = 0; i < instances.size(); ++i) {
+		BenchInstance &inst = instances[i];
+		if (inst.finished)
+			continue;
+		if (maxSteps && inst.steps >= maxSteps) {
+			finish(inst);
+			continue;
+		}
+		if (!next || (int32)(inst.nextStep - next->nextStep) < 0)
+			next = &inst;
+	}
+
+	if (!next)
+		return false;
+
+	uint32 now = g_system->getMillis();
+	const int32 wait = (int32)(next->nextStep - now);
+	if (wait > 0 && !fast) {
+		g_system->delayMillis(wait);
+		now = g_system->getMillis();
+	} else if (wait < 0 && !fast) {
+		const uint32 late = -wait;
+		next->lateTime += late;
+		if (late > next->lateMax)
+			next->lateMax = late;
+	}
+
+	activate(*next);
+	const int32 delay = next->stepper->runStep();
+	if (delay != EngineStepper::kStepFinished)
+		next->stepper->idleStep();
+	deactivate(*next);
+
+	const uint32 end = g_system->getMillis();
+	next->busyTime += end - now;
+	next->steps++;
+
+	if (delay == EngineStepper::kStepFinished)
+		finish(*next);
+	else
+		next->nextStep = fast ? end : end + delay;
+
+	return true;
+}
+
+void report(const Common::Array<BenchInstance> &instances, uint32 elapsed) {
+	const double seconds = MAX<uint32>(elapsed, 1) / 1000.0;
+	uint32 totalSteps = 0;
+	double totalOpcodes = 0;
+	uint32 totalBusy = 0;
+
+	printf("\nInstance    frames   frames/s  opcodes/s  heap peak KB  late avg/max ms\n");
+	for (uint i = 0; i < instances.size(); ++i) {
+		const BenchInstance &inst = instances[i];
+		EngineStepper::StepStats stats = { 0, 0, 0 };
+		inst.stepper->getStepStats(stats);
+
+		printf("%8u  %8u  %9.1f  %9.0f  %12u  %7u/%u\n", i, inst.steps,
+			inst.steps / seconds, stats.opcodes / seconds, stats.heapPeak / 1024,
+			inst.steps ? inst.lateTime / inst.steps : 0, inst.lateMax);
+
+		totalSteps += inst.steps;
+		totalOpcodes += stats.opcodes;
+		totalBusy += inst.busyTime;
+	}
+
+	printf("   total  %8u  %9.1f  %9.0f\n", totalSteps, totalSteps / seconds, totalOpcodes / seconds);
+	printf("%u instances ran for %.2f s, the engines kept the CPU busy %.1f%% of that time\n",
+		instances.size(), seconds, 100.0 * totalBusy / MAX<uint32>(elapsed, 1));
+}
+
+} // End of anonymous namespace
+
+int runHeadlessBench(int argc, const char *const argv[]) {
+	uint instanceCount = 1;
+	uint32 maxSteps = 1000;
+	bool fast = false;
+	Common::String replayFile;
+
+	// Take out our own options, the rest is passed on to the command line parser
+	Common::Array<const char *> args;
+	args.push_back("scummvm");
+	for (int i = 1; i < argc; ++i) {
+		const Common::String arg(argv[i]);
+		if (arg.hasPrefix("--instances="))
+			instanceCount = MAX<int>(atoi(arg.c_str() + 12), 1);
+		else if (arg.hasPrefix("--frames="))
+			maxSteps = atoi(arg.c_str() + 9);
+		else if (arg == "--fast")
+			fast = true;
+		else if (arg.hasPrefix("--replay="))
+			replayFile = arg.c_str() + 9;
+		else
+			args.push_back(argv[i]);
+	}
+
+	Base::registerDefaults();
+
+	Common::StringMap settings;
+	Common::String command = Base::parseCommandLine(settings, args.size(), args.begin());
+
+	if (settings.contains("config")) {
+		ConfMan.loadConfigFile(settings["config"]);
+		settings.erase("config");
+	} else {
+		ConfMan.loadDefaultConfigFile();
+	}
+
+	if (settings.contains("debuglevel")) {
+		gDebugLevel = (int)strtol(settings["debuglevel"].c_str(), 0, 10);
+		settings.erase("debuglevel");
+	}
+
+	PluginManager::instance().init();
+	PluginManager::instance().loadAllPlugins();
+
+	Common::Error err;
+	if (Base::processSettings(command, settings, err))
+		return err.getCode();
+
+	if (0 == ConfMan.getActiveDomain()) {
+		warning("Headless bench: no game target given");
+		return Common::kUnknownError;
+	}
+
+	g_system->initBackend();
+	g_system->getEventManager()->init();
+
+	Common::String gameid(ConfMan.getActiveDomainName());
+	if (ConfMan.hasKey("gameid"))
+		gameid = ConfMan.get("gameid");
+	gameid.toLowercase();
+	ConfMan.set("gameid", gameid);
+
+	const EnginePlugin *plugin = 0;
+	EngineMan.findGame(gameid, &plugin);
+	if (!plugin) {
+		warning("Headless bench: %s is an invalid gameid", gameid.c_str());
+		return Common::kUnknownError;
+	}
+
+	Common::FSNode dir(ConfMan.get("path"));
+	if (!(dir.exists() && dir.isDirectory()))
+		return Common::kPathNotDirectory;
+	SearchMan.addDirectory(dir.getPath(), dir, 0, 4);
+
+	g_system->engineInit();
+
+	Common::Array<BenchInstance> instances;
+	for (uint i = 0; i < instanceCount; ++i) {
+		BenchInstance inst;
+		memset(&inst, 0, sizeof(inst));
+
+		err = (*plugin)->createInstance(g_system, &inst.engine);
+		if (!inst.engine || err.getCode() != Common::kNoError) {
+			warning("Headless bench: failed to instantiate engine: %s", err.getDesc().c_str());
+			break;
+		}
+
+		inst.stepper = inst.engine->getStepper();
+		if (!inst.stepper) {
+			warning("Headless bench: %s can not be run one step at a time", plugin->getName());
+			delete inst.engine;
+			break;
+		}
+
+		if (!replayFile.empty()) {
+			inst.replay = new Common::EventReplaySource(Common::FSNode(replayFile).createReadStream());
+			if (!inst.replay->isValid())
+				warning("Headless bench: can not replay '%s'", replayFile.c_str());
+		}
+
+		activate(inst);
+		err = inst.stepper->beginSteps();
+		deactivate(inst);
+		if (err.getCode() != Common::kNoError) {
+			warning("Headless bench: failed to start engine: %s", err.getDesc().c_str());
+			delete inst.replay;
+			delete inst.engine;
+			break;
+		}
+
+		inst.nextStep = g_system->getMillis();
+		instances.push_back(inst);
+	}
+
+	const uint32 start = g_system->getMillis();
+	while (stepNext(instances, maxSteps, fast))
+		;
+	report(instances, g_system->getMillis() - start);
+
+	for (uint i = 0; i < instances.size(); ++i) {
+		g_engine = instances[i].engine;
+		delete instances[i].engine;
+		delete instances[i].replay;
+	}
+
+	g_system->engineDone();
+	SearchMan.clear();
+	PluginManager::instance().unloadAllPlugins();
+
+	return instances.size() == instanceCount ? Common::kNoError : Common::kUnknownError;
+}
+
+#else /* USE_NULL_DRIVER */
+
+int runHeadlessBench(int argc, const char *const argv[]) {
+	return 1;
+}
+
+#endif
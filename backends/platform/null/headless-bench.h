@@ -0,0 +1,44 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_PLATFORM_NULL_HEADLESS_BENCH_H
+#define BACKENDS_PLATFORM_NULL_HEADLESS_BENCH_H
+
+/**
+ * Run several independent instances of one game cooperatively in this
+ * thread, without any output, and report their throughput.
+ *
+ * Usage: scummvm --headless-bench [--instances=N] [--frames=N] [--fast]
+ *                [--replay=FILE] [scummvm options] TARGET
+ *
+ * Every instance is driven through EngineStepper one main loop iteration
+ * at a time, at the deadlines requested by the engine, or back to back
+ * with --fast. With --replay, every instance replays the input of a file
+ * written by the event recorder on its own.
+ *
+ * g_system has to be set up, but not initialized yet.
+ *
+ * @return 0 on success, else an error code.
+ */
+int runHeadlessBench(int argc, const char *const argv[]);
+
+#endif
@@ -1,7 +1,8 @@
 MODULE := backends/platform/null
 
 MODULE_OBJS := \
-	null.o
+	null.o \
+	headless-bench.o
 
 # We don't use rules.mk but rather manually update OBJS and MODULE_DIRS.
 MODULE_OBJS := $(addprefix $(MODULE)/, $(MODULE_OBJS))
@@ -20,15 +20,29 @@
  *
  */
 
+#if defined(POSIX)
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+#endif
+
 #include "backends/modular-backend.h"
 #include "base/main.h"
 
 #if defined(USE_NULL_DRIVER)
+#include "backends/events/default/default-events.h"
+#include "backends/graphics/null/null-graphics.h"
+#include "backends/mutex/null/null-mutex.h"
+#include "backends/platform/null/headless-bench.h"
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "audio/mixer_intern.h"
 #include "common/scummsys.h"
 
+#if defined(POSIX)
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
 /*
  * Include header files needed for the getFilesystemFactory() method.
  */
@@ -40,7 +54,7 @@
 	#include "backends/fs/windows/windows-fs-factory.h"
 #endif
 
-class OSystem_NULL : public ModularBackend {
+class OSystem_NULL : public ModularBackend, Common::EventSource {
 public:
 	OSystem_NULL();
 	virtual ~OSystem_NULL();
@@ -48,12 +62,18 @@ public:
 	virtual void initBackend();
 
 	virtual bool pollEvent(Common::Event &event);
+	virtual Common::EventSource *getDefaultEventSource() { return this; }
 
 	virtual uint32 getMillis();
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &t) const {}
 
 	virtual void logMessage(LogMessageType::Type type, const char *message);
+
+private:
+#if defined(POSIX)
+	timeval _startTime;
+#endif
 };
 
 OSystem_NULL::OSystem_NULL() {
@@ -66,6 +86,10 @@ OSystem_NULL::OSystem_NULL() {
 	#else
 		#error Unknown and unsupported FS backend
 	#endif
+
+	#if defined(POSIX)
+		gettimeofday(&_startTime, 0);
+	#endif
 }
 
 OSystem_NULL::~OSystem_NULL() {
@@ -93,10 +117,21 @@ bool OSystem_NULL::pollEvent(Common::Event &event) {
 }
 
 uint32 OSystem_NULL::getMillis() {
+#if defined(POSIX)
+	// The headless benchmark paces the engines with this, so it has to be real
+	timeval currentTime;
+	gettimeofday(&currentTime, 0);
+	return (uint32)((currentTime.tv_sec - _startTime.tv_sec) * 1000 +
+	                (currentTime.tv_usec - _startTime.tv_usec) / 1000);
+#else
 	return 0;
+#endif
 }
 
 void OSystem_NULL::delayMillis(uint msecs) {
+#if defined(POSIX)
+	usleep(msecs * 1000);
+#endif
 }
 
 void OSystem_NULL::logMessage(LogMessageType::Type type, const char *message) {
@@ -119,8 +154,14 @@ int main(int argc, char *argv[]) {
 	g_system = OSystem_NULL_create();
 	assert(g_system);
 
-	// Invoke the actual ScummVM main entry point:
-	int res = scummvm_main(argc, argv);
+	int res;
+	if (argc > 1 && !strcmp(argv[1], "--headless-bench")) {
+		// Run several engine instances without output, see headless-bench.cpp
+		res = runHeadlessBench(argc - 1, argv + 1);
+	} else {
+		// Invoke the actual ScummVM main entry point:
+		res = scummvm_main(argc, argv);
+	}
 	delete (OSystem_NULL *)g_system;
 	return res;
 }
@@ -48,6 +48,7 @@
 #include "common/debug-channels.h" /* for debug manager */
 #include "common/events.h"
 #include "common/EventRecorder.h"
+#include "common/frame-scheduler.h"
 #include "common/fs.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -129,6 +130,9 @@ static const EnginePlugin *detectPlugin() {
 	return plugin;
 }
 
+/** The engine driven by mainLoop(), see runGame() */
+static EngineStepper *s_mainLoopStepper = 0;
+
 // TODO: specify the possible return values here
 static Common::Error runGame(const EnginePlugin *plugin, OSystem &system, const Common::String &edebuglevels) {
 	// Determine the game data path, for validation and error messages
@@ -227,7 +231,16 @@ static Common::Error runGame(const EnginePlugin *plugin, OSystem &system, const
 	// Inform backend that the engine is about to be run
 	system.engineInit();
 
-	// Run the engine
+	// Run the engine. Engines which can run their main loop one iteration
+	// at a time are only initialized here and then driven by mainLoop().
+	EngineStepper *stepper = engine->getStepper();
+	if (stepper) {
+		Common::Error result = stepper->beginSteps();
+		if (result.getCode() == Common::kNoError)
+			s_mainLoopStepper = stepper;
+		return result;
+	}
+
 	Common::Error result = engine->run();
 	return result;
 
@@ -332,17 +345,43 @@ static void setupKeymapper(OSystem &system) {
 #include "emscripten/emscripten.h"
 #endif
 
-typedef void (*FuncPtr)();
-FuncPtr mainLoopUpdateFunc = 0;
+static Common::FrameScheduler *s_mainLoopScheduler = 0;
+
+static void mainLoopStep() {
+	if (!s_mainLoopStepper)
+		return;
+
+	const int32 delay = s_mainLoopStepper->runStep();
+
+	if (delay == EngineStepper::kStepFinished) {
+		const Common::Error result = s_mainLoopStepper->endSteps();
+		if (result.getCode() != Common::kNoError)
+			warning("Engine finished with error: %s", result.getDesc().c_str());
+		s_mainLoopStepper = 0;
+		return;
+	}
+
+	// The delay counts from the end of the step. The logic tick presents
+	// the screen itself, see Common::FrameScheduler.
+	const uint32 now = s_mainLoopScheduler->getMillis();
+	s_mainLoopStepper->idleStep();
+	s_mainLoopScheduler->scheduleLogic(now + delay);
+}
+
+static void mainLoopIdle() {
+	if (s_mainLoopStepper)
+		s_mainLoopStepper->idleStep();
+}
+
+#ifdef EMSCRIPTEN
 void emscriptenUpdate(void *)
 {
-	if (mainLoopUpdateFunc)
-		mainLoopUpdateFunc();
-//	warning("Update at %f", (float)emscripten_get_now());
-//        emscripten_async_call(emscriptenUpdate, 0, 1);
+	const int32 wait = s_mainLoopScheduler->step();
+	// Sleep exactly until the next deadline instead of polling
+	if (wait >= 0 && s_mainLoopStepper)
+		emscripten_async_call(emscriptenUpdate, 0, wait);
 }
 
-#ifdef EMSCRIPTEN
 bool directoryExists(const char *path)
 {
 	if (access(path, 0) != 0)
@@ -356,12 +395,34 @@ bool directoryExists(const char *path)
 void mainLoop()
 {
 	printf("Entering main loop!");
-//#ifndef EMSCRIPTEN
-//	while(mainLoopUpdateFunc)
-//#endif
-//		emscriptenUpdate(0);
-//	emscripten_set_main_loop(mainLoopUpdateFunc, 1, 0);
-	emscripten_async_call(emscriptenUpdate, 0, 1);
+
+	if (!s_mainLoopStepper)
+		return;
+
+	if (!s_mainLoopScheduler) {
+		s_mainLoopScheduler = new Common::FrameScheduler();
+		s_mainLoopScheduler->setLogicProc(mainLoopStep);
+		s_mainLoopScheduler->setPresentProc(mainLoopIdle);
+	}
+
+	// Run the first iteration right away, each step schedules the next one
+	s_mainLoopScheduler->scheduleLogic(s_mainLoopScheduler->getMillis());
+
+#ifdef EMSCRIPTEN
+	emscripten_async_call(emscriptenUpdate, 0, 0);
+#else
+	while (s_mainLoopStepper) {
+		const int32 wait = s_mainLoopScheduler->step();
+		if (wait < 0)
+			break;
+		if (wait > 0)
+			g_system->delayMillis(wait);
+	}
+
+	const Common::FrameScheduler::JitterStats &jitter = s_mainLoopScheduler->getJitterStats();
+	debug(1, "Main loop: %d iterations, late by %d ms on average, %d ms max",
+		jitter.ticks, jitter.average(), jitter.max);
+#endif
 }
 
 extern "C" int scummvm_main(int argc, const char * const argv[]) {
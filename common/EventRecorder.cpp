@@ -425,4 +425,77 @@ bool EventRecorder::pollEvent(Event &ev) {
 	return false;
 }
 
+EventReplaySource::EventReplaySource(SeekableReadStream *stream)
+	: _stream(stream), _eventsLeft(0), _pollCount(0), _diff(0), _hasEvent(false) {
+	if (!_stream)
+		return;
+
+	if (_stream->readUint32LE() != RECORD_SIGNATURE) {
+		warning("EventReplaySource: Unknown record file signature");
+		delete _stream;
+		_stream = 0;
+		return;
+	}
+
+	_stream->readUint32LE(); // version
+	_stream->readByte(); // subtitles
+
+	_eventsLeft = _stream->readUint32LE();
+	_stream->readUint32LE(); // time count
+
+	// Skip the random seeds
+	const uint32 randomSourceCount = _stream->readUint32LE();
+	for (uint i = 0; i < randomSourceCount; ++i) {
+		const uint32 nameLen = _stream->readUint32LE();
+		_stream->skip(nameLen + 4);
+	}
+
+	if (_stream->err() || _stream->eos()) {
+		warning("EventReplaySource: Truncated record file");
+		delete _stream;
+		_stream = 0;
+		_eventsLeft = 0;
+	}
+}
+
+EventReplaySource::~EventReplaySource() {
+	delete _stream;
+}
+
+bool EventReplaySource::pollEvent(Event &ev) {
+	if (!_stream)
+		return false;
+
+	++_pollCount;
+
+	if (!_hasEvent && _eventsLeft > 0) {
+		uint32 millis;
+		readRecord(_stream, _diff, _event, millis);
+		_eventsLeft--;
+		_hasEvent = true;
+	}
+
+	if (!_hasEvent || _diff > _pollCount)
+		return false;
+
+	switch (_event.type) {
+	case EVENT_MOUSEMOVE:
+	case EVENT_LBUTTONDOWN:
+	case EVENT_LBUTTONUP:
+	case EVENT_RBUTTONDOWN:
+	case EVENT_RBUTTONUP:
+	case EVENT_WHEELUP:
+	case EVENT_WHEELDOWN:
+		g_system->warpMouse(_event.mouse.x, _event.mouse.y);
+		break;
+	default:
+		break;
+	}
+
+	ev = _event;
+	_hasEvent = false;
+	_pollCount = 0;
+	return true;
+}
+
 } // End of namespace Common
@@ -105,6 +105,41 @@ private:
 	String _recordTimeFileName;
 };
 
+/**
+ * Event source replaying the events of a file written by the EventRecorder,
+ * independent of the global recorder. Each event is replayed after the same
+ * number of polls after the previous one as it was recorded with. The
+ * recorded timing and random seeds are not used.
+ *
+ * Several sources can replay the same recording side by side, e.g. one per
+ * engine instance in the headless benchmark of the null backend.
+ */
+class EventReplaySource : public EventSource {
+public:
+	/**
+	 * Create a replay source. The source takes ownership of the stream.
+	 * If the stream is not a valid recording, isValid() returns false.
+	 */
+	explicit EventReplaySource(SeekableReadStream *stream);
+	~EventReplaySource();
+
+	bool isValid() const { return _stream != 0; }
+
+	/** Whether all events of the recording have been replayed */
+	bool isFinished() const { return !_hasEvent && _eventsLeft == 0; }
+
+	virtual bool pollEvent(Event &ev);
+	virtual bool allowMapping() const { return false; }
+
+private:
+	SeekableReadStream *_stream;
+	uint32 _eventsLeft;
+	uint32 _pollCount;
+	uint32 _diff;
+	bool _hasEvent;
+	Event _event;
+};
+
 } // End of namespace Common
 
 #endif
@@ -26,8 +26,10 @@
 #define COMMON_BITSTREAM_H
 
 #include "common/scummsys.h"
+#include "common/endian.h"
 #include "common/textconsole.h"
 #include "common/stream.h"
+#include "common/types.h"
 
 namespace Common {
 
@@ -61,35 +63,170 @@ public:
 	/** Read a bit from the bit stream, without changing the stream's position. */
 	virtual uint32 peekBit() = 0;
 
-	/** Read a multi-bit value from the bit stream, without changing the stream's position. */
+	/**
+	 * Read a multi-bit value from the bit stream, without changing the stream's position.
+	 *
+	 * Bits past the end of the stream read as 0.
+	 */
 	virtual uint32 peekBits(uint8 n) = 0;
 
 	/** Add a bit to the value x, making it an n+1-bit value. */
 	virtual void addBit(uint32 &x, uint32 n) = 0;
 
+	/** Are the bits of a multi-bit value handed out MSB first? */
+	virtual bool isMSBFirst() const = 0;
+
 protected:
 	BitStream() {
 	}
 };
 
+/**
+ * A simple memory based data stream for bit streams.
+ *
+ * It offers the subset of the SeekableReadStream interface a BitStreamImpl
+ * uses, without any virtual calls, so that the bit stream's reads compile
+ * down to plain memory accesses.
+ */
+class BitStreamMemoryStream {
+private:
+	const byte * const _ptrOrig;
+	const byte *_ptr;
+	const uint32 _size;
+	uint32 _pos;
+	DisposeAfterUse::Flag _disposeMemory;
+	bool _eos;
+
+public:
+	/**
+	 * Wrap a memory buffer of this size. If disposeMemory is true, the stream
+	 * takes ownership of the buffer and free's it when destructed.
+	 */
+	BitStreamMemoryStream(const byte *dataPtr, uint32 dataSize, DisposeAfterUse::Flag disposeMemory = DisposeAfterUse::NO) :
+		_ptrOrig(dataPtr),
+		_ptr(dataPtr),
+		_size(dataSize),
+		_pos(0),
+		_disposeMemory(disposeMemory),
+		_eos(false) {}
+
+	~BitStreamMemoryStream() {
+		if (_disposeMemory)
+			free(const_cast<byte *>(_ptrOrig));
+	}
+
+	bool eos() const { return _eos; }
+	bool err() const { return false; }
+
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		switch (whence) {
+		case SEEK_END:
+			offset = _size + offset;
+			// Fall through
+		case SEEK_SET:
+			_pos = offset;
+			break;
+
+		case SEEK_CUR:
+			_pos += offset;
+			break;
+		}
+
+		assert(_pos <= _size);
+
+		_ptr = _ptrOrig + _pos;
+		_eos = false;
+		return true;
+	}
+
+	byte readByte() {
+		if (!hasBytes(1))
+			return 0;
+
+		byte val = *_ptr;
+		skipBytes(1);
+		return val;
+	}
+
+	uint16 readUint16LE() {
+		if (!hasBytes(2))
+			return 0;
+
+		uint16 val = READ_LE_UINT16(_ptr);
+		skipBytes(2);
+		return val;
+	}
+
+	uint16 readUint16BE() {
+		if (!hasBytes(2))
+			return 0;
+
+		uint16 val = READ_BE_UINT16(_ptr);
+		skipBytes(2);
+		return val;
+	}
+
+	uint32 readUint32LE() {
+		if (!hasBytes(4))
+			return 0;
+
+		uint32 val = READ_LE_UINT32(_ptr);
+		skipBytes(4);
+		return val;
+	}
+
+	uint32 readUint32BE() {
+		if (!hasBytes(4))
+			return 0;
+
+		uint32 val = READ_BE_UINT32(_ptr);
+		skipBytes(4);
+		return val;
+	}
+
+private:
+	/** Are there n more bytes to read? Sets eos and moves to the end if not. */
+	inline bool hasBytes(uint32 n) {
+		if (_size - _pos >= n)
+			return true;
+
+		_eos = true;
+		_pos = _size;
+		_ptr = _ptrOrig + _size;
+		return false;
+	}
+
+	inline void skipBytes(uint32 n) {
+		_ptr += n;
+		_pos += n;
+	}
+};
+
 /**
  * A template implementing a bit stream for different data memory layouts.
  *
- * Such a bit stream reads valueBits-wide values from the data stream and
- * gives access to their bits, one at a time.
+ * Such a bit stream reads valueBits-wide values from the data stream into
+ * a 64-bit cache and hands out their bits from there, so that reading,
+ * peeking and skipping a number of bits costs the same as a single one.
  *
  * For example, a bit stream with the layout parameters 32, true, false
  * for valueBits, isLE and isMSB2LSB, reads 32bit little-endian values
  * from the data stream and hands out the bits in the order of LSB to MSB.
+ *
+ * STREAM is the type of the data stream, either SeekableReadStream or,
+ * for data that's already in memory, the cheaper BitStreamMemoryStream.
  */
-template<int valueBits, bool isLE, bool isMSB2LSB>
+template<class STREAM, int valueBits, bool isLE, bool isMSB2LSB>
 class BitStreamImpl : public BitStream {
 private:
-	SeekableReadStream *_stream; ///< The input stream.
+	STREAM *_stream;             ///< The input stream.
 	bool _disposeAfterUse;       ///< Should we delete the stream on destruction?
 
-	uint32 _value;   ///< Current value.
-	uint8  _inValue; ///< Position within the current value.
+	uint64 _cache;     ///< Bits read ahead, the next one at the MSB or LSB end.
+	uint8  _cacheSize; ///< Number of valid bits in the cache.
 
 	/** Read a data value. */
 	inline uint32 readData() {
@@ -113,32 +250,69 @@ private:
 		return 0;
 	}
 
-	/** Read the next data value. */
-	inline void readValue() {
-		if ((size() - pos()) < valueBits)
-			error("BitStreamImpl::readValue(): End of bit stream reached");
+	/** Read as many data values into the cache as fit. */
+	void refill() {
+		uint32 end = size() >> 3;
+		uint32 cur = _stream->pos();
 
-		_value = readData();
-		if (_stream->err() || _stream->eos())
-			error("BitStreamImpl::readValue(): Read error");
+		if (cur >= end)
+			return;
 
-		// If we're reading the bits MSB first, we need to shift the value to that position
-		if (isMSB2LSB)
-			_value <<= 32 - valueBits;
+		// Values that fit into the cache, and that are left in the stream
+		uint32 count = (64 - _cacheSize) / valueBits;
+		uint32 left  = (end - cur) / (valueBits >> 3);
+
+		for (count = (count < left) ? count : left; count > 0; count--) {
+			uint64 value = readData();
+			if (_stream->err() || _stream->eos())
+				error("BitStreamImpl::refill(): Read error");
+
+			// Bits are taken from the top of the cache if we're reading them MSB first
+			if (isMSB2LSB)
+				_cache |= value << (64 - valueBits - _cacheSize);
+			else
+				_cache |= value << _cacheSize;
+
+			_cacheSize += valueBits;
 		}
+	}
+
+	/** Make sure n bits are cached, unless the stream ends before. */
+	inline void fill(uint8 n) {
+		if (_cacheSize < n)
+			refill();
+	}
+
+	/** Return the next n bits in the cache, 0 < n <= 32. Bits not cached are 0. */
+	inline uint32 peekCache(uint8 n) const {
+		if (isMSB2LSB)
+			return (uint32)(_cache >> (64 - n));
+
+		return (uint32)(_cache & ((((uint64) 1) << n) - 1));
+	}
+
+	/** Drop the next n bits from the cache, n < 64. */
+	inline void dropCache(uint8 n) {
+		if (isMSB2LSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+
+		_cacheSize -= n;
+	}
 
 public:
 	/** Create a bit stream using this input data stream and optionally delete it on destruction. */
-	BitStreamImpl(SeekableReadStream *stream, bool disposeAfterUse = false) :
-		_stream(stream), _disposeAfterUse(disposeAfterUse), _value(0), _inValue(0) {
+	BitStreamImpl(STREAM *stream, bool disposeAfterUse = false) :
+		_stream(stream), _disposeAfterUse(disposeAfterUse), _cache(0), _cacheSize(0) {
 
 		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
 			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
 	}
 
 	/** Create a bit stream using this input data stream. */
-	BitStreamImpl(SeekableReadStream &stream) :
-		_stream(&stream), _disposeAfterUse(false), _value(0), _inValue(0) {
+	BitStreamImpl(STREAM &stream) :
+		_stream(&stream), _disposeAfterUse(false), _cache(0), _cacheSize(0) {
 
 		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
 			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
@@ -151,25 +325,12 @@ public:
 
 	/** Read a bit from the bit stream. */
 	uint32 getBit() {
-		// Check if we need the next value
-		if (_inValue == 0)
-			readValue();
+		fill(1);
+		if (_cacheSize == 0)
+			error("BitStreamImpl::getBit(): End of bit stream reached");
 
-		// Get the current bit
-		int b = 0;
-		if (isMSB2LSB)
-			b = ((_value & 0x80000000) == 0) ? 0 : 1;
-		else
-			b = ((_value & 1) == 0) ? 0 : 1;
-
-		// Shift to the next bit
-		if (isMSB2LSB)
-			_value <<= 1;
-		else
-			_value >>= 1;
-
-		// Increase the position within the current value
-		_inValue = (_inValue + 1) % valueBits;
+		uint32 b = peekCache(1);
+		dropCache(1);
 
 		return b;
 	}
@@ -191,54 +352,37 @@ public:
 		if (n > 32)
 			error("BitStreamImpl::getBits(): Too many bits requested to be read");
 
-		// Read the number of bits
-		uint32 v = 0;
+		fill(n);
+		if (_cacheSize < n)
+			error("BitStreamImpl::getBits(): End of bit stream reached");
 
-		if (isMSB2LSB) {
-			while (n-- > 0)
-				v = (v << 1) | getBit();
-		} else {
-			for (uint32 i = 0; i < n; i++)
-				v = (v >> 1) | (((uint32) getBit()) << 31);
-
-			v >>= (32 - n);
-		}
+		uint32 v = peekCache(n);
+		dropCache(n);
 
 		return v;
 	}
 
 	/** Read a bit from the bit stream, without changing the stream's position. */
 	uint32 peekBit() {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curPos  = _stream->pos();
-
-		uint32 v = getBit();
-
-		_stream->seek(curPos);
-		_inValue = inValue;
-		_value   = value;
-
-		return v;
+		fill(1);
+		return peekCache(1);
 	}
 
 	/**
 	 * Read a multi-bit value from the bit stream, without changing the stream's position.
 	 *
-	 * The bit order is the same as in getBits().
+	 * The bit order is the same as in getBits(). Bits past the end of the
+	 * stream read as 0.
 	 */
 	uint32 peekBits(uint8 n) {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curPos  = _stream->pos();
-
-		uint32 v = getBits(n);
+		if (n == 0)
+			return 0;
 
-		_stream->seek(curPos);
-		_inValue = inValue;
-		_value   = value;
+		if (n > 32)
+			error("BitStreamImpl::peekBits(): Too many bits requested to be read");
 
-		return v;
+		fill(n);
+		return peekCache(n);
 	}
 
 	/**
@@ -262,27 +406,46 @@ public:
 			x = (x & ~(1 << n)) | (getBit() << n);
 	}
 
+	/** Are the bits of a multi-bit value handed out MSB first? */
+	bool isMSBFirst() const {
+		return isMSB2LSB;
+	}
+
 	/** Rewind the bit stream back to the start. */
 	void rewind() {
 		_stream->seek(0);
 
-		_value   = 0;
-		_inValue = 0;
+		_cache     = 0;
+		_cacheSize = 0;
 	}
 
 	/** Skip the specified amount of bits. */
 	void skip(uint32 n) {
-		while (n-- > 0)
-			getBit();
+		if (n < _cacheSize) {
+			dropCache(n);
+			return;
+		}
+
+		n -= _cacheSize;
+		_cache     = 0;
+		_cacheSize = 0;
+
+		// Seek over whole values instead of reading them
+		uint32 values = n / valueBits;
+		if (values > 0) {
+			if (pos() + values * valueBits > size())
+				error("BitStreamImpl::skip(): End of bit stream reached");
+
+			_stream->seek(values * (valueBits >> 3), SEEK_CUR);
+			n -= values * valueBits;
+		}
+
+		getBits(n);
 	}
 
 	/** Return the stream position in bits. */
 	uint32 pos() const {
-		if (_stream->pos() == 0)
-			return 0;
-
-		uint32 p = (_inValue == 0) ? _stream->pos() : ((_stream->pos() - 1) & ~((uint32) ((valueBits >> 3) - 1)));
-		return p * 8 + _inValue;
+		return _stream->pos() * 8 - _cacheSize;
 	}
 
 	/** Return the stream size in bits. */
@@ -298,27 +461,52 @@ public:
 // typedefs for various memory layouts.
 
 /** 8-bit data, MSB to LSB. */
-typedef BitStreamImpl<8, false, true > BitStream8MSB;
+typedef BitStreamImpl<SeekableReadStream, 8, false, true > BitStream8MSB;
+/** 8-bit data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 8, false, false> BitStream8LSB;
+
+/** 16-bit little-endian data, MSB to LSB. */
+typedef BitStreamImpl<SeekableReadStream, 16, true , true > BitStream16LEMSB;
+/** 16-bit little-endian data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 16, true , false> BitStream16LELSB;
+/** 16-bit big-endian data, MSB to LSB. */
+typedef BitStreamImpl<SeekableReadStream, 16, false, true > BitStream16BEMSB;
+/** 16-bit big-endian data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 16, false, false> BitStream16BELSB;
+
+/** 32-bit little-endian data, MSB to LSB. */
+typedef BitStreamImpl<SeekableReadStream, 32, true , true > BitStream32LEMSB;
+/** 32-bit little-endian data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 32, true , false> BitStream32LELSB;
+/** 32-bit big-endian data, MSB to LSB. */
+typedef BitStreamImpl<SeekableReadStream, 32, false, true > BitStream32BEMSB;
+/** 32-bit big-endian data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 32, false, false> BitStream32BELSB;
+
+// typedefs for various memory layouts, reading directly from memory.
+
+/** 8-bit data, MSB to LSB. */
+typedef BitStreamImpl<BitStreamMemoryStream, 8, false, true > BitStreamMemory8MSB;
 /** 8-bit data, LSB to MSB. */
-typedef BitStreamImpl<8, false, false> BitStream8LSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 8, false, false> BitStreamMemory8LSB;
 
 /** 16-bit little-endian data, MSB to LSB. */
-typedef BitStreamImpl<16, true , true > BitStream16LEMSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 16, true , true > BitStreamMemory16LEMSB;
 /** 16-bit little-endian data, LSB to MSB. */
-typedef BitStreamImpl<16, true , false> BitStream16LELSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 16, true , false> BitStreamMemory16LELSB;
 /** 16-bit big-endian data, MSB to LSB. */
-typedef BitStreamImpl<16, false, true > BitStream16BEMSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 16, false, true > BitStreamMemory16BEMSB;
 /** 16-bit big-endian data, LSB to MSB. */
-typedef BitStreamImpl<16, false, false> BitStream16BELSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 16, false, false> BitStreamMemory16BELSB;
 
 /** 32-bit little-endian data, MSB to LSB. */
-typedef BitStreamImpl<32, true , true > BitStream32LEMSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 32, true , true > BitStreamMemory32LEMSB;
 /** 32-bit little-endian data, LSB to MSB. */
-typedef BitStreamImpl<32, true , false> BitStream32LELSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 32, true , false> BitStreamMemory32LELSB;
 /** 32-bit big-endian data, MSB to LSB. */
-typedef BitStreamImpl<32, false, true > BitStream32BEMSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 32, false, true > BitStreamMemory32BEMSB;
 /** 32-bit big-endian data, LSB to MSB. */
-typedef BitStreamImpl<32, false, false> BitStream32BELSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 32, false, false> BitStreamMemory32BELSB;
 
 } // End of namespace Common
 
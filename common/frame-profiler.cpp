@@ -0,0 +1,231 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX) && !defined(EMSCRIPTEN)
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#endif
+
+#include "common/frame-profiler.h"
+#include "common/file.h"
+#include "common/system.h"
+#include "common/util.h"
+
+#if defined(EMSCRIPTEN)
+#include "emscripten/emscripten.h"
+#elif defined(POSIX)
+#include <sys/time.h>
+#endif
+
+namespace Common {
+
+namespace {
+
+class SystemClock : public FrameProfiler::Clock {
+public:
+	virtual uint64 getMicros() const {
+#if defined(EMSCRIPTEN)
+		return (uint64)(emscripten_get_now() * 1000.0);
+#elif defined(POSIX)
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return (uint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#else
+		return (uint64)g_system->getMillis() * 1000;
+#endif
+	}
+};
+
+} // End of anonymous namespace
+
+FrameProfiler::FrameProfiler(const char *const *stageNames, uint stageCount, Clock *clock)
+	: _clock(clock), _ownClock(0), _stageNames(stageNames), _stageCount(stageCount),
+	  _enabled(false), _inFrame(false) {
+	assert(stageCount <= kMaxStages);
+
+	if (!_clock)
+		_clock = _ownClock = new SystemClock();
+
+	reset();
+}
+
+FrameProfiler::~FrameProfiler() {
+	delete _ownClock;
+}
+
+void FrameProfiler::setEnabled(bool enable) {
+	if (enable && !_enabled)
+		reset();
+	_enabled = enable;
+	_inFrame = false;
+}
+
+void FrameProfiler::reset() {
+	_startTime = _clock->getMicros();
+	_next = 0;
+	_count = 0;
+	memset(&_current, 0, sizeof(_current));
+	memset(_stageBegin, 0, sizeof(_stageBegin));
+}
+
+uint64 FrameProfiler::getMicros() const {
+	return _clock->getMicros() - _startTime;
+}
+
+void FrameProfiler::beginFrame() {
+	if (!_enabled)
+		return;
+
+	memset(&_current, 0, sizeof(_current));
+	_current.start = getMicros();
+	_inFrame = true;
+}
+
+void FrameProfiler::endFrame(uint rects, bool fullUpdate) {
+	if (!_inFrame)
+		return;
+
+	_inFrame = false;
+
+	// Idle frames would only dilute the averages
+	if (!rects)
+		return;
+
+	_current.duration = (uint32)(getMicros() - _current.start);
+	_current.rects = MIN<uint>(rects, 0xFFFF);
+	_current.fullUpdate = fullUpdate;
+
+	_history[_next] = _current;
+	_next = (_next + 1) % kHistorySize;
+	if (_count < kHistorySize)
+		_count++;
+}
+
+void FrameProfiler::beginStage(uint stage) {
+	if (!_inFrame)
+		return;
+
+	assert(stage < _stageCount);
+	_stageBegin[stage] = getMicros();
+	if (!_current.stageDuration[stage])
+		_current.stageStart[stage] = (uint32)(_stageBegin[stage] - _current.start);
+}
+
+void FrameProfiler::endStage(uint stage) {
+	if (!_inFrame)
+		return;
+
+	// Stages shorter than the timer resolution still count as having run
+	assert(stage < _stageCount);
+	_current.stageDuration[stage] += MAX<uint32>((uint32)(getMicros() - _stageBegin[stage]), 1);
+}
+
+const FrameProfiler::Frame &FrameProfiler::getFrame(uint i) const {
+	assert(i < _count);
+	return _history[(_next + kHistorySize - _count + i) % kHistorySize];
+}
+
+const char *FrameProfiler::getStageName(uint stage) const {
+	assert(stage < _stageCount);
+	return _stageNames[stage];
+}
+
+String FrameProfiler::getSummary() const {
+	if (!_count)
+		return "No frames profiled";
+
+	uint32 totalSum = 0, totalMax = 0, rects = 0, fullUpdates = 0;
+	uint32 stageSum[kMaxStages], stageMax[kMaxStages];
+	memset(stageSum, 0, sizeof(stageSum));
+	memset(stageMax, 0, sizeof(stageMax));
+
+	for (uint i = 0; i < _count; ++i) {
+		const Frame &frame = getFrame(i);
+		totalSum += frame.duration;
+		totalMax = MAX(totalMax, frame.duration);
+		rects += frame.rects;
+		if (frame.fullUpdate)
+			fullUpdates++;
+
+		for (uint s = 0; s < _stageCount; ++s) {
+			stageSum[s] += frame.stageDuration[s];
+			stageMax[s] = MAX(stageMax[s], frame.stageDuration[s]);
+		}
+	}
+
+	// Times are printed in 1/100 ms
+	String summary = String::format("%d frames, %d rects avg, %d full\nframe %d.%02d avg %d.%02d max",
+		_count, rects / _count, fullUpdates,
+		totalSum / _count / 1000, totalSum / _count / 10 % 100, totalMax / 1000, totalMax / 10 % 100);
+
+	for (uint s = 0; s < _stageCount; ++s) {
+		const uint32 avg = stageSum[s] / _count;
+		summary += String::format("\n%s %d.%02d avg %d.%02d max", _stageNames[s],
+			avg / 1000, avg / 10 % 100, stageMax[s] / 1000, stageMax[s] / 10 % 100);
+	}
+
+	return summary;
+}
+
+/** Format a 64 bit time, without relying on printf support for it. */
+static String formatMicros(uint64 micros) {
+	if (micros < 1000000)
+		return String::format("%u", (uint32)micros);
+	return String::format("%u%06u", (uint32)(micros / 1000000), (uint32)(micros % 1000000));
+}
+
+bool FrameProfiler::exportTrace(const String &filename) const {
+	DumpFile out;
+	if (!out.open(filename))
+		return false;
+
+	out.writeString("{\"traceEvents\":[\n");
+
+	// Stages get a track each, since the summed up spans may overlap
+	out.writeString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"frame\"}}");
+	for (uint s = 0; s < _stageCount; ++s) {
+		out.writeString(String::format(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+			s + 2, _stageNames[s]));
+	}
+
+	for (uint i = 0; i < _count; ++i) {
+		const Frame &frame = getFrame(i);
+
+		out.writeString(String::format(",\n{\"name\":\"frame\",\"cat\":\"gfx\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%s,\"dur\":%u,"
+			"\"args\":{\"rects\":%d,\"full\":%s}}",
+			formatMicros(frame.start).c_str(), frame.duration, frame.rects, frame.fullUpdate ? "true" : "false"));
+
+		for (uint s = 0; s < _stageCount; ++s) {
+			if (!frame.stageDuration[s])
+				continue;
+
+			out.writeString(String::format(",\n{\"name\":\"%s\",\"cat\":\"gfx\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%s,\"dur\":%u}",
+				_stageNames[s], s + 2, formatMicros(frame.start + frame.stageStart[s]).c_str(), frame.stageDuration[s]));
+		}
+	}
+
+	out.writeString("\n],\"displayTimeUnit\":\"ms\"}\n");
+	out.flush();
+
+	return !out.err();
+}
+
+} // End of namespace Common
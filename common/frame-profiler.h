@@ -0,0 +1,146 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_FRAME_PROFILER_H
+#define COMMON_FRAME_PROFILER_H
+
+#include "common/scummsys.h"
+#include "common/str.h"
+
+namespace Common {
+
+/**
+ * Timing of the stages of a frame, e.g. the screen update of a graphics
+ * manager. The stages are numbered by the client, which names them.
+ *
+ * The durations of each stage are summed up per frame and kept for the
+ * last kHistorySize frames. Stages which run more than once per frame, like
+ * a scaler running once per dirty rect, are reported as a single span
+ * starting at their first run. Frames which present nothing are not
+ * recorded, and nothing is measured while the profiler is disabled.
+ */
+class FrameProfiler {
+public:
+	enum {
+		kHistorySize = 256,
+		kMaxStages = 8
+	};
+
+	/** Time source of the profiler, in microseconds. */
+	class Clock {
+	public:
+		virtual ~Clock() {}
+		virtual uint64 getMicros() const = 0;
+	};
+
+	/** Measures a stage from construction until destruction. */
+	class Scope {
+	public:
+		Scope(FrameProfiler &profiler, uint stage) : _profiler(profiler), _stage(stage) {
+			_profiler.beginStage(_stage);
+		}
+		~Scope() {
+			_profiler.endStage(_stage);
+		}
+
+	private:
+		FrameProfiler &_profiler;
+		uint _stage;
+	};
+
+	struct Frame {
+		/** Start of the frame, in microseconds since the profiler was reset */
+		uint64 start;
+		/** Duration of the whole frame */
+		uint32 duration;
+		/** Start of the first run of each stage, relative to the frame start */
+		uint32 stageStart[kMaxStages];
+		/** Summed up duration of each stage */
+		uint32 stageDuration[kMaxStages];
+		uint16 rects;
+		bool fullUpdate;
+	};
+
+	/**
+	 * Create a profiler.
+	 *
+	 * @param stageNames	the names of the stages, used in the summary and the trace
+	 * @param stageCount	the number of stages, at most kMaxStages
+	 * @param clock			the time source to use, or 0 for the system timer.
+	 *						The profiler does not take ownership.
+	 */
+	FrameProfiler(const char *const *stageNames, uint stageCount, Clock *clock = 0);
+	~FrameProfiler();
+
+	void setEnabled(bool enable);
+	bool isEnabled() const { return _enabled; }
+
+	void beginFrame();
+	void endFrame(uint rects, bool fullUpdate);
+
+	void beginStage(uint stage);
+	void endStage(uint stage);
+
+	/** Number of frames in the history. */
+	uint getFrameCount() const { return _count; }
+
+	/** Get a frame from the history, 0 being the oldest one. */
+	const Frame &getFrame(uint i) const;
+
+	/** Averages and maxima over the history, one line per stage. */
+	String getSummary() const;
+
+	/**
+	 * Write the history as Chrome trace event JSON, which can be loaded
+	 * into chrome://tracing or similar viewers.
+	 */
+	bool exportTrace(const String &filename) const;
+
+	void reset();
+
+	uint getStageCount() const { return _stageCount; }
+	const char *getStageName(uint stage) const;
+
+private:
+	/** Microseconds since the last reset. */
+	uint64 getMicros() const;
+
+	Clock *_clock;
+	Clock *_ownClock;
+
+	const char *const *_stageNames;
+	uint _stageCount;
+
+	bool _enabled;
+	bool _inFrame;
+	uint64 _startTime;
+	uint64 _stageBegin[kMaxStages];
+
+	Frame _history[kHistorySize];
+	uint _next;
+	uint _count;
+	Frame _current;
+};
+
+} // End of namespace Common
+
+#endif
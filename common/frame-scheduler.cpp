@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/frame-scheduler.h"
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/util.h"
+
+namespace Common {
+
+namespace {
+
+class SystemClock : public FrameScheduler::Clock {
+public:
+	virtual uint32 getMillis() const { return g_system->getMillis(); }
+};
+
+/** Signed distance from a to b which survives wrap around of the clock. */
+inline int32 timeUntil(uint32 now, uint32 deadline) {
+	return (int32)(deadline - now);
+}
+
+} // End of anonymous namespace
+
+FrameScheduler::FrameScheduler(Clock *clock)
+	: _clock(clock), _ownClock(0), _logicProc(0), _presentProc(0),
+	  _presentInterval(kDefaultPresentInterval), _mergeWindow(kDefaultMergeWindow),
+	  _logicPending(false), _logicDeadline(0), _nextPresent(0) {
+	if (!_clock)
+		_clock = _ownClock = new SystemClock();
+
+	_nextPresent = _clock->getMillis();
+	resetJitterStats();
+}
+
+FrameScheduler::~FrameScheduler() {
+	delete _ownClock;
+}
+
+uint32 FrameScheduler::getMillis() const {
+	return _clock->getMillis();
+}
+
+void FrameScheduler::scheduleLogic(uint32 deadline) {
+	_logicPending = true;
+	_logicDeadline = deadline;
+}
+
+void FrameScheduler::resetJitterStats() {
+	_jitter.ticks = 0;
+	_jitter.last = 0;
+	_jitter.max = 0;
+	_jitter.total = 0;
+}
+
+int32 FrameScheduler::step() {
+	const uint32 now = _clock->getMillis();
+
+	if (_logicPending && timeUntil(now, _logicDeadline) <= 0) {
+		const uint32 late = now - _logicDeadline;
+		_jitter.ticks++;
+		_jitter.last = late;
+		_jitter.total += late;
+		if (late > _jitter.max)
+			_jitter.max = late;
+
+		if (_jitter.ticks % 1000 == 0)
+			debug(2, "FrameScheduler: %d logic ticks, late by %d ms on average, %d ms max",
+				_jitter.ticks, _jitter.average(), _jitter.max);
+
+		// The logic tick presents the screen itself, so the next present
+		// tick is only needed one full interval later.
+		_logicPending = false;
+		_nextPresent = now + _presentInterval;
+		if (_logicProc)
+			_logicProc();
+	} else if (_presentProc && timeUntil(now, _nextPresent) <= 0) {
+		_nextPresent = now + _presentInterval;
+		_presentProc();
+	}
+
+	return getTimeToNextWake();
+}
+
+int32 FrameScheduler::getTimeToNextWake() const {
+	const uint32 now = _clock->getMillis();
+	bool haveWake = false;
+	int32 wait = 0;
+
+	if (_logicPending) {
+		wait = timeUntil(now, _logicDeadline);
+		haveWake = true;
+	}
+
+	if (_presentProc) {
+		const int32 presentWait = timeUntil(now, _nextPresent);
+
+		// Skip present ticks which the next logic tick covers anyway
+		if (!haveWake || presentWait + (int32)_mergeWindow < wait)
+			wait = presentWait;
+		haveWake = true;
+	}
+
+	if (!haveWake)
+		return -1;
+
+	return MAX<int32>(wait, 0);
+}
+
+} // End of namespace Common
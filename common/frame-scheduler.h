@@ -0,0 +1,128 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_FRAME_SCHEDULER_H
+#define COMMON_FRAME_SCHEDULER_H
+
+#include "common/scummsys.h"
+
+namespace Common {
+
+/**
+ * Cooperative scheduler for hosts which can not block inside the engine,
+ * e.g. the browser event loop.
+ *
+ * Two kinds of work are scheduled: logic ticks, which run one iteration of
+ * the game loop at a deadline requested by the engine, and present ticks,
+ * which keep the screen and the event queue alive while waiting for the
+ * next logic tick. A logic tick is expected to present the screen itself,
+ * so a present tick which would fall shortly before a logic tick is merged
+ * into it instead of waking up twice.
+ *
+ * The scheduler does not sleep by itself. step() runs whatever is due and
+ * returns how long the host may wait until the next deadline, which can be
+ * fed into emscripten_async_call(), OSystem::delayMillis() or a fake clock.
+ */
+class FrameScheduler {
+public:
+	typedef void (*TickProc)();
+
+	/** Time source of the scheduler, in milliseconds. */
+	class Clock {
+	public:
+		virtual ~Clock() {}
+		virtual uint32 getMillis() const = 0;
+	};
+
+	/** Lateness of logic ticks against their deadlines, in milliseconds. */
+	struct JitterStats {
+		uint32 ticks;
+		uint32 last;
+		uint32 max;
+		uint32 total;
+
+		uint32 average() const { return ticks ? total / ticks : 0; }
+	};
+
+	enum {
+		/** Default interval between present ticks (~60 Hz) */
+		kDefaultPresentInterval = 16,
+		/** Present ticks this close to the next logic tick are merged into it */
+		kDefaultMergeWindow = 4
+	};
+
+	/**
+	 * Create a scheduler.
+	 *
+	 * @param clock	the time source to use, or 0 for OSystem::getMillis.
+	 *				The scheduler does not take ownership.
+	 */
+	explicit FrameScheduler(Clock *clock = 0);
+	~FrameScheduler();
+
+	void setLogicProc(TickProc proc) { _logicProc = proc; }
+	void setPresentProc(TickProc proc) { _presentProc = proc; }
+	void setPresentInterval(uint32 interval) { _presentInterval = interval; }
+	void setMergeWindow(uint32 window) { _mergeWindow = window; }
+
+	/** Request the next logic tick to run at the given time. */
+	void scheduleLogic(uint32 deadline);
+
+	/** Whether a logic tick is waiting for its deadline. */
+	bool isLogicPending() const { return _logicPending; }
+
+	/**
+	 * Run the tick which is due, if any.
+	 *
+	 * @return the time in milliseconds until the next deadline, 0 if
+	 *         something is due already, or -1 if nothing is scheduled.
+	 */
+	int32 step();
+
+	/** Time in milliseconds until the next deadline, see step(). */
+	int32 getTimeToNextWake() const;
+
+	uint32 getMillis() const;
+
+	const JitterStats &getJitterStats() const { return _jitter; }
+	void resetJitterStats();
+
+private:
+	Clock *_clock;
+	Clock *_ownClock;
+
+	TickProc _logicProc;
+	TickProc _presentProc;
+
+	uint32 _presentInterval;
+	uint32 _mergeWindow;
+
+	bool _logicPending;
+	uint32 _logicDeadline;
+	uint32 _nextPresent;
+
+	JitterStats _jitter;
+};
+
+} // End of namespace Common
+
+#endif
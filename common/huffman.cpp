@@ -29,10 +29,11 @@
 
 namespace Common {
 
-Huffman::Symbol::Symbol(uint32 c, uint32 s) : code(c), symbol(s) {
+/** Return bit n of a code, counting from the first one in the stream. */
+static inline uint32 getCodeBit(uint32 code, uint8 length, uint8 n, bool msbFirst) {
+	return (msbFirst ? (code >> (length - 1 - n)) : (code >> n)) & 1;
 }
 
-
 Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols) {
 	assert(codeCount > 0);
 
@@ -45,38 +46,139 @@ Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const u
 
 	assert(maxLength <= 32);
 
-	_codes.resize(maxLength);
 	_symbols.resize(codeCount);
+	setSymbols(symbols);
+
+	_codes.resize(codeCount);
+	_lengths.resize(codeCount);
 
 	for (uint32 i = 0; i < codeCount; i++) {
-		// The symbol. If none were specified, just assume it's identical to the code index
-		uint32 symbol = symbols ? symbols[i] : i;
+		assert(lengths[i] > 0 && lengths[i] <= maxLength);
+		_codes[i]   = codes[i];
+		_lengths[i] = lengths[i];
+	}
+
+	_primaryBits = MIN<uint8>(maxLength, kPrimaryBits);
+}
+
+Huffman::~Huffman() {
+}
+
+const Huffman::Table &Huffman::getTable(bool msbFirst) const {
+	Table &table = _tables[msbFirst ? 1 : 0];
 
-		// Put the code and symbol into the correct list
-		_codes[lengths[i] - 1].push_back(Symbol(codes[i], symbol));
+	// Which table is used depends on the bit order of the stream
+	if (table.empty()) {
+		Array<uint32> indices;
+		indices.resize(_codes.size());
 
-		// And put the pointer to the symbol/code struct into the symbol list.
-		_symbols[i] = &_codes[lengths[i] - 1].back();
+		for (uint32 i = 0; i < _codes.size(); i++)
+			indices[i] = i;
+
+		table.resize(1 << _primaryBits);
+		buildTable(table, 0, _primaryBits, 0, msbFirst, indices);
 	}
+
+	return table;
 }
 
-Huffman::~Huffman() {
+void Huffman::buildTable(Table &table, uint32 offset, uint8 tableBits, uint8 start, bool msbFirst,
+                         const Array<uint32> &indices) const {
+	const uint32 tableSize = 1 << tableBits;
+
+	for (uint32 i = 0; i < tableSize; i++) {
+		table[offset + i].value  = 0;
+		table[offset + i].length = 0;
+		table[offset + i].bits   = 0;
+	}
+
+	// Longest remainder of the codes that continue past this table, by entry
+	Array<uint8> subLengths;
+	subLengths.resize(tableSize);
+
+	for (uint32 i = 0; i < tableSize; i++)
+		subLengths[i] = 0;
+
+	for (uint32 i = 0; i < indices.size(); i++) {
+		uint32 code   = _codes[indices[i]];
+		uint8  length = _lengths[indices[i]] - start;
+		uint8  bits   = MIN(length, tableBits);
+
+		// The entry index as peeked from the stream
+		uint32 entry = 0;
+		for (uint8 j = 0; j < bits; j++)
+			entry |= getCodeBit(code, _lengths[indices[i]], start + j, msbFirst) << (msbFirst ? (tableBits - 1 - j) : j);
+
+		if (length > tableBits) {
+			subLengths[entry] = MAX<uint8>(subLengths[entry], length - tableBits);
+			continue;
+		}
+
+		// The code covers every entry that starts with its bits
+		for (uint32 j = 0; j < (1u << (tableBits - length)); j++) {
+			TableEntry &tableEntry = table[offset + (msbFirst ? (entry + j) : (entry | (j << length)))];
+
+			tableEntry.value  = indices[i];
+			tableEntry.length = length;
+		}
+	}
+
+	for (uint32 i = 0; i < tableSize; i++) {
+		if (subLengths[i] == 0)
+			continue;
+
+		Array<uint32> subIndices;
+
+		for (uint32 j = 0; j < indices.size(); j++) {
+			uint8 length = _lengths[indices[j]] - start;
+			if (length <= tableBits)
+				continue;
+
+			uint32 entry = 0;
+			for (uint8 k = 0; k < tableBits; k++)
+				entry |= getCodeBit(_codes[indices[j]], _lengths[indices[j]], start + k, msbFirst) << (msbFirst ? (tableBits - 1 - k) : k);
+
+			if (entry == i)
+				subIndices.push_back(indices[j]);
+		}
+
+		uint8 subBits = MIN<uint8>(subLengths[i], kSubTableBits);
+		uint32 subOffset = table.size();
+
+		table[offset + i].value = subOffset;
+		table[offset + i].bits  = subBits;
+
+		table.resize(subOffset + (1 << subBits));
+		buildTable(table, subOffset, subBits, start + tableBits, msbFirst, subIndices);
+	}
 }
 
 void Huffman::setSymbols(const uint32 *symbols) {
 	for (uint32 i = 0; i < _symbols.size(); i++)
-		_symbols[i]->symbol = symbols ? *symbols++ : i;
+		_symbols[i] = symbols ? *symbols++ : i;
 }
 
 uint32 Huffman::getSymbol(BitStream &bits) const {
-	uint32 code = 0;
+	const Table &table = getTable(bits.isMSBFirst());
+
+	uint32 offset = 0;
+	uint8 tableBits = _primaryBits;
+
+	for (;;) {
+		const TableEntry &entry = table[offset + bits.peekBits(tableBits)];
+
+		if (entry.length != 0) {
+			bits.skip(entry.length);
+			return _symbols[entry.value];
+		}
 
-	for (uint32 i = 0; i < _codes.size(); i++) {
-		bits.addBit(code, i);
+		// Not a prefix of any code
+		if (entry.bits == 0)
+			break;
 
-		for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
-			if (code == cCode->code)
-				return cCode->symbol;
+		bits.skip(tableBits);
+		offset    = entry.value;
+		tableBits = entry.bits;
 	}
 
 	error("Unknown Huffman code");
@@ -26,7 +26,6 @@
 #define COMMON_HUFFMAN_H
 
 #include "common/array.h"
-#include "common/list.h"
 #include "common/types.h"
 
 namespace Common {
@@ -59,22 +58,51 @@ public:
 	uint32 getSymbol(BitStream &bits) const;
 
 private:
-	struct Symbol {
-		uint32 code;
-		uint32 symbol;
+	enum {
+		kPrimaryBits = 9, ///< Maximal number of bits resolved by the first table probe.
+		kSubTableBits = 6 ///< Maximal number of bits resolved by each further probe.
+	};
 
-		Symbol(uint32 c, uint32 s);
+	/**
+	 * An entry in a lookup table, indexed by the next bits in the stream.
+	 *
+	 * If length is not 0, the bits start a code of that many bits, and value
+	 * is the code's index. Otherwise, if bits is not 0, the code continues
+	 * in the table at offset value, indexed by that many of the following
+	 * bits. An entry with neither is not part of any code.
+	 */
+	struct TableEntry {
+		uint32 value;
+		uint8 length;
+		uint8 bits;
 	};
 
-	typedef List<Symbol> CodeList;
-	typedef Array<CodeList> CodeLists;
-	typedef Array<Symbol *> SymbolList;
+	typedef Array<TableEntry> Table;
+
+	/**
+	 * Fill the lookup table at the given offset for the codes with these
+	 * indices, which all share their first start bits.
+	 */
+	void buildTable(Table &table, uint32 offset, uint8 tableBits, uint8 start, bool msbFirst,
+	                const Array<uint32> &indices) const;
+
+	/** Return the lookup table for a bit order, building it on first use. */
+	const Table &getTable(bool msbFirst) const;
 
-	/** Lists of codes and their symbols, sorted by code length. */
-	CodeLists _codes;
+	/** The codes and their lengths, by code index. */
+	Array<uint32> _codes;
+	Array<uint8> _lengths;
 
-	/** Sorted list of pointers to the symbols. */
-	SymbolList _symbols;
+	/** The symbols of the codes, by code index. */
+	Array<uint32> _symbols;
+
+	/**
+	 * Lookup tables for streams handing out the bits LSB first and MSB
+	 * first. Streams use one bit order, so the other table is usually
+	 * never built.
+	 */
+	mutable Table _tables[2];
+	uint8 _primaryBits;
 };
 
 } // End of namespace Common
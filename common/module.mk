@@ -12,6 +12,8 @@ MODULE_OBJS := \
 	EventMapper.o \
 	EventRecorder.o \
 	file.o \
+	frame-profiler.o \
+	frame-scheduler.o \
 	fs.o \
 	gui_options.o \
 	hashmap.o \
@@ -40,6 +42,7 @@ MODULE_OBJS := \
 	winexe.o \
 	winexe_ne.o \
 	winexe_pe.o \
+	workerpool.o \
 	xmlparser.o \
 	zlib.o
 
@@ -26,6 +26,11 @@
 #include "common/scummsys.h"
 #include "common/system.h"
 
+#if defined(_MSC_VER)
+// For _ReadWriteBarrier, see the comment in common/math.h on intrin.h
+#include "common/math.h"
+#endif
+
 namespace Common {
 
 class Mutex;
@@ -68,6 +73,19 @@ public:
 	void unlock();
 };
 
+/**
+ * Keep the compiler and the CPU from moving memory accesses across this
+ * point. Data handed from one thread to another without a lock has to be
+ * written before the index or flag announcing it, and read after it.
+ */
+inline void memoryBarrier() {
+#if defined(__GNUC__)
+	__sync_synchronize();
+#elif defined(_MSC_VER)
+	_ReadWriteBarrier();
+#endif
+}
+
 
 } // End of namespace Common
 
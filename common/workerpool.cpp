@@ -0,0 +1,266 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/workerpool.h"
+
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
+namespace Common {
+
+#ifdef USE_PTHREADS
+
+struct WorkerCondition::Impl {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+WorkerCondition::WorkerCondition() {
+	_impl = new Impl;
+	pthread_mutex_init(&_impl->mutex, 0);
+	pthread_cond_init(&_impl->cond, 0);
+}
+
+WorkerCondition::~WorkerCondition() {
+	pthread_cond_destroy(&_impl->cond);
+	pthread_mutex_destroy(&_impl->mutex);
+	delete _impl;
+}
+
+void WorkerCondition::lock() {
+	pthread_mutex_lock(&_impl->mutex);
+}
+
+void WorkerCondition::unlock() {
+	pthread_mutex_unlock(&_impl->mutex);
+}
+
+bool WorkerCondition::tryLock() {
+	return pthread_mutex_trylock(&_impl->mutex) == 0;
+}
+
+void WorkerCondition::wait() {
+	pthread_cond_wait(&_impl->cond, &_impl->mutex);
+}
+
+void WorkerCondition::notifyAll() {
+	pthread_cond_broadcast(&_impl->cond);
+}
+
+struct WorkerPool::Worker {
+	WorkerPool *pool;
+	uint index;
+	uint generation; ///< Of the last task run
+	pthread_t thread;
+};
+
+#else
+
+WorkerCondition::WorkerCondition() : _impl(0) {
+}
+
+WorkerCondition::~WorkerCondition() {
+}
+
+void WorkerCondition::lock() {
+}
+
+void WorkerCondition::unlock() {
+}
+
+bool WorkerCondition::tryLock() {
+	return true;
+}
+
+void WorkerCondition::wait() {
+	assert(false);
+}
+
+void WorkerCondition::notifyAll() {
+}
+
+struct WorkerPool::Worker {
+};
+
+#endif
+
+WorkerPool::WorkerPool() {
+	_workers = 0;
+	_workerCount = 0;
+
+	_busy = false;
+	_task = 0;
+	_param = 0;
+	_generation = 0;
+	_busyWorkers = 0;
+	_quit = false;
+}
+
+WorkerPool::~WorkerPool() {
+	stopWorkers();
+}
+
+uint WorkerPool::setThreadCount(uint count) {
+	if (count < 1)
+		count = 1;
+
+	if (count == getThreadCount())
+		return count;
+
+	stopWorkers();
+
+#ifdef USE_PTHREADS
+	if (count > 1) {
+		_workers = new Worker[count - 1];
+		_quit = false;
+
+		// Worker indices start at 1, the thread calling run() takes index 0
+		for (uint i = 0; i < count - 1; i++) {
+			Worker &worker = _workers[i];
+			worker.pool = this;
+			worker.index = i + 1;
+			worker.generation = _generation;
+			if (pthread_create(&worker.thread, 0, workerMain, &worker) != 0)
+				break;
+
+			_workerCount++;
+		}
+
+		if (_workerCount == 0)
+			stopWorkers();
+	}
+#endif
+
+	return getThreadCount();
+}
+
+void WorkerPool::stopWorkers() {
+#ifdef USE_PTHREADS
+	if (_workers) {
+		_condition.lock();
+		_quit = true;
+		_condition.notifyAll();
+		_condition.unlock();
+
+		for (uint i = 0; i < _workerCount; i++)
+			pthread_join(_workers[i].thread, 0);
+	}
+#endif
+
+	delete[] _workers;
+	_workers = 0;
+	_workerCount = 0;
+}
+
+bool WorkerPool::run(Task task, void *param) {
+	if (_workerCount == 0) {
+		task(param, 0);
+		return true;
+	}
+
+	_condition.lock();
+	if (_busy) {
+		_condition.unlock();
+		return false;
+	}
+
+	startWorkers(task, param);
+	_condition.unlock();
+
+	task(param, 0);
+
+	_condition.lock();
+	waitForWorkers();
+	_condition.unlock();
+	return true;
+}
+
+bool WorkerPool::start(Task task, void *param) {
+	if (_workerCount == 0)
+		return false;
+
+	_condition.lock();
+	const bool started = !_busy;
+	if (started)
+		startWorkers(task, param);
+	_condition.unlock();
+
+	return started;
+}
+
+void WorkerPool::wait() {
+	if (_workerCount == 0)
+		return;
+
+	_condition.lock();
+	waitForWorkers();
+	_condition.unlock();
+}
+
+void WorkerPool::startWorkers(Task task, void *param) {
+	_busy = true;
+	_task = task;
+	_param = param;
+	_busyWorkers = _workerCount;
+	_generation++;
+	_condition.notifyAll();
+}
+
+void WorkerPool::waitForWorkers() {
+	while (_busyWorkers > 0)
+		_condition.wait();
+
+	_busy = false;
+}
+
+void *WorkerPool::workerMain(void *param) {
+#ifdef USE_PTHREADS
+	Worker *worker = (Worker *)param;
+	WorkerPool *pool = worker->pool;
+
+	pool->_condition.lock();
+	for (;;) {
+		while (!pool->_quit && pool->_generation == worker->generation)
+			pool->_condition.wait();
+
+		if (pool->_quit)
+			break;
+
+		worker->generation = pool->_generation;
+		Task task = pool->_task;
+		void *taskParam = pool->_param;
+		pool->_condition.unlock();
+
+		task(taskParam, worker->index);
+
+		pool->_condition.lock();
+		if (--pool->_busyWorkers == 0)
+			pool->_condition.notifyAll();
+	}
+	pool->_condition.unlock();
+#endif
+
+	return 0;
+}
+
+} // End of namespace Common
@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_WORKERPOOL_H
+#define COMMON_WORKERPOOL_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * A mutex with a condition variable, for state shared with the threads of
+ * a WorkerPool. Unlike Common::Mutex, it doesn't go through OSystem, so it
+ * can be used before the backend is set up and from any thread.
+ *
+ * Where threads are not available, locking does nothing, and wait() must
+ * not be called.
+ */
+class WorkerCondition : NonCopyable {
+public:
+	WorkerCondition();
+	~WorkerCondition();
+
+	void lock();
+	void unlock();
+
+	/** Lock the mutex unless another thread holds it. Return whether it was locked. */
+	bool tryLock();
+
+	/** Unlock the mutex, wait for a notification and lock it again. */
+	void wait();
+
+	/** Wake up all threads waiting. */
+	void notifyAll();
+
+private:
+	struct Impl;
+	Impl *_impl;
+};
+
+/**
+ * A pool of worker threads running a task at once.
+ *
+ * Tasks split their work by the index of the thread running them, from 0
+ * to getThreadCount() - 1. The threads are started by setThreadCount() and
+ * wait for tasks until the pool is destroyed or resized. Where threads are
+ * not available (USE_PTHREADS isn't defined), only the calling thread is.
+ */
+class WorkerPool : NonCopyable {
+public:
+	/** A task, run by each thread with its index. */
+	typedef void (*Task)(void *param, uint thread);
+
+	WorkerPool();
+	~WorkerPool();
+
+	/**
+	 * Set the number of threads running tasks, including the one calling
+	 * run(). Must not be called while a task is running.
+	 *
+	 * @return the number of threads actually available
+	 */
+	uint setThreadCount(uint count);
+
+	/** Return the number of threads running tasks, including the calling one. */
+	uint getThreadCount() const { return _workerCount + 1; }
+
+	/**
+	 * Run a task on all threads, the calling one taking index 0, and wait
+	 * for it to finish.
+	 *
+	 * @return false, without running the task, if the workers are busy with
+	 *         the task of another thread
+	 */
+	bool run(Task task, void *param);
+
+	/**
+	 * Start a task on the worker threads only, with indices from 1, and
+	 * return right away. The task must be waited for with wait().
+	 *
+	 * @return false if there are no workers, or they are busy
+	 */
+	bool start(Task task, void *param);
+
+	/** Wait for the task started with start() to finish. */
+	void wait();
+
+private:
+	struct Worker;
+
+	WorkerCondition _condition;
+
+	Worker *_workers;
+	uint _workerCount;
+
+	// Set while a task is running, guarded by _condition
+	bool _busy;
+	Task _task;
+	void *_param;
+	uint _generation;  ///< Bumped for every task
+	uint _busyWorkers; ///< Workers which didn't finish the current task yet
+	bool _quit;
+
+	void stopWorkers();
+
+	/** Hand the current task to the workers. Called with the condition locked. */
+	void startWorkers(Task task, void *param);
+	/** Wait for the workers to finish the current task. Called with the condition locked. */
+	void waitForWorkers();
+
+	static void *workerMain(void *param);
+};
+
+} // End of namespace Common
+
+#endif
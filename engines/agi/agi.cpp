@@ -575,6 +575,7 @@ AgiEngine::AgiEngine(OSystem *syst, const AGIGameDescription *gameDesc) : AgiBas
 	_objects = NULL;
 
 	_restartGame = false;
+	_firstLoop = false;
 
 	_oldMode = INPUT_NONE;
 
@@ -721,7 +722,20 @@ Common::Error AgiEngine::go() {
 		} while (_game.state < STATE_RUNNING);
 	}
 
-	runGame();
+	return Common::kNoError;
+}
+
+Common::Error AgiEngine::beginSteps() {
+	Common::Error err = init();
+	if (err.getCode() != Common::kNoError)
+		return err;
+
+	err = go();
+	if (err.getCode() != Common::kNoError)
+		return err;
+
+	// If the game can not be started, the first step finishes right away
+	startGame();
 
 	return Common::kNoError;
 }
@@ -843,9 +843,14 @@ public:
 
 typedef void (*AgiCommand)(AgiGame *state, uint8 *p);
 
-class AgiEngine : public AgiBase {
+class AgiEngine : public AgiBase, public EngineStepper {
 protected:
 	// Engine APIs
+	virtual Common::Error run() {
+		return runSteps(*this);
+	}
+
+	/** Show the loading screen. The main loop is run by runStep(). */
 	virtual Common::Error go();
 
 	void initialize();
@@ -856,6 +861,14 @@ public:
 	AgiEngine(OSystem *syst, const AGIGameDescription *gameDesc);
 	virtual ~AgiEngine();
 
+	virtual EngineStepper *getStepper() { return this; }
+
+	// EngineStepper APIs
+	virtual Common::Error beginSteps();
+	virtual int32 runStep();
+	virtual void idleStep();
+	virtual Common::Error endSteps();
+
 	Common::Error loadGameState(int slot);
 	Common::Error saveGameState(int slot, const Common::String &desc);
 
@@ -944,7 +957,6 @@ public:
 	void releaseSprites();
 	int mainCycle(bool onlyCheckForEvents = false);
 	int viewPictures();
-	int runGame();
 	void inventory();
 	void updateTimer();
 	int getAppDir(char *appDir, unsigned int size);
@@ -955,7 +967,15 @@ public:
 	void newRoom(int n);
 	void resetControllers();
 	void interpretCycle();
-	int playGame();
+
+	/** Init the game and prepare the main loop, also used on restart. */
+	bool startGame();
+	/** Run one iteration of the main loop, i.e. one interpreter cycle. */
+	void playCycle();
+	void stopGame();
+
+	/** Whether a quick load may still be done before the next cycle */
+	bool _firstLoop;
 
 	void printItem(int n, int fg, int bg);
 	int findItem();
@@ -302,8 +302,72 @@ int AgiEngine::mainCycle(bool onlyCheckForEvents) {
 	return true;
 }
 
-int AgiEngine::playGame() {
-	int ec = errOK;
+bool AgiEngine::startGame() {
+	debugC(2, kDebugLevelMain, "game loop");
+	debugC(2, kDebugLevelMain, "game version = 0x%x", getVersion());
+
+	if (agiInit() != errOK)
+		return false;
+
+	if (_restartGame) {
+		setflag(fRestartGame, true);
+		setvar(vTimeDelay, 2);	// "normal" speed
+		_restartGame = false;
+	}
+
+	// Set computer type (v20 i.e. vComputer) and sound type
+	switch (getPlatform()) {
+	case Common::kPlatformAtariST:
+		setvar(vComputer, kAgiComputerAtariST);
+		setvar(vSoundgen, kAgiSoundPC);
+		break;
+	case Common::kPlatformAmiga:
+		if (getFeatures() & GF_OLDAMIGAV20)
+			setvar(vComputer, kAgiComputerAmigaOld);
+		else
+			setvar(vComputer, kAgiComputerAmiga);
+		setvar(vSoundgen, kAgiSoundTandy);
+		break;
+	case Common::kPlatformApple2GS:
+		setvar(vComputer, kAgiComputerApple2GS);
+		if (getFeatures() & GF_2GSOLDSOUND)
+			setvar(vSoundgen, kAgiSound2GSOld);
+		else
+			setvar(vSoundgen, kAgiSoundTandy);
+		break;
+	case Common::kPlatformDOS:
+	default:
+		setvar(vComputer, kAgiComputerPC);
+		setvar(vSoundgen, kAgiSoundPC);
+		break;
+	}
+
+	// Set monitor type (v26 i.e. vMonitor)
+	switch (_renderMode) {
+	case Common::kRenderCGA:
+		setvar(vMonitor, kAgiMonitorCga);
+		break;
+	case Common::kRenderHercG:
+	case Common::kRenderHercA:
+		setvar(vMonitor, kAgiMonitorHercules);
+		break;
+	// Don't know if Amiga AGI games use a different value than kAgiMonitorEga
+	// for vMonitor so I just use kAgiMonitorEga for them (As was done before too).
+	case Common::kRenderAmiga:
+	case Common::kRenderDefault:
+	case Common::kRenderEGA:
+	default:
+		setvar(vMonitor, kAgiMonitorEga);
+		break;
+	}
+
+	setvar(vFreePages, 180); // Set amount of free memory to realistic value
+	setvar(vMaxInputChars, 38);
+	_game.inputMode = INPUT_NONE;
+	_game.inputEnabled = false;
+	_game.hasPrompt = 0;
+
+	_game.state = STATE_RUNNING;
 
 	debugC(2, kDebugLevelMain, "initializing...");
 	debugC(2, kDebugLevelMain, "game version = 0x%x", getVersion());
@@ -338,129 +402,84 @@ int AgiEngine::playGame() {
 	_game.vars[vKey] = 0;
 
 	debugC(2, kDebugLevelMain, "Entering main loop");
-	bool firstLoop = !getflag(fRestartGame); // Do not restore on game restart
-
-	do {
+	_firstLoop = !getflag(fRestartGame); // Do not restore on game restart
 
-		if (!mainCycle())
-			continue;
+	return true;
+}
 
-		if (getvar(vTimeDelay) == 0 || (1 + _clockCount) % getvar(vTimeDelay) == 0) {
-			if (!_game.hasPrompt && _game.inputMode == INPUT_NORMAL) {
-				writePrompt();
-				_game.hasPrompt = 1;
-			} else if (_game.hasPrompt && _game.inputMode == INPUT_NONE) {
-				writePrompt();
-				_game.hasPrompt = 0;
-			}
+void AgiEngine::playCycle() {
+	if (!mainCycle())
+		return;
 
-			interpretCycle();
+	if (getvar(vTimeDelay) == 0 || (1 + _clockCount) % getvar(vTimeDelay) == 0) {
+		if (!_game.hasPrompt && _game.inputMode == INPUT_NORMAL) {
+			writePrompt();
+			_game.hasPrompt = 1;
+		} else if (_game.hasPrompt && _game.inputMode == INPUT_NONE) {
+			writePrompt();
+			_game.hasPrompt = 0;
+		}
 
-			// Check if the user has asked to load a game from the command line
-			// or the launcher
-			if (firstLoop) {
-				checkQuickLoad();
-				firstLoop = false;
-			}
+		interpretCycle();
 
-			setflag(fEnteredCli, false);
-			setflag(fSaidAcceptedInput, false);
-			_game.vars[vWordNotFound] = 0;
-			_game.vars[vKey] = 0;
+		// Check if the user has asked to load a game from the command line
+		// or the launcher
+		if (_firstLoop) {
+			checkQuickLoad();
+			_firstLoop = false;
 		}
 
-		if (shouldPerformAutoSave(_lastSaveTime)) {
-			saveGame(getSavegameFilename(0), "Autosave");
-		}
+		setflag(fEnteredCli, false);
+		setflag(fSaidAcceptedInput, false);
+		_game.vars[vWordNotFound] = 0;
+		_game.vars[vKey] = 0;
+	}
 
-	} while (!(shouldQuit() || _restartGame));
+	if (shouldPerformAutoSave(_lastSaveTime)) {
+		saveGame(getSavegameFilename(0), "Autosave");
+	}
+}
 
+void AgiEngine::stopGame() {
 	_sound->stopSound();
-
-	return ec;
+	_game.state = STATE_LOADED;
+	agiDeinit();
 }
 
-int AgiEngine::runGame() {
-	int ec = errOK;
+int32 AgiEngine::runStep() {
+	if (_game.state != STATE_RUNNING)
+		return kStepFinished;
 
-	// Execute the game
-	do {
-		debugC(2, kDebugLevelMain, "game loop");
-		debugC(2, kDebugLevelMain, "game version = 0x%x", getVersion());
-
-		if (agiInit() != errOK)
-			break;
+	// The interpreter runs one cycle every 50 ms. Only start the cycle once
+	// it is due, so that pollTimer() in mainCycle() does not block.
+	const int32 wait = (int32)(_lastTick + 50 - _system->getMillis());
+	if (wait > 0)
+		return wait;
 
-		if (_restartGame) {
-			setflag(fRestartGame, true);
-			setvar(vTimeDelay, 2);	// "normal" speed
-			_restartGame = false;
-		}
+	playCycle();
 
-		// Set computer type (v20 i.e. vComputer) and sound type
-		switch (getPlatform()) {
-		case Common::kPlatformAtariST:
-			setvar(vComputer, kAgiComputerAtariST);
-			setvar(vSoundgen, kAgiSoundPC);
-			break;
-		case Common::kPlatformAmiga:
-			if (getFeatures() & GF_OLDAMIGAV20)
-				setvar(vComputer, kAgiComputerAmigaOld);
-			else
-				setvar(vComputer, kAgiComputerAmiga);
-			setvar(vSoundgen, kAgiSoundTandy);
-			break;
-		case Common::kPlatformApple2GS:
-			setvar(vComputer, kAgiComputerApple2GS);
-			if (getFeatures() & GF_2GSOLDSOUND)
-				setvar(vSoundgen, kAgiSound2GSOld);
-			else
-				setvar(vSoundgen, kAgiSoundTandy);
-			break;
-		case Common::kPlatformDOS:
-		default:
-			setvar(vComputer, kAgiComputerPC);
-			setvar(vSoundgen, kAgiSoundPC);
-			break;
-		}
-
-		// Set monitor type (v26 i.e. vMonitor)
-		switch (_renderMode) {
-		case Common::kRenderCGA:
-			setvar(vMonitor, kAgiMonitorCga);
-			break;
-		case Common::kRenderHercG:
-		case Common::kRenderHercA:
-			setvar(vMonitor, kAgiMonitorHercules);
-			break;
-		// Don't know if Amiga AGI games use a different value than kAgiMonitorEga
-		// for vMonitor so I just use kAgiMonitorEga for them (As was done before too).
-		case Common::kRenderAmiga:
-		case Common::kRenderDefault:
-		case Common::kRenderEGA:
-		default:
-			setvar(vMonitor, kAgiMonitorEga);
-			break;
-		}
+	if (shouldQuit() || _restartGame) {
+		stopGame();
+		if (!_restartGame || !startGame())
+			return kStepFinished;
+	}
 
-		setvar(vFreePages, 180); // Set amount of free memory to realistic value
-		setvar(vMaxInputChars, 38);
-		_game.inputMode = INPUT_NONE;
-		_game.inputEnabled = false;
-		_game.hasPrompt = 0;
+	return MAX<int32>(_lastTick + 50 - _system->getMillis(), 0);
+}
 
-		_game.state = STATE_RUNNING;
-		ec = playGame();
-		_game.state = STATE_LOADED;
-		agiDeinit();
-	} while (_restartGame);
+void AgiEngine::idleStep() {
+	processEvents();
+	_console->onFrame();
+	_system->updateScreen();
+}
 
+Common::Error AgiEngine::endSteps() {
 	delete _menu;
 	_menu = NULL;
 
 	releaseImageStack();
 
-	return ec;
+	return Common::kNoError;
 }
 
 } // End of namespace Agi
@@ -386,6 +386,27 @@ bool Engine::shouldPerformAutoSave(int lastSaveTime) {
 	return autosavePeriod != 0 && diff > autosavePeriod * 1000;
 }
 
+Common::Error Engine::runSteps(EngineStepper &stepper) {
+	Common::Error err = stepper.beginSteps();
+	if (err.getCode() != Common::kNoError)
+		return err;
+
+	int32 delay;
+	while ((delay = stepper.runStep()) != EngineStepper::kStepFinished) {
+		const uint32 deadline = _system->getMillis() + delay;
+
+		// Keep the screen and events alive until the next iteration is due
+		stepper.idleStep();
+		int32 wait;
+		while ((wait = (int32)(deadline - _system->getMillis())) > 0) {
+			_system->delayMillis(MIN<int32>(wait, 10));
+			stepper.idleStep();
+		}
+	}
+
+	return stepper.endSteps();
+}
+
 void Engine::errorString(const char *buf1, char *buf2, int size) {
 	Common::strlcpy(buf2, buf1, size);
 }
@@ -48,6 +48,67 @@ class Dialog;
  */
 void GUIErrorMessage(const Common::String &msg);
 
+/**
+ * Interface for engines whose main loop can be run one iteration at a time.
+ *
+ * Instead of blocking inside Engine::run(), the host calls runStep() for
+ * every iteration of the main loop and waits for the returned delay itself,
+ * calling idleStep() in the meantime to keep the screen and the event queue
+ * alive. This allows running on hosts which must not block, like the
+ * browser event loop, and driving several engines from a single thread.
+ *
+ * @see Engine::getStepper(), Engine::runSteps()
+ */
+class EngineStepper {
+public:
+	enum {
+		/** Returned by runStep() once the main loop has ended */
+		kStepFinished = -1
+	};
+
+	/** Counters for benchmarking, see getStepStats(). */
+	struct StepStats {
+		uint32 opcodes;		///< script instructions executed so far
+		uint32 heapSize;	///< bytes currently held in the engine resource heap
+		uint32 heapPeak;	///< high-water mark of heapSize
+	};
+
+	virtual ~EngineStepper() {}
+
+	/**
+	 * Init the engine and prepare its main loop. This does everything
+	 * run() does before entering the main loop.
+	 * @return returns kNoError on success, else an error code.
+	 */
+	virtual Common::Error beginSteps() = 0;
+
+	/**
+	 * Run one iteration of the main loop.
+	 * @return the time in milliseconds until the next iteration is due,
+	 *         or kStepFinished if the main loop has ended.
+	 */
+	virtual int32 runStep() = 0;
+
+	/**
+	 * Process events and update the screen while waiting for the next
+	 * iteration. Called at least once after every runStep() which did not
+	 * finish, and then periodically until the next iteration is due.
+	 */
+	virtual void idleStep() = 0;
+
+	/**
+	 * Clean up after the main loop has ended. This does everything run()
+	 * does after leaving the main loop.
+	 * @return returns kNoError on success, else an error code.
+	 */
+	virtual Common::Error endSteps() = 0;
+
+	/**
+	 * Report the counters the engine keeps track of. Counters which are not
+	 * supported by the engine are left untouched.
+	 */
+	virtual void getStepStats(StepStats &stats) const {}
+};
 
 class Engine {
 public:
@@ -147,6 +208,12 @@ public:
 	 */
 	virtual Common::Error run() = 0;
 
+	/**
+	 * Return the step interface of the engine if its main loop can be run
+	 * one iteration at a time, or 0 if run() has to be used instead.
+	 */
+	virtual EngineStepper *getStepper() { return 0; }
+
 	/**
 	 * Prepare an error string, which is printed by the error() function.
 	 */
@@ -320,6 +387,12 @@ protected:
 	 */
 	bool shouldPerformAutoSave(int lastSaveTime);
 
+	/**
+	 * Run all iterations of a main loop, blocking until it has ended.
+	 * Engines which implement EngineStepper use this for run().
+	 */
+	Common::Error runSteps(EngineStepper &stepper);
+
 };
 
 // FIXME: HACK for MidiEmu & error()
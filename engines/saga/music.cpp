@@ -32,6 +32,7 @@
 #include "audio/midiparser.h"
 #include "audio/midiparser_qt.h"
 #include "audio/decoders/raw.h"
+#include "audio/softsynth/mt32cache.h"
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/substream.h"
@@ -47,6 +48,7 @@ MusicDriver::MusicDriver() : _isGM(false) {
 
 	MidiDriver::DeviceHandle dev = MidiDriver::detectDevice(MDT_MIDI | MDT_ADLIB | MDT_PREFER_GM);
 	_driverType = MidiDriver::getMusicType(dev);
+	_isEmulatedMT32 = _nativeMT32 && MidiDriver::getDeviceString(dev, MidiDriver::kDriverId) == "mt32";
 
 	int retValue = _driver->open();
 	if (retValue == 0) {
@@ -181,12 +183,27 @@ Music::Music(SagaEngine *vm, Audio::Mixer *mixer) : _vm(vm), _mixer(mixer) {
 	_currentVolumePercent = 0;
 
 	_digitalMusic = false;
+
+	_mt32Cache = 0;
+	_cachedMT32Playing = false;
+#ifdef USE_MT32EMU
+	if (_player->isEmulatedMT32() && ConfMan.hasKey("mt32_render_cache") && ConfMan.getBool("mt32_render_cache")) {
+		_mt32Cache = new Audio::MT32RenderCache();
+		if (!_mt32Cache->open()) {
+			delete _mt32Cache;
+			_mt32Cache = 0;
+		}
+	}
+#endif
 }
 
 Music::~Music() {
 	_vm->getTimerManager()->removeTimerProc(&musicVolumeGaugeCallback);
 	_mixer->stopHandle(_musicHandle);
 	delete _player;
+#ifdef USE_MT32EMU
+	delete _mt32Cache;
+#endif
 }
 
 void Music::musicVolumeGaugeCallback(void *refCon) {
@@ -254,6 +271,7 @@ void Music::play(uint32 resourceId, MusicFlags flags) {
 	_trackNumber = resourceId;
 	_mixer->stopHandle(_musicHandle);
 	_player->stop();
+	_cachedMT32Playing = false;
 
 	int realTrackNumber;
 
@@ -374,24 +392,60 @@ void Music::play(uint32 resourceId, MusicFlags flags) {
 		}
 
 		_vm->_resource->loadResource(_musicContext, resourceId, *_currentMusicBuffer);
-		_player->play(_vm, _currentMusicBuffer, (flags & MUSIC_LOOP));
+		if (!playCachedMT32(_currentMusicBuffer, (flags & MUSIC_LOOP)))
+			_player->play(_vm, _currentMusicBuffer, (flags & MUSIC_LOOP));
 	}
 
 	setVolume(_vm->_musicVolume);
 }
 
+bool Music::playCachedMT32(ByteArray *buffer, bool loop) {
+#ifdef USE_MT32EMU
+	// The tracks play on their own and SAGA sends no timbres, so the
+	// rendered tracks sound like the live emulator
+	if (!_mt32Cache || buffer->size() < 4)
+		return false;
+
+	Audio::MT32RenderCache::MusicFormat format = Audio::MT32RenderCache::kFormatSMF;
+	if (!memcmp(buffer->getBuffer(), "FORM", 4))
+		format = Audio::MT32RenderCache::kFormatXMIDI;
+
+	Audio::AudioStream *stream = _mt32Cache->makeStream(buffer->getBuffer(), buffer->size(), format, loop);
+	if (!stream) {
+		// Play it live this time, it is rendered for the next one
+		_mt32Cache->prepare(buffer->getBuffer(), buffer->size(), format);
+		return false;
+	}
+
+	debug(2, "Playing pre-rendered MT-32 music");
+	_mixer->playStream(Audio::Mixer::kMusicSoundType, &_musicHandle, stream);
+	_cachedMT32Playing = true;
+	return true;
+#else
+	return false;
+#endif
+}
+
 void Music::pause() {
 	_player->pause();
 	_player->setVolume(0);
+	if (_cachedMT32Playing)
+		_mixer->pauseHandle(_musicHandle, true);
 }
 
 void Music::resume() {
 	_player->resume();
 	_player->setVolume(_vm->_musicVolume);
+	if (_cachedMT32Playing)
+		_mixer->pauseHandle(_musicHandle, false);
 }
 
 void Music::stop() {
 	_player->stop();
+	if (_cachedMT32Playing) {
+		_mixer->stopHandle(_musicHandle);
+		_cachedMT32Playing = false;
+	}
 }
 
 } // End of namespace Saga
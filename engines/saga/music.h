@@ -33,6 +33,10 @@
 #include "audio/decoders/flac.h"
 #include "common/mutex.h"
 
+namespace Audio {
+class MT32RenderCache;
+}
+
 namespace Saga {
 
 enum MusicFlags {
@@ -51,6 +55,7 @@ public:
 	virtual void resume();
 
 	bool isAdlib() const { return _driverType == MT_ADLIB; }
+	bool isEmulatedMT32() const { return _isEmulatedMT32; }
 
 	// FIXME
 	bool isPlaying() const { return _parser && _parser->isPlaying(); }
@@ -62,6 +67,7 @@ public:
 protected:
 	MusicType _driverType;
 	bool _isGM;
+	bool _isEmulatedMT32;
 };
 
 class Music {
@@ -98,6 +104,11 @@ private:
 	ResourceContext *_musicContext;
 	ResourceContext *_digitalMusicContext;
 
+	// Tracks pre-rendered by the MT-32 emulator, or 0
+	Audio::MT32RenderCache *_mt32Cache;
+	bool _cachedMT32Playing;
+	bool playCachedMT32(ByteArray *buffer, bool loop);
+
 
 	static void musicVolumeGaugeCallback(void *refCon);
 	static void onTimer(void *refCon);
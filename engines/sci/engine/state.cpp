@@ -108,6 +108,8 @@ void EngineState::reset(bool isRestoring) {
 	_throttleCounter = 0;
 	_throttleLastTime = 0;
 	_throttleTrigger = false;
+	_throttleYield = false;
+	_throttleYieldDelay = 0;
 	_gameIsBenchmarking = false;
 
 	_lastSaveVirtualId = SAVEGAMEID_OFFICIALRANGE_START;
@@ -134,7 +136,12 @@ void EngineState::speedThrottler(uint32 neededSleep) {
 		uint32 curTime = g_system->getMillis();
 		uint32 duration = curTime - _throttleLastTime;
 
-		if (duration < neededSleep) {
+		if (duration < neededSleep && _throttleYield && executionStackBase == 0) {
+			// Let the outermost VM return to the engine main loop, which
+			// waits and then resumes it, see SciEngine::runStep()
+			_throttleYieldDelay = neededSleep - duration;
+			abortScriptProcessing = kAbortYield;
+		} else if (duration < neededSleep) {
 			g_sci->sleep(neededSleep - duration);
 			_throttleLastTime = g_system->getMillis();
 		} else {
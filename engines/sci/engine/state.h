@@ -54,7 +54,8 @@ enum AbortGameState {
 	kAbortNone = 0,
 	kAbortLoadGame = 1,
 	kAbortRestartGame = 2,
-	kAbortQuitGame = 3
+	kAbortQuitGame = 3,
+	kAbortYield = 4 ///< return to the engine main loop, which resumes the VM later
 };
 
 // We assume that scripts give us savegameId 0->99 for creating a new save slot
@@ -116,6 +117,8 @@ public:
 	uint32 _throttleCounter; /**< total times kAnimate was invoked */
 	uint32 _throttleLastTime; /**< last time kAnimate was invoked */
 	bool _throttleTrigger;
+	bool _throttleYield; /**< yield to the engine main loop instead of sleeping in the throttler */
+	uint32 _throttleYieldDelay; /**< time to wait before resuming the VM after a yield */
 	bool _gameIsBenchmarking;
 
 	/* Kernel File IO stuff */
@@ -528,7 +528,7 @@ int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4])
 	return offset;
 }
 
-void run_vm(EngineState *s) {
+void run_vm(EngineState *s, bool resume) {
 	assert(s);
 
 	int temp;
@@ -543,13 +543,16 @@ void run_vm(EngineState *s) {
 	Object *obj = s->_segMan->getObject(s->xs->objp);
 	Script *scr = 0;
 	Script *local_script = s->_segMan->getScriptIfLoaded(s->xs->local_segment);
-	int old_executionStackBase = s->executionStackBase;
-	// Used to detect the stack bottom, for "physical" returns
+	// Used to detect the stack bottom, for "physical" returns. Only the
+	// outermost VM yields, so a resumed VM keeps its base and has no
+	// VM running below it.
+	int old_executionStackBase = resume ? -1 : s->executionStackBase;
 
 	if (!local_script)
 		error("run_vm(): program counter gone astray (local_script pointer is null)");
 
-	s->executionStackBase = s->_executionStack.size() - 1;
+	if (!resume)
+		s->executionStackBase = s->_executionStack.size() - 1;
 
 	s->variablesSegment[VAR_TEMP] = s->variablesSegment[VAR_PARAM] = s->_segMan->findSegmentByType(SEG_TYPE_STACK);
 	s->variablesBase[VAR_TEMP] = s->variablesBase[VAR_PARAM] = s->stack_base;
@@ -316,8 +316,10 @@ ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj,
  * It executes the code on s->heap[pc] until it hits a 'ret' operation
  * while (stack_base == stack_pos). Requires s to be set up correctly.
  * @param[in] s			The state to use
+ * @param[in] resume	Continue the outermost VM after it returned with
+ *						kAbortYield, instead of starting a new one
  */
-void run_vm(EngineState *s);
+void run_vm(EngineState *s, bool resume = false);
 
 /**
  * Debugger functionality
@@ -86,6 +86,7 @@ SciEngine::SciEngine(OSystem *syst, const ADGameDescription *desc, SciGameId gam
 	_features = 0;
 	_resMan = 0;
 	_gamestate = 0;
+	_resumeVm = false;
 	_kernel = 0;
 	_vocabulary = 0;
 	_vocabularyLanguage = 1; // we load english vocabulary on startup
@@ -190,6 +191,10 @@ SciEngine::~SciEngine() {
 extern void showScummVMDialog(const Common::String &message);
 
 Common::Error SciEngine::run() {
+	return runSteps(*this);
+}
+
+Common::Error SciEngine::beginSteps() {
 	// Assign default values to the config manager, in case settings are missing
 	ConfMan.registerDefault("originalsaveload", "false");
 	ConfMan.registerDefault("native_fb01", "false");
@@ -352,8 +357,22 @@ Common::Error SciEngine::run() {
 		                  "having unexpected errors and/or issues later on.");
 	}
 
-	runGame();
+	setTotalPlayTime(0);
+
+	initStackBaseWithSelector(SELECTOR(play)); // Call the play selector
+
+	// Attach the debug console on game startup, if requested
+	if (DebugMan.isDebugChannelEnabled(kDebugLevelOnStartup))
+		_console->attach();
 
+	_gamestate->_syncedAudioOptions = false;
+	_gamestate->_executionStackPosChanged = false;
+	_resumeVm = false;
+
+	return Common::kNoError;
+}
+
+Common::Error SciEngine::endSteps() {
 	ConfMan.flushToDisk();
 
 	return Common::kNoError;
@@ -691,52 +710,64 @@ void SciEngine::initStackBaseWithSelector(Selector selector) {
 
 }
 
-void SciEngine::runGame() {
-	setTotalPlayTime(0);
+int32 SciEngine::runStep() {
+	// The speed throttler of the outermost VM returns here instead of
+	// sleeping, see EngineState::speedThrottler()
+	_gamestate->_throttleYield = true;
+	if (_resumeVm) {
+		_resumeVm = false;
+		_gamestate->_throttleLastTime = g_system->getMillis();
+		run_vm(_gamestate, true);
+	} else {
+		run_vm(_gamestate);
+	}
+	_gamestate->_throttleYield = false;
 
-	initStackBaseWithSelector(SELECTOR(play)); // Call the play selector
+	if (_gamestate->abortScriptProcessing == kAbortYield) {
+		_gamestate->abortScriptProcessing = kAbortNone;
+		_resumeVm = true;
+		return _gamestate->_throttleYieldDelay;
+	}
 
-	// Attach the debug console on game startup, if requested
-	if (DebugMan.isDebugChannelEnabled(kDebugLevelOnStartup))
-		_console->attach();
+	exitGame();
 
-	_gamestate->_syncedAudioOptions = false;
+	_gamestate->_syncedAudioOptions = true;
 
-	do {
-		_gamestate->_executionStackPosChanged = false;
-		run_vm(_gamestate);
-		exitGame();
-
-		_gamestate->_syncedAudioOptions = true;
-
-		if (_gamestate->abortScriptProcessing == kAbortRestartGame) {
-			_gamestate->_segMan->resetSegMan();
-			initGame();
-			initStackBaseWithSelector(SELECTOR(play));
-			patchGameSaveRestore();
-			setLauncherLanguage();
-			_gamestate->gameIsRestarting = GAMEISRESTARTING_RESTART;
-			_gamestate->_throttleLastTime = 0;
-			if (_gfxMenu)
-				_gfxMenu->reset();
-			_gamestate->abortScriptProcessing = kAbortNone;
-			_gamestate->_syncedAudioOptions = false;
-		} else if (_gamestate->abortScriptProcessing == kAbortLoadGame) {
-			_gamestate->abortScriptProcessing = kAbortNone;
-			_gamestate->_executionStack.clear();
-			initStackBaseWithSelector(SELECTOR(replay));
-			patchGameSaveRestore();
-			setLauncherLanguage();
-			_gamestate->shrinkStackToBase();
-			_gamestate->abortScriptProcessing = kAbortNone;
-
-			syncSoundSettings();
-			syncIngameAudioOptions();
-			// Games do not set their audio settings when loading
-		} else {
-			break;	// exit loop
-		}
-	} while (true);
+	if (_gamestate->abortScriptProcessing == kAbortRestartGame) {
+		_gamestate->_segMan->resetSegMan();
+		initGame();
+		initStackBaseWithSelector(SELECTOR(play));
+		patchGameSaveRestore();
+		setLauncherLanguage();
+		_gamestate->gameIsRestarting = GAMEISRESTARTING_RESTART;
+		_gamestate->_throttleLastTime = 0;
+		if (_gfxMenu)
+			_gfxMenu->reset();
+		_gamestate->abortScriptProcessing = kAbortNone;
+		_gamestate->_syncedAudioOptions = false;
+	} else if (_gamestate->abortScriptProcessing == kAbortLoadGame) {
+		_gamestate->abortScriptProcessing = kAbortNone;
+		_gamestate->_executionStack.clear();
+		initStackBaseWithSelector(SELECTOR(replay));
+		patchGameSaveRestore();
+		setLauncherLanguage();
+		_gamestate->shrinkStackToBase();
+		_gamestate->abortScriptProcessing = kAbortNone;
+
+		syncSoundSettings();
+		syncIngameAudioOptions();
+		// Games do not set their audio settings when loading
+	} else {
+		return kStepFinished;
+	}
+
+	_gamestate->_executionStackPosChanged = false;
+	return 0;
+}
+
+void SciEngine::idleStep() {
+	// let backend process events and update the screen
+	_eventMan->getSciEvent(SCI_EVENT_PEEK);
 }
 
 void SciEngine::exitGame() {
@@ -212,7 +212,7 @@ enum kLanguage {
 	K_LANG_PORTUGUESE = 351
 };
 
-class SciEngine : public Engine {
+class SciEngine : public Engine, public EngineStepper {
 	friend class Console;
 public:
 	SciEngine(OSystem *syst, const ADGameDescription *desc, SciGameId gameId);
@@ -220,6 +220,7 @@ public:
 
 	// Engine APIs
 	virtual Common::Error run();
+	virtual EngineStepper *getStepper() { return this; }
 	bool hasFeature(EngineFeature f) const;
 	void pauseEngineIntern(bool pause);
 	virtual GUI::Debugger *getDebugger();
@@ -369,12 +370,17 @@ private:
 
 	/**
 	 * Runs a SCI game
-	 * This is the main function for SCI games. It takes a valid state, loads
-	 * script 0 to it, finds the game object, allocates a stack, and runs the
-	 * init method of the game object. In layman's terms, this runs a SCI game.
-	 * @param[in] s	Pointer to the pointer of the state to operate on
-	  */
-	void runGame();
+	 * The main loop of SCI games is the VM itself. Each step runs it until
+	 * the game scripts are throttled, or until the game quits, restarts or
+	 * restores a saved game, which is then set up for the next step.
+	 */
+	virtual Common::Error beginSteps();
+	virtual int32 runStep();
+	virtual void idleStep();
+	virtual Common::Error endSteps();
+
+	/** Whether the next step continues a VM which yielded, see runStep() */
+	bool _resumeVm;
 
 	/**
 	 * Uninitializes an initialized SCI game
@@ -55,6 +55,8 @@ public:
 	int open(ResourceManager *resMan);
 	void close();
 	void send(uint32 b);
+	// Events are mapped to voices on the way, which happens right away
+	void sendDelayed(uint32 b, uint32 delayUs) { send(b); }
 	void sysEx(const byte *msg, uint16 length);
 	bool hasRhythmChannel() const { return false; }
 	byte getPlayId() const;
@@ -435,7 +435,7 @@ void MidiParser_SCI::sendToDriver(uint32 midi) {
 	if (_mainThreadCalled)
 		_music->putMidiCommandInQueue(midi);
 	else
-		_driver->send(midi);
+		MidiParser::sendToDriver(midi);
 }
 
 void MidiParser_SCI::parseNextEvent(EventInfo &info) {
@@ -330,6 +330,8 @@ void SciMusic::soundInitSnd(MusicEntry *pSnd) {
 				pSnd->pMidiParser->setMidiDriver(_pMidiDrv);
 				pSnd->pMidiParser->setTimerRate(_dwTempo);
 				pSnd->pMidiParser->setMasterVolume(_masterVolume);
+				// Emulated drivers start notes at their sample, not the tick
+				pSnd->pMidiParser->property(MidiParser::mpSampleAccurate, 1);
 			}
 
 			pSnd->pauseCounter = 0;
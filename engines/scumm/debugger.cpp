@@ -37,6 +37,8 @@
 
 namespace Scumm {
 
+extern const char *nameOfResType(ResType type);
+
 void debugC(int channel, const char *s, ...) {
 	char buf[STRINGBUFLEN];
 	va_list va;
@@ -79,6 +81,8 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	DCmd_Register("scr",       WRAP_METHOD(ScummDebugger, Cmd_Script));
 	DCmd_Register("scripts",   WRAP_METHOD(ScummDebugger, Cmd_PrintScript));
 	DCmd_Register("importres", WRAP_METHOD(ScummDebugger, Cmd_ImportRes));
+	DCmd_Register("resources", WRAP_METHOD(ScummDebugger, Cmd_Resources));
+	DCmd_Register("dirty",     WRAP_METHOD(ScummDebugger, Cmd_Dirty));
 
 	if (_vm->_game.id == GID_LOOM)
 		DCmd_Register("drafts",  WRAP_METHOD(ScummDebugger, Cmd_PrintDraft));
@@ -844,6 +848,79 @@ bool ScummDebugger::Cmd_Passcode(int argc, const char **argv) {
 	return false;
 }
 
+bool ScummDebugger::Cmd_Resources(int argc, const char **argv) {
+	ResourceManager *res = _vm->_res;
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		res->resetStats();
+		DebugPrintf("Resource statistics reset\n");
+		return true;
+	}
+
+	if (argc == 4 && !strcmp(argv[1], "budget")) {
+		ResType type = rtInvalid;
+		for (ResType t = rtFirst; t <= rtLast; t = ResType(t + 1)) {
+			if (!scumm_stricmp(argv[2], nameOfResType(t)))
+				type = t;
+		}
+		if (type == rtInvalid) {
+			DebugPrintf("Unknown resource type '%s'\n", argv[2]);
+			return true;
+		}
+		res->setTypeBudget(type, atoi(argv[3]) * 1024);
+		DebugPrintf("Budget of %s set to %d KB\n", nameOfResType(type), atoi(argv[3]));
+		return true;
+	}
+
+	if (argc != 1) {
+		DebugPrintf("Syntax: resources [reset | budget <type> <KB>]\n");
+		return true;
+	}
+
+	DebugPrintf("Heap: %d KB allocated, %d KB peak\n", res->getAllocatedSize() / 1024, res->getAllocatedSizePeak() / 1024);
+	DebugPrintf("Type            Loaded     KB  Budget KB     Hits   Misses  Evicted\n");
+	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
+		const ResourceManager::ResTypeData &rtd = res->_types[type];
+		if (rtd._mode == kDynamicResTypeMode)
+			continue;
+
+		int loaded = 0;
+		for (uint idx = 0; idx < rtd.size(); idx++) {
+			if (rtd[idx]._address)
+				loaded++;
+		}
+
+		DebugPrintf("%-14s %7d %6d %10d %8d %8d %8d\n", nameOfResType(type), loaded,
+			rtd._allocatedSize / 1024, rtd._budget / 1024, rtd._hits, rtd._misses, rtd._evictions);
+	}
+	return true;
+}
+
+bool ScummDebugger::Cmd_Dirty(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		_vm->_dirtyRegion.resetStats();
+		DebugPrintf("Dirty region statistics reset\n");
+		return true;
+	}
+
+	if (argc != 1) {
+		DebugPrintf("Syntax: dirty [reset]\n");
+		return true;
+	}
+
+	const Graphics::DirtyRegion::Stats &last = _vm->_dirtyRegion.getLastStats();
+	const Graphics::DirtyRegion::Stats &total = _vm->_dirtyRegion.getTotalStats();
+
+	DebugPrintf("Last update: %d rects, %d pixels marked dirty, %d pixels drawn\n",
+		last.rects, last.markedPixels, last.presentedPixels);
+	if (total.flushes) {
+		DebugPrintf("Average of %d updates: %d rects, %d pixels marked dirty, %d pixels drawn\n",
+			total.flushes, total.rects / total.flushes, total.markedPixels / total.flushes,
+			total.presentedPixels / total.flushes);
+	}
+	return true;
+}
+
 bool ScummDebugger::Cmd_ResetCursors(int argc, const char **argv) {
 	_vm->resetCursors();
 	detach();
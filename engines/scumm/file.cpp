@@ -27,13 +27,58 @@
 #include "common/memstream.h"
 #include "common/substream.h"
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace Scumm {
 
+enum {
+	// Larger files, e.g. the bundles of the v7/v8 games, are kept on disk
+	kMaxPreloadSize = 16 * 1024 * 1024
+};
+
+/**
+ * XOR the given data with value. Used to decode the simple "encryption"
+ * of the older SCUMM games, a vector resp. machine word at a time.
+ */
+static void xorData(byte *data, uint32 len, byte value) {
+	while (len && ((size_t)data & 7)) {
+		*data++ ^= value;
+		len--;
+	}
+
+#if defined(__wasm_simd128__)
+	const v128_t pattern = wasm_i8x16_splat(value);
+	for (; len >= 16; len -= 16, data += 16)
+		wasm_v128_store(data, wasm_v128_xor(wasm_v128_load(data), pattern));
+#elif defined(__SSE2__)
+	const __m128i pattern = _mm_set1_epi8(value);
+	for (; len >= 16; len -= 16, data += 16)
+		_mm_storeu_si128((__m128i *)data, _mm_xor_si128(_mm_loadu_si128((const __m128i *)data), pattern));
+#endif
+
+	// memcpy keeps the word access free of alignment and aliasing issues,
+	// compilers turn it into a plain load and store
+	const uint64 pattern64 = value * 0x0101010101010101ULL;
+	for (; len >= 8; len -= 8, data += 8) {
+		uint64 word;
+		memcpy(&word, data, sizeof(word));
+		word ^= pattern64;
+		memcpy(data, &word, sizeof(word));
+	}
+
+	while (len--)
+		*data++ ^= value;
+}
+
 #pragma mark -
 #pragma mark --- ScummFile ---
 #pragma mark -
 
-ScummFile::ScummFile() : _subFileStart(0), _subFileLen(0) {
+ScummFile::ScummFile() : _subFileStart(0), _subFileLen(0), _preloaded(false), _preloadEnc(0) {
 }
 
 void ScummFile::setSubfileRange(int32 start, int32 len) {
@@ -61,6 +106,48 @@ bool ScummFile::open(const Common::String &filename) {
 	}
 }
 
+void ScummFile::close() {
+	_preloaded = false;
+	_preloadEnc = 0;
+	BaseScummFile::close();
+}
+
+bool ScummFile::preload() {
+	assert(isOpen());
+
+	if (_preloaded)
+		return true;
+
+	const int32 fileSize = File::size();
+	if (fileSize <= 0 || fileSize > kMaxPreloadSize)
+		return false;
+
+	byte *data = (byte *)malloc(fileSize);
+	if (!data)
+		return false;
+
+	const int32 oldPos = File::pos();
+	File::seek(0, SEEK_SET);
+	if (File::read(data, fileSize) != (uint32)fileSize) {
+		free(data);
+		File::clearErr();
+		File::seek(oldPos, SEEK_SET);
+		return false;
+	}
+
+	if (_encbyte)
+		xorData(data, fileSize, _encbyte);
+
+	// Serve all further reads from memory
+	delete _handle;
+	_handle = new Common::MemoryReadStream(data, fileSize, DisposeAfterUse::YES);
+	_handle->seek(oldPos, SEEK_SET);
+
+	_preloaded = true;
+	_preloadEnc = _encbyte;
+	return true;
+}
+
 bool ScummFile::openSubFile(const Common::String &filename) {
 	assert(isOpen());
 
@@ -173,13 +260,10 @@ uint32 ScummFile::read(void *dataPtr, uint32 dataSize) {
 
 	// If an encryption byte was specified, XOR the data we just read by it.
 	// This simple kind of "encryption" was used by some of the older SCUMM
-	// games.
-	if (_encbyte) {
-		byte *p = (byte *)dataPtr;
-		byte *end = p + realLen;
-		while (p < end)
-			*p++ ^= _encbyte;
-	}
+	// games. Preloaded data has been decoded already.
+	const byte enc = _encbyte ^ _preloadEnc;
+	if (enc)
+		xorData((byte *)dataPtr, realLen, enc);
 
 	return realLen;
 }
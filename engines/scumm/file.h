@@ -45,6 +45,14 @@ public:
 	virtual int32 size() const = 0;
 	virtual bool seek(int32 offs, int whence = SEEK_SET) = 0;
 
+	/**
+	 * Load the whole opened file into memory, so that reads do not have to
+	 * go through the file system anymore. Data is decoded with the current
+	 * encryption byte once while loading.
+	 * @return true if the file is held in memory
+	 */
+	virtual bool preload() { return false; }
+
 // Unused
 #if 0
 	virtual bool eos() const = 0;
@@ -58,6 +66,9 @@ private:
 	int32	_subFileLen;
 	bool	_myEos; // Have we read past the end of the subfile?
 
+	bool	_preloaded;	// Is the whole file held in memory?
+	byte	_preloadEnc;	// Encryption byte the preloaded data was decoded with
+
 	void setSubfileRange(int32 start, int32 len);
 	void resetSubfile();
 
@@ -66,6 +77,9 @@ public:
 
 	bool open(const Common::String &filename);
 	bool openSubFile(const Common::String &filename);
+	void close();
+
+	bool preload();
 
 	void clearErr() { _myEos = false; BaseScummFile::clearErr(); }
 
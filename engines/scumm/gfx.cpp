@@ -573,26 +573,24 @@ void ScummEngine::updateDirtyScreen(VirtScreenNumber slot) {
 	if (vs->h == 0)
 		return;
 
-	int i;
-	int w = 8;
-	int start = 0;
+	if (_dirtyRegion.getWidth() != _gdi->_numStrips * 8 || _dirtyRegion.getHeight() != vs->h)
+		_dirtyRegion.init(_gdi->_numStrips * 8, vs->h, 8, 1);
 
-	for (i = 0; i < _gdi->_numStrips; i++) {
+	for (int i = 0; i < _gdi->_numStrips; i++) {
 		if (vs->bdirty[i]) {
-			const int top = vs->tdirty[i];
-			const int bottom = vs->bdirty[i];
+			_dirtyRegion.addRect(i * 8, vs->tdirty[i], 8, vs->bdirty[i] - vs->tdirty[i]);
 			vs->tdirty[i] = vs->h;
 			vs->bdirty[i] = 0;
-			if (i != (_gdi->_numStrips - 1) && vs->bdirty[i + 1] == bottom && vs->tdirty[i + 1] == top) {
-				// Simple optimizations: if two or more neighboring strips
-				// form one bigger rectangle, coalesce them.
-				w += 8;
-				continue;
-			}
-			drawStripToScreen(vs, start * 8, w, top, bottom);
-			w = 8;
 		}
-		start = i + 1;
+	}
+
+	// Neighboring strips are coalesced into bigger rectangles, also where
+	// their dirty ranges differ. Never draw more rectangles than strips.
+	_dirtyRects.clear();
+	_dirtyRegion.flush(_dirtyRects, _gdi->_numStrips);
+	for (uint i = 0; i < _dirtyRects.size(); i++) {
+		const Common::Rect &r = _dirtyRects[i];
+		drawStripToScreen(vs, r.left, r.width(), r.top, r.bottom);
 	}
 }
 
@@ -51,6 +51,7 @@ MODULE_OBJS := \
 	player_v3m.o \
 	player_v4a.o \
 	player_v5m.o \
+	prefetch.o \
 	resource_v2.o \
 	resource_v3.o \
 	resource_v4.o \
@@ -0,0 +1,238 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/savefile.h"
+#include "common/system.h"
+
+#include "scumm/prefetch.h"
+#include "scumm/resource.h"
+
+namespace Scumm {
+
+extern const char *nameOfResType(ResType type);
+
+enum {
+	kHistoryVersion = 1
+};
+
+RoomPrefetcher::RoomPrefetcher(ScummEngine *vm)
+	: _vm(vm), _historyChanged(false), _lastRoom(0), _queuePos(0) {
+	// Until some loads were measured, assume that every resource fits
+	for (int i = 0; i <= rtLast; i++)
+		_loadTime[i] = 4 * 16;
+}
+
+RoomPrefetcher::~RoomPrefetcher() {
+}
+
+void RoomPrefetcher::loadHistory() {
+	Common::String filename = _vm->_targetName + ".rooms";
+	Common::InSaveFile *file = _vm->_saveFileMan->openForLoading(filename);
+	if (!file)
+		return;
+
+	_transitions.clear();
+
+	if (file->readUint32BE() == MKTAG('R','M','H','S') && file->readByte() == kHistoryVersion) {
+		uint16 num = file->readUint16LE();
+		while (num-- && !file->eos()) {
+			Transition t;
+			t.from = file->readUint16LE();
+			t.to = file->readUint16LE();
+			t.count = file->readUint16LE();
+			if (!file->eos() && !file->err())
+				_transitions.push_back(t);
+		}
+	} else {
+		warning("Room history '%s' is invalid", filename.c_str());
+	}
+
+	delete file;
+	_historyChanged = false;
+}
+
+void RoomPrefetcher::saveHistory() {
+	if (!_historyChanged)
+		return;
+
+	Common::String filename = _vm->_targetName + ".rooms";
+	Common::OutSaveFile *file = _vm->_saveFileMan->openForSaving(filename);
+	if (!file)
+		return;
+
+	file->writeUint32BE(MKTAG('R','M','H','S'));
+	file->writeByte(kHistoryVersion);
+	file->writeUint16LE(_transitions.size());
+	for (uint i = 0; i < _transitions.size(); i++) {
+		file->writeUint16LE(_transitions[i].from);
+		file->writeUint16LE(_transitions[i].to);
+		file->writeUint16LE(_transitions[i].count);
+	}
+	file->finalize();
+	delete file;
+
+	_historyChanged = false;
+}
+
+void RoomPrefetcher::recordTransition(int from, int to) {
+	_historyChanged = true;
+
+	for (uint i = 0; i < _transitions.size(); i++) {
+		Transition &t = _transitions[i];
+		if (t.from != from || t.to != to)
+			continue;
+
+		if (t.count == 0xFFFF) {
+			// Keep the proportions, but let recent behavior count more
+			for (uint j = 0; j < _transitions.size(); j++) {
+				if (_transitions[j].from == from)
+					_transitions[j].count = (_transitions[j].count + 1) / 2;
+			}
+		}
+		t.count++;
+		return;
+	}
+
+	if (_transitions.size() >= 0xFFFF)
+		return;
+
+	Transition t;
+	t.from = from;
+	t.to = to;
+	t.count = 1;
+	_transitions.push_back(t);
+}
+
+void RoomPrefetcher::roomEntered(int room) {
+	// Room 0 is used in cutscenes between two rooms, ignore it
+	if (room <= 0)
+		return;
+
+	if (_lastRoom > 0 && _lastRoom != room)
+		recordTransition(_lastRoom, room);
+	_lastRoom = room;
+
+	_queue.clear();
+	_queuePos = 0;
+
+	uint32 total = 0;
+	for (uint i = 0; i < _transitions.size(); i++) {
+		if (_transitions[i].from == room)
+			total += _transitions[i].count;
+	}
+
+	// Pick the most frequent successors, but only those which were taken
+	// at least every fourth time
+	uint16 lastCount = 0xFFFF;
+	int lastTo = -1;
+	for (int n = 0; n < kMaxPredictions; n++) {
+		const Transition *best = 0;
+		for (uint i = 0; i < _transitions.size(); i++) {
+			const Transition &t = _transitions[i];
+			if (t.from != room || t.count > lastCount || (t.count == lastCount && t.to <= lastTo))
+				continue;
+			if (!best || t.count > best->count || (t.count == best->count && t.to < best->to))
+				best = &t;
+		}
+
+		if (!best || best->count * 4 < total)
+			break;
+
+		queueRoom(best->to);
+		lastCount = best->count;
+		lastTo = best->to;
+	}
+}
+
+void RoomPrefetcher::queueRoom(int room) {
+	ResourceManager *res = _vm->_res;
+
+	if (room >= (int)res->_types[rtRoom].size())
+		return;
+
+	queueResource(rtRoom, room);
+	if (_vm->_game.heversion >= 70) {
+		queueResource(rtRoomImage, room);
+		queueResource(rtRoomScripts, room);
+	}
+
+	// Global scripts and costumes are stored in the room they are first
+	// used in, so those are likely to be needed as well.
+	const ResType types[] = { rtCostume, rtScript };
+	for (int i = 0; i < ARRAYSIZE(types); i++) {
+		const ResourceManager::ResTypeData &rtd = res->_types[types[i]];
+		for (uint idx = 1; idx < rtd.size(); idx++) {
+			if (rtd[idx]._roomno == room)
+				queueResource(types[i], idx);
+		}
+	}
+}
+
+void RoomPrefetcher::queueResource(ResType type, ResId idx) {
+	const ResourceManager::Resource &res = _vm->_res->_types[type][idx];
+	if (res._address || res._roomoffs == RES_INVALID_OFFSET)
+		return;
+
+	Request req;
+	req.type = type;
+	req.idx = idx;
+	_queue.push_back(req);
+}
+
+bool RoomPrefetcher::hasHeapRoom(ResType type) const {
+	// Prefetching must never cause other resources to be expired
+	const ResourceManager *res = _vm->_res;
+	if (res->getAllocatedSize() >= res->getMaxHeapThreshold() / 4 * 3)
+		return false;
+
+	const uint32 budget = res->_types[type]._budget;
+	return !budget || res->_types[type]._allocatedSize < budget / 4 * 3;
+}
+
+void RoomPrefetcher::run(uint32 budget) {
+	const uint32 start = _vm->_system->getMillis();
+
+	while (_queuePos < _queue.size()) {
+		const Request &req = _queue[_queuePos];
+
+		if (_vm->_res->isResourceLoaded(req.type, req.idx) || !hasHeapRoom(req.type)) {
+			_queuePos++;
+			continue;
+		}
+
+		const uint32 now = _vm->_system->getMillis();
+		if ((now - start) * 16 + _loadTime[req.type] > budget * 16)
+			break;
+
+		debugC(DEBUG_RESOURCE, "Prefetching %s %d", nameOfResType(req.type), req.idx);
+
+		_queuePos++;
+		_vm->loadResource(req.type, req.idx);
+		noteLoadTime(req.type, _vm->_system->getMillis() - now);
+	}
+}
+
+void RoomPrefetcher::noteLoadTime(ResType type, uint32 msecs) {
+	_loadTime[type] = (_loadTime[type] * 3 + msecs * 16) / 4;
+}
+
+} // End of namespace Scumm
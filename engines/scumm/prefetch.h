@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SCUMM_PREFETCH_H
+#define SCUMM_PREFETCH_H
+
+#include "common/array.h"
+
+#include "scumm/scumm.h"
+
+namespace Scumm {
+
+/**
+ * Loads the resources of the rooms which are likely to be entered next
+ * while the engine is idle, so that entering them does not stall on the
+ * data files.
+ *
+ * The prefetcher learns which rooms follow each other. The history is
+ * kept per target in the save directory, so the predictions improve
+ * each time the game is played.
+ */
+class RoomPrefetcher {
+public:
+	enum {
+		/** Upper limit for the time spent in one call of run(), in ms */
+		kMaxBudget = 8,
+		/** Number of successor rooms prefetched after entering a room */
+		kMaxPredictions = 2
+	};
+
+	RoomPrefetcher(ScummEngine *vm);
+	~RoomPrefetcher();
+
+	void loadHistory();
+	void saveHistory();
+
+	/**
+	 * Record the transition from the previously entered room and queue the
+	 * resources of the rooms which most often followed this one.
+	 */
+	void roomEntered(int room);
+
+	/**
+	 * Load queued resources, as long as this is expected to take no longer
+	 * than the given number of milliseconds.
+	 */
+	void run(uint32 budget);
+
+	/** Update the expected load time of the given resource type. */
+	void noteLoadTime(ResType type, uint32 msecs);
+
+private:
+	struct Transition {
+		uint16 from;
+		uint16 to;
+		uint16 count;
+	};
+
+	struct Request {
+		ResType type;
+		ResId idx;
+	};
+
+	ScummEngine *_vm;
+
+	Common::Array<Transition> _transitions;
+	bool _historyChanged;
+	int _lastRoom;
+
+	Common::Array<Request> _queue;
+	uint _queuePos;
+
+	/**
+	 * Expected time to load a resource of each type, in 1/16 ms. This is a
+	 * running average of the measured load times.
+	 */
+	uint32 _loadTime[rtLast + 1];
+
+	void recordTransition(int from, int to);
+	void queueRoom(int room);
+	void queueResource(ResType type, ResId idx);
+	bool hasHeapRoom(ResType type) const;
+};
+
+} // End of namespace Scumm
+
+#endif
@@ -32,6 +32,7 @@
 #include "scumm/imuse_digi/dimuse.h"
 #include "scumm/he/intern_he.h"
 #include "scumm/object.h"
+#include "scumm/prefetch.h"
 #include "scumm/resource.h"
 #include "scumm/scumm.h"
 #include "scumm/scumm_v5.h"
@@ -205,6 +206,7 @@ bool ScummEngine::openResourceFile(const Common::String &filename, byte encByte)
 
 	if (openFile(*_fileHandle, filename, true)) {
 		_fileHandle->setEnc(encByte);
+		_fileHandle->preload();
 		return true;
 	}
 	return false;
@@ -609,10 +611,17 @@ void ScummEngine::ensureResourceLoaded(ResType type, ResId idx) {
 	if (type != rtCharset && idx == 0)
 		return;
 
-	if (idx <= _res->_types[type].size() && _res->_types[type][idx]._address)
+	if (idx <= _res->_types[type].size() && _res->_types[type][idx]._address) {
+		_res->_types[type]._hits++;
 		return;
+	}
+
+	_res->_types[type]._misses++;
 
+	const uint32 loadStart = _system->getMillis();
 	loadResource(type, idx);
+	if (_prefetcher)
+		_prefetcher->noteLoadTime(type, _system->getMillis() - loadStart);
 
 	if (_game.version == 5 && type == rtRoom && (int)idx == _roomResource)
 		VAR(VAR_ROOM_FLAG) = 1;
@@ -713,6 +722,32 @@ uint32 ScummEngine::getResourceRoomOffset(ResType type, ResId idx) {
 	return _res->_types[type][idx]._roomoffs;
 }
 
+uint ScummEngine::getResourceReloadCost(ResType type, ResId idx) const {
+	const ResourceManager::Resource &res = _res->_types[type][idx];
+
+	// Resources which are not in the data files can not be reloaded at all
+	if (res._roomoffs == RES_INVALID_OFFSET)
+		return 16;
+
+	uint cost = 1;
+
+	// Reloading from another room than the one currently opened requires
+	// to reopen the data files resp. to seek to another room block.
+	const int roomNr = (type == rtRoom && _game.heversion < 70) ? idx : res._roomno;
+	if (roomNr != _lastLoadedRoom)
+		cost += 2;
+
+	// Encoded data files have to be decoded again
+	if (_game.features & GF_USE_KEY)
+		cost++;
+
+	// Sounds are converted while loading
+	if (type == rtSound)
+		cost++;
+
+	return cost;
+}
+
 uint32 ScummEngine_v70he::getResourceRoomOffset(ResType type, ResId idx) {
 	if (type == rtRoom) {
 		return _heV7RoomIntOffsets[idx];
@@ -736,8 +771,11 @@ byte *ScummEngine::getResourceAddress(ResType type, ResId idx) {
 		return NULL;
 
 	// If the resource is missing, but loadable from the game data files, try to do so.
-	if (!_res->_types[type][idx]._address && _res->_types[type]._mode != kDynamicResTypeMode) {
-		ensureResourceLoaded(type, idx);
+	if (_res->_types[type]._mode != kDynamicResTypeMode) {
+		if (!_res->_types[type][idx]._address)
+			ensureResourceLoaded(type, idx);
+		else
+			_res->_types[type]._hits++;
 	}
 
 	ptr = (byte *)_res->_types[type][idx]._address;
@@ -821,7 +859,7 @@ byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 
 	nukeResource(type, idx);
 
-	expireResources(size);
+	expireResources(type, size);
 
 	byte *ptr = new byte[size + SAFETY_AREA];
 	if (ptr == NULL) {
@@ -830,6 +868,9 @@ byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 
 	memset(ptr, 0, size + SAFETY_AREA);
 	_allocatedSize += size;
+	if (_allocatedSize > _allocatedSizePeak)
+		_allocatedSizePeak = _allocatedSize;
+	_types[type]._allocatedSize += size;
 
 	_types[type][idx]._address = ptr;
 	_types[type][idx]._size = size;
@@ -862,6 +903,9 @@ void ResourceManager::Resource::nuke() {
 ResourceManager::ResTypeData::ResTypeData() {
 	_mode = kDynamicResTypeMode;
 	_tag = 0;
+	_budget = 0;
+	_allocatedSize = 0;
+	_hits = _misses = _evictions = 0;
 }
 
 ResourceManager::ResTypeData::~ResTypeData() {
@@ -869,6 +913,7 @@ ResourceManager::ResTypeData::~ResTypeData() {
 
 ResourceManager::ResourceManager(ScummEngine *vm) : _vm(vm) {
 	_allocatedSize = 0;
+	_allocatedSizePeak = 0;
 	_maxHeapThreshold = 0;
 	_minHeapThreshold = 0;
 	_expireCounter = 0;
@@ -883,6 +928,24 @@ void ResourceManager::setHeapThreshold(int min, int max) {
 	assert(min <= max);
 	_maxHeapThreshold = max;
 	_minHeapThreshold = min;
+
+	// Keep a single kind of resource from pushing all others out of the
+	// heap. In particular, many sounds or costumes loaded in one room should
+	// not force the rooms visited just before to be reloaded.
+	setTypeBudget(rtRoom, max / 2);
+	setTypeBudget(rtCostume, max / 3);
+	setTypeBudget(rtSound, max / 3);
+	setTypeBudget(rtScript, max / 8);
+}
+
+void ResourceManager::setTypeBudget(ResType type, uint32 budget) {
+	assert(type >= rtFirst && type <= rtLast);
+	_types[type]._budget = budget;
+}
+
+void ResourceManager::resetStats() {
+	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1))
+		_types[type]._hits = _types[type]._misses = _types[type]._evictions = 0;
 }
 
 bool ResourceManager::validateResource(const char *str, ResType type, ResId idx) const {
@@ -898,6 +961,7 @@ void ResourceManager::nukeResource(ResType type, ResId idx) {
 	if (ptr != NULL) {
 		debugC(DEBUG_RESOURCE, "nukeResource(%s,%d)", nameOfResType(type), idx);
 		_allocatedSize -= _types[type][idx]._size;
+		_types[type]._allocatedSize -= _types[type][idx]._size;
 		_types[type][idx].nuke();
 	}
 }
@@ -1032,10 +1096,46 @@ void ResourceManager::Resource::setOnHeap() {
 	_status &= ~RF_OFFHEAP;
 }
 
-void ResourceManager::expireResources(uint32 size) {
-	byte best_counter;
-	ResType best_type;
+bool ResourceManager::expireResource(ResType onlyType) {
+	ResType best_type = rtInvalid;
 	int best_res = 0;
+	uint32 best_score = 0;
+
+	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
+		if (onlyType != rtInvalid && type != onlyType)
+			continue;
+		if (_types[type]._mode == kDynamicResTypeMode)
+			continue;
+
+		// Resources of this type can be reloaded from the data files,
+		// so we can potentially unload them to free memory.
+		ResId idx = _types[type].size();
+		while (idx-- > 0) {
+			Resource &tmp = _types[type][idx];
+			byte counter = tmp.getResourceCounter();
+			if (tmp.isLocked() || counter < 2 || !tmp._address || tmp.isOffHeap() || _vm->isResourceInUse(type, idx))
+				continue;
+
+			// Old and big resources free the most memory per reload, but
+			// resources which are expensive to reload are kept longer.
+			const uint32 score = counter * ((tmp._size >> 8) + 1) / _vm->getResourceReloadCost(type, idx);
+			if (score >= best_score) {
+				best_score = score;
+				best_type = type;
+				best_res = idx;
+			}
+		}
+	}
+
+	if (!best_type)
+		return false;
+
+	nukeResource(best_type, best_res);
+	_types[best_type]._evictions++;
+	return true;
+}
+
+void ResourceManager::expireResources(ResType type, uint32 size) {
 	uint32 oldAllocatedSize;
 
 	if (_expireCounter != 0xFF) {
@@ -1043,36 +1143,27 @@ void ResourceManager::expireResources(uint32 size) {
 		increaseResourceCounters();
 	}
 
-	if (size + _allocatedSize < _maxHeapThreshold)
+	const uint32 budget = _types[type]._budget;
+	const bool overBudget = budget && size + _types[type]._allocatedSize > budget;
+
+	if (size + _allocatedSize < _maxHeapThreshold && !overBudget)
 		return;
 
 	oldAllocatedSize = _allocatedSize;
 
-	do {
-		best_type = rtInvalid;
-		best_counter = 2;
-
-		for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
-			if (_types[type]._mode != kDynamicResTypeMode) {
-				// Resources of this type can be reloaded from the data files,
-				// so we can potentially unload them to free memory.
-				ResId idx = _types[type].size();
-				while (idx-- > 0) {
-					Resource &tmp = _types[type][idx];
-					byte counter = tmp.getResourceCounter();
-					if (!tmp.isLocked() && counter >= best_counter && tmp._address && !_vm->isResourceInUse(type, idx) && !tmp.isOffHeap()) {
-						best_counter = counter;
-						best_type = type;
-						best_res = idx;
-					}
-				}
-			}
+	if (overBudget) {
+		while (size + _types[type]._allocatedSize > budget) {
+			if (!expireResource(type))
+				break;
 		}
+	}
 
-		if (!best_type)
-			break;
-		nukeResource(best_type, best_res);
-	} while (size + _allocatedSize > _minHeapThreshold);
+	if (size + _allocatedSize >= _maxHeapThreshold) {
+		do {
+			if (!expireResource(rtInvalid))
+				break;
+		} while (size + _allocatedSize > _minHeapThreshold);
+	}
 
 	increaseResourceCounters();
 
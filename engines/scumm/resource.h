@@ -164,6 +164,24 @@ public:
 		 */
 		uint32 _tag;
 
+		/**
+		 * The number of bytes the resources of this type may occupy, or 0 if
+		 * they are only limited by the heap threshold.
+		 */
+		uint32 _budget;
+
+		/**
+		 * The number of bytes the loaded resources of this type occupy.
+		 */
+		uint32 _allocatedSize;
+
+		/**
+		 * Access statistics, for debugging purposes: how often a resource
+		 * of this type was requested while loaded resp. not loaded, and how
+		 * often one was expired to make room for other resources.
+		 */
+		uint32 _hits, _misses, _evictions;
+
 	public:
 		ResTypeData();
 		~ResTypeData();
@@ -172,6 +190,7 @@ public:
 
 protected:
 	uint32 _allocatedSize;
+	uint32 _allocatedSizePeak;
 	uint32 _maxHeapThreshold, _minHeapThreshold;
 	byte _expireCounter;
 
@@ -181,6 +200,22 @@ public:
 
 	void setHeapThreshold(int min, int max);
 
+	/**
+	 * Limit the memory used by the resources of the given type. Once they
+	 * exceed the budget, resources of that type are expired even if the heap
+	 * threshold is not reached yet. A budget of 0 removes the limit.
+	 */
+	void setTypeBudget(ResType type, uint32 budget);
+
+	/** Reset the hit, miss and eviction counters of all resource types. */
+	void resetStats();
+
+	uint32 getMaxHeapThreshold() const { return _maxHeapThreshold; }
+
+	uint32 getAllocatedSize() const { return _allocatedSize; }
+	/** The largest size the resource heap had so far */
+	uint32 getAllocatedSizePeak() const { return _allocatedSizePeak; }
+
 	void allocResTypeData(ResType type, uint32 tag, int num, ResTypeMode mode);
 	void freeResources();
 
@@ -227,7 +262,16 @@ public:
 //protected:
 	bool validateResource(const char *str, ResType type, ResId idx) const;
 protected:
-	void expireResources(uint32 size);
+	void expireResources(ResType type, uint32 size);
+
+	/**
+	 * Expire the least valuable resource which can be reloaded from the data
+	 * files, either of the given type or of any type if rtInvalid is passed.
+	 * The value of a resource is weighed by its age, its size and the cost to
+	 * reload it, see ScummEngine::getResourceReloadCost.
+	 * @return false if there was no resource which could be expired
+	 */
+	bool expireResource(ResType type);
 };
 
 } // End of namespace Scumm
@@ -483,6 +483,7 @@ void ScummEngine::executeScript() {
 			debugN("\n");
 		}
 
+		_opcodeCount++;
 		executeOpcode(_opcode);
 
 	}
@@ -64,6 +64,7 @@
 #include "scumm/player_v3m.h"
 #include "scumm/player_v4a.h"
 #include "scumm/player_v5m.h"
+#include "scumm/prefetch.h"
 #include "scumm/resource.h"
 #include "scumm/he/resource_he.h"
 #include "scumm/scumm_v0.h"
@@ -81,16 +82,8 @@
 
 #include "audio/mixer.h"
 
-#ifdef EMSCRIPTEN
-#include "emscripten/emscripten.h"
-#endif
-
 using Common::File;
 
-typedef void (*FuncPtr)();
-extern FuncPtr mainLoopUpdateFunc;
-extern void emscriptenUpdate(void *);
-
 namespace Scumm {
 
 // Use g_scumm from error() ONLY
@@ -173,6 +166,10 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 	_pauseDialog = NULL;
 	_versionDialog = NULL;
 	_fastMode = 0;
+	_mainLoopDelta = 1;
+	_opcodeCount = 0;
+	_nextStepTime = 0;
+	_prefetcher = 0;
 	_actors = _sortedActors = NULL;
 	_arraySlot = NULL;
 	_inventory = NULL;
@@ -651,6 +648,10 @@ ScummEngine::~ScummEngine() {
 
 	delete _debugger;
 
+	if (_prefetcher)
+		_prefetcher->saveHistory();
+	delete _prefetcher;
+
 	delete _res;
 	delete _gdi;
 }
@@ -1212,6 +1213,9 @@ Common::Error ScummEngine::init() {
 	// Create the debugger now that _numVariables has been set
 	_debugger = new ScummDebugger(this);
 
+	_prefetcher = new RoomPrefetcher(this);
+	_prefetcher->loadHistory();
+
 	resetScumm();
 	resetScummVars();
 
@@ -1972,29 +1976,44 @@ int ScummEngine::getTalkSpeed() {
 #pragma mark --- Main loop ---
 #pragma mark -
 
-namespace
-{
-	int diff = 0;	// Duration of one loop iteration
-	int delta = 1;
-	ScummEngine *e = 0;
-}
+Common::Error ScummEngine::beginSteps() {
+	Common::Error err = init();
+	if (err.getCode() != Common::kNoError)
+		return err;
 
-void ScummEngine::updateIteration()
-{
-	// Start the stop watch!
-	diff = _system->getMillis();
+	setTotalPlayTime();
 
-	// Run the main loop
-	scummLoop(delta);
+	// If requested, load a save game instead of running the boot script
+	if (_saveLoadFlag != 2 || !loadState(_saveLoadSlot, _saveTemporaryState)) {
+		_saveLoadFlag = 0;
+		runBootscript();
+	} else {
+		_saveLoadFlag = 0;
+	}
 
-	// Halt the stop watch and compute how much time this iteration took.
-	diff = _system->getMillis() - diff;
+	_mainLoopDelta = 1;
+
+	return Common::kNoError;
+}
 
+int32 ScummEngine::runStep() {
+	// Several instances may be stepped in turn by the same host
+	g_scumm = this;
 
 	if (shouldQuit()) {
 		// TODO: Maybe perform an autosave on exit?
+		return kStepFinished;
 	}
 
+	// Start the stop watch!
+	int diff = _system->getMillis();	// Duration of one loop iteration
+
+	// Run the main loop
+	scummLoop(_mainLoopDelta);
+
+	// Halt the stop watch and compute how much time this iteration took.
+	diff = _system->getMillis() - diff;
+
 	_debugger->onFrame();
 
 	// Randomize the PRNG by calling it at regular intervals. This ensures
@@ -2008,9 +2027,9 @@ void ScummEngine::updateIteration()
 		VAR(VAR_TIMER_TOTAL) += diff * 60 / 1000;
 
 	// Determine how long to wait before the next loop iteration should start
-	delta = (VAR_TIMER_NEXT != 0xFF) ? VAR(VAR_TIMER_NEXT) : 4;
-	if (delta < 1)	// Ensure we don't get into an endless loop
-		delta = 1;  // by not decreasing sleepers.
+	_mainLoopDelta = (VAR_TIMER_NEXT != 0xFF) ? VAR(VAR_TIMER_NEXT) : 4;
+	if (_mainLoopDelta < 1)	// Ensure we don't get into an endless loop
+		_mainLoopDelta = 1;  // by not decreasing sleepers.
 
 	// WORKAROUND: walking speed in the original v0/v1 interpreter
 	// is sometimes slower (e.g. during scrolling) than in ScummVM.
@@ -2018,74 +2037,58 @@ void ScummEngine::updateIteration()
 	// otherwise (delta < 6) a single kid is able to escape.
 	if ((_game.version == 0 && isScriptRunning(132)) ||
 		(_game.version == 1 && isScriptRunning(137)))
-		delta = 6;
+		_mainLoopDelta = 6;
 
-	// Wait...
-	waitForTimer(delta * 1000 / 60 - diff);
-}
-void updateIterationGlobal()
-{
-	if (e)
-		e->updateIteration();
-}
+	// Wait... The caller presents the frame via idleStep() and keeps doing
+	// so until the delay has passed, see Engine::runSteps().
+	int msec_delay = _mainLoopDelta * 1000 / 60 - diff;
+	if (_fastMode & 2)
+		msec_delay = 0;
+	else if (_fastMode & 1)
+		msec_delay = 10;
 
-Common::Error ScummEngine::go() {
-	setTotalPlayTime();
+	msec_delay = MAX(msec_delay, 0);
+	_nextStepTime = _system->getMillis() + msec_delay;
 
-	// If requested, load a save game instead of running the boot script
-	if (_saveLoadFlag != 2 || !loadState(_saveLoadSlot, _saveTemporaryState)) {
-		_saveLoadFlag = 0;
-		runBootscript();
-	} else {
-		_saveLoadFlag = 0;
-	}
+	return msec_delay;
+}
 
-	diff = 0;
-	e = this;
-	mainLoopUpdateFunc = updateIterationGlobal;
+void ScummEngine::idleStep() {
+	g_scumm = this;
+	presentFrame();
 
-/*
-	while (!shouldQuit()) {
-		updateIteration();
-	}
-*/
+	// Use the time left until the next iteration to load the rooms which
+	// are likely to be entered next
+	const int32 timeLeft = (int32)(_nextStepTime - _system->getMillis()) - 1;
+	if (_prefetcher && timeLeft > 0)
+		_prefetcher->run(MIN<int32>(timeLeft, RoomPrefetcher::kMaxBudget));
+}
 
+Common::Error ScummEngine::endSteps() {
 	return Common::kNoError;
 }
 
-uint32 nextUpdateTime = 0;
-
-void emscriptenWaitForUpdate(void *)
-{
-	if (e)
-		e->waitForNextUpdate();
+void ScummEngine::getStepStats(StepStats &stats) const {
+	stats.opcodes = _opcodeCount;
+	stats.heapSize = _res->getAllocatedSize();
+	stats.heapPeak = _res->getAllocatedSizePeak();
 }
 
-void ScummEngine::waitForNextUpdate() {
-	_sound->updateCD();
+void ScummEngine::presentFrame() {
+	_sound->updateCD(); // Loop CD Audio if needed
 	parseEvents();
 
 #ifndef DISABLE_TOWNS_DUAL_LAYER_MODE
-                if (_townsScreen)
-                        _townsScreen->update();
+	if (_townsScreen)
+		_townsScreen->update();
 #endif
 
-                _system->updateScreen();
-
-	uint32 t = _system->getMillis();
-	if (t >= nextUpdateTime || (t < nextUpdateTime && nextUpdateTime - t > 1000))
-	{
-		emscriptenUpdate(0);
-		return;
-	}
-	else {
-                emscripten_async_call(emscriptenWaitForUpdate, 0, 5);
-	}
+	_system->updateScreen();
 }
 
 void ScummEngine::waitForTimer(int msec_delay) {
 	uint32 start_time;
-//	warning("msec delay: %d", msec_delay);
+
 	if (_fastMode & 2)
 		msec_delay = 0;
 	else if (_fastMode & 1)
@@ -2093,28 +2096,13 @@ void ScummEngine::waitForTimer(int msec_delay) {
 
 	start_time = _system->getMillis();
 
-#ifndef EMSCRIPTEN
-	while (!shouldQuit())
-#endif
-{
-		_sound->updateCD(); // Loop CD Audio if needed
-		parseEvents();
-
-#ifndef DISABLE_TOWNS_DUAL_LAYER_MODE
-		if (_townsScreen)
-			_townsScreen->update();
-#endif
+	while (!shouldQuit()) {
+		presentFrame();
 
-		_system->updateScreen();
 #ifdef EMSCRIPTEN
-//		msec_delay = 100;
-		if (msec_delay < 1)
-			msec_delay = 1;
-		if (msec_delay > 110)
-			msec_delay = 110;
-		nextUpdateTime = start_time + msec_delay;
-		emscripten_async_call(emscriptenWaitForUpdate, 0, 1);
-		return;
+		// Blocking is not possible in the browser; the main loop
+		// iteration itself is paced by the host, see runStep().
+		break;
 #else
 		if (_system->getMillis() >= start_time + msec_delay)
 			break;
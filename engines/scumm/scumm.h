@@ -35,6 +35,7 @@
 #include "common/rendermode.h"
 #include "common/str.h"
 #include "common/textconsole.h"
+#include "graphics/dirty_region.h"
 #include "graphics/surface.h"
 #include "graphics/sjis.h"
 
@@ -361,15 +362,17 @@ enum ResType {
 typedef uint16 ResId;
 
 class ResourceManager;
+class RoomPrefetcher;
 
 /**
  * Base class for all SCUMM engines.
  */
-class ScummEngine : public Engine {
+class ScummEngine : public Engine, public EngineStepper {
 	friend class ScummDebugger;
 	friend class CharsetRenderer;
 	friend class CharsetRendererTownsClassic;
 	friend class ResourceManager;
+	friend class RoomPrefetcher;
 
 public:
 	/* Put often used variables at the top.
@@ -410,15 +413,10 @@ public:
 
 	// Engine APIs
 	Common::Error init();
-	Common::Error go();
-	void updateIteration();
 	virtual Common::Error run() {
-		Common::Error err;
-		err = init();
-		if (err.getCode() != Common::kNoError)
-			return err;
-		return go();
+		return runSteps(*this);
 	}
+	virtual EngineStepper *getStepper() { return this; }
 	virtual void errorString(const char *buf_input, char *buf_output, int buf_output_size);
 	virtual GUI::Debugger *getDebugger();
 	virtual bool hasFeature(EngineFeature f) const;
@@ -431,6 +429,13 @@ public:
 
 	virtual void pauseEngineIntern(bool pause);
 
+	// EngineStepper APIs
+	virtual Common::Error beginSteps();
+	virtual int32 runStep();
+	virtual void idleStep();
+	virtual Common::Error endSteps();
+	virtual void getStepStats(StepStats &stats) const;
+
 protected:
 	virtual void setupScumm();
 	virtual void resetScumm();
@@ -461,7 +466,7 @@ protected:
 	// Event handling
 public:
 	void parseEvents();	// Used by IMuseDigital::startSound
-	void waitForNextUpdate();
+	void presentFrame();
 protected:
 	virtual void parseEvent(Common::Event event);
 
@@ -497,6 +502,17 @@ protected:
 
 	byte _fastMode;
 
+	/** Ticks (1/60 s) between two main loop iterations, passed to scummLoop() */
+	int _mainLoopDelta;
+
+	/** Number of script opcodes executed, see getStepStats() */
+	uint32 _opcodeCount;
+
+	/** Time at which the next main loop iteration is due */
+	uint32 _nextStepTime;
+
+	RoomPrefetcher *_prefetcher;
+
 	byte _numActors;
 	Actor **_actors;	// Has _numActors elements
 	Actor **_sortedActors;
@@ -759,6 +775,12 @@ protected:
 	int readSoundResourceSmallHeader(ResId idx);
 	bool isResourceInUse(ResType type, ResId idx) const;
 
+	/**
+	 * Estimate how expensive it is to load the given resource again once it
+	 * was expired, relative to reading it from the currently opened room.
+	 */
+	uint getResourceReloadCost(ResType type, ResId idx) const;
+
 	virtual void setupRoomSubBlocks();
 	virtual void resetRoomSubBlocks();
 
@@ -1032,6 +1054,10 @@ protected:
 	byte *_compositeBuf;
 	byte *_herculesBuf;
 
+	/** Coalesces the dirty strips of a virtual screen, see updateDirtyScreen() */
+	Graphics::DirtyRegion _dirtyRegion;
+	Common::Array<Common::Rect> _dirtyRects;
+
 	virtual void drawDirtyScreenParts();
 	void updateDirtyScreen(VirtScreenNumber slot);
 	void drawStripToScreen(VirtScreen *vs, int x, int w, int t, int b);
@@ -1818,18 +1818,14 @@ int ScummEngine::readSoundResourceSmallHeader(ResId idx) {
 	if ((_game.id == GID_LOOM) && (_game.version == 3) && (_game.platform == Common::kPlatformDOS) && VAR(VAR_SOUNDCARD) == 4) {
 		// Roland resources in Loom are tagless
 		// So we add an RO tag to allow imuse to detect format
-		byte *ptr, *src_ptr;
+		byte *ptr;
 		ro_offs = _fileHandle->pos();
 		ro_size = _fileHandle->readUint16LE();
-
-		src_ptr = (byte *) calloc(ro_size - 4, 1);
 		_fileHandle->seek(ro_offs + 4, SEEK_SET);
-		_fileHandle->read(src_ptr, ro_size -4);
 
 		ptr = _res->createResource(rtSound, idx, ro_size + 2);
 		memcpy(ptr, "RO", 2); ptr += 2;
-		memcpy(ptr, src_ptr, ro_size - 4); ptr += ro_size - 4;
-		free(src_ptr);
+		_fileHandle->read(ptr, ro_size - 4);
 		return 1;
 	} else if (_game.features & GF_OLD_BUNDLE) {
 		wa_offs = _fileHandle->pos();
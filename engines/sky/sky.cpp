@@ -78,7 +78,7 @@ void *SkyEngine::_itemList[300];
 SystemVars SkyEngine::_systemVars = {0, 0, 0, 0, 4316, 0, 0, false, false };
 
 SkyEngine::SkyEngine(OSystem *syst)
-	: Engine(syst), _fastMode(0), _debugger(0) {
+	: Engine(syst), _fastMode(0), _debugger(0), _lastSaveTime(0), _delayCount(0) {
 }
 
 SkyEngine::~SkyEngine() {
@@ -167,7 +167,11 @@ void SkyEngine::handleKey() {
 	_keyPressed.reset();
 }
 
-Common::Error SkyEngine::go() {
+Common::Error SkyEngine::beginSteps() {
+	Common::Error err = init();
+	if (err.getCode() != Common::kNoError)
+		return err;
+
 	_keyPressed.reset();
 
 	uint16 result = 0;
@@ -194,9 +198,22 @@ Common::Error SkyEngine::go() {
 	}
 
 	_lastSaveTime = _system->getMillis();
+	_delayCount = _system->getMillis();
+
+	return Common::kNoError;
+}
 
-	uint32 delayCount = _system->getMillis();
-	while (!shouldQuit()) {
+int32 SkyEngine::runStep() {
+	if (shouldQuit())
+		return kStepFinished;
+
+	if (_systemVars.paused) {
+		// Wait for a key press to unpause the game, see handleKey()
+		handleKey();
+		if (_systemVars.paused)
+			return 50;
+		_delayCount = _system->getMillis();
+	} else {
 		_debugger->onFrame();
 
 		if (shouldPerformAutoSave(_lastSaveTime)) {
@@ -209,43 +226,43 @@ Common::Error SkyEngine::go() {
 		_skySound->checkFxQueue();
 		_skyMouse->mouseEngine();
 		handleKey();
-		if (_systemVars.paused) {
-			do {
-				_system->updateScreen();
-				delay(50);
-				handleKey();
-			} while (_systemVars.paused);
-			delayCount = _system->getMillis();
-		}
+		if (_systemVars.paused)
+			return 50;
+	}
 
-		_skyLogic->engine();
-		_skyScreen->processSequence();
-		_skyScreen->recreate();
-		_skyScreen->spriteEngine();
-		if (_debugger->showGrid()) {
-			uint8 *grid = _skyLogic->_skyGrid->giveGrid(Logic::_scriptVariables[SCREEN]);
-			if (grid) {
-				_skyScreen->showGrid(grid);
-				_skyScreen->forceRefresh();
-			}
-		}
-		_skyScreen->flip();
-
-		if (_fastMode & 2)
-			delay(0);
-		else if (_fastMode & 1)
-			delay(10);
-		else {
-			delayCount += _systemVars.gameSpeed;
-			int needDelay = delayCount - (int)_system->getMillis();
-			if ((needDelay < 0) || (needDelay > _systemVars.gameSpeed)) {
-				needDelay = 0;
-				delayCount = _system->getMillis();
-			}
-			delay(needDelay);
+	_skyLogic->engine();
+	_skyScreen->processSequence();
+	_skyScreen->recreate();
+	_skyScreen->spriteEngine();
+	if (_debugger->showGrid()) {
+		uint8 *grid = _skyLogic->_skyGrid->giveGrid(Logic::_scriptVariables[SCREEN]);
+		if (grid) {
+			_skyScreen->showGrid(grid);
+			_skyScreen->forceRefresh();
 		}
 	}
+	_skyScreen->flip();
+
+	if (_fastMode & 2)
+		return 0;
+	else if (_fastMode & 1)
+		return 10;
+
+	_delayCount += _systemVars.gameSpeed;
+	int needDelay = _delayCount - (int)_system->getMillis();
+	if ((needDelay < 0) || (needDelay > _systemVars.gameSpeed)) {
+		needDelay = 0;
+		_delayCount = _system->getMillis();
+	}
+	return needDelay;
+}
+
+void SkyEngine::idleStep() {
+	processEvents();
+	_system->updateScreen();
+}
 
+Common::Error SkyEngine::endSteps() {
 	_skyControl->showGameQuitMsg();
 	_skyMusic->stopMusic();
 	ConfMan.flushToDisk();
@@ -387,9 +404,35 @@ void *SkyEngine::fetchItem(uint32 num) {
 	return _itemList[num];
 }
 
-void SkyEngine::delay(int32 amount) {
+void SkyEngine::processEvents() {
 	Common::Event event;
 
+	while (_eventMan->pollEvent(event)) {
+		switch (event.type) {
+		case Common::EVENT_KEYDOWN:
+			_keyPressed = event.kbd;
+			break;
+		case Common::EVENT_MOUSEMOVE:
+			if (!(_systemVars.systemFlags & SF_MOUSE_LOCKED))
+				_skyMouse->mouseMoved(event.mouse.x, event.mouse.y);
+			break;
+		case Common::EVENT_LBUTTONDOWN:
+			if (!(_systemVars.systemFlags & SF_MOUSE_LOCKED))
+				_skyMouse->mouseMoved(event.mouse.x, event.mouse.y);
+			_skyMouse->buttonPressed(2);
+			break;
+		case Common::EVENT_RBUTTONDOWN:
+			if (!(_systemVars.systemFlags & SF_MOUSE_LOCKED))
+				_skyMouse->mouseMoved(event.mouse.x, event.mouse.y);
+			_skyMouse->buttonPressed(1);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void SkyEngine::delay(int32 amount) {
 	uint32 start = _system->getMillis();
 	_keyPressed.reset();
 
@@ -397,29 +440,7 @@ void SkyEngine::delay(int32 amount) {
 		amount = 0;
 
 	do {
-		while (_eventMan->pollEvent(event)) {
-			switch (event.type) {
-			case Common::EVENT_KEYDOWN:
-				_keyPressed = event.kbd;
-				break;
-			case Common::EVENT_MOUSEMOVE:
-				if (!(_systemVars.systemFlags & SF_MOUSE_LOCKED))
-					_skyMouse->mouseMoved(event.mouse.x, event.mouse.y);
-				break;
-			case Common::EVENT_LBUTTONDOWN:
-				if (!(_systemVars.systemFlags & SF_MOUSE_LOCKED))
-					_skyMouse->mouseMoved(event.mouse.x, event.mouse.y);
-				_skyMouse->buttonPressed(2);
-				break;
-			case Common::EVENT_RBUTTONDOWN:
-				if (!(_systemVars.systemFlags & SF_MOUSE_LOCKED))
-					_skyMouse->mouseMoved(event.mouse.x, event.mouse.y);
-				_skyMouse->buttonPressed(1);
-				break;
-			default:
-				break;
-			}
-		}
+		processEvents();
 
 		_system->updateScreen();
 
@@ -61,7 +61,7 @@ class MusicBase;
 class Debugger;
 class SkyCompact;
 
-class SkyEngine : public Engine {
+class SkyEngine : public Engine, public EngineStepper {
 protected:
 	Common::KeyState _keyPressed;
 
@@ -99,23 +99,28 @@ public:
 protected:
 	// Engine APIs
 	Common::Error init();
-	Common::Error go();
 	virtual Common::Error run() {
-		Common::Error err;
-		err = init();
-		if (err.getCode() != Common::kNoError)
-			return err;
-		return go();
+		return runSteps(*this);
 	}
+	virtual EngineStepper *getStepper() { return this; }
 	virtual GUI::Debugger *getDebugger();
 	virtual bool hasFeature(EngineFeature f) const;
 
+	// EngineStepper APIs
+	virtual Common::Error beginSteps();
+	virtual int32 runStep();
+	virtual void idleStep();
+	virtual Common::Error endSteps();
+
 	byte _fastMode;
 
 	void delay(int32 amount);
+	void processEvents();
 	void handleKey();
 
 	uint32 _lastSaveTime;
+	/** Time at which the current game cycle is due, see runStep() */
+	uint32 _delayCount;
 
 	void initItemList();
 
@@ -0,0 +1,192 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/dirty_region.h"
+
+namespace Graphics {
+
+DirtyRegion::DirtyRegion()
+	: _width(0), _height(0), _tileWidth(1), _tileHeight(1), _cols(0), _rows(0),
+	  _wordsPerRow(0), _empty(true), _markedPixels(0) {
+	resetStats();
+}
+
+void DirtyRegion::init(int width, int height, int tileWidth, int tileHeight) {
+	assert(tileWidth > 0 && tileHeight > 0);
+
+	_width = MAX(width, 0);
+	_height = MAX(height, 0);
+	_tileWidth = tileWidth;
+	_tileHeight = tileHeight;
+	_cols = (_width + tileWidth - 1) / tileWidth;
+	_rows = (_height + tileHeight - 1) / tileHeight;
+	_wordsPerRow = (_cols + 31) / 32;
+
+	_bits.resize(_rows * _wordsPerRow);
+	clear();
+}
+
+void DirtyRegion::addRect(int x, int y, int w, int h) {
+	// clip
+	if (x < 0) {
+		w += x;
+		x = 0;
+	}
+	if (y < 0) {
+		h += y;
+		y = 0;
+	}
+	w = MIN(w, _width - x);
+	h = MIN(h, _height - y);
+	if (w <= 0 || h <= 0)
+		return;
+
+	_markedPixels += w * h;
+	_empty = false;
+
+	const int col0 = x / _tileWidth;
+	const int col1 = (x + w - 1) / _tileWidth;
+	const int row0 = y / _tileHeight;
+	const int row1 = (y + h - 1) / _tileHeight;
+
+	for (int row = row0; row <= row1; ++row) {
+		uint32 *bits = &_bits[row * _wordsPerRow];
+		for (int col = col0; col <= col1; ++col)
+			bits[col / 32] |= 1u << (col & 31);
+	}
+}
+
+void DirtyRegion::addAll() {
+	addRect(0, 0, _width, _height);
+}
+
+void DirtyRegion::clear() {
+	for (uint i = 0; i < _bits.size(); ++i)
+		_bits[i] = 0;
+	_empty = true;
+	_markedPixels = 0;
+}
+
+void DirtyRegion::resetStats() {
+	memset(&_lastStats, 0, sizeof(_lastStats));
+	memset(&_totalStats, 0, sizeof(_totalStats));
+}
+
+void DirtyRegion::coalesce(Common::Array<Common::Rect> &rects, int maxGap) const {
+	Common::Array<Span> open, runs;
+
+	// The extra row without any dirty tiles closes all open rectangles
+	for (int row = 0; row <= _rows; ++row) {
+		runs.clear();
+		if (row < _rows) {
+			int col = 0;
+			while (col < _cols) {
+				if (!isDirty(col, row)) {
+					++col;
+					continue;
+				}
+
+				Span run;
+				run.col0 = col;
+				run.col1 = ++col;
+				while (col < _cols && col - run.col1 <= maxGap) {
+					if (isDirty(col, row))
+						run.col1 = col + 1;
+					++col;
+				}
+				col = run.col1;
+				run.row0 = row;
+				runs.push_back(run);
+			}
+		}
+
+		// Continue the rectangles of the row above with identical runs
+		for (uint i = 0; i < runs.size(); ++i) {
+			for (uint j = 0; j < open.size(); ++j) {
+				if (open[j].col0 == runs[i].col0 && open[j].col1 == runs[i].col1) {
+					runs[i].row0 = open[j].row0;
+					open.remove_at(j);
+					break;
+				}
+			}
+		}
+
+		// Whatever was not continued is finished
+		for (uint j = 0; j < open.size(); ++j) {
+			rects.push_back(Common::Rect(open[j].col0 * _tileWidth, open[j].row0 * _tileHeight,
+				MIN(open[j].col1 * _tileWidth, _width), MIN(row * _tileHeight, _height)));
+		}
+
+		open = runs;
+	}
+}
+
+void DirtyRegion::flush(Common::Array<Common::Rect> &rects, uint maxRects) {
+	if (_empty)
+		return;
+
+	assert(maxRects > 0);
+
+	Common::Array<Common::Rect> result;
+	int maxGap = 0;
+	coalesce(result, maxGap);
+
+	// Too many rectangles: first bridge ever bigger gaps within the rows,
+	// then merge neighboring rectangles
+	while (result.size() > maxRects && maxGap < _cols) {
+		maxGap = maxGap ? maxGap * 2 : 1;
+		result.clear();
+		coalesce(result, maxGap);
+	}
+
+	if (result.size() > maxRects) {
+		const uint perRect = (result.size() + maxRects - 1) / maxRects;
+		Common::Array<Common::Rect> merged;
+		for (uint i = 0; i < result.size(); i += perRect) {
+			Common::Rect r = result[i];
+			for (uint j = i + 1; j < i + perRect && j < result.size(); ++j)
+				r.extend(result[j]);
+			merged.push_back(r);
+		}
+		result = merged;
+	}
+
+	Stats stats;
+	stats.flushes = 1;
+	stats.rects = result.size();
+	stats.markedPixels = _markedPixels;
+	stats.presentedPixels = 0;
+	for (uint i = 0; i < result.size(); ++i) {
+		stats.presentedPixels += result[i].width() * result[i].height();
+		rects.push_back(result[i]);
+	}
+
+	_lastStats = stats;
+	_totalStats.flushes += stats.flushes;
+	_totalStats.rects += stats.rects;
+	_totalStats.markedPixels += stats.markedPixels;
+	_totalStats.presentedPixels += stats.presentedPixels;
+
+	clear();
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_DIRTY_REGION_H
+#define GRAPHICS_DIRTY_REGION_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * Collects the dirty parts of a screen and coalesces them into a small
+ * number of rectangles.
+ *
+ * The screen is divided into tiles; every rectangle added marks the tiles
+ * it touches in a bitmap. flush() turns the bitmap into rectangles: runs of
+ * dirty tiles in a tile row are joined with identical runs in the rows
+ * below. If that still gives too many rectangles, small gaps between the
+ * runs are bridged, but the region never grows into a full screen update
+ * unless the whole screen is dirty.
+ */
+class DirtyRegion {
+public:
+	/** Statistics about the flushed regions. */
+	struct Stats {
+		uint32 flushes;		///< number of flushes with at least one dirty tile
+		uint32 rects;		///< number of rectangles handed out
+		uint32 markedPixels;	///< area of all rectangles added, overlaps counted once per add
+		uint32 presentedPixels;	///< area of all rectangles handed out
+	};
+
+	DirtyRegion();
+
+	/**
+	 * Set the size of the screen and of the tiles, and clear the region.
+	 * Smaller tiles give tighter rectangles at the cost of a bigger bitmap.
+	 */
+	void init(int width, int height, int tileWidth, int tileHeight);
+
+	int getWidth() const { return _width; }
+	int getHeight() const { return _height; }
+
+	/** Mark a rectangle as dirty. It is clipped to the screen. */
+	void addRect(int x, int y, int w, int h);
+	void addRect(const Common::Rect &r) { addRect(r.left, r.top, r.width(), r.height()); }
+
+	/** Mark the whole screen as dirty. */
+	void addAll();
+
+	bool isEmpty() const { return _empty; }
+
+	/** Discard the dirty region without handing it out. */
+	void clear();
+
+	/**
+	 * Append rectangles covering the dirty region to rects and clear the
+	 * region.
+	 *
+	 * @param maxRects  the maximal number of rectangles to append, at least 1
+	 */
+	void flush(Common::Array<Common::Rect> &rects, uint maxRects = 0xFFFFFFFF);
+
+	/** Statistics of the last flush which had anything to hand out. */
+	const Stats &getLastStats() const { return _lastStats; }
+
+	/** Statistics accumulated since the last resetStats(). */
+	const Stats &getTotalStats() const { return _totalStats; }
+
+	void resetStats();
+
+private:
+	int _width, _height;
+	int _tileWidth, _tileHeight;
+	int _cols, _rows;
+
+	/** One bit per tile, each tile row starts at a new word */
+	Common::Array<uint32> _bits;
+	uint _wordsPerRow;
+	bool _empty;
+
+	uint32 _markedPixels;
+	Stats _lastStats, _totalStats;
+
+	/** A run of dirty tiles, while building the rectangles */
+	struct Span {
+		int col0, col1;	///< dirty columns [col0, col1)
+		int row0;	///< first row of the rectangle this run belongs to
+	};
+
+	bool isDirty(int col, int row) const {
+		return (_bits[row * _wordsPerRow + col / 32] & (1u << (col & 31))) != 0;
+	}
+
+	/**
+	 * Build the rectangles, treating gaps of up to maxGap clean tiles between
+	 * two dirty tiles in the same row as dirty.
+	 */
+	void coalesce(Common::Array<Common::Rect> &rects, int maxGap) const;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,169 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/palette_lut.h"
+
+// Neither SSE2 nor WebAssembly SIMD has a byte gather, so the table lookups
+// themselves stay scalar. The kernels do however assemble 8 or 16 converted
+// pixels in vector registers and write them out with full width stores,
+// which is where the per-pixel conversion spent most of its time.
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define PALETTE_LUT_WASM_SIMD
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PALETTE_LUT_SSE2
+#endif
+
+namespace Graphics {
+
+void PaletteLUT::update(const byte *colors, uint start, uint num, uint stride) {
+	assert(start + num <= 256);
+
+	for (uint i = start; i < start + num; ++i, colors += stride) {
+		const byte r = colors[0];
+		const byte g = colors[1];
+		const byte b = colors[2];
+
+		rgb565[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+		abgr8888[i] = 0xFF000000 | (b << 16) | (g << 8) | r;
+	}
+}
+
+void PaletteLUT::convertRow(uint16 *dst, const byte *src, uint width) const {
+	const uint16 *lut = rgb565;
+
+#if defined(PALETTE_LUT_WASM_SIMD)
+	for (; width >= 16; width -= 16, src += 16, dst += 16) {
+		wasm_v128_store(dst, wasm_u16x8_make(lut[src[0]], lut[src[1]], lut[src[2]], lut[src[3]],
+		                                     lut[src[4]], lut[src[5]], lut[src[6]], lut[src[7]]));
+		wasm_v128_store(dst + 8, wasm_u16x8_make(lut[src[8]], lut[src[9]], lut[src[10]], lut[src[11]],
+		                                         lut[src[12]], lut[src[13]], lut[src[14]], lut[src[15]]));
+	}
+#elif defined(PALETTE_LUT_SSE2)
+	for (; width >= 16; width -= 16, src += 16, dst += 16) {
+		_mm_storeu_si128((__m128i *)dst, _mm_setr_epi16(lut[src[0]], lut[src[1]], lut[src[2]], lut[src[3]],
+		                                                lut[src[4]], lut[src[5]], lut[src[6]], lut[src[7]]));
+		_mm_storeu_si128((__m128i *)(dst + 8), _mm_setr_epi16(lut[src[8]], lut[src[9]], lut[src[10]], lut[src[11]],
+		                                                      lut[src[12]], lut[src[13]], lut[src[14]], lut[src[15]]));
+	}
+#endif
+
+	for (; width >= 8; width -= 8, src += 8, dst += 8) {
+		dst[0] = lut[src[0]];
+		dst[1] = lut[src[1]];
+		dst[2] = lut[src[2]];
+		dst[3] = lut[src[3]];
+		dst[4] = lut[src[4]];
+		dst[5] = lut[src[5]];
+		dst[6] = lut[src[6]];
+		dst[7] = lut[src[7]];
+	}
+
+	while (width--)
+		*dst++ = lut[*src++];
+}
+
+void PaletteLUT::convertRow(uint32 *dst, const byte *src, uint width) const {
+	const uint32 *lut = abgr8888;
+
+#if defined(PALETTE_LUT_WASM_SIMD)
+	for (; width >= 8; width -= 8, src += 8, dst += 8) {
+		wasm_v128_store(dst, wasm_u32x4_make(lut[src[0]], lut[src[1]], lut[src[2]], lut[src[3]]));
+		wasm_v128_store(dst + 4, wasm_u32x4_make(lut[src[4]], lut[src[5]], lut[src[6]], lut[src[7]]));
+	}
+#elif defined(PALETTE_LUT_SSE2)
+	for (; width >= 8; width -= 8, src += 8, dst += 8) {
+		_mm_storeu_si128((__m128i *)dst, _mm_setr_epi32(lut[src[0]], lut[src[1]], lut[src[2]], lut[src[3]]));
+		_mm_storeu_si128((__m128i *)(dst + 4), _mm_setr_epi32(lut[src[4]], lut[src[5]], lut[src[6]], lut[src[7]]));
+	}
+#else
+	for (; width >= 8; width -= 8, src += 8, dst += 8) {
+		dst[0] = lut[src[0]];
+		dst[1] = lut[src[1]];
+		dst[2] = lut[src[2]];
+		dst[3] = lut[src[3]];
+		dst[4] = lut[src[4]];
+		dst[5] = lut[src[5]];
+		dst[6] = lut[src[6]];
+		dst[7] = lut[src[7]];
+	}
+#endif
+
+	while (width--)
+		*dst++ = lut[*src++];
+}
+
+namespace {
+
+inline const uint16 *lookupTable(const PaletteLUT &lut, const uint16 *) {
+	return lut.rgb565;
+}
+
+inline const uint32 *lookupTable(const PaletteLUT &lut, const uint32 *) {
+	return lut.abgr8888;
+}
+
+template<typename DstColor, int scale>
+void convertRowScaled(DstColor *dst, const byte *src, uint width, const DstColor *lut) {
+	while (width--) {
+		const DstColor color = lut[*src++];
+		dst[0] = color;
+		dst[1] = color;
+		if (scale == 3)
+			dst[2] = color;
+		dst += scale;
+	}
+}
+
+} // End of anonymous namespace
+
+template<typename DstColor>
+void PaletteLUT::convertRectScaled(byte *dst, uint dstPitch, const byte *src, uint srcPitch, uint width, uint height, uint scale) const {
+	assert(scale >= 1 && scale <= 3);
+
+	if (scale == 1) {
+		convertRect<DstColor>(dst, dstPitch, src, srcPitch, width, height);
+		return;
+	}
+
+	const DstColor *lut = lookupTable(*this, (const DstColor *)0);
+	const uint rowSize = width * scale * sizeof(DstColor);
+
+	while (height--) {
+		if (scale == 2)
+			convertRowScaled<DstColor, 2>((DstColor *)dst, src, width, lut);
+		else
+			convertRowScaled<DstColor, 3>((DstColor *)dst, src, width, lut);
+
+		for (uint i = 1; i < scale; ++i)
+			memcpy(dst + i * dstPitch, dst, rowSize);
+
+		dst += dstPitch * scale;
+		src += srcPitch;
+	}
+}
+
+template void PaletteLUT::convertRectScaled<uint16>(byte *dst, uint dstPitch, const byte *src, uint srcPitch, uint width, uint height, uint scale) const;
+template void PaletteLUT::convertRectScaled<uint32>(byte *dst, uint dstPitch, const byte *src, uint srcPitch, uint width, uint height, uint scale) const;
+
+} // End of namespace Graphics
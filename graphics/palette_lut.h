@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_PALETTE_LUT_H
+#define GRAPHICS_PALETTE_LUT_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Precomputed lookup table for converting CLUT8 pixel data to RGB.
+ *
+ * Each palette entry is kept both as RGB565 and as a 32 bit value in the
+ * 0xAABBGGRR layout used by the SDL hardware screen. The table only has to
+ * be refreshed for the palette entries which actually changed, after that
+ * whole rows can be converted without touching the palette again.
+ *
+ * This is a plain structure without constructor on purpose, so it can be
+ * embedded in C style surfaces which are allocated with malloc.
+ */
+struct PaletteLUT {
+	uint16 rgb565[256];
+	uint32 abgr8888[256];
+
+	/**
+	 * Rebuild the table entries [start, start + num).
+	 *
+	 * @param colors  the first color to use, stored as R, G, B bytes
+	 * @param start   the first palette index to update
+	 * @param num     the number of palette entries to update
+	 * @param stride  the distance in bytes between two colors in 'colors'
+	 */
+	void update(const byte *colors, uint start, uint num, uint stride = 3);
+
+	/** Convert a row of CLUT8 pixels to RGB565. */
+	void convertRow(uint16 *dst, const byte *src, uint width) const;
+
+	/** Convert a row of CLUT8 pixels to 32 bit 0xAABBGGRR. */
+	void convertRow(uint32 *dst, const byte *src, uint width) const;
+
+	/**
+	 * Convert a rectangle of CLUT8 pixels. Pitches are in bytes.
+	 */
+	template<typename DstColor>
+	void convertRect(byte *dst, uint dstPitch, const byte *src, uint srcPitch, uint width, uint height) const {
+		while (height--) {
+			convertRow((DstColor *)dst, src, width);
+			dst += dstPitch;
+			src += srcPitch;
+		}
+	}
+
+	/**
+	 * Convert a rectangle of CLUT8 pixels and enlarge it by an integer factor
+	 * with nearest neighbor sampling in the same pass. Every source row is
+	 * converted once, the duplicated rows are copied from the first one.
+	 * Pitches are in bytes.
+	 *
+	 * @note Only DstColor uint16 (RGB565) and uint32 (0xAABBGGRR) are supported.
+	 */
+	template<typename DstColor>
+	void convertRectScaled(byte *dst, uint dstPitch, const byte *src, uint srcPitch, uint width, uint height, uint scale) const;
+};
+
+} // End of namespace Graphics
+
+#endif
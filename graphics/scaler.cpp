@@ -28,10 +28,11 @@
 
 int gBitFormat = 565;
 
+#ifndef USE_HQ_SCALERS
 extern "C" {
 	uint32 *RGBtoYUV = 0;
 }
-#ifdef USE_HQ_SCALERS
+#else
 // RGB-to-YUV lookup table
 extern "C" {
 
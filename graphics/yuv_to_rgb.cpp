@@ -83,15 +83,52 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/config-manager.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define YUV_WASM_SIMD
+#define YUV_SIMD
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define YUV_SSE2
+#define YUV_SIMD
+#endif
+
+// Maximum number of threads converting an image
+static const uint kMaxThreads = 16;
+// Smaller images are not worth waking the workers for
+static const int kMinParallelPixels = 256 * 256;
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
 
 namespace Graphics {
 
+/** An image to convert, in steps of a few rows. */
+struct YUVToRGBJob {
+	YUVToRGBStepFunc convertStep;
+	int stepRows; ///< Rows converted by each step
+
+	const YUVToRGBLookup *lookup;
+	const int16 *colorTab;
+	const byte *paletteMap; ///< Set when converting to 8bpp
+
+	byte *dstPtr;
+	int dstPitch;
+
+	const byte *ySrc, *uSrc, *vSrc;
+	int yWidth, yHeight, yPitch, uvPitch;
+
+	uint threadCount; ///< Number of bands the steps are split into
+};
+
 class YUVToRGBLookup {
 public:
 	YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale);
@@ -158,7 +195,11 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 }
 
 YUVToRGBManager::YUVToRGBManager() {
-	_lookup = 0;
+	_paletteCount = 0;
+	_paletteMap = 0;
+
+	if (ConfMan.hasKey("yuv_threads"))
+		setThreadCount(MAX(ConfMan.getInt("yuv_threads"), 1));
 
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
@@ -180,122 +221,577 @@ YUVToRGBManager::YUVToRGBManager() {
 }
 
 YUVToRGBManager::~YUVToRGBManager() {
-	delete _lookup;
+	for (uint i = 0; i < _lookups.size(); i++)
+		delete _lookups[i];
+
+	delete[] _paletteMap;
 }
 
 const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
-	if (_lookup && _lookup->getFormat() == format && _lookup->getScale() == scale)
-		return _lookup;
+	// Lookups are kept until the manager is destroyed, since other threads
+	// may still be converting with them
+	_lookupLock.lock();
+
+	YUVToRGBLookup *lookup = 0;
+	for (uint i = 0; i < _lookups.size() && !lookup; i++)
+		if (_lookups[i]->getFormat() == format && _lookups[i]->getScale() == scale)
+			lookup = _lookups[i];
+
+	if (!lookup) {
+		lookup = new YUVToRGBLookup(format, scale);
+		_lookups.push_back(lookup);
+	}
+
+	_lookupLock.unlock();
+	return lookup;
+}
+
+void YUVToRGBManager::setPalette(const byte *colors, uint count) {
+	assert(count > 0 && count <= 256);
+
+	if (_paletteMap && count == _paletteCount && !memcmp(colors, _palette, count * 3))
+		return;
+
+	memcpy(_palette, colors, count * 3);
+	_paletteCount = count;
+
+	if (!_paletteMap)
+		_paletteMap = new byte[1 << 15];
+
+	for (int color = 0; color < (1 << 15); color++) {
+		// The middle of the range of 8-bit values the RGB555 color stands for
+		int r = (((color >> 10) & 0x1F) << 3) + 4;
+		int g = (((color >>  5) & 0x1F) << 3) + 4;
+		int b = (( color        & 0x1F) << 3) + 4;
+
+		int bestDistance = 0x7FFFFFFF;
+		for (uint i = 0; i < count && bestDistance > 0; i++) {
+			int dr = r - colors[i * 3 + 0];
+			int dg = g - colors[i * 3 + 1];
+			int db = b - colors[i * 3 + 2];
+
+			int distance = dr * dr + dg * dg + db * db;
+			if (distance < bestDistance) {
+				bestDistance = distance;
+				_paletteMap[color] = i;
+			}
+		}
+	}
+}
+
+uint YUVToRGBManager::setThreadCount(uint count) {
+	return _pool.setThreadCount(CLIP<uint>(count, 1, kMaxThreads));
+}
+
+void YUVToRGBManager::runJob(void *param, uint thread) {
+	const YUVToRGBJob &job = *(const YUVToRGBJob *)param;
+	int steps = job.yHeight / job.stepRows;
+	int start = (steps *  thread     ) / job.threadCount;
+	int end   = (steps * (thread + 1)) / job.threadCount;
+
+	if (!job.paletteMap) {
+		for (int i = start; i < end; i++) {
+			int row = i * job.stepRows;
+			job.convertStep(job, row, job.dstPtr + row * job.dstPitch, job.dstPitch);
+		}
+
+		return;
+	}
+
+	// Convert to RGB555 rows first, then look their colors up in the palette
+	int rowPitch = job.yWidth * sizeof(uint16);
+	uint16 *rows = (uint16 *)malloc(rowPitch * job.stepRows);
+
+	for (int i = start; i < end; i++) {
+		int row = i * job.stepRows;
+		job.convertStep(job, row, (byte *)rows, rowPitch);
+
+		for (int j = 0; j < job.stepRows; j++) {
+			const uint16 *src = rows + j * job.yWidth;
+			byte *dst = job.dstPtr + (row + j) * job.dstPitch;
+
+			for (int x = 0; x < job.yWidth; x++)
+				dst[x] = job.paletteMap[src[x]];
+		}
+	}
+
+	free(rows);
+}
+
+void YUVToRGBManager::convert(YUVToRGBJob &job, Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, YUVToRGBStepFunc convertStep16, YUVToRGBStepFunc convertStep32) {
+	Graphics::PixelFormat format = dst->format;
+
+	job.paletteMap = 0;
+	if (format.bytesPerPixel == 1) {
+		if (!_paletteMap)
+			error("YUVToRGBManager: No palette set for an 8bpp surface");
+
+		job.paletteMap = _paletteMap;
+		format = Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
+	}
 
-	delete _lookup;
-	_lookup = new YUVToRGBLookup(format, scale);
-	return _lookup;
+	// Use a templated function to avoid an if check on every pixel
+	job.convertStep = (format.bytesPerPixel == 4) ? convertStep32 : convertStep16;
+	job.lookup      = getLookup(format, scale);
+	job.colorTab    = _colorTab;
+	job.dstPtr      = (byte *)dst->pixels;
+	job.dstPitch    = dst->pitch;
+	job.threadCount = 1;
+
+	// Another thread's image may keep the workers busy, then this one is
+	// converted alone
+	if ((job.yWidth * job.yHeight >= kMinParallelPixels) && (_pool.getThreadCount() > 1)) {
+		job.threadCount = _pool.getThreadCount();
+		if (_pool.run(runJob, &job))
+			return;
+
+		job.threadCount = 1;
+	}
+
+	runJob(&job, 0);
 }
 
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
 
+#ifdef YUV_WASM_SIMD
+
+typedef v128_t YUVVec;
+
+static inline YUVVec vecLoad8(const byte *src) { return wasm_u16x8_load8x8(src); }
+static inline void vecStore(void *dst, YUVVec x) { wasm_v128_store(dst, x); }
+
+static inline YUVVec vecSplat16(uint16 x) { return wasm_i16x8_splat(x); }
+static inline YUVVec vecSplat32(uint32 x) { return wasm_i32x4_splat(x); }
+
+static inline YUVVec vecAdd16(YUVVec a, YUVVec b) { return wasm_i16x8_add(a, b); }
+static inline YUVVec vecSub16(YUVVec a, YUVVec b) { return wasm_i16x8_sub(a, b); }
+static inline YUVVec vecMin16(YUVVec a, YUVVec b) { return wasm_i16x8_min(a, b); }
+static inline YUVVec vecMax16(YUVVec a, YUVVec b) { return wasm_i16x8_max(a, b); }
+static inline YUVVec vecOr(YUVVec a, YUVVec b) { return wasm_v128_or(a, b); }
+static inline YUVVec vecXor(YUVVec a, YUVVec b) { return wasm_v128_xor(a, b); }
+
+static inline YUVVec vecShl16(YUVVec x, int n) { return wasm_i16x8_shl(x, n); }
+static inline YUVVec vecShr16(YUVVec x, int n) { return wasm_u16x8_shr(x, n); }
+static inline YUVVec vecSar16(YUVVec x, int n) { return wasm_i16x8_shr(x, n); }
+static inline YUVVec vecShl32(YUVVec x, int n) { return wasm_i32x4_shl(x, n); }
+
+/** The high halves of the unsigned products. */
+static inline YUVVec vecMulHiU16(YUVVec a, YUVVec b) {
+	YUVVec lo = wasm_u32x4_extmul_low_u16x8(a, b);
+	YUVVec hi = wasm_u32x4_extmul_high_u16x8(a, b);
+	return wasm_i16x8_shuffle(lo, hi, 1, 3, 5, 7, 9, 11, 13, 15);
+}
+
+static inline YUVVec vecDupLo16(YUVVec x) { return wasm_i16x8_shuffle(x, x, 0, 0, 1, 1, 2, 2, 3, 3); }
+static inline YUVVec vecDupHi16(YUVVec x) { return wasm_i16x8_shuffle(x, x, 4, 4, 5, 5, 6, 6, 7, 7); }
+
+static inline YUVVec vecWidenLo32(YUVVec x) { return wasm_u32x4_extend_low_u16x8(x); }
+static inline YUVVec vecWidenHi32(YUVVec x) { return wasm_u32x4_extend_high_u16x8(x); }
+
+static inline YUVVec vecSplat8(byte x) { return wasm_i8x16_splat(x); }
+static inline YUVVec vecPackU8(YUVVec a, YUVVec b) { return wasm_u8x16_narrow_i16x8(a, b); }
+
+static inline YUVVec vecInterleaveLo8(YUVVec a, YUVVec b) { return wasm_i8x16_shuffle(a, b, 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23); }
+static inline YUVVec vecInterleaveHi8(YUVVec a, YUVVec b) { return wasm_i8x16_shuffle(a, b, 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31); }
+static inline YUVVec vecInterleaveLo16(YUVVec a, YUVVec b) { return wasm_i16x8_shuffle(a, b, 0, 8, 1, 9, 2, 10, 3, 11); }
+static inline YUVVec vecInterleaveHi16(YUVVec a, YUVVec b) { return wasm_i16x8_shuffle(a, b, 4, 12, 5, 13, 6, 14, 7, 15); }
+
+#elif defined(YUV_SSE2)
+
+typedef __m128i YUVVec;
+
+static inline YUVVec vecLoad8(const byte *src) { return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128()); }
+static inline void vecStore(void *dst, YUVVec x) { _mm_storeu_si128((__m128i *)dst, x); }
+
+static inline YUVVec vecSplat16(uint16 x) { return _mm_set1_epi16((short)x); }
+static inline YUVVec vecSplat32(uint32 x) { return _mm_set1_epi32((int)x); }
+
+static inline YUVVec vecAdd16(YUVVec a, YUVVec b) { return _mm_add_epi16(a, b); }
+static inline YUVVec vecSub16(YUVVec a, YUVVec b) { return _mm_sub_epi16(a, b); }
+static inline YUVVec vecMin16(YUVVec a, YUVVec b) { return _mm_min_epi16(a, b); }
+static inline YUVVec vecMax16(YUVVec a, YUVVec b) { return _mm_max_epi16(a, b); }
+static inline YUVVec vecOr(YUVVec a, YUVVec b) { return _mm_or_si128(a, b); }
+static inline YUVVec vecXor(YUVVec a, YUVVec b) { return _mm_xor_si128(a, b); }
+
+static inline YUVVec vecShl16(YUVVec x, int n) { return _mm_sll_epi16(x, _mm_cvtsi32_si128(n)); }
+static inline YUVVec vecShr16(YUVVec x, int n) { return _mm_srl_epi16(x, _mm_cvtsi32_si128(n)); }
+static inline YUVVec vecSar16(YUVVec x, int n) { return _mm_sra_epi16(x, _mm_cvtsi32_si128(n)); }
+static inline YUVVec vecShl32(YUVVec x, int n) { return _mm_sll_epi32(x, _mm_cvtsi32_si128(n)); }
+
+/** The high halves of the unsigned products. */
+static inline YUVVec vecMulHiU16(YUVVec a, YUVVec b) { return _mm_mulhi_epu16(a, b); }
+
+static inline YUVVec vecDupLo16(YUVVec x) { return _mm_unpacklo_epi16(x, x); }
+static inline YUVVec vecDupHi16(YUVVec x) { return _mm_unpackhi_epi16(x, x); }
+
+static inline YUVVec vecWidenLo32(YUVVec x) { return _mm_unpacklo_epi16(x, _mm_setzero_si128()); }
+static inline YUVVec vecWidenHi32(YUVVec x) { return _mm_unpackhi_epi16(x, _mm_setzero_si128()); }
+
+static inline YUVVec vecSplat8(byte x) { return _mm_set1_epi8((char)x); }
+static inline YUVVec vecPackU8(YUVVec a, YUVVec b) { return _mm_packus_epi16(a, b); }
+
+static inline YUVVec vecInterleaveLo8(YUVVec a, YUVVec b) { return _mm_unpacklo_epi8(a, b); }
+static inline YUVVec vecInterleaveHi8(YUVVec a, YUVVec b) { return _mm_unpackhi_epi8(a, b); }
+static inline YUVVec vecInterleaveLo16(YUVVec a, YUVVec b) { return _mm_unpacklo_epi16(a, b); }
+static inline YUVVec vecInterleaveHi16(YUVVec a, YUVVec b) { return _mm_unpackhi_epi16(a, b); }
+
+#endif
+
+#ifdef YUV_SIMD
+
+/** A pixel format's layout, for composing vectors of pixels. */
+struct YUVToRGBVecFormat {
+	YUVToRGBVecFormat(const YUVToRGBLookup *lookup) {
+		Graphics::PixelFormat format = lookup->getFormat();
+
+		itu    = lookup->getScale() == YUVToRGBManager::kScaleITU;
+		rLoss  = format.rLoss;
+		gLoss  = format.gLoss;
+		bLoss  = format.bLoss;
+		rShift = format.rShift;
+		gShift = format.gShift;
+		bShift = format.bShift;
+		alpha  = (0xFF >> format.aLoss) << format.aShift;
+
+		// Formats with a byte per channel are composed by interleaving bytes
+		byteChannels = (format.bytesPerPixel == 4) &&
+		               (rLoss == 0) && (gLoss == 0) && (bLoss == 0) &&
+		               ((rShift & 7) == 0) && ((gShift & 7) == 0) && ((bShift & 7) == 0) &&
+		               (rShift != gShift) && (rShift != bShift) && (gShift != bShift) &&
+		               ((format.aLoss == 8) || ((format.aLoss == 0) && ((format.aShift & 7) == 0)));
+
+		rByte = rShift >> 3;
+		gByte = gShift >> 3;
+		bByte = bShift >> 3;
+		aByte = 6 - rByte - gByte - bByte;
+		alphaByte = (format.aLoss == 0) ? 0xFF : 0x00;
+	}
+
+	bool itu;
+	int rLoss, gLoss, bLoss;
+	int rShift, gShift, bShift;
+	uint32 alpha;
+
+	bool byteChannels;
+	int rByte, gByte, bByte, aByte;
+	byte alphaByte;
+};
+
+/**
+ * Compute the chroma terms of eight pixels, the same as the color table's
+ * trunc(k * (c - 128)). The factors k are applied to the absolute values
+ * in fixed point, scaled so that the high half of each product is the
+ * truncated result for all 256 chroma values.
+ */
+static inline void vecChroma(YUVVec u, YUVVec v, YUVVec &crR, YUVVec &crbG, YUVVec &cbB) {
+	YUVVec cr = vecSub16(v, vecSplat16(128));
+	YUVVec cb = vecSub16(u, vecSplat16(128));
+
+	YUVVec crSign = vecSar16(cr, 15);
+	YUVVec cbSign = vecSar16(cb, 15);
+	YUVVec crAbs  = vecSub16(vecXor(cr, crSign), crSign);
+	YUVVec cbAbs  = vecSub16(vecXor(cb, cbSign), cbSign);
+
+	YUVVec crRAbs = vecMulHiU16(vecShl16(crAbs, 7), vecSplat16(  717)); // 0.419 / 0.299
+	YUVVec crGAbs = vecMulHiU16(vecShl16(crAbs, 6), vecSplat16(  731)); // 0.299 / 0.419
+	YUVVec cbGAbs = vecMulHiU16(vecShl16(cbAbs, 3), vecSplat16( 2821)); // 0.114 / 0.331
+	YUVVec cbBAbs = vecMulHiU16(vecShl16(cbAbs, 2), vecSplat16(29055)); // 0.587 / 0.331
+
+	// Restore the signs, the green factors are negative
+	crR  = vecSub16(vecXor(crRAbs, crSign), crSign);
+	cbB  = vecSub16(vecXor(cbBAbs, cbSign), cbSign);
+	crbG = vecSub16(vecSub16(vecSplat16(0), vecSub16(vecXor(crGAbs, crSign), crSign)),
+	                vecSub16(vecXor(cbGAbs, cbSign), cbSign));
+}
+
+/**
+ * Prepare the luminance and the chroma terms of a luminance scale. For the
+ * ITU scale, the channels are computed as 2 * (x - 16) directly, which is
+ * what they're scaled from.
+ */
+template<bool itu>
+static inline YUVVec vecLuma(YUVVec y) {
+	return itu ? vecSub16(vecShl16(y, 1), vecSplat16(32)) : y;
+}
+
+template<bool itu>
+static inline YUVVec vecChromaTerm(YUVVec x) {
+	return itu ? vecShl16(x, 1) : x;
+}
+
+/**
+ * Compute a color channel from the prepared luminance and chroma term, clip
+ * it to the luminance scale and scale it to [0, 255]. Unclipped full scale
+ * values are left to a saturating pack.
+ */
+template<bool itu>
+static inline YUVVec vecChannel(YUVVec y, YUVVec c, bool clip) {
+	YUVVec x = vecAdd16(y, c);
+
+	// (x - 16) * 255 / 219, exact for all x in [16, 235]
+	if (itu)
+		return vecMulHiU16(vecMin16(vecMax16(x, vecSplat16(0)), vecSplat16(438)), vecSplat16(38155));
+
+	if (clip)
+		return vecMin16(vecMax16(x, vecSplat16(0)), vecSplat16(255));
+
+	return x;
+}
+
+/** The color channels of sixteen pixels, in [0, 255] if clipped. */
+struct YUVToRGBVecPixels {
+	YUVVec r[2], g[2], b[2];
+
+	template<bool itu>
+	inline void set(int i, YUVVec y, YUVVec crR, YUVVec crbG, YUVVec cbB, bool clip) {
+		r[i] = vecChannel<itu>(y, crR,  clip);
+		g[i] = vecChannel<itu>(y, crbG, clip);
+		b[i] = vecChannel<itu>(y, cbB,  clip);
+	}
+};
+
+static inline void vecPutPixels(uint16 *dst, const YUVToRGBVecPixels &pixels, const YUVToRGBVecFormat &format) {
+	YUVVec alpha = vecSplat16(format.alpha);
+
+	for (int i = 0; i < 2; i++) {
+		YUVVec r = vecShl16(vecShr16(pixels.r[i], format.rLoss), format.rShift);
+		YUVVec g = vecShl16(vecShr16(pixels.g[i], format.gLoss), format.gShift);
+		YUVVec b = vecShl16(vecShr16(pixels.b[i], format.bLoss), format.bShift);
+
+		vecStore(dst + i * 8, vecOr(vecOr(r, g), vecOr(b, alpha)));
+	}
+}
+
+static inline void vecPutPixels(uint32 *dst, const YUVToRGBVecPixels &pixels, const YUVToRGBVecFormat &format) {
+	if (format.byteChannels) {
+		// Gather the channels' bytes in the order they have in memory
+		YUVVec bytes[4];
+		bytes[format.rByte] = vecPackU8(pixels.r[0], pixels.r[1]);
+		bytes[format.gByte] = vecPackU8(pixels.g[0], pixels.g[1]);
+		bytes[format.bByte] = vecPackU8(pixels.b[0], pixels.b[1]);
+		bytes[format.aByte] = vecSplat8(format.alphaByte);
+
+		// Pixel values are stored little-endian on all SIMD targets
+		YUVVec lo01 = vecInterleaveLo8(bytes[0], bytes[1]);
+		YUVVec hi01 = vecInterleaveHi8(bytes[0], bytes[1]);
+		YUVVec lo23 = vecInterleaveLo8(bytes[2], bytes[3]);
+		YUVVec hi23 = vecInterleaveHi8(bytes[2], bytes[3]);
+
+		vecStore(dst     , vecInterleaveLo16(lo01, lo23));
+		vecStore(dst +  4, vecInterleaveHi16(lo01, lo23));
+		vecStore(dst +  8, vecInterleaveLo16(hi01, hi23));
+		vecStore(dst + 12, vecInterleaveHi16(hi01, hi23));
+		return;
+	}
+
+	YUVVec alpha = vecSplat32(format.alpha);
+
+	for (int i = 0; i < 2; i++) {
+		YUVVec r = vecShr16(pixels.r[i], format.rLoss);
+		YUVVec g = vecShr16(pixels.g[i], format.gLoss);
+		YUVVec b = vecShr16(pixels.b[i], format.bLoss);
+
+		YUVVec lo = vecOr(vecOr(vecShl32(vecWidenLo32(r), format.rShift), vecShl32(vecWidenLo32(g), format.gShift)),
+		                  vecOr(vecShl32(vecWidenLo32(b), format.bShift), alpha));
+		YUVVec hi = vecOr(vecOr(vecShl32(vecWidenHi32(r), format.rShift), vecShl32(vecWidenHi32(g), format.gShift)),
+		                  vecOr(vecShl32(vecWidenHi32(b), format.bShift), alpha));
+
+		vecStore(dst + i * 8    , lo);
+		vecStore(dst + i * 8 + 4, hi);
+	}
+}
+
+/** Convert a YUV444 row, 16 pixels at a time. Return the number of pixels converted. */
+template<typename PixelInt, bool itu>
+static int convertYUV444RowVec(PixelInt *dst, const YUVToRGBVecFormat &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth) {
+	// Only the pack composing bytes clips by itself
+	bool clip = (sizeof(PixelInt) != 4) || !format.byteChannels;
+	int x = 0;
+
+	for (; x + 16 <= yWidth; x += 16) {
+		YUVToRGBVecPixels pixels;
+
+		for (int i = 0; i < 2; i++) {
+			YUVVec crR, crbG, cbB;
+			vecChroma(vecLoad8(uSrc + x + i * 8), vecLoad8(vSrc + x + i * 8), crR, crbG, cbB);
+
+			pixels.set<itu>(i, vecLuma<itu>(vecLoad8(ySrc + x + i * 8)),
+			                vecChromaTerm<itu>(crR), vecChromaTerm<itu>(crbG), vecChromaTerm<itu>(cbB), clip);
+		}
+
+		vecPutPixels(dst + x, pixels, format);
+	}
+
+	return x;
+}
+
+/** Convert two rows sharing a YUV420 chroma row, 16 pixels at a time. Return the number of pixels converted. */
+template<typename PixelInt, bool itu>
+static int convertYUV420RowsVec(PixelInt *dst, int dstPitch, const YUVToRGBVecFormat &format, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int yWidth) {
+	// Only the pack composing bytes clips by itself
+	bool clip = (sizeof(PixelInt) != 4) || !format.byteChannels;
+	PixelInt *dst2 = (PixelInt *)((byte *)dst + dstPitch);
+	int x = 0;
+
+	for (; x + 16 <= yWidth; x += 16) {
+		YUVVec crR, crbG, cbB;
+		vecChroma(vecLoad8(uSrc + (x >> 1)), vecLoad8(vSrc + (x >> 1)), crR, crbG, cbB);
+
+		crR  = vecChromaTerm<itu>(crR);
+		crbG = vecChromaTerm<itu>(crbG);
+		cbB  = vecChromaTerm<itu>(cbB);
+
+		// Each chroma value covers two pixels of both rows
+		YUVVec crRLo  = vecDupLo16(crR),  crRHi  = vecDupHi16(crR);
+		YUVVec crbGLo = vecDupLo16(crbG), crbGHi = vecDupHi16(crbG);
+		YUVVec cbBLo  = vecDupLo16(cbB),  cbBHi  = vecDupHi16(cbB);
+
+		YUVToRGBVecPixels pixels;
+
+		pixels.set<itu>(0, vecLuma<itu>(vecLoad8(ySrc + x)),     crRLo, crbGLo, cbBLo, clip);
+		pixels.set<itu>(1, vecLuma<itu>(vecLoad8(ySrc + x + 8)), crRHi, crbGHi, cbBHi, clip);
+		vecPutPixels(dst + x, pixels, format);
+
+		pixels.set<itu>(0, vecLuma<itu>(vecLoad8(ySrc + yPitch + x)),     crRLo, crbGLo, cbBLo, clip);
+		pixels.set<itu>(1, vecLuma<itu>(vecLoad8(ySrc + yPitch + x + 8)), crRHi, crbGHi, cbBHi, clip);
+		vecPutPixels(dst2 + x, pixels, format);
+	}
+
+	return x;
+}
+
+#endif // YUV_SIMD
+
 template<typename PixelInt>
-void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+static void convertYUV444Step(const YUVToRGBJob &job, int row, byte *dstPtr, int dstPitch) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = job.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
-
-	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
-			register const uint32 *L;
+	const uint32 *rgbToPix = job.lookup->getRGBToPix();
 
-			int16 cr_r  = Cr_r_tab[*vSrc];
-			int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
-			int16 cb_b  = Cb_b_tab[*uSrc];
-			++uSrc;
-			++vSrc;
+	const byte *ySrc = job.ySrc + row * job.yPitch;
+	const byte *uSrc = job.uSrc + row * job.uvPitch;
+	const byte *vSrc = job.vSrc + row * job.uvPitch;
 
-			PUT_PIXEL(*ySrc, dstPtr);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-		}
-
-		dstPtr += dstPitch - yWidth * sizeof(PixelInt);
-		ySrc += yPitch - yWidth;
-		uSrc += uvPitch - yWidth;
-		vSrc += uvPitch - yWidth;
+	int w = 0;
+#ifdef YUV_SIMD
+	YUVToRGBVecFormat format(job.lookup);
+	if (format.itu)
+		w = convertYUV444RowVec<PixelInt, true >((PixelInt *)dstPtr, format, ySrc, uSrc, vSrc, job.yWidth);
+	else
+		w = convertYUV444RowVec<PixelInt, false>((PixelInt *)dstPtr, format, ySrc, uSrc, vSrc, job.yWidth);
+
+	dstPtr += w * sizeof(PixelInt);
+	ySrc += w;
+	uSrc += w;
+	vSrc += w;
+#endif
+
+	for (; w < job.yWidth; w++) {
+		register const uint32 *L;
+
+		int16 cr_r  = Cr_r_tab[*vSrc];
+		int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
+		int16 cb_b  = Cb_b_tab[*uSrc];
+		++uSrc;
+		++vSrc;
+
+		PUT_PIXEL(*ySrc, dstPtr);
+		ySrc++;
+		dstPtr += sizeof(PixelInt);
 	}
 }
 
 void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
 	assert(dst && dst->pixels);
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(dst->format.bytesPerPixel == 1 || dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->pixels, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV444ToRGB<uint32>((byte *)dst->pixels, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	YUVToRGBJob job;
+	job.stepRows = 1;
+	job.ySrc     = ySrc;
+	job.uSrc     = uSrc;
+	job.vSrc     = vSrc;
+	job.yWidth   = yWidth;
+	job.yHeight  = yHeight;
+	job.yPitch   = yPitch;
+	job.uvPitch  = uvPitch;
+
+	convert(job, dst, scale, convertYUV444Step<uint16>, convertYUV444Step<uint32>);
 }
 
 template<typename PixelInt>
-void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	int halfHeight = yHeight >> 1;
-	int halfWidth = yWidth >> 1;
-
+static void convertYUV420Step(const YUVToRGBJob &job, int row, byte *dstPtr, int dstPitch) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = job.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
-
-	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
-			register const uint32 *L;
-
-			int16 cr_r  = Cr_r_tab[*vSrc];
-			int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
-			int16 cb_b  = Cb_b_tab[*uSrc];
-			++uSrc;
-			++vSrc;
-
-			PUT_PIXEL(*ySrc, dstPtr);
-			PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-			PUT_PIXEL(*ySrc, dstPtr);
-			PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-		}
-
-		dstPtr += dstPitch;
-		ySrc += (yPitch << 1) - yWidth;
-		uSrc += uvPitch - halfWidth;
-		vSrc += uvPitch - halfWidth;
+	const uint32 *rgbToPix = job.lookup->getRGBToPix();
+
+	int yPitch = job.yPitch;
+	const byte *ySrc = job.ySrc + row * yPitch;
+	const byte *uSrc = job.uSrc + (row >> 1) * job.uvPitch;
+	const byte *vSrc = job.vSrc + (row >> 1) * job.uvPitch;
+
+	int w = 0;
+#ifdef YUV_SIMD
+	YUVToRGBVecFormat format(job.lookup);
+	if (format.itu)
+		w = convertYUV420RowsVec<PixelInt, true >((PixelInt *)dstPtr, dstPitch, format, ySrc, yPitch, uSrc, vSrc, job.yWidth);
+	else
+		w = convertYUV420RowsVec<PixelInt, false>((PixelInt *)dstPtr, dstPitch, format, ySrc, yPitch, uSrc, vSrc, job.yWidth);
+
+	dstPtr += w * sizeof(PixelInt);
+	ySrc += w;
+	uSrc += w >> 1;
+	vSrc += w >> 1;
+#endif
+
+	for (; w < job.yWidth; w += 2) {
+		register const uint32 *L;
+
+		int16 cr_r  = Cr_r_tab[*vSrc];
+		int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
+		int16 cb_b  = Cb_b_tab[*uSrc];
+		++uSrc;
+		++vSrc;
+
+		PUT_PIXEL(*ySrc, dstPtr);
+		PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
+		ySrc++;
+		dstPtr += sizeof(PixelInt);
+		PUT_PIXEL(*ySrc, dstPtr);
+		PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
+		ySrc++;
+		dstPtr += sizeof(PixelInt);
 	}
 }
 
 void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
 	assert(dst && dst->pixels);
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(dst->format.bytesPerPixel == 1 || dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->pixels, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV420ToRGB<uint32>((byte *)dst->pixels, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	YUVToRGBJob job;
+	job.stepRows = 2;
+	job.ySrc     = ySrc;
+	job.uSrc     = uSrc;
+	job.vSrc     = vSrc;
+	job.yWidth   = yWidth;
+	job.yHeight  = yHeight;
+	job.yPitch   = yPitch;
+	job.uvPitch  = uvPitch;
+
+	convert(job, dst, scale, convertYUV420Step<uint16>, convertYUV420Step<uint32>);
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -323,42 +819,42 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	xDiff++
 
 template<typename PixelInt>
-void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+static void convertYUV410Step(const YUVToRGBJob &job, int y, byte *dstPtr, int dstPitch) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = job.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
-
-	int quarterWidth = yWidth >> 2;
-
-	for (int y = 0; y < yHeight; y++) {
-		for (int x = 0; x < quarterWidth; x++) {
-			// Perform bilinear interpolation on the the chroma values
-			// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
-			// Feel free to optimize further
-			int targetY = y >> 2;
-			int xDiff = 0;
-			int yDiff = y & 3;
-			int index = targetY * uvPitch + x;
-
-			// Declare some variables for the following macros
-			byte u, v;
-			int16 cr_r, crb_g, cb_b;
-			register const uint32 *L;
-
-			READ_QUAD(uSrc, u);
-			READ_QUAD(vSrc, v);
-
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
-		}
-
-		dstPtr += dstPitch - yWidth * sizeof(PixelInt);
-		ySrc += yPitch - yWidth;
+	const uint32 *rgbToPix = job.lookup->getRGBToPix();
+
+	const byte *ySrc = job.ySrc + y * job.yPitch;
+	const byte *uSrc = job.uSrc;
+	const byte *vSrc = job.vSrc;
+	int uvPitch = job.uvPitch;
+
+	int quarterWidth = job.yWidth >> 2;
+
+	for (int x = 0; x < quarterWidth; x++) {
+		// Perform bilinear interpolation on the the chroma values
+		// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
+		// Feel free to optimize further
+		int targetY = y >> 2;
+		int xDiff = 0;
+		int yDiff = y & 3;
+		int index = targetY * uvPitch + x;
+
+		// Declare some variables for the following macros
+		byte u, v;
+		int16 cr_r, crb_g, cb_b;
+		register const uint32 *L;
+
+		READ_QUAD(uSrc, u);
+		READ_QUAD(vSrc, v);
+
+		DO_YUV410_PIXEL();
+		DO_YUV410_PIXEL();
+		DO_YUV410_PIXEL();
+		DO_YUV410_PIXEL();
 	}
 }
 
@@ -369,18 +865,22 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
 	assert(dst && dst->pixels);
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(dst->format.bytesPerPixel == 1 || dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 	assert((yWidth & 3) == 0);
 	assert((yHeight & 3) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->pixels, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV410ToRGB<uint32>((byte *)dst->pixels, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	YUVToRGBJob job;
+	job.stepRows = 1;
+	job.ySrc     = ySrc;
+	job.uSrc     = uSrc;
+	job.vSrc     = vSrc;
+	job.yWidth   = yWidth;
+	job.yHeight  = yHeight;
+	job.yPitch   = yPitch;
+	job.uvPitch  = uvPitch;
+
+	convert(job, dst, scale, convertYUV410Step<uint16>, convertYUV410Step<uint32>);
 }
 
 } // End of namespace Graphics
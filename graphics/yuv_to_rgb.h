@@ -32,12 +32,17 @@
 #define GRAPHICS_YUV_TO_RGB_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/singleton.h"
+#include "common/workerpool.h"
 #include "graphics/surface.h"
 
 namespace Graphics {
 
 class YUVToRGBLookup;
+struct YUVToRGBJob;
+
+typedef void (*YUVToRGBStepFunc)(const YUVToRGBJob &job, int row, byte *dstPtr, int dstPitch);
 
 class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
 public:
@@ -47,6 +52,23 @@ public:
 		kScaleITU   /** Luminance values range from [16, 235], the range from ITU-R BT.601 */
 	};
 
+	/**
+	 * Set the palette used for 8bpp destination surfaces. Each pixel is
+	 * converted to the closest of its colors.
+	 *
+	 * @param colors the palette, as RGB triplets
+	 * @param count  the number of colors in the palette
+	 */
+	void setPalette(const byte *colors, uint count);
+
+	/**
+	 * Set the number of threads converting large images, including the
+	 * calling one. The default can be set with the "yuv_threads" config key.
+	 *
+	 * @return the number of threads actually available
+	 */
+	uint setThreadCount(uint count);
+
 	/**
 	 * Convert a YUV444 image to an RGB surface
 	 *
@@ -105,8 +127,18 @@ private:
 
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale);
 
-	YUVToRGBLookup *_lookup;
+	void convert(YUVToRGBJob &job, Graphics::Surface *dst, LuminanceScale scale, YUVToRGBStepFunc convertStep16, YUVToRGBStepFunc convertStep32);
+	static void runJob(void *job, uint thread);
+
+	Common::Array<YUVToRGBLookup *> _lookups; ///< One per format and luminance scale used
+	Common::WorkerCondition _lookupLock;      ///< Guards _lookups, shared by converting threads
 	int16 _colorTab[4 * 256]; // 2048 bytes
+
+	byte _palette[3 * 256];
+	uint _paletteCount;
+	byte *_paletteMap; ///< Palette index of each RGB555 color
+
+	Common::WorkerPool _pool;
 };
 
 } // End of namespace Graphics
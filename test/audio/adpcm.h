@@ -0,0 +1,264 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/decoders/adpcm.h"
+#include "audio/decoders/xa.h"
+
+#include "common/endian.h"
+#include "common/memstream.h"
+
+class ADPCMTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_ms_ima_does_not_depend_on_read_size() {
+		const uint32 blockAlign = 256;
+		const uint32 size = blockAlign * 8;
+		byte *data = createData(size);
+		for (uint32 block = 0; block < size; block += blockAlign) {
+			// Two channel headers: initial sample and step index
+			WRITE_LE_UINT16(data + block + 2, data[block + 2] % 89);
+			WRITE_LE_UINT16(data + block + 6, data[block + 6] % 89);
+		}
+
+		int16 *whole = new int16[size * 2];
+		int16 *pieces = new int16[size * 2];
+		const int wholeSamples = decode(data, size, Audio::kADPCMMSIma, blockAlign, whole, size * 2, 512);
+		const int pieceSamples = decode(data, size, Audio::kADPCMMSIma, blockAlign, pieces, size * 2, 6);
+
+		// Each block holds a 4 byte header and 248 samples per channel,
+		// so 496 samples in all
+		TS_ASSERT_EQUALS(wholeSamples, 8 * 496);
+		TS_ASSERT_EQUALS(pieceSamples, wholeSamples);
+		for (int i = 0; i < wholeSamples; ++i)
+			TS_ASSERT_EQUALS(pieces[i], whole[i]);
+
+		delete[] whole;
+		delete[] pieces;
+		free(data);
+	}
+
+	void test_ms_stereo_header_samples() {
+		const uint32 blockAlign = 64;
+		byte *data = createData(blockAlign);
+		// Predictors, deltas, first and second samples of both channels
+		data[0] = 0;
+		data[1] = 1;
+		WRITE_LE_UINT16(data + 2, 16);
+		WRITE_LE_UINT16(data + 4, 16);
+		WRITE_LE_UINT16(data + 6, 1000);
+		WRITE_LE_UINT16(data + 8, (uint16)-1000);
+		WRITE_LE_UINT16(data + 10, 2000);
+		WRITE_LE_UINT16(data + 12, (uint16)-2000);
+
+		int16 out[256];
+		const int samples = decode(data, blockAlign, Audio::kADPCMMS, blockAlign, out, ARRAYSIZE(out), 2);
+
+		// The header holds two samples per channel, the other 50 bytes
+		// one sample per channel each
+		TS_ASSERT_EQUALS(samples, 4 + 100);
+		TS_ASSERT_EQUALS(out[0], 2000);
+		TS_ASSERT_EQUALS(out[1], -2000);
+		TS_ASSERT_EQUALS(out[2], 1000);
+		TS_ASSERT_EQUALS(out[3], -1000);
+
+		free(data);
+	}
+
+	void test_oki_matches_reference() {
+		const uint32 size = 1001;
+		byte *data = createData(size);
+
+		int16 *expected = new int16[size * 2];
+		int16 *out = new int16[size * 2];
+		decodeOkiReference(data, size, expected);
+
+		static const int chunkSizes[] = { 1, 7, 4096 };
+		for (uint i = 0; i < ARRAYSIZE(chunkSizes); ++i) {
+			TS_ASSERT_EQUALS(decode(data, size, Audio::kADPCMOki, 0, out, size * 2, chunkSizes[i], 1), (int)size * 2);
+			TS_ASSERT_EQUALS(memcmp(out, expected, size * 2 * sizeof(int16)), 0);
+		}
+
+		delete[] expected;
+		delete[] out;
+		free(data);
+	}
+
+	void test_dvi_matches_reference() {
+		const uint32 size = 1001;
+		byte *data = createData(size);
+
+		int16 *expected = new int16[size * 2];
+		int16 *out = new int16[size * 2];
+		static const int chunkSizes[] = { 2, 6, 4096 };
+		for (int channels = 1; channels <= 2; ++channels) {
+			decodeDVIReference(data, size, channels, expected);
+			for (uint i = 0; i < ARRAYSIZE(chunkSizes); ++i) {
+				TS_ASSERT_EQUALS(decode(data, size, Audio::kADPCMDVI, 0, out, size * 2, chunkSizes[i], channels), (int)size * 2);
+				TS_ASSERT_EQUALS(memcmp(out, expected, size * 2 * sizeof(int16)), 0);
+			}
+		}
+
+		delete[] expected;
+		delete[] out;
+		free(data);
+	}
+
+	void test_xa_matches_reference() {
+		// 16 byte blocks of a predictor and shift byte, a flags byte and
+		// 28 samples; the last one ends the stream
+		const uint32 blocks = 150;
+		const uint32 size = blocks * 16;
+		byte *data = createData(size);
+		for (uint32 block = 0; block < blocks; ++block) {
+			data[block * 16] = ((block % 5) << 4) | (data[block * 16] % 13);
+			data[block * 16 + 1] = (block == blocks - 1) ? 7 : 0;
+		}
+
+		const int maxSamples = blocks * 28;
+		int16 *expected = new int16[maxSamples];
+		int16 *out = new int16[maxSamples];
+		const int expectedSamples = decodeXAReference(data, size, expected);
+		TS_ASSERT_EQUALS(expectedSamples, (int)(blocks - 1) * 28);
+
+		static const int chunkSizes[] = { 1, 5, 28, 100, 4096 };
+		for (uint i = 0; i < ARRAYSIZE(chunkSizes); ++i) {
+			byte *copy = (byte *)malloc(size);
+			memcpy(copy, data, size);
+			Audio::RewindableAudioStream *stream = Audio::makeXAStream(new Common::MemoryReadStream(copy, size, DisposeAfterUse::YES), 22050);
+
+			int total = 0;
+			while (!stream->endOfData() && total < maxSamples) {
+				const int samples = stream->readBuffer(out + total, MIN(chunkSizes[i], maxSamples - total));
+				if (samples <= 0)
+					break;
+				total += samples;
+			}
+			delete stream;
+
+			TS_ASSERT_EQUALS(total, expectedSamples);
+			TS_ASSERT_EQUALS(memcmp(out, expected, expectedSamples * sizeof(int16)), 0);
+		}
+
+		delete[] expected;
+		delete[] out;
+		free(data);
+	}
+
+	private:
+	static const int16 *stepAdjust() {
+		static const int16 table[16] = {
+			-1, -1, -1, -1, 2, 4, 6, 8,
+			-1, -1, -1, -1, 2, 4, 6, 8
+		};
+		return table;
+	}
+
+	/** Sample by sample Oki ADPCM, as the decoder did before bulk decoding. */
+	static void decodeOkiReference(const byte *data, uint32 size, int16 *out) {
+		static const int16 stepSize[49] = {
+			   16,   17,   19,   21,   23,   25,   28,   31,
+			   34,   37,   41,   45,   50,   55,   60,   66,
+			   73,   80,   88,   97,  107,  118,  130,  143,
+			  157,  173,  190,  209,  230,  253,  279,  307,
+			  337,  371,  408,  449,  494,  544,  598,  658,
+			  724,  796,  876,  963, 1060, 1166, 1282, 1411,
+			 1552
+		};
+
+		int16 last = 0;
+		int32 stepIndex = 0;
+		for (uint32 i = 0; i < size * 2; ++i) {
+			const byte code = (i & 1) ? (data[i / 2] & 0x0f) : (data[i / 2] >> 4);
+			const int16 e = (2 * (code & 0x7) + 1) * stepSize[stepIndex] / 8;
+			const int16 samp = CLIP<int16>(last + ((code & 0x08) ? -e : e), -2048, 2047);
+			last = samp;
+			stepIndex = CLIP<int32>(stepIndex + stepAdjust()[code], 0, ARRAYSIZE(stepSize) - 1);
+			out[i] = samp * 16;
+		}
+	}
+
+	/** Sample by sample DVI ADPCM, the high nibble first. */
+	static void decodeDVIReference(const byte *data, uint32 size, int channels, int16 *out) {
+		static const int16 imaTable[89] = {
+			    7,    8,    9,   10,   11,   12,   13,   14,
+			   16,   17,   19,   21,   23,   25,   28,   31,
+			   34,   37,   41,   45,   50,   55,   60,   66,
+			   73,   80,   88,   97,  107,  118,  130,  143,
+			  157,  173,  190,  209,  230,  253,  279,  307,
+			  337,  371,  408,  449,  494,  544,  598,  658,
+			  724,  796,  876,  963, 1060, 1166, 1282, 1411,
+			 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+			 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+			 7132, 7845, 8630, 9493,10442,11487,12635,13899,
+			15289,16818,18500,20350,22385,24623,27086,29794,
+			32767
+		};
+
+		int32 last[2] = { 0, 0 };
+		int32 stepIndex[2] = { 0, 0 };
+		for (uint32 i = 0; i < size * 2; ++i) {
+			const byte code = (i & 1) ? (data[i / 2] & 0x0f) : (data[i / 2] >> 4);
+			const int ch = (channels == 2) ? (i & 1) : 0;
+			const int32 e = (2 * (code & 0x7) + 1) * imaTable[stepIndex[ch]] / 8;
+			last[ch] = CLIP<int32>(last[ch] + ((code & 0x08) ? -e : e), -32768, 32767);
+			stepIndex[ch] = CLIP<int32>(stepIndex[ch] + stepAdjust()[code], 0, ARRAYSIZE(imaTable) - 1);
+			out[i] = last[ch];
+		}
+	}
+
+	/** Block by block XA ADPCM without loops, returning the sample count. */
+	static int decodeXAReference(const byte *data, uint32 size, int16 *out) {
+		static const double filter[5][2] = {
+			{  0.0, 0.0 },
+			{  60.0 / 64.0,  0.0 },
+			{  115.0 / 64.0, -52.0 / 64.0 },
+			{  98.0 / 64.0, -55.0 / 64.0 },
+			{  122.0 / 64.0, -60.0 / 64.0 }
+		};
+
+		double s1 = 0.0, s2 = 0.0;
+		int samples = 0;
+		for (uint32 pos = 0; pos + 16 <= size && data[pos + 1] != 7; pos += 16) {
+			const int predictor = data[pos] >> 4;
+			const int shift = data[pos] & 0xf;
+			for (int i = 0; i < 28; ++i) {
+				const byte d = data[pos + 2 + i / 2];
+				const int16 s = (int16)(((i & 1) ? (d & 0xf0) << 8 : (d & 0xf) << 12) & 0xffff);
+				const double sample = (double)(s >> shift) + s1 * filter[predictor][0] + s2 * filter[predictor][1];
+				s2 = s1;
+				s1 = sample;
+				out[samples++] = (int16)(int)(sample + 0.5);
+			}
+		}
+		return samples;
+	}
+
+	static byte *createData(uint32 size) {
+		byte *data = (byte *)malloc(size);
+		uint32 seed = 1;
+		for (uint32 i = 0; i < size; ++i) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+		return data;
+	}
+
+	/** Decode a copy of the data, reading chunkSize samples at a time. */
+	static int decode(const byte *data, uint32 size, Audio::ADPCMType type, uint32 blockAlign, int16 *out, int maxSamples, int chunkSize, int channels = 2) {
+		byte *copy = (byte *)malloc(size);
+		memcpy(copy, data, size);
+		Audio::RewindableAudioStream *stream = Audio::makeADPCMStream(new Common::MemoryReadStream(copy, size, DisposeAfterUse::YES),
+		                                                              DisposeAfterUse::YES, size, type, 22050, channels, blockAlign);
+
+		int total = 0;
+		while (!stream->endOfData() && total < maxSamples) {
+			const int samples = stream->readBuffer(out + total, MIN(chunkSize, maxSamples - total));
+			if (samples <= 0)
+				break;
+			total += samples;
+		}
+
+		delete stream;
+		return total;
+	}
+};
@@ -0,0 +1,490 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/fmopl.h"
+#include "audio/mixer_intern.h"
+#include "audio/rate.h"
+#include "audio/decoders/adpcm.h"
+#include "audio/decoders/flac.h"
+#include "audio/decoders/mp3.h"
+#include "audio/decoders/vorbis.h"
+#include "audio/softsynth/opl/dosbox.h"
+#include "audio/softsynth/opl/mame.h"
+
+#ifdef USE_MT32EMU
+#include "audio/softsynth/mt32/mt32emu.h"
+#endif
+
+#include "common/file.h"
+#include "common/list.h"
+#include "common/memstream.h"
+#include "common/str.h"
+#include "common/system.h"
+#include "common/timer.h"
+#include "graphics/pixelformat.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef POSIX
+#include <sys/time.h>
+#endif
+
+#include "helper.h"
+
+/**
+ * Throughput benchmarks of the audio code. They are skipped unless
+ * AUDIO_BENCHMARK is set, as they take a while. Its value is the file
+ * which the results are appended to as CSV, one line per case, or "-"
+ * to print them only. Each case reports the sample frames produced per
+ * second and how many times faster than real time that is.
+ *
+ * The compressed decoders read bench.mp3, bench.ogg and bench.flac from
+ * the directory named by AUDIO_BENCHMARK_MEDIA, the MT-32 case needs
+ * the ROMs in MT32_ROM_PATH. Cases whose input is missing are skipped.
+ */
+class AudioBenchmarkTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_rate_converters() {
+		static const int inRates[] = { 8000, 11025, 22050, 32000, 44100, 48000 };
+		static const int outRates[] = { 22050, 44100, 48000 };
+		static const Audio::RateConverterQuality qualities[] = { Audio::kRateConverterFast, Audio::kRateConverterHighQuality };
+		static const char *const qualityNames[] = { "fast", "hq" };
+
+		if (!enabled())
+			return;
+
+		int16 buffer[kChunkFrames * 2];
+		for (uint q = 0; q < ARRAYSIZE(qualities); ++q) {
+			for (uint o = 0; o < ARRAYSIZE(outRates); ++o) {
+				for (uint i = 0; i < ARRAYSIZE(inRates); ++i) {
+					// Equal rates always get the copy converter, whatever the quality
+					const bool copy = (inRates[i] == outRates[o]);
+					if (copy && q > 0)
+						continue;
+
+					for (int stereo = 0; stereo < 2; ++stereo) {
+						ToneStream input(inRates[i], stereo != 0);
+						Audio::RateConverter *converter = Audio::makeRateConverter(inRates[i], outRates[o], stereo != 0, false, qualities[q]);
+
+						const uint32 frames = kSeconds * outRates[o];
+						uint32 done = 0;
+						const double start = wallClock();
+						while (done < frames) {
+							memset(buffer, 0, sizeof(buffer));
+							done += converter->flow(input, buffer, kChunkFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+						}
+						const double seconds = wallClock() - start;
+						delete converter;
+
+						Common::String name = Common::String::format("%s %d->%d %s", copy ? "copy" : qualityNames[q], inRates[i], outRates[o], stereo ? "stereo" : "mono");
+						report("rate", name.c_str(), done, outRates[o], seconds);
+					}
+				}
+			}
+		}
+	}
+
+	void test_mixer() {
+		static const int channelCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+		static const int streamRates[] = { 22050, 44100, 11025, 48000 };
+
+		if (!enabled())
+			return;
+
+		StubSystem system;
+
+		byte buffer[kChunkFrames * 4];
+		for (uint c = 0; c < ARRAYSIZE(channelCounts); ++c) {
+			Audio::MixerImpl *mixer = new Audio::MixerImpl(&system, kMixerRate);
+			mixer->setMaxChannels(channelCounts[c]);
+			mixer->setReady(true);
+
+			for (int i = 0; i < channelCounts[c]; ++i) {
+				Audio::SoundHandle handle;
+				Audio::AudioStream *stream = new ToneStream(streamRates[i % ARRAYSIZE(streamRates)], (i & 1) != 0);
+				mixer->playStream(Audio::Mixer::kPlainSoundType, &handle, stream, -1, 200, (int8)(i * 7 % 127 - 63),
+				                  DisposeAfterUse::YES, false, false);
+			}
+
+			const uint32 frames = kSeconds * kMixerRate;
+			uint32 done = 0;
+			const double start = wallClock();
+			for (; done < frames; done += kChunkFrames)
+				mixer->mixCallback(buffer, sizeof(buffer));
+			const double seconds = wallClock() - start;
+			delete mixer;
+
+			Common::String name = Common::String::format("%d channels", channelCounts[c]);
+			report("mixer", name.c_str(), done, kMixerRate, seconds);
+		}
+	}
+
+	void test_adpcm_decoders() {
+		static const struct {
+			Audio::ADPCMType type;
+			const char *name;
+			int channels;
+			uint32 blockAlign;
+			uint32 headerSize;	///< Bytes at the start of each block which have to be valid
+		} decoders[] = {
+			{ Audio::kADPCMOki,   "oki",   1, 0,    0 },
+			{ Audio::kADPCMMSIma, "msima", 2, 1024, 8 },
+			{ Audio::kADPCMMS,    "ms",    2, 1024, 14 },
+			{ Audio::kADPCMDVI,   "dvi",   2, 0,    0 },
+			{ Audio::kADPCMApple, "apple", 2, 34,   2 },
+			{ Audio::kADPCMDK3,   "dk3",   2, 1024, 16 }
+		};
+		const int rate = 22050;
+		const uint32 size = 256 * 1024;
+
+		if (!enabled())
+			return;
+
+		int16 buffer[kChunkFrames * 2];
+		for (uint d = 0; d < ARRAYSIZE(decoders); ++d) {
+			byte *data = (byte *)malloc(size);
+			uint32 seed = 1;
+			for (uint32 i = 0; i < size; ++i) {
+				seed = seed * 1103515245 + 12345;
+				data[i] = seed >> 16;
+			}
+			if (decoders[d].blockAlign) {
+				for (uint32 block = 0; block < size; block += decoders[d].blockAlign) {
+					memset(data + block, 0, decoders[d].headerSize);
+					if (decoders[d].type == Audio::kADPCMDK3)
+						WRITE_LE_UINT16(data + block + 2, rate);
+				}
+			}
+
+			Common::SeekableReadStream *input = new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+			Audio::RewindableAudioStream *stream = Audio::makeADPCMStream(input, DisposeAfterUse::YES, size,
+			                                                              decoders[d].type, rate, decoders[d].channels,
+			                                                              decoders[d].blockAlign);
+			TS_ASSERT(stream);
+			if (!stream)
+				continue;
+
+			const int channels = stream->isStereo() ? 2 : 1;
+			const uint32 frames = kSeconds * rate;
+			uint32 done = 0;
+			const double start = wallClock();
+			while (done < frames) {
+				const int samples = stream->readBuffer(buffer, kChunkFrames * channels);
+				if (samples <= 0) {
+					if (!stream->rewind())
+						break;
+					continue;
+				}
+				done += samples / channels;
+			}
+			const double seconds = wallClock() - start;
+			delete stream;
+
+			report("adpcm", decoders[d].name, done, rate, seconds);
+		}
+	}
+
+	void test_compressed_decoders() {
+		if (!enabled())
+			return;
+
+#ifdef USE_MAD
+		decodeFile("mp3", "bench.mp3", Audio::makeMP3Stream);
+#endif
+#ifdef USE_VORBIS
+		decodeFile("vorbis", "bench.ogg", Audio::makeVorbisStream);
+#endif
+#ifdef USE_FLAC
+		decodeFile("flac", "bench.flac", Audio::makeFLACStream);
+#endif
+	}
+
+	void test_opl_emulators() {
+		if (!enabled())
+			return;
+
+		StubSystem system;
+
+		// Only one OPL may exist at a time
+		{
+			OPL::MAME::OPL mame;
+			renderOPL("mame opl2", mame, false);
+		}
+
+#ifndef DISABLE_DOSBOX_OPL
+		static const struct {
+			OPL::Config::OplType type;
+			const char *name;
+		} types[] = {
+			{ OPL::Config::kOpl2,     "opl2" },
+			{ OPL::Config::kDualOpl2, "dual opl2" },
+			{ OPL::Config::kOpl3,     "opl3" }
+		};
+
+		for (uint t = 0; t < ARRAYSIZE(types); ++t) {
+			for (int block = 0; block < 2; ++block) {
+				OPL::DOSBox::OPL dosbox(types[t].type);
+				dosbox.setBlockRender(block != 0);
+				Common::String name = Common::String::format("dosbox %s %s", types[t].name, block ? "block" : "sample");
+				renderOPL(name.c_str(), dosbox, types[t].type == OPL::Config::kOpl3);
+			}
+		}
+#endif
+	}
+
+	void test_mt32() {
+#ifdef USE_MT32EMU
+		if (!enabled())
+			return;
+
+		Common::File *controlFile = openROM("MT32_CONTROL.ROM", "CM32L_CONTROL.ROM");
+		Common::File *pcmFile = openROM("MT32_PCM.ROM", "CM32L_PCM.ROM");
+		if (!controlFile || !pcmFile) {
+			delete controlFile;
+			delete pcmFile;
+			return;
+		}
+
+		const MT32Emu::ROMImage *controlROM = MT32Emu::ROMImage::makeROMImage(controlFile);
+		const MT32Emu::ROMImage *pcmROM = MT32Emu::ROMImage::makeROMImage(pcmFile);
+		MT32Emu::Synth *synth = new MT32Emu::Synth();
+		const bool opened = synth->open(*controlROM, *pcmROM);
+		TS_ASSERT(opened);
+
+		if (opened) {
+			// Restart a chord on each melodic part every 200 ms, which keeps
+			// most of the partials busy.
+			const int rate = 32000;
+			const uint32 frames = kSeconds * rate;
+			const uint32 chordFrames = rate / 5;
+			int16 buffer[kChunkFrames * 2];
+			uint32 done = 0;
+			uint32 chord = 0;
+			const double start = wallClock();
+			while (done < frames) {
+				if (done >= chord * chordFrames) {
+					for (int ch = 1; ch <= 8; ++ch) {
+						for (int voice = 0; voice < 3; ++voice) {
+							const byte note = 40 + ch * 3 + voice * 4 + chord % 5;
+							const byte oldNote = 40 + ch * 3 + voice * 4 + (chord + 4) % 5;
+							synth->playMsg((0x80 | ch) | (oldNote << 8));
+							synth->playMsg((0x90 | ch) | (note << 8) | (100 << 16));
+						}
+					}
+					++chord;
+				}
+				synth->render(buffer, kChunkFrames);
+				done += kChunkFrames;
+			}
+			const double seconds = wallClock() - start;
+			synth->close();
+
+			report("mt32", "8 parts", done, rate, seconds);
+		}
+
+		delete synth;
+		MT32Emu::ROMImage::freeROMImage(controlROM);
+		MT32Emu::ROMImage::freeROMImage(pcmROM);
+		delete controlFile;
+		delete pcmFile;
+#endif
+	}
+
+	private:
+	enum {
+		kSeconds = 10,
+		kChunkFrames = 512,
+		kMixerRate = 48000
+	};
+
+	/**
+	 * An endless sine tone, so the stream itself costs next to nothing.
+	 */
+	class ToneStream : public Audio::AudioStream {
+	public:
+		ToneStream(int rate, bool stereo) : _rate(rate), _stereo(stereo), _pos(0) {
+			for (int i = 0; i < kTableSize; ++i)
+				_table[i] = (int16)(sin(i * 2 * M_PI / kTableSize) * 12000);
+		}
+
+		int readBuffer(int16 *buffer, const int numSamples) {
+			for (int i = 0; i < numSamples; ++i)
+				buffer[i] = _table[(_pos++ >> (_stereo ? 1 : 0)) % kTableSize];
+			return numSamples;
+		}
+
+		bool isStereo() const { return _stereo; }
+		int getRate() const { return _rate; }
+		bool endOfData() const { return false; }
+
+	private:
+		enum {
+			kTableSize = 100
+		};
+
+		int16 _table[kTableSize];
+		const int _rate;
+		const bool _stereo;
+		uint32 _pos;
+	};
+
+	static bool enabled() {
+		return getenv("AUDIO_BENCHMARK") != 0;
+	}
+
+	static double wallClock() {
+#ifdef POSIX
+		struct timeval tv;
+		gettimeofday(&tv, 0);
+		return tv.tv_sec + tv.tv_usec / 1000000.0;
+#else
+		return (double)clock() / CLOCKS_PER_SEC;
+#endif
+	}
+
+	/**
+	 * Print the result of one case and append it to the CSV file named
+	 * by AUDIO_BENCHMARK.
+	 */
+	static void report(const char *benchmark, const char *name, uint32 frames, int rate, double seconds) {
+		seconds = MAX(seconds, 0.000001);
+		const double framesPerSecond = frames / seconds;
+		const double realTime = framesPerSecond / rate;
+
+		printf("\n%-8s %-28s %12.0f frames/s %9.1fx real time", benchmark, name, framesPerSecond, realTime);
+
+		const char *path = getenv("AUDIO_BENCHMARK");
+		if (!path || !strcmp(path, "-"))
+			return;
+
+		FILE *f = fopen(path, "a");
+		if (!f)
+			return;
+		fseek(f, 0, SEEK_END);
+		if (ftell(f) == 0)
+			fputs("benchmark,case,frames,rate,seconds,frames_per_second,real_time_factor\n", f);
+		fprintf(f, "%s,%s,%u,%d,%.6f,%.0f,%.2f\n", benchmark, name, frames, rate, seconds, framesPerSecond, realTime);
+		fclose(f);
+	}
+
+	static Common::SeekableReadStream *readFile(const char *dirVariable, const char *name) {
+		const char *dir = getenv(dirVariable);
+		if (!dir)
+			return 0;
+
+		Common::String fileName = Common::String::format("%s/%s", dir, name);
+		FILE *f = fopen(fileName.c_str(), "rb");
+		if (!f)
+			return 0;
+		fseek(f, 0, SEEK_END);
+		const long size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		byte *data = (byte *)malloc(size);
+		if (fread(data, 1, size, f) != (size_t)size) {
+			free(data);
+			fclose(f);
+			return 0;
+		}
+		fclose(f);
+
+		return new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+	}
+
+#ifdef USE_MT32EMU
+	static Common::File *openROM(const char *mt32Name, const char *cm32lName) {
+		const char *names[] = { mt32Name, cm32lName };
+		for (uint i = 0; i < ARRAYSIZE(names); ++i) {
+			Common::SeekableReadStream *stream = readFile("MT32_ROM_PATH", names[i]);
+			if (stream) {
+				Common::File *file = new Common::File();
+				file->open(stream, names[i]);
+				return file;
+			}
+		}
+		return 0;
+	}
+#endif
+
+	typedef Audio::SeekableAudioStream *(*DecoderFactory)(Common::SeekableReadStream *, DisposeAfterUse::Flag);
+
+	/** Decode a whole file from AUDIO_BENCHMARK_MEDIA. */
+	static void decodeFile(const char *benchmark, const char *name, DecoderFactory factory) {
+		Common::SeekableReadStream *input = readFile("AUDIO_BENCHMARK_MEDIA", name);
+		if (!input)
+			return;
+
+		Audio::SeekableAudioStream *stream = factory(input, DisposeAfterUse::YES);
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		const int channels = stream->isStereo() ? 2 : 1;
+		int16 buffer[kChunkFrames * 2];
+		uint32 done = 0;
+		const double start = wallClock();
+		while (!stream->endOfData()) {
+			const int samples = stream->readBuffer(buffer, kChunkFrames * channels);
+			if (samples <= 0)
+				break;
+			done += samples / channels;
+		}
+		const double seconds = wallClock() - start;
+		const int rate = stream->getRate();
+		delete stream;
+
+		report(benchmark, name, done, rate, seconds);
+	}
+
+	/**
+	 * Play nine two-operator voices and restart them every 100 ms, like
+	 * a typical AdLib music driver does.
+	 */
+	static void renderOPL(const char *name, OPL::OPL &opl, bool opl3) {
+		static const byte operatorOffsets[9] = { 0x00, 0x01, 0x02, 0x08, 0x09, 0x0A, 0x10, 0x11, 0x12 };
+		const int rate = 49716;
+
+		TS_ASSERT(opl.init(rate));
+
+		if (opl3)
+			opl.writeReg(0x105, 0x01);
+		opl.writeReg(0x01, 0x20);
+		for (int ch = 0; ch < 9; ++ch) {
+			for (int op = 0; op < 2; ++op) {
+				const int reg = operatorOffsets[ch] + op * 3;
+				opl.writeReg(0x20 + reg, 0x21);
+				opl.writeReg(0x40 + reg, op ? 0x00 : 0x18);
+				opl.writeReg(0x60 + reg, 0xF2);
+				opl.writeReg(0x80 + reg, 0x54);
+				opl.writeReg(0xE0 + reg, ch & 3);
+			}
+			opl.writeReg(0xC0 + ch, opl3 ? 0x36 : 0x06);
+		}
+
+		const int channels = opl.isStereo() ? 2 : 1;
+		const uint32 frames = kSeconds * rate;
+		const uint32 noteFrames = rate / 10;
+		int16 buffer[kChunkFrames * 2];
+		uint32 done = 0;
+		uint32 note = 0;
+		const double start = wallClock();
+		while (done < frames) {
+			if (done >= note * noteFrames) {
+				for (int ch = 0; ch < 9; ++ch) {
+					const int fnum = 0x200 + ((note * 37 + ch * 53) & 0xFF);
+					opl.writeReg(0xB0 + ch, 0);
+					opl.writeReg(0xA0 + ch, fnum & 0xFF);
+					opl.writeReg(0xB0 + ch, 0x20 | (4 << 2) | (fnum >> 8));
+				}
+				++note;
+			}
+			opl.readBuffer(buffer, kChunkFrames * channels);
+			done += kChunkFrames;
+		}
+		const double seconds = wallClock() - start;
+
+		report("opl", name, done, rate, seconds);
+	}
+};
@@ -0,0 +1,102 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/opl/dbopl.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+class DBOPLTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_block_render_matches_sample_render() {
+		compareRenderers(false);
+		compareRenderers(true);
+	}
+
+	private:
+	uint32 _seed;
+
+	uint32 random() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	void writeRandomRegister(OPL::DOSBox::DBOPL::Chip *a, OPL::DOSBox::DBOPL::Chip *b, bool opl3) {
+		// Register groups of the chip with the number of registers in them
+		static const uint32 groups[][2] = {
+			{ 0x20, 0x16 }, { 0x40, 0x16 }, { 0x60, 0x16 }, { 0x80, 0x16 },
+			{ 0xA0, 0x09 }, { 0xB0, 0x09 }, { 0xBD, 0x01 }, { 0xC0, 0x09 },
+			{ 0xE0, 0x16 }
+		};
+
+		uint32 group = random() % ARRAYSIZE(groups);
+		uint32 reg = groups[group][0] + random() % groups[group][1];
+		uint32 val = random() & 0xFF;
+		if (opl3 && (random() & 1))
+			reg += 0x100;
+		// Favour audible notes: short attack, sustain and key on
+		if (reg >= 0x40 && reg < 0x56)
+			val &= 0x1F;
+		else if ((reg & 0xFF) >= 0xB0 && (reg & 0xFF) < 0xB9)
+			val |= 0x20;
+
+		a->WriteReg(reg, val);
+		b->WriteReg(reg, val);
+	}
+
+	void compareRenderers(bool opl3) {
+		OPL::DOSBox::DBOPL::InitTables();
+		OPL::DOSBox::DBOPL::Chip *sampleChip = new OPL::DOSBox::DBOPL::Chip();
+		OPL::DOSBox::DBOPL::Chip *blockChip = new OPL::DOSBox::DBOPL::Chip();
+		sampleChip->Setup(44100);
+		blockChip->Setup(44100);
+		sampleChip->blockRender = false;
+		blockChip->blockRender = true;
+
+		if (opl3) {
+			sampleChip->WriteReg(0x105, 1);
+			blockChip->WriteReg(0x105, 1);
+			sampleChip->WriteReg(0x104, 0x3F);
+			blockChip->WriteReg(0x104, 0x3F);
+		}
+
+		_seed = 1;
+		const uint32 maxSamples = 700;
+		int32 expected[maxSamples * 2];
+		int32 actual[maxSamples * 2];
+		bool audible = false;
+
+		for (int round = 0; round < 200; ++round) {
+			for (int i = 0; i < 8; ++i)
+				writeRandomRegister(sampleChip, blockChip, opl3);
+
+			uint32 samples = 1 + random() % maxSamples;
+			if (opl3) {
+				sampleChip->GenerateBlock3(samples, expected);
+				blockChip->GenerateBlock3(samples, actual);
+			} else {
+				sampleChip->GenerateBlock2(samples, expected);
+				blockChip->GenerateBlock2(samples, actual);
+			}
+
+			const uint32 values = opl3 ? samples * 2 : samples;
+			for (uint32 i = 0; i < values; ++i) {
+				audible |= (expected[i] != 0);
+				if (expected[i] != actual[i]) {
+					TS_ASSERT_EQUALS(expected[i], actual[i]);
+					round = 200;
+					break;
+				}
+			}
+		}
+
+		TS_ASSERT(audible);
+		TS_ASSERT_EQUALS(sampleChip->statSamples, blockChip->statSamples);
+		TS_ASSERT_EQUALS(sampleChip->statRendered, blockChip->statRendered);
+		TS_ASSERT_LESS_THAN_EQUALS(blockChip->statRendered, blockChip->statBlocks);
+
+		delete sampleChip;
+		delete blockChip;
+	}
+};
+
+#endif
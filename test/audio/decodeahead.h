@@ -0,0 +1,166 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decodeahead.h"
+
+#include "helper.h"
+
+/**
+ * A stream counting up from 0, one value per frame, so every sample read
+ * tells where in the stream it came from.
+ */
+class CountingAudioStream : public Audio::SeekableAudioStream {
+public:
+	CountingAudioStream(uint32 frames, bool stereo) : _frames(frames), _stereo(stereo), _pos(0) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		const int channels = _stereo ? 2 : 1;
+		int samples = 0;
+		while (samples + channels <= numSamples && _pos < _frames) {
+			for (int i = 0; i < channels; ++i)
+				buffer[samples++] = value(_pos, i);
+			_pos++;
+		}
+		return samples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return kRate; }
+	bool endOfData() const { return _pos >= _frames; }
+
+	bool seek(const Audio::Timestamp &where) {
+		_pos = MIN<uint32>(where.convertToFramerate(kRate).totalNumberOfFrames(), _frames);
+		return true;
+	}
+	Audio::Timestamp getLength() const { return Audio::Timestamp(0, _frames, kRate); }
+
+	static int16 value(uint32 frame, int channel) {
+		return (int16)((frame & 0x3FFF) | (channel << 14));
+	}
+
+	enum {
+		kRate = 22050
+	};
+
+private:
+	const uint32 _frames;
+	const bool _stereo;
+	uint32 _pos;
+};
+
+class DecodeAheadTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_stream_order() {
+		StubSystem system;
+		CountingAudioStream *source = new CountingAudioStream(10000, false);
+		Audio::DecodeAheadAudioStream stream(source, 1);
+		TS_ASSERT_EQUALS(stream.getLength().totalNumberOfFrames(), 10000);
+
+		// Odd read sizes, with the ring buffer refilled in between
+		int16 buffer[777];
+		uint32 frame = 0;
+		for (int size = 1; !stream.endOfData(); size = (size * 7 + 3) % ARRAYSIZE(buffer)) {
+			const int samples = stream.readBuffer(buffer, size);
+			for (int i = 0; i < samples; ++i)
+				TS_ASSERT_EQUALS(buffer[i], CountingAudioStream::value(frame + i, 0));
+			frame += samples;
+			stream.fill();
+		}
+
+		TS_ASSERT_EQUALS(frame, 10000u);
+		TS_ASSERT_EQUALS(stream.getUnderruns(), 0u);
+	}
+
+	void test_wrap_around() {
+		StubSystem system;
+		Audio::DecodeAheadAudioStream stream(new CountingAudioStream(10000, true), 1);
+
+		// The smallest ring buffer holds kRingFrames frames, and the
+		// constructor filled it
+		int16 buffer[kRingFrames * 2];
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, (kRingFrames - 24) * 2), (kRingFrames - 24) * 2);
+
+		// The next fill wraps around the end of the ring buffer
+		stream.fill();
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, kRingFrames * 2), kRingFrames * 2);
+		for (int i = 0; i < kRingFrames; ++i) {
+			TS_ASSERT_EQUALS(buffer[i * 2], CountingAudioStream::value(kRingFrames - 24 + i, 0));
+			TS_ASSERT_EQUALS(buffer[i * 2 + 1], CountingAudioStream::value(kRingFrames - 24 + i, 1));
+		}
+		TS_ASSERT_EQUALS(stream.getUnderruns(), 0u);
+	}
+
+	void test_underrun() {
+		StubSystem system;
+		Audio::DecodeAheadAudioStream stream(new CountingAudioStream(10000, false), 1);
+
+		int16 buffer[kRingFrames];
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, kRingFrames - 100), kRingFrames - 100);
+
+		// Without a fill, only what is left in the ring buffer is handed out
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 300), 100);
+		TS_ASSERT_EQUALS(buffer[99], CountingAudioStream::value(kRingFrames - 1, 0));
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 50), 0);
+		TS_ASSERT(!stream.endOfData());
+		TS_ASSERT_EQUALS(stream.getUnderruns(), 2u);
+		TS_ASSERT_EQUALS(stream.getUnderrunSamples(), 250u);
+
+		// Playback picks up where it stopped
+		stream.fill();
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 10), 10);
+		TS_ASSERT_EQUALS(buffer[0], CountingAudioStream::value(kRingFrames, 0));
+	}
+
+	void test_seek() {
+		StubSystem system;
+		Audio::DecodeAheadAudioStream stream(new CountingAudioStream(10000, false), 1);
+
+		int16 buffer[100];
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 100), 100);
+
+		// What was decoded before the seek is dropped. The ring buffer only
+		// takes new samples once the reading side has seen the seek.
+		TS_ASSERT(stream.seek(Audio::Timestamp(0, 5000, CountingAudioStream::kRate)));
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 100), 0);
+		TS_ASSERT(!stream.endOfData());
+
+		stream.fill();
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 100), 100);
+		TS_ASSERT_EQUALS(buffer[0], CountingAudioStream::value(5000, 0));
+
+		// Rewinding works the same, also with several seeks in a row
+		stream.seek(Audio::Timestamp(0, 9000, CountingAudioStream::kRate));
+		stream.fill();
+		stream.rewind();
+		stream.fill();
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 100), 0);
+		stream.fill();
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 100), 100);
+		TS_ASSERT_EQUALS(buffer[0], CountingAudioStream::value(0, 0));
+		TS_ASSERT_EQUALS(buffer[99], CountingAudioStream::value(99, 0));
+	}
+
+	void test_seek_after_end() {
+		StubSystem system;
+		Audio::DecodeAheadAudioStream stream(new CountingAudioStream(500, false), 1);
+
+		int16 buffer[600];
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 600), 500);
+		TS_ASSERT(stream.endOfData());
+
+		// A seek revives a stream which played to its end
+		stream.seek(Audio::Timestamp(0, 400, CountingAudioStream::kRate));
+		TS_ASSERT(!stream.endOfData());
+		stream.fill();
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 600), 100);
+		TS_ASSERT_EQUALS(buffer[0], CountingAudioStream::value(400, 0));
+		TS_ASSERT(stream.endOfData());
+		TS_ASSERT_EQUALS(stream.getUnderruns(), 0u);
+	}
+
+	private:
+	enum {
+		// kMinRingFrames in audio/decodeahead.cpp
+		kRingFrames = 1024
+	};
+};
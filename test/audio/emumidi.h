@@ -0,0 +1,164 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/midiparser.h"
+#include "audio/softsynth/emumidi.h"
+
+class EmulatedMidiTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_delayed_events_start_at_their_sample() {
+		RecordingDriver driver;
+		driver.open();
+
+		int16 buffer[300];
+		driver.readBuffer(buffer, ARRAYSIZE(buffer));
+
+		// 25000 Hz at 250 timer calls per second, so 1000 us are
+		// 25 samples and the first callback runs at sample 0.
+		TS_ASSERT_EQUALS(driver._eventCount, 8);
+		TS_ASSERT_EQUALS(driver._events[0].b, 0x10u);
+		TS_ASSERT_EQUALS(driver._events[0].pos, 0u);
+		TS_ASSERT_EQUALS(driver._events[1].b, 0x11u);
+		TS_ASSERT_EQUALS(driver._events[1].pos, 25u);
+		TS_ASSERT_EQUALS(driver._events[2].b, 0xF0u);
+		TS_ASSERT_EQUALS(driver._events[2].pos, 25u);
+		TS_ASSERT_EQUALS(driver._events[3].b, 0x12u);
+		TS_ASSERT_EQUALS(driver._events[3].pos, 50u);
+		TS_ASSERT_EQUALS(driver._events[4].b, 0x13u);
+		TS_ASSERT_EQUALS(driver._events[4].pos, 100u);
+
+		// A delay beyond the timer interval is held back until the next
+		// callback at the most, ahead of the events sent from there.
+		TS_ASSERT_EQUALS(driver._events[5].b, 0x20u);
+		TS_ASSERT_EQUALS(driver._events[5].pos, 200u);
+		TS_ASSERT_EQUALS(driver._events[6].b, 0x10u);
+		TS_ASSERT_EQUALS(driver._events[6].pos, 200u);
+		TS_ASSERT_EQUALS(driver._events[7].b, 0x11u);
+		TS_ASSERT_EQUALS(driver._events[7].pos, 225u);
+	}
+
+	void test_events_outside_the_timer_are_not_delayed() {
+		RecordingDriver driver;
+		driver.open();
+
+		driver.sendDelayed(0x30, 1000);
+		TS_ASSERT_EQUALS(driver._eventCount, 1);
+		TS_ASSERT_EQUALS(driver._events[0].pos, 0u);
+	}
+
+	void test_parser_events_start_at_their_sample() {
+		// One tick is 1000 us at the default tempo with 500 ticks per
+		// quarter note, so 25 samples
+		static const byte smf[] = {
+			'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0x01, 0xF4,
+			'M', 'T', 'r', 'k', 0, 0, 0, 20,
+			0x00, 0x90, 60, 100,
+			0x02, 0x90, 61, 100,
+			0x03, 0x90, 62, 100,
+			0x04, 0x90, 63, 100,
+			0x0B, 0xFF, 0x2F, 0x00
+		};
+		static const uint32 sampleAccurate[] = { 0, 50, 125, 225 };
+		static const uint32 perTick[] = { 0, 0, 100, 200 };
+
+		for (int accurate = 0; accurate < 2; ++accurate) {
+			RecordingDriver driver(false);
+			driver.open();
+
+			MidiParser *parser = MidiParser::createParser_SMF();
+			parser->property(MidiParser::mpSampleAccurate, accurate);
+			parser->setMidiDriver(&driver);
+			parser->setTimerRate(driver.getBaseTempo());
+			TS_ASSERT(parser->loadMusic((byte *)smf, sizeof(smf)));
+			driver.setTimerCallback(parser, MidiParser::timerCallback);
+
+			// Loading resets all channels, which is not of interest here
+			driver._eventCount = 0;
+
+			int16 buffer[300];
+			driver.readBuffer(buffer, ARRAYSIZE(buffer));
+			driver.setTimerCallback(0, 0);
+
+			// Without the property, events are sent at the start of the tick
+			const uint32 *expected = accurate ? sampleAccurate : perTick;
+			int notes = 0;
+			for (int i = 0; i < driver._eventCount; ++i) {
+				if ((driver._events[i].b & 0xF0) != 0x90)
+					continue;
+				TS_ASSERT_LESS_THAN(notes, 4);
+				if (notes < 4) {
+					TS_ASSERT_EQUALS(driver._events[i].b, 0x640090u | ((60u + notes) << 8));
+					TS_ASSERT_EQUALS(driver._events[i].pos, expected[notes]);
+				}
+				++notes;
+			}
+			TS_ASSERT_EQUALS(notes, 4);
+
+			delete parser;
+		}
+	}
+
+	private:
+	struct Event {
+		uint32 b;
+		uint32 pos;
+	};
+
+	class RecordingDriver : public MidiDriver_Emulated {
+	public:
+		RecordingDriver(bool scripted = true) : MidiDriver_Emulated(0), _scripted(scripted), _pos(0), _ticks(0), _eventCount(0) {}
+
+		/** Whether onTimer() sends the scripted events below. */
+		bool _scripted;
+		uint32 _pos;
+		int _ticks;
+		Event _events[16];
+		int _eventCount;
+
+		void record(uint32 b) {
+			if (_eventCount < ARRAYSIZE(_events)) {
+				_events[_eventCount].b = b;
+				_events[_eventCount].pos = _pos;
+				++_eventCount;
+			}
+		}
+
+		void send(uint32 b) { record(b); }
+		void sysEx(const byte *msg, uint16 length) { record(0xF0); }
+		void close() {}
+		MidiChannel *allocateChannel() { return 0; }
+		MidiChannel *getPercussionChannel() { return 0; }
+		bool isStereo() const { return false; }
+		int getRate() const { return 25000; }
+
+	protected:
+		void generateSamples(int16 *buf, int len) {
+			memset(buf, 0, len * sizeof(int16));
+			_pos += len;
+		}
+
+		void onTimer() {
+			static const byte sysExData[] = { 0x41, 0x10 };
+
+			if (!_scripted)
+				return;
+
+			switch (_ticks++) {
+			case 0:
+				sendDelayed(0x12, 2000);
+				sendDelayed(0x11, 1000);
+				sysExDelayed(sysExData, sizeof(sysExData), 1000);
+				sendDelayed(0x10, 0);
+				break;
+			case 1:
+				sendDelayed(0x13, 0);
+				sendDelayed(0x20, 10000);
+				break;
+			case 2:
+				sendDelayed(0x11, 1000);
+				sendDelayed(0x10, 0);
+				break;
+			}
+		}
+	};
+};
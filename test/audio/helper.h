@@ -5,8 +5,12 @@
 
 #include "common/stream.h"
 #include "common/endian.h"
+#include "common/list.h"
+#include "common/system.h"
+#include "graphics/pixelformat.h"
 
 #include <math.h>
+#include <stdio.h>
 #include <limits>
 
 template<typename T>
@@ -65,4 +69,60 @@ static Audio::SeekableAudioStream *createSineStream(const int sampleRate, const
 	return s;
 }
 
+/**
+ * The mixer and the OPL emulators need an OSystem for their mutexes,
+ * clock and random seed. It replaces g_system for its lifetime. The
+ * mutexes do nothing, since the tests only lock them from one thread.
+ * The clock only moves when delayMillis() is called or millis is changed.
+ */
+class StubSystem : public OSystem {
+public:
+	StubSystem() : millis(0), _oldSystem(g_system) { g_system = this; }
+	~StubSystem() { g_system = _oldSystem; }
+
+	const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	int getDefaultGraphicsMode() const { return 0; }
+	bool setGraphicsMode(int mode) { return true; }
+	int getGraphicsMode() const { return 0; }
+	Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat(); }
+	Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+	int16 getHeight() { return 0; }
+	int16 getWidth() { return 0; }
+	PaletteManager *getPaletteManager() { return 0; }
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	Graphics::Surface *lockScreen() { return 0; }
+	void unlockScreen() {}
+	void fillScreen(uint32 col) {}
+	void updateScreen() {}
+	void setShakePos(int shakeOffset) {}
+	void showOverlay() {}
+	void hideOverlay() {}
+	Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(); }
+	void clearOverlay() {}
+	void grabOverlay(void *buf, int pitch) {}
+	void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	int16 getOverlayHeight() { return 0; }
+	int16 getOverlayWidth() { return 0; }
+	bool showMouse(bool visible) { return false; }
+	void warpMouse(int x, int y) {}
+	void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale, const Graphics::PixelFormat *format) {}
+	uint32 getMillis() { return millis; }
+	void delayMillis(uint msecs) { millis += msecs; }
+	void getTimeAndDate(TimeDate &t) const {}
+	MutexRef createMutex() { return (MutexRef)1; }
+	void lockMutex(MutexRef mutex) {}
+	void unlockMutex(MutexRef mutex) {}
+	void deleteMutex(MutexRef mutex) {}
+	Audio::Mixer *getMixer() { return 0; }
+	void quit() {}
+	void displayMessageOnOSD(const char *msg) {}
+	void logMessage(LogMessageType::Type type, const char *message) { fputs(message, stderr); }
+
+	uint32 millis;
+
+private:
+	OSystem *_oldSystem;
+};
+
 #endif
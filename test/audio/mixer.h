@@ -0,0 +1,163 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "audio/decoders/raw.h"
+
+#include "helper.h"
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_grow_channel_table() {
+		StubSystem system;
+		Audio::MixerImpl mixer(&system, kRate);
+		mixer.setReady(true);
+
+		// The limit is clipped to the size of the slot table
+		mixer.setMaxChannels(1000);
+		TS_ASSERT_EQUALS(mixer.getMaxChannels(), 256u);
+
+		Audio::SoundHandle handles[257];
+		for (int i = 0; i < 256; ++i)
+			play(mixer, Audio::Mixer::kSFXSoundType, handles[i]);
+
+		TS_ASSERT_EQUALS(mixer.getChannelCount(), 256u);
+		for (int i = 0; i < 256; ++i)
+			TS_ASSERT(mixer.isSoundHandleActive(handles[i]));
+		TS_ASSERT_EQUALS(mixer.getStolenChannelCount(), 0u);
+
+		// A full table makes room by stopping the oldest sound
+		play(mixer, Audio::Mixer::kSFXSoundType, handles[256]);
+		TS_ASSERT_EQUALS(mixer.getChannelCount(), 256u);
+		TS_ASSERT(!mixer.isSoundHandleActive(handles[0]));
+		TS_ASSERT(mixer.isSoundHandleActive(handles[1]));
+		TS_ASSERT(mixer.isSoundHandleActive(handles[256]));
+		TS_ASSERT_EQUALS(mixer.getStolenChannelCount(), 1u);
+
+		// Slots of stopped channels are reused once the callback let go
+		mixer.stopAll();
+		mix(mixer);
+		TS_ASSERT_EQUALS(mixer.getChannelCount(), 0u);
+		play(mixer, Audio::Mixer::kSFXSoundType, handles[0]);
+		TS_ASSERT_EQUALS(mixer.getChannelCount(), 1u);
+	}
+
+	void test_steal_by_priority() {
+		StubSystem system;
+		Audio::MixerImpl mixer(&system, kRate);
+		mixer.setReady(true);
+		mixer.setMaxChannels(4);
+
+		Audio::SoundHandle permanent, speech, music, sfx, plain, sfx2, sfx3;
+		play(mixer, Audio::Mixer::kSFXSoundType, permanent, true);
+		play(mixer, Audio::Mixer::kSpeechSoundType, speech);
+		play(mixer, Audio::Mixer::kMusicSoundType, music);
+		play(mixer, Audio::Mixer::kSFXSoundType, sfx);
+
+		// Plain sounds go over sound effects, but never over permanent sounds
+		play(mixer, Audio::Mixer::kPlainSoundType, plain);
+		TS_ASSERT(mixer.isSoundHandleActive(plain));
+		TS_ASSERT(!mixer.isSoundHandleActive(sfx));
+		TS_ASSERT(mixer.isSoundHandleActive(permanent));
+
+		// Nothing has a priority as low as a sound effect now
+		play(mixer, Audio::Mixer::kSFXSoundType, sfx2);
+		TS_ASSERT(!mixer.isSoundHandleActive(sfx2));
+		TS_ASSERT_EQUALS(mixer.getChannelCount(), 4u);
+		TS_ASSERT_EQUALS(mixer.getStolenChannelCount(), 1u);
+
+		// Raised over music, the lowest priority sound, the plain one, goes
+		mixer.setSoundTypePriority(Audio::Mixer::kSFXSoundType, 2);
+		TS_ASSERT_EQUALS(mixer.getSoundTypePriority(Audio::Mixer::kSFXSoundType), 2);
+		play(mixer, Audio::Mixer::kSFXSoundType, sfx3);
+		TS_ASSERT(mixer.isSoundHandleActive(sfx3));
+		TS_ASSERT(!mixer.isSoundHandleActive(plain));
+		TS_ASSERT(mixer.isSoundHandleActive(music));
+		TS_ASSERT(mixer.isSoundHandleActive(speech));
+		TS_ASSERT_EQUALS(mixer.getStolenChannelCount(), 2u);
+	}
+
+	void test_channel_stats() {
+		StubSystem system;
+		Audio::MixerImpl mixer(&system, kRate);
+		mixer.setReady(true);
+
+		// A stream which finishes after 100 frames, and one which runs dry
+		Audio::QueuingAudioStream *finite = Audio::makeQueuingAudioStream(kRate, true);
+		byte *data = (byte *)calloc(100 * 4, 1);
+		finite->queueBuffer(data, 100 * 4, DisposeAfterUse::YES, Audio::FLAG_16BITS | Audio::FLAG_STEREO);
+		finite->finish();
+
+		Audio::SoundHandle finiteHandle, dryHandle;
+		Audio::Mixer &base = mixer;
+		base.playStream(Audio::Mixer::kSFXSoundType, &finiteHandle, finite);
+		play(mixer, Audio::Mixer::kMusicSoundType, dryHandle);
+
+		mix(mixer);
+		Audio::Mixer::ChannelStats stats;
+		TS_ASSERT(mixer.getChannelStats(finiteHandle, stats));
+		TS_ASSERT_EQUALS(stats.framesMixed, 64u);
+		TS_ASSERT_EQUALS(stats.underruns, 0u);
+		TS_ASSERT(mixer.getChannelStats(dryHandle, stats));
+		TS_ASSERT_EQUALS(stats.framesMixed, 0u);
+		TS_ASSERT_EQUALS(stats.underruns, 1u);
+
+		// The finished stream is let go of in the callback after its end
+		mix(mixer);
+		TS_ASSERT(mixer.getChannelStats(finiteHandle, stats));
+		TS_ASSERT_EQUALS(stats.framesMixed, 100u);
+		mix(mixer);
+		TS_ASSERT(!mixer.getChannelStats(finiteHandle, stats));
+		TS_ASSERT(mixer.getChannelStats(dryHandle, stats));
+		TS_ASSERT_EQUALS(stats.underruns, 3u);
+		TS_ASSERT_EQUALS(mixer.getChannelCount(), 1u);
+	}
+
+	void test_converter_tail() {
+		StubSystem system;
+		Audio::MixerImpl mixer(&system, 44100);
+		mixer.setReady(true);
+
+		// Resampled by the sinc converter, which holds back the end of the stream
+		const int inFrames = 1000;
+		Audio::QueuingAudioStream *stream = Audio::makeQueuingAudioStream(22050, false);
+		int16 *data = (int16 *)malloc(inFrames * 2);
+		for (int i = 0; i < inFrames; ++i)
+			data[i] = TO_BE_16(10000);
+		stream->queueBuffer((byte *)data, inFrames * 2, DisposeAfterUse::YES, Audio::FLAG_16BITS);
+		stream->finish();
+
+		Audio::SoundHandle handle;
+		Audio::Mixer &base = mixer;
+		base.playStream(Audio::Mixer::kSFXSoundType, &handle, stream);
+
+		Audio::Mixer::ChannelStats stats;
+		uint32 frames = 0;
+		for (int i = 0; i < 100 && mixer.getChannelStats(handle, stats); ++i) {
+			frames = stats.framesMixed;
+			mix(mixer);
+		}
+
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT_LESS_THAN((uint32)inFrames * 2, frames);
+		TS_ASSERT_LESS_THAN_EQUALS(frames, (uint32)inFrames * 2 + 32);
+	}
+
+	private:
+	enum {
+		kRate = 22050,
+		kMixFrames = 64
+	};
+
+	/** Play a stream which never finishes. */
+	static void play(Audio::MixerImpl &mixer, Audio::Mixer::SoundType type, Audio::SoundHandle &handle, bool permanent = false) {
+		mixer.playStream(type, &handle, Audio::makeQueuingAudioStream(kRate, true), -1,
+			Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, permanent, false);
+	}
+
+	static void mix(Audio::MixerImpl &mixer) {
+		int16 buffer[kMixFrames * 2];
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+	}
+};
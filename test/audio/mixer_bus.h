@@ -0,0 +1,71 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_bus.h"
+
+class MixerBusTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_mix_volume_and_balance() {
+		// An odd number of sample pairs exercises the scalar tail, too
+		const int frames = 13;
+		int16 src[frames * 2];
+		int32 bus[frames * 2];
+
+		for (int i = 0; i < frames * 2; ++i) {
+			src[i] = (int16)((i * 2731) % 65536 - 32768);
+			bus[i] = i;
+		}
+
+		Audio::mixToBus(bus, src, frames, 256, 64);
+
+		for (int i = 0; i < frames; ++i) {
+			TS_ASSERT_EQUALS(bus[i * 2], i * 2 + src[i * 2] * 256);
+			TS_ASSERT_EQUALS(bus[i * 2 + 1], i * 2 + 1 + src[i * 2 + 1] * 64);
+		}
+	}
+
+	void test_convert_rounds_and_saturates() {
+		const int frames = 9;
+		const int32 bus[frames * 2] = {
+			0, 127, 128, -128, -129, 256 * 100, -256 * 100, 256 * 40000,
+			-256 * 40000, 256 * 32767, -256 * 32768, 383, 384, -384, -385, 1 << 30,
+			-(1 << 30), 5
+		};
+		const int16 expected[frames * 2] = {
+			0, 0, 1, 0, -1, 100, -100, 32767,
+			-32768, 32767, -32768, 1, 2, -1, -2, 32767,
+			-32768, 0
+		};
+		int16 dst[frames * 2];
+
+		Audio::convertBus(dst, bus, frames);
+
+		for (int i = 0; i < frames * 2; ++i) {
+#ifdef OUTPUT_UNSIGNED_AUDIO
+			TS_ASSERT_EQUALS(dst[i], (int16)(expected[i] ^ 0x8000));
+#else
+			TS_ASSERT_EQUALS(dst[i], expected[i]);
+#endif
+		}
+	}
+
+	void test_mix_does_not_clip_between_channels() {
+		const int16 loud[8] = { 30000, -30000, 30000, -30000, 30000, -30000, 30000, -30000 };
+		const int16 inverted[8] = { -30000, 30000, -30000, 30000, -30000, 30000, -30000, 30000 };
+		int32 bus[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		int16 dst[8];
+
+		Audio::mixToBus(bus, loud, 4, 256, 256);
+		Audio::mixToBus(bus, loud, 4, 256, 256);
+		Audio::mixToBus(bus, inverted, 4, 256, 256);
+		Audio::convertBus(dst, bus, 4);
+
+		for (int i = 0; i < 8; ++i) {
+#ifdef OUTPUT_UNSIGNED_AUDIO
+			TS_ASSERT_EQUALS(dst[i], (int16)(loud[i] ^ 0x8000));
+#else
+			TS_ASSERT_EQUALS(dst[i], loud[i]);
+#endif
+		}
+	}
+};
@@ -0,0 +1,254 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#ifdef USE_MT32EMU
+
+#include "audio/mididrv.h"
+#include "audio/midiparser.h"
+#include "audio/softsynth/mt32/mt32emu.h"
+
+#include "common/array.h"
+#include "common/file.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#if MT32EMU_USE_THREADS
+#include <sys/time.h>
+#endif
+
+/**
+ * The MT-32 tests need the ROM images, which are not bundled. They only
+ * run when MT32_ROM_PATH names a directory holding them, and are skipped
+ * with a warning otherwise. When AUDIO_BENCHMARK is set as well, the
+ * real-time factor of each thread count is printed.
+ */
+class MT32TestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_threaded_render_matches_serial() {
+		static const uint threadCounts[] = { 1, 2, 4 };
+
+		if (!getenv("MT32_ROM_PATH")) {
+			TS_WARN("MT32_ROM_PATH is not set, skipping the MT-32 tests");
+			return;
+		}
+
+		Common::Array<byte> smf;
+		makeDenseSMF(smf);
+
+		Common::Array<int16> reference;
+		for (uint i = 0; i < ARRAYSIZE(threadCounts); ++i) {
+			Common::Array<int16> output;
+			uint usedThreads;
+			double seconds;
+			if (!renderSMF(smf, threadCounts[i], output, usedThreads, seconds)) {
+				TS_FAIL("MT-32 ROM images not found in MT32_ROM_PATH");
+				return;
+			}
+
+			if (getenv("AUDIO_BENCHMARK")) {
+				double audioSeconds = (double)output.size() / 2 / kRate;
+				printf("\nMT-32 dense SMF, %u render thread(s): %.2fx real time", usedThreads, audioSeconds / seconds);
+			}
+
+			if (i == 0) {
+				reference = output;
+				continue;
+			}
+
+			TS_ASSERT_EQUALS(output.size(), reference.size());
+			TS_ASSERT(!memcmp(output.begin(), reference.begin(), MIN(output.size(), reference.size()) * sizeof(int16)));
+		}
+	}
+
+	private:
+	enum {
+		kRate = 32000,
+		kTickMicros = 4000,
+		kTickFrames = 128,
+		kTailFrames = kRate
+	};
+
+	class SynthDriver : public MidiDriver_BASE {
+	public:
+		SynthDriver(MT32Emu::Synth *synth) : _synth(synth) {}
+		void send(uint32 b) { _synth->playMsg(b); }
+		void sysEx(const byte *msg, uint16 length) { _synth->playSysexWithoutFraming(msg, length); }
+	private:
+		MT32Emu::Synth *_synth;
+	};
+
+	static Common::File *openROM(const char *name) {
+		const char *path = getenv("MT32_ROM_PATH");
+		if (!path)
+			return 0;
+
+		Common::String fileName = Common::String::format("%s/%s", path, name);
+		FILE *f = fopen(fileName.c_str(), "rb");
+		if (!f)
+			return 0;
+		fseek(f, 0, SEEK_END);
+		long size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		byte *data = (byte *)malloc(size);
+		if (fread(data, 1, size, f) != (size_t)size) {
+			free(data);
+			fclose(f);
+			return 0;
+		}
+		fclose(f);
+
+		Common::File *file = new Common::File();
+		file->open(new Common::MemoryReadStream(data, size, DisposeAfterUse::YES), name);
+		return file;
+	}
+
+	static Common::File *openROM(const char *mt32Name, const char *cm32lName) {
+		Common::File *file = openROM(mt32Name);
+		return file ? file : openROM(cm32lName);
+	}
+
+	static void writeVLQ(Common::Array<byte> &out, uint32 value) {
+		byte bytes[4];
+		int count = 0;
+		do {
+			bytes[count++] = value & 0x7F;
+			value >>= 7;
+		} while (value);
+		while (count > 1)
+			out.push_back(bytes[--count] | 0x80);
+		out.push_back(bytes[0]);
+	}
+
+	static void writeEvent(Common::Array<byte> &out, uint32 delta, byte status, byte data1, byte data2) {
+		writeVLQ(out, delta);
+		out.push_back(status);
+		out.push_back(data1);
+		out.push_back(data2);
+	}
+
+	/**
+	 * Build a format 0 SMF keeping all melodic parts and the rhythm part
+	 * busy with overlapping chords, so the partial table stays saturated.
+	 */
+	static void makeDenseSMF(Common::Array<byte> &smf) {
+		static const byte programs[] = { 0, 16, 32, 48, 52, 61, 88, 94 };
+		static const byte drums[] = { 36, 38, 42, 46, 49 };
+		const int steps = 64;
+		const int stepTicks = 24;
+
+		Common::Array<byte> track;
+		for (int ch = 1; ch <= 8; ++ch) {
+			writeVLQ(track, 0);
+			track.push_back(0xC0 | ch);
+			track.push_back(programs[ch - 1]);
+		}
+
+		uint32 delta = 0;
+		for (int step = 0; step <= steps; ++step) {
+			for (int ch = 1; ch <= 8; ++ch) {
+				for (int voice = 0; voice < 3; ++voice) {
+					byte note = 40 + ch * 3 + voice * 4 + (step % 5);
+					if (step >= 2) {
+						byte oldNote = 40 + ch * 3 + voice * 4 + ((step - 2) % 5);
+						writeEvent(track, delta, 0x80 | ch, oldNote, 0);
+						delta = 0;
+					}
+					if (step < steps - 2) {
+						writeEvent(track, delta, 0x90 | ch, note, 80 + voice * 10);
+						delta = 0;
+					}
+				}
+			}
+			if (step < steps)
+				writeEvent(track, delta, 0x99, drums[step % ARRAYSIZE(drums)], 100);
+			delta = stepTicks;
+		}
+		writeVLQ(track, delta);
+		track.push_back(0xFF);
+		track.push_back(0x2F);
+		track.push_back(0x00);
+
+		static const byte header[] = {
+			'M', 'T', 'h', 'd', 0, 0, 0, 6,
+			0, 0, 0, 1, 0, 96,
+			'M', 'T', 'r', 'k'
+		};
+		smf.clear();
+		for (uint i = 0; i < ARRAYSIZE(header); ++i)
+			smf.push_back(header[i]);
+		for (int shift = 24; shift >= 0; shift -= 8)
+			smf.push_back((track.size() >> shift) & 0xFF);
+		for (uint i = 0; i < track.size(); ++i)
+			smf.push_back(track[i]);
+	}
+
+	static double wallClock() {
+#if MT32EMU_USE_THREADS
+		struct timeval tv;
+		gettimeofday(&tv, 0);
+		return tv.tv_sec + tv.tv_usec / 1000000.0;
+#else
+		return (double)clock() / CLOCKS_PER_SEC;
+#endif
+	}
+
+	/**
+	 * Play the SMF through a fresh Synth the way MidiDriver_Emulated does,
+	 * ticking the parser every kTickFrames frames.
+	 */
+	static bool renderSMF(Common::Array<byte> &smf, uint threads, Common::Array<int16> &output, uint &usedThreads, double &seconds) {
+		Common::File *controlFile = openROM("MT32_CONTROL.ROM", "CM32L_CONTROL.ROM");
+		Common::File *pcmFile = openROM("MT32_PCM.ROM", "CM32L_PCM.ROM");
+		if (!controlFile || !pcmFile) {
+			delete controlFile;
+			delete pcmFile;
+			return false;
+		}
+
+		const MT32Emu::ROMImage *controlROM = MT32Emu::ROMImage::makeROMImage(controlFile);
+		const MT32Emu::ROMImage *pcmROM = MT32Emu::ROMImage::makeROMImage(pcmFile);
+		MT32Emu::Synth *synth = new MT32Emu::Synth();
+		bool opened = synth->open(*controlROM, *pcmROM);
+		TS_ASSERT(opened);
+
+		if (opened) {
+			usedThreads = synth->setRenderThreadCount(threads);
+
+			SynthDriver driver(synth);
+			MidiParser *parser = MidiParser::createParser_SMF();
+			parser->setMidiDriver(&driver);
+			parser->setTimerRate(kTickMicros);
+			TS_ASSERT(parser->loadMusic(smf.begin(), smf.size()));
+
+			int16 buffer[kTickFrames * 2];
+			output.clear();
+			double start = wallClock();
+			for (uint32 tail = 0; tail < kTailFrames; ) {
+				if (parser->isPlaying())
+					parser->onTimer();
+				else
+					tail += kTickFrames;
+				synth->render(buffer, kTickFrames);
+				for (uint i = 0; i < ARRAYSIZE(buffer); ++i)
+					output.push_back(buffer[i]);
+			}
+			seconds = MAX(wallClock() - start, 0.001);
+
+			delete parser;
+			synth->close();
+		}
+
+		delete synth;
+		MT32Emu::ROMImage::freeROMImage(controlROM);
+		MT32Emu::ROMImage::freeROMImage(pcmROM);
+		delete controlFile;
+		delete pcmFile;
+		return opened;
+	}
+};
+
+#endif
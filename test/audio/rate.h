@@ -0,0 +1,168 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/decoders/raw.h"
+
+#include "common/endian.h"
+
+#include <math.h>
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+	private:
+	static Audio::AudioStream *createStream(const int16 *samples, int numSamples, int rate, bool stereo) {
+		byte *data = (byte *)malloc(numSamples * 2);
+		for (int i = 0; i < numSamples; ++i)
+			WRITE_LE_UINT16(data + i * 2, samples[i]);
+
+		return Audio::makeRawStream(data, numSamples * 2, rate,
+		                            Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (stereo ? Audio::FLAG_STEREO : 0));
+	}
+
+	/** Convert a whole stream, returning the number of sample pairs written. */
+	static int convert(Audio::RateConverter *converter, Audio::AudioStream *stream, int16 *out, int maxFrames) {
+		memset(out, 0, maxFrames * 4);
+
+		int total = 0;
+		while (total < maxFrames) {
+			const int frames = converter->flow(*stream, out + total * 2, MIN(maxFrames - total, 1000),
+			                                   Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			if (frames <= 0)
+				break;
+			total += frames;
+		}
+		return total;
+	}
+
+	public:
+	void test_sinc_keeps_constant_signal() {
+		const int inFrames = 2205;
+		int16 *in = new int16[inFrames];
+		for (int i = 0; i < inFrames; ++i)
+			in[i] = 10000;
+
+		Audio::AudioStream *stream = createStream(in, inFrames, 22050, false);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 48000, false, false, Audio::kRateConverterHighQuality);
+
+		int16 *out = new int16[5000 * 2];
+		const int frames = convert(converter, stream, out, 5000);
+
+		// All input is consumed, minus the samples still in the filter
+		TS_ASSERT_LESS_THAN_EQUALS(inFrames * 48000 / 22050 - 40, frames);
+		TS_ASSERT_LESS_THAN_EQUALS(frames, inFrames * 48000 / 22050 + 1);
+
+		// Once the filter is filled, the level must stay constant
+		for (int i = 40; i < frames - 40; ++i) {
+			TS_ASSERT_LESS_THAN_EQUALS(abs(out[i * 2] - 10000), 2);
+			TS_ASSERT_EQUALS(out[i * 2], out[i * 2 + 1]);
+		}
+
+		delete converter;
+		delete stream;
+		delete[] out;
+		delete[] in;
+	}
+
+	void test_sinc_follows_sine() {
+		const int inRate = 11025, outRate = 48000;
+		const int inFrames = 4000;
+		const double freq = 1000.0, amplitude = 16000.0;
+
+		int16 *in = new int16[inFrames * 2];
+		for (int i = 0; i < inFrames; ++i) {
+			in[i * 2] = (int16)(amplitude * sin(2 * M_PI * freq * i / inRate));
+			in[i * 2 + 1] = -in[i * 2];
+		}
+
+		Audio::AudioStream *stream = createStream(in, inFrames * 2, inRate, true);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, true, false, Audio::kRateConverterHighQuality);
+
+		const int maxFrames = inFrames * outRate / inRate + 100;
+		int16 *out = new int16[maxFrames * 2];
+		const int frames = convert(converter, stream, out, maxFrames);
+
+		// The filter delays the signal by half its length, i.e. 8 input samples
+		const double delay = 8.0;
+		double maxError = 0.0;
+		for (int i = 200; i < frames - 200; ++i) {
+			const double t = (double)i * inRate / outRate - delay;
+			const double expected = amplitude * sin(2 * M_PI * freq * t / inRate);
+			maxError = MAX(maxError, fabs(out[i * 2] - expected));
+			TS_ASSERT_LESS_THAN_EQUALS(abs(out[i * 2] + out[i * 2 + 1]), 1);
+		}
+
+		// Within 1% of the amplitude
+		TS_ASSERT_LESS_THAN(maxError, amplitude / 100);
+
+		delete converter;
+		delete stream;
+		delete[] out;
+		delete[] in;
+	}
+
+	void test_sinc_drain_flushes_tail() {
+		const int inFrames = 1000;
+		int16 *in = new int16[inFrames];
+		for (int i = 0; i < inFrames; ++i)
+			in[i] = 10000;
+
+		Audio::AudioStream *stream = createStream(in, inFrames, 22050, false);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, false, false, Audio::kRateConverterHighQuality);
+
+		const int maxFrames = inFrames * 2 + 100;
+		int16 *out = new int16[maxFrames * 2];
+		int frames = convert(converter, stream, out, maxFrames);
+		TS_ASSERT(stream->endOfStream());
+
+		// Without draining, the last input samples never leave the filter
+		TS_ASSERT_LESS_THAN_EQUALS(frames, inFrames * 2);
+
+		while (frames < maxFrames) {
+			const int drained = converter->drain(out + frames * 2, MIN(maxFrames - frames, 7), Audio::Mixer::kMaxMixerVolume);
+			frames += drained;
+			if (drained < 7)
+				break;
+		}
+		TS_ASSERT_EQUALS(converter->drain(out, 10, Audio::Mixer::kMaxMixerVolume), 0);
+
+		// The filter has unity gain, so all of the input makes it to the output
+		double sum = 0;
+		for (int i = 0; i < frames; ++i)
+			sum += out[i * 2];
+		TS_ASSERT_LESS_THAN(fabs(sum - 2.0 * inFrames * 10000), 10000);
+
+		// The output fades out with the end of the filter
+		TS_ASSERT_LESS_THAN(inFrames * 2, frames);
+		TS_ASSERT_LESS_THAN(abs(out[(frames - 1) * 2]), 100);
+
+		delete converter;
+		delete stream;
+		delete[] out;
+		delete[] in;
+	}
+
+	void test_sinc_reverse_stereo() {
+		const int16 in[] = { 1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000,
+		                     1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000,
+		                     1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000, 1000, -2000 };
+		const int inSamples = ARRAYSIZE(in);
+
+		Audio::AudioStream *stream = createStream(in, inSamples, 44100, true);
+		Audio::RateConverter *converter = Audio::makeRateConverter(44100, 48000, true, true, Audio::kRateConverterHighQuality);
+
+		int16 out[100 * 2];
+		const int frames = convert(converter, stream, out, 100);
+		TS_ASSERT_LESS_THAN(0, frames);
+
+		// Once the filter is filled, the right output carries the left input
+		for (int i = 16; i < frames; ++i) {
+			TS_ASSERT_LESS_THAN_EQUALS(abs(out[i * 2] + 2000), 2);
+			TS_ASSERT_LESS_THAN_EQUALS(abs(out[i * 2 + 1] - 1000), 2);
+		}
+
+		delete converter;
+		delete stream;
+	}
+};
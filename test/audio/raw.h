@@ -287,4 +287,60 @@ public:
 	void test_seek_stereo() {
 		seekTest(11025, 2, true);
 	}
+
+	void test_matches_reference() {
+		// Odd sizes and read lengths, so the vectorized conversions get
+		// unaligned heads and leftover tails
+		const uint32 size = 4003 * 4;
+		byte *data = (byte *)malloc(size);
+		uint32 seed = 1;
+		for (uint32 i = 0; i < size; ++i) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+
+		int16 *expected = new int16[size];
+		int16 *out = new int16[size];
+		static const int chunkSizes[] = { 1, 17, 4096 };
+
+		for (byte flags = 0; flags < 16; ++flags) {
+			const bool is16Bits = (flags & Audio::FLAG_16BITS) != 0;
+			const bool isUnsigned = (flags & Audio::FLAG_UNSIGNED) != 0;
+			const int samples = is16Bits ? size / 2 : size;
+
+			// Sample by sample, as the stream did before bulk conversion
+			for (int i = 0; i < samples; ++i) {
+				if (is16Bits) {
+					uint16 v = (flags & Audio::FLAG_LITTLE_ENDIAN) ? READ_LE_UINT16(data + i * 2) : READ_BE_UINT16(data + i * 2);
+					expected[i] = (int16)(isUnsigned ? v ^ 0x8000 : v);
+				} else {
+					expected[i] = (int16)((isUnsigned ? data[i] ^ 0x80 : data[i]) << 8);
+				}
+			}
+
+			for (uint c = 0; c < ARRAYSIZE(chunkSizes); ++c) {
+				Audio::SeekableAudioStream *stream = Audio::makeRawStream(data, size, 22050, flags, DisposeAfterUse::NO);
+				int total = 0;
+				while (total < samples) {
+					// Stereo streams are read in whole frames
+					int chunk = MIN(chunkSizes[c], samples - total);
+					if ((flags & Audio::FLAG_STEREO) && (chunk & 1))
+						chunk++;
+					const int read = stream->readBuffer(out + total, chunk);
+					if (read <= 0)
+						break;
+					total += read;
+				}
+				TS_ASSERT(stream->endOfData());
+				delete stream;
+
+				TS_ASSERT_EQUALS(total, samples);
+				TS_ASSERT_EQUALS(memcmp(out, expected, samples * sizeof(int16)), 0);
+			}
+		}
+
+		delete[] expected;
+		delete[] out;
+		free(data);
+	}
 };
@@ -3,6 +3,13 @@
 #include "common/bitstream.h"
 #include "common/memstream.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef POSIX
+#include <sys/time.h>
+#endif
+
 class BitStreamTestSuite : public CxxTest::TestSuite
 {
 	public:
@@ -149,4 +156,190 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(bs.peekBits(5), 12u);
 		TS_ASSERT(!bs.eos());
 	}
+
+	void test_peek_bits_past_end() {
+		byte contents[] = { 'a', 'b' };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		Common::BitStream8MSB bs(ms);
+		bs.skip(11);
+		TS_ASSERT_EQUALS(bs.peekBits(8), 16u);
+		TS_ASSERT_EQUALS(bs.pos(), 11u);
+		TS_ASSERT_EQUALS(bs.getBits(5), 2u);
+		TS_ASSERT_EQUALS(bs.peekBits(8), 0u);
+		TS_ASSERT(bs.eos());
+	}
+
+	void test_peek_bits_past_end_lsb() {
+		byte contents[] = { 'a', 'b' };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		Common::BitStream8LSB bs(ms);
+		bs.skip(11);
+		TS_ASSERT_EQUALS(bs.peekBits(8), 12u);
+		TS_ASSERT_EQUALS(bs.pos(), 11u);
+		TS_ASSERT_EQUALS(bs.getBits(5), 12u);
+		TS_ASSERT(bs.eos());
+	}
+
+	void test_skip_values() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		Common::BitStream8MSB bs(ms);
+		TS_ASSERT_EQUALS(bs.getBits(3), 0u);
+		bs.skip(67);
+		TS_ASSERT_EQUALS(bs.pos(), 70u);
+		TS_ASSERT_EQUALS(bs.getBits(4), 4u);
+		bs.skip(18);
+		TS_ASSERT_EQUALS(bs.pos(), 92u);
+		TS_ASSERT_EQUALS(bs.getBits(4), 12u);
+		TS_ASSERT(bs.eos());
+	}
+
+	void test_memory_get_bits() {
+		byte contents[] = { 'a', 'b' };
+
+		Common::BitStreamMemoryStream ms(contents, sizeof(contents));
+
+		Common::BitStreamMemory8MSB bs(ms);
+		TS_ASSERT_EQUALS(bs.getBits(3), 3u);
+		TS_ASSERT_EQUALS(bs.peekBits(5), 1u);
+		TS_ASSERT_EQUALS(bs.getBits(5), 1u);
+		TS_ASSERT_EQUALS(bs.getBits(8), 98u);
+		TS_ASSERT_EQUALS(bs.peekBits(8), 0u);
+		TS_ASSERT(bs.eos());
+		TS_ASSERT(bs.isMSBFirst());
+
+		bs.rewind();
+		TS_ASSERT_EQUALS(bs.getBits(16), 0x6162u);
+	}
+
+	void test_memory_get_bits_lsb() {
+		byte contents[] = { 'a', 'b' };
+
+		Common::BitStreamMemoryStream ms(contents, sizeof(contents));
+
+		Common::BitStreamMemory8LSB bs(ms);
+		TS_ASSERT_EQUALS(bs.getBits(3), 1u);
+		TS_ASSERT_EQUALS(bs.getBits(8), 76u);
+		TS_ASSERT_EQUALS(bs.peekBits(8), 12u);
+		TS_ASSERT_EQUALS(bs.pos(), 11u);
+		TS_ASSERT(!bs.isMSBFirst());
+	}
+
+	void test_memory_layouts() {
+		compareLayout<Common::BitStream8MSB,    Common::BitStreamMemory8MSB   >();
+		compareLayout<Common::BitStream8LSB,    Common::BitStreamMemory8LSB   >();
+		compareLayout<Common::BitStream16LEMSB, Common::BitStreamMemory16LEMSB>();
+		compareLayout<Common::BitStream16LELSB, Common::BitStreamMemory16LELSB>();
+		compareLayout<Common::BitStream16BEMSB, Common::BitStreamMemory16BEMSB>();
+		compareLayout<Common::BitStream16BELSB, Common::BitStreamMemory16BELSB>();
+		compareLayout<Common::BitStream32LEMSB, Common::BitStreamMemory32LEMSB>();
+		compareLayout<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>();
+		compareLayout<Common::BitStream32BEMSB, Common::BitStreamMemory32BEMSB>();
+		compareLayout<Common::BitStream32BELSB, Common::BitStreamMemory32BELSB>();
+	}
+
+	/**
+	 * Throughput of the stream and memory based bit streams. It is skipped
+	 * unless BITSTREAM_BENCHMARK is set, and prints the time a getBits(),
+	 * and a peekBits() plus skip() pair, take in nanoseconds.
+	 */
+	void test_benchmark() {
+		if (!getenv("BITSTREAM_BENCHMARK"))
+			return;
+
+		const uint32 size = 4 << 20;
+		byte *data = (byte *)malloc(size);
+		for (uint32 i = 0; i < size; i++)
+			data[i] = (byte)(i * 2654435761u >> 24);
+
+		benchmark<Common::BitStream8LSB,          Common::MemoryReadStream     >("stream 8LSB",    data, size);
+		benchmark<Common::BitStreamMemory8LSB,    Common::BitStreamMemoryStream>("memory 8LSB",    data, size);
+		benchmark<Common::BitStream32LELSB,       Common::MemoryReadStream     >("stream 32LELSB", data, size);
+		benchmark<Common::BitStreamMemory32LELSB, Common::BitStreamMemoryStream>("memory 32LELSB", data, size);
+		benchmark<Common::BitStream32BEMSB,       Common::MemoryReadStream     >("stream 32BEMSB", data, size);
+		benchmark<Common::BitStreamMemory32BEMSB, Common::BitStreamMemoryStream>("memory 32BEMSB", data, size);
+
+		free(data);
+	}
+
+	private:
+	/** Read the same random data through both bit streams, in random steps. */
+	template<class STREAM, class MEMORY>
+	static void compareLayout() {
+		byte contents[64];
+		uint32 seed = 1;
+		for (uint32 i = 0; i < sizeof(contents); i++)
+			contents[i] = (byte)(nextRandom(seed) >> 8);
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		Common::BitStreamMemoryStream mms(contents, sizeof(contents));
+
+		STREAM bs(ms);
+		MEMORY mbs(mms);
+		TS_ASSERT_EQUALS(bs.size(), mbs.size());
+
+		while (bs.pos() < bs.size()) {
+			uint32 left = bs.size() - bs.pos();
+			uint8 n = nextRandom(seed) % 33;
+			if (n > left)
+				n = left;
+
+			TS_ASSERT_EQUALS(bs.peekBits(32), mbs.peekBits(32));
+			if (nextRandom(seed) & 1) {
+				TS_ASSERT_EQUALS(bs.getBits(n), mbs.getBits(n));
+			} else {
+				bs.skip(n);
+				mbs.skip(n);
+			}
+			TS_ASSERT_EQUALS(bs.pos(), mbs.pos());
+		}
+
+		TS_ASSERT(mbs.eos());
+	}
+
+	template<class BITSTREAM, class STREAM>
+	static void benchmark(const char *name, const byte *data, uint32 size) {
+		const uint32 count = size * 8 / 13 - 1;
+		uint32 sum = 0;
+
+		STREAM getStream(data, size);
+		BITSTREAM getBs(getStream);
+		double start = wallClock();
+		for (uint32 i = 0; i < count; i++)
+			sum += getBs.getBits(13);
+		const double getTime = wallClock() - start;
+
+		STREAM peekStream(data, size);
+		BITSTREAM peekBs(peekStream);
+		start = wallClock();
+		for (uint32 i = 0; i < count; i++) {
+			sum += peekBs.peekBits(16);
+			peekBs.skip(13);
+		}
+		const double peekTime = wallClock() - start;
+
+		printf("\n%-16s getBits %6.2f ns, peekBits+skip %6.2f ns (%u)", name,
+		       getTime * 1e9 / count, peekTime * 1e9 / count, sum & 1);
+	}
+
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	}
+
+	static double wallClock() {
+#ifdef POSIX
+		struct timeval tv;
+		gettimeofday(&tv, 0);
+		return tv.tv_sec + tv.tv_usec / 1000000.0;
+#else
+		return (double)clock() / CLOCKS_PER_SEC;
+#endif
+	}
 };
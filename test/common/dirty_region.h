@@ -0,0 +1,176 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirty_region.h"
+
+class DirtyRegionTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_empty() {
+		Graphics::DirtyRegion region;
+		region.init(320, 200, 8, 8);
+		TS_ASSERT(region.isEmpty());
+
+		Common::Array<Common::Rect> rects;
+		region.flush(rects);
+		TS_ASSERT_EQUALS(rects.size(), (uint)0);
+
+		// Rectangles outside of the screen are dropped
+		region.addRect(-20, 10, 20, 10);
+		region.addRect(320, 0, 5, 5);
+		region.addRect(10, 10, 0, 5);
+		TS_ASSERT(region.isEmpty());
+	}
+
+	void test_single_tile() {
+		Graphics::DirtyRegion region;
+		region.init(100, 50, 8, 8);
+		region.addRect(3, 3, 2, 2);
+		TS_ASSERT(!region.isEmpty());
+
+		Common::Array<Common::Rect> rects;
+		region.flush(rects);
+		TS_ASSERT_EQUALS(rects.size(), (uint)1);
+		TS_ASSERT(rects[0] == Common::Rect(0, 0, 8, 8));
+		TS_ASSERT(region.isEmpty());
+	}
+
+	void test_clipping() {
+		Graphics::DirtyRegion region;
+		region.init(100, 50, 8, 8);
+		region.addRect(-5, 45, 200, 20);
+
+		Common::Array<Common::Rect> rects;
+		region.flush(rects);
+		TS_ASSERT_EQUALS(rects.size(), (uint)1);
+		TS_ASSERT(rects[0] == Common::Rect(0, 40, 100, 50));
+	}
+
+	void test_vertical_merge() {
+		Graphics::DirtyRegion region;
+		region.init(320, 200, 8, 8);
+
+		// Identical tile columns in consecutive tile rows form one rectangle
+		region.addRect(16, 0, 16, 8);
+		region.addRect(18, 8, 10, 20);
+
+		Common::Array<Common::Rect> rects;
+		region.flush(rects);
+		TS_ASSERT_EQUALS(rects.size(), (uint)1);
+		TS_ASSERT(rects[0] == Common::Rect(16, 0, 32, 32));
+	}
+
+	void test_word_boundary() {
+		Graphics::DirtyRegion region;
+		region.init(40 * 8, 16, 8, 8);
+
+		// Columns 30 to 34 span two words of the bitmap
+		region.addRect(30 * 8, 0, 5 * 8, 8);
+
+		Common::Array<Common::Rect> rects;
+		region.flush(rects);
+		TS_ASSERT_EQUALS(rects.size(), (uint)1);
+		TS_ASSERT(rects[0] == Common::Rect(30 * 8, 0, 35 * 8, 8));
+	}
+
+	void test_bridge_gaps() {
+		Graphics::DirtyRegion region;
+		region.init(320, 200, 8, 8);
+
+		region.addRect(0, 0, 8, 8);
+		region.addRect(24, 0, 8, 8);
+		region.addRect(200, 96, 8, 8);
+
+		Common::Array<Common::Rect> rects;
+		region.flush(rects);
+		TS_ASSERT_EQUALS(rects.size(), (uint)3);
+
+		// With two rectangles, the gap in the first row is bridged
+		region.addRect(0, 0, 8, 8);
+		region.addRect(24, 0, 8, 8);
+		region.addRect(200, 96, 8, 8);
+
+		rects.clear();
+		region.flush(rects, 2);
+		TS_ASSERT_EQUALS(rects.size(), (uint)2);
+		TS_ASSERT(rects[0] == Common::Rect(0, 0, 32, 8));
+		TS_ASSERT(rects[1] == Common::Rect(200, 96, 208, 104));
+	}
+
+	void test_stats() {
+		Graphics::DirtyRegion region;
+		region.init(320, 200, 8, 8);
+
+		region.addRect(1, 1, 4, 4);
+		region.addRect(2, 2, 4, 4);
+
+		Common::Array<Common::Rect> rects;
+		region.flush(rects);
+		TS_ASSERT_EQUALS(region.getLastStats().flushes, (uint32)1);
+		TS_ASSERT_EQUALS(region.getLastStats().rects, (uint32)1);
+		TS_ASSERT_EQUALS(region.getLastStats().markedPixels, (uint32)32);
+		TS_ASSERT_EQUALS(region.getLastStats().presentedPixels, (uint32)64);
+
+		// An empty flush leaves the statistics alone
+		region.flush(rects);
+		TS_ASSERT_EQUALS(region.getTotalStats().flushes, (uint32)1);
+
+		region.addAll();
+		region.flush(rects);
+		TS_ASSERT_EQUALS(region.getLastStats().presentedPixels, (uint32)(320 * 200));
+		TS_ASSERT_EQUALS(region.getTotalStats().flushes, (uint32)2);
+		TS_ASSERT_EQUALS(region.getTotalStats().rects, (uint32)2);
+		TS_ASSERT_EQUALS(region.getTotalStats().presentedPixels, (uint32)(64 + 320 * 200));
+
+		region.resetStats();
+		TS_ASSERT_EQUALS(region.getTotalStats().flushes, (uint32)0);
+	}
+
+	void test_coverage() {
+		const int width = 203, height = 97;
+		Common::Array<byte> marked;
+		marked.resize(width * height);
+		uint32 seed = 1;
+
+		for (int i = 0; i < 200; ++i) {
+			Graphics::DirtyRegion region;
+			region.init(width, height, 1 + i % 9, 1 + i % 5);
+			memset(&marked[0], 0, marked.size());
+
+			const int count = 1 + i % 40;
+			for (int j = 0; j < count; ++j) {
+				int r[4];
+				for (int k = 0; k < 4; ++k) {
+					seed = seed * 1103515245 + 12345;
+					r[k] = (seed >> 8) % 240 - 20;
+				}
+				const int w = r[2] / 4, h = r[3] / 4;
+				region.addRect(r[0], r[1], w, h);
+
+				for (int y = MAX(r[1], 0); y < MIN(r[1] + h, height); ++y)
+					for (int x = MAX(r[0], 0); x < MIN(r[0] + w, width); ++x)
+						marked[y * width + x] = 1;
+			}
+
+			const uint maxRects = 1 + i % 7;
+			Common::Array<Common::Rect> rects;
+			region.flush(rects, maxRects);
+			TS_ASSERT(region.isEmpty());
+			TS_ASSERT_LESS_THAN_EQUALS(rects.size(), maxRects);
+
+			// Every rectangle lies on the screen, and every marked pixel is covered
+			for (uint j = 0; j < rects.size(); ++j) {
+				TS_ASSERT(Common::Rect(width, height).contains(rects[j]));
+				for (int y = rects[j].top; y < rects[j].bottom; ++y)
+					for (int x = rects[j].left; x < rects[j].right; ++x)
+						marked[y * width + x] = 0;
+			}
+
+			for (uint j = 0; j < marked.size(); ++j) {
+				if (marked[j]) {
+					TS_FAIL("marked pixel not covered");
+					break;
+				}
+			}
+		}
+	}
+};
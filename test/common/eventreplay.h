@@ -0,0 +1,71 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/EventRecorder.h"
+#include "common/memstream.h"
+
+class EventReplayTestSuite : public CxxTest::TestSuite {
+	Common::MemoryWriteStreamDynamic *createRecording() {
+		Common::MemoryWriteStreamDynamic *file = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+
+		file->writeUint32LE(0x54455354); // signature
+		file->writeUint32LE(1); // version
+		file->writeByte(1); // subtitles
+		file->writeUint32LE(2); // events
+		file->writeUint32LE(0); // times
+
+		file->writeUint32LE(1); // random sources
+		file->writeUint32LE(5);
+		file->writeString("scumm");
+		file->writeUint32LE(1234);
+
+		// Key press three polls after the start
+		file->writeByte(0);
+		file->writeUint32LE(3);
+		file->writeUint32LE(Common::EVENT_KEYDOWN);
+		file->writeSint32LE(Common::KEYCODE_a);
+		file->writeUint16LE('a');
+		file->writeByte(0);
+
+		// Key release on the next poll
+		file->writeByte(0);
+		file->writeUint32LE(1);
+		file->writeUint32LE(Common::EVENT_KEYUP);
+		file->writeSint32LE(Common::KEYCODE_a);
+		file->writeUint16LE('a');
+		file->writeByte(0);
+
+		return file;
+	}
+
+public:
+	void test_replay() {
+		Common::MemoryWriteStreamDynamic *file = createRecording();
+		Common::EventReplaySource replay(new Common::MemoryReadStream(file->getData(), file->size()));
+		TS_ASSERT(replay.isValid());
+
+		Common::Event event;
+		TS_ASSERT(!replay.pollEvent(event));
+		TS_ASSERT(!replay.pollEvent(event));
+		TS_ASSERT(replay.pollEvent(event));
+		TS_ASSERT_EQUALS(event.type, Common::EVENT_KEYDOWN);
+		TS_ASSERT_EQUALS(event.kbd.keycode, Common::KEYCODE_a);
+		TS_ASSERT_EQUALS(event.kbd.ascii, 'a');
+		TS_ASSERT(!replay.isFinished());
+
+		TS_ASSERT(replay.pollEvent(event));
+		TS_ASSERT_EQUALS(event.type, Common::EVENT_KEYUP);
+		TS_ASSERT(replay.isFinished());
+		TS_ASSERT(!replay.pollEvent(event));
+
+		delete file;
+	}
+
+	void test_invalid() {
+		byte contents[] = { 'n', 'o', 'p', 'e', 0, 0, 0, 0 };
+		Common::EventReplaySource replay(new Common::MemoryReadStream(contents, sizeof(contents)));
+		TS_ASSERT(!replay.isValid());
+
+		Common::Event event;
+		TS_ASSERT(!replay.pollEvent(event));
+	}
+};
@@ -0,0 +1,147 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/frame-profiler.h"
+
+class FakeProfilerClock : public Common::FrameProfiler::Clock {
+public:
+	uint64 now;
+
+	FakeProfilerClock() : now(0) {}
+	virtual uint64 getMicros() const { return now; }
+};
+
+static const char *const s_testStageNames[] = { "first", "second" };
+
+class FrameProfilerTestSuite : public CxxTest::TestSuite {
+public:
+	void test_disabled() {
+		FakeProfilerClock clock;
+		Common::FrameProfiler profiler(s_testStageNames, 2, &clock);
+
+		profiler.beginFrame();
+		clock.now += 100;
+		profiler.endFrame(1, false);
+		TS_ASSERT_EQUALS(profiler.getFrameCount(), 0u);
+		TS_ASSERT_EQUALS(profiler.getSummary(), "No frames profiled");
+	}
+
+	void test_stages() {
+		FakeProfilerClock clock;
+		clock.now = 5000;
+		Common::FrameProfiler profiler(s_testStageNames, 2, &clock);
+		profiler.setEnabled(true);
+
+		clock.now += 1000;
+		profiler.beginFrame();
+		clock.now += 10;
+		profiler.beginStage(0);
+		clock.now += 20;
+		profiler.endStage(0);
+
+		// A stage running twice is summed up, and starts at its first run
+		clock.now += 5;
+		{
+			Common::FrameProfiler::Scope scope(profiler, 1);
+			clock.now += 7;
+		}
+		profiler.beginStage(1);
+		clock.now += 3;
+		profiler.endStage(1);
+		clock.now += 50;
+		profiler.endFrame(3, true);
+
+		TS_ASSERT_EQUALS(profiler.getFrameCount(), 1u);
+		const Common::FrameProfiler::Frame &frame = profiler.getFrame(0);
+		TS_ASSERT_EQUALS(frame.start, 1000u);
+		TS_ASSERT_EQUALS(frame.duration, 95u);
+		TS_ASSERT_EQUALS(frame.stageStart[0], 10u);
+		TS_ASSERT_EQUALS(frame.stageDuration[0], 20u);
+		TS_ASSERT_EQUALS(frame.stageStart[1], 35u);
+		TS_ASSERT_EQUALS(frame.stageDuration[1], 10u);
+		TS_ASSERT_EQUALS(frame.rects, 3);
+		TS_ASSERT(frame.fullUpdate);
+
+		// Stages below the timer resolution still show up
+		profiler.beginFrame();
+		profiler.beginStage(0);
+		profiler.endStage(0);
+		profiler.endFrame(1, false);
+		TS_ASSERT_EQUALS(profiler.getFrame(1).stageDuration[0], 1u);
+		TS_ASSERT_EQUALS(profiler.getFrame(1).stageDuration[1], 0u);
+	}
+
+	void test_idle_frames() {
+		FakeProfilerClock clock;
+		Common::FrameProfiler profiler(s_testStageNames, 2, &clock);
+		profiler.setEnabled(true);
+
+		profiler.beginFrame();
+		clock.now += 100;
+		profiler.endFrame(0, false);
+		TS_ASSERT_EQUALS(profiler.getFrameCount(), 0u);
+	}
+
+	void test_history() {
+		FakeProfilerClock clock;
+		Common::FrameProfiler profiler(s_testStageNames, 2, &clock);
+		profiler.setEnabled(true);
+
+		for (uint i = 0; i < Common::FrameProfiler::kHistorySize + 10; ++i) {
+			profiler.beginFrame();
+			clock.now += i + 1;
+			profiler.endFrame(1, false);
+		}
+
+		// The oldest frames are dropped
+		TS_ASSERT_EQUALS(profiler.getFrameCount(), (uint)Common::FrameProfiler::kHistorySize);
+		TS_ASSERT_EQUALS(profiler.getFrame(0).duration, 11u);
+		TS_ASSERT_EQUALS(profiler.getFrame(Common::FrameProfiler::kHistorySize - 1).duration, (uint32)Common::FrameProfiler::kHistorySize + 10);
+
+		// Enabling the profiler again starts from scratch
+		profiler.setEnabled(false);
+		profiler.setEnabled(true);
+		TS_ASSERT_EQUALS(profiler.getFrameCount(), 0u);
+	}
+
+	void test_long_session() {
+		// Start just before a 32 bit microsecond clock would wrap, ~71 minutes
+		FakeProfilerClock clock;
+		clock.now = 0xFFFFFF00ULL;
+		Common::FrameProfiler profiler(s_testStageNames, 2, &clock);
+		profiler.setEnabled(true);
+
+		clock.now += 0xFFFFFFF0ULL;
+		profiler.beginFrame();
+		profiler.beginStage(0);
+		clock.now += 0x20;
+		profiler.endStage(0);
+		clock.now += 0x20;
+		profiler.endFrame(1, false);
+
+		const Common::FrameProfiler::Frame &frame = profiler.getFrame(0);
+		TS_ASSERT_EQUALS(frame.start, 0xFFFFFFF0ULL);
+		TS_ASSERT_EQUALS(frame.duration, 0x40u);
+		TS_ASSERT_EQUALS(frame.stageStart[0], 0u);
+		TS_ASSERT_EQUALS(frame.stageDuration[0], 0x20u);
+	}
+
+	void test_summary() {
+		FakeProfilerClock clock;
+		Common::FrameProfiler profiler(s_testStageNames, 2, &clock);
+		profiler.setEnabled(true);
+
+		for (int i = 1; i <= 2; ++i) {
+			profiler.beginFrame();
+			profiler.beginStage(1);
+			clock.now += i * 1000;
+			profiler.endStage(1);
+			profiler.endFrame(i * 2, i == 2);
+		}
+
+		TS_ASSERT_EQUALS(profiler.getSummary(),
+			"2 frames, 3 rects avg, 1 full\n"
+			"frame 1.50 avg 2.00 max\n"
+			"first 0.00 avg 0.00 max\n"
+			"second 1.50 avg 2.00 max");
+	}
+};
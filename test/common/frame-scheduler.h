@@ -0,0 +1,122 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/frame-scheduler.h"
+
+class FakeSchedulerClock : public Common::FrameScheduler::Clock {
+public:
+	uint32 now;
+
+	FakeSchedulerClock() : now(0) {}
+	virtual uint32 getMillis() const { return now; }
+};
+
+static int s_logicTicks = 0;
+static int s_presentTicks = 0;
+
+static void countLogic() { s_logicTicks++; }
+static void countPresent() { s_presentTicks++; }
+
+class FrameSchedulerTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		s_logicTicks = 0;
+		s_presentTicks = 0;
+	}
+
+	void test_idle() {
+		FakeSchedulerClock clock;
+		Common::FrameScheduler scheduler(&clock);
+
+		TS_ASSERT_EQUALS(scheduler.step(), -1);
+		TS_ASSERT_EQUALS(scheduler.getTimeToNextWake(), -1);
+	}
+
+	void test_logic_deadline() {
+		FakeSchedulerClock clock;
+		Common::FrameScheduler scheduler(&clock);
+		scheduler.setLogicProc(countLogic);
+
+		clock.now = 100;
+		scheduler.scheduleLogic(150);
+		TS_ASSERT_EQUALS(scheduler.getTimeToNextWake(), 50);
+
+		// Not due yet
+		clock.now = 149;
+		TS_ASSERT_EQUALS(scheduler.step(), 1);
+		TS_ASSERT_EQUALS(s_logicTicks, 0);
+
+		clock.now = 153;
+		TS_ASSERT_EQUALS(scheduler.step(), -1);
+		TS_ASSERT_EQUALS(s_logicTicks, 1);
+		TS_ASSERT(!scheduler.isLogicPending());
+
+		const Common::FrameScheduler::JitterStats &jitter = scheduler.getJitterStats();
+		TS_ASSERT_EQUALS(jitter.ticks, 1u);
+		TS_ASSERT_EQUALS(jitter.last, 3u);
+		TS_ASSERT_EQUALS(jitter.max, 3u);
+	}
+
+	void test_present_between_logic_ticks() {
+		FakeSchedulerClock clock;
+		Common::FrameScheduler scheduler(&clock);
+		scheduler.setLogicProc(countLogic);
+		scheduler.setPresentProc(countPresent);
+		scheduler.setPresentInterval(10);
+		scheduler.setMergeWindow(2);
+
+		scheduler.scheduleLogic(0);
+		scheduler.step();
+		TS_ASSERT_EQUALS(s_logicTicks, 1);
+		TS_ASSERT_EQUALS(s_presentTicks, 0);
+
+		// Long wait: the scheduler wakes up for the present ticks
+		scheduler.scheduleLogic(35);
+		TS_ASSERT_EQUALS(scheduler.getTimeToNextWake(), 10);
+
+		while (s_logicTicks < 2) {
+			int32 wait = scheduler.getTimeToNextWake();
+			TS_ASSERT(wait >= 0);
+			clock.now += wait;
+			scheduler.step();
+		}
+
+		TS_ASSERT_EQUALS(clock.now, 35u);
+		TS_ASSERT_EQUALS(s_presentTicks, 3);
+		TS_ASSERT_EQUALS(scheduler.getJitterStats().max, 0u);
+	}
+
+	void test_merge_present_into_logic() {
+		FakeSchedulerClock clock;
+		Common::FrameScheduler scheduler(&clock);
+		scheduler.setLogicProc(countLogic);
+		scheduler.setPresentProc(countPresent);
+		scheduler.setPresentInterval(10);
+		scheduler.setMergeWindow(4);
+
+		scheduler.scheduleLogic(0);
+		scheduler.step();
+
+		// The present tick at 10 would be only 2 ms before the logic tick
+		scheduler.scheduleLogic(12);
+		TS_ASSERT_EQUALS(scheduler.getTimeToNextWake(), 12);
+
+		clock.now = 12;
+		scheduler.step();
+		TS_ASSERT_EQUALS(s_logicTicks, 2);
+		TS_ASSERT_EQUALS(s_presentTicks, 0);
+	}
+
+	void test_clock_wrap() {
+		FakeSchedulerClock clock;
+		Common::FrameScheduler scheduler(&clock);
+		scheduler.setLogicProc(countLogic);
+
+		clock.now = 0xFFFFFFF0;
+		scheduler.scheduleLogic(clock.now + 0x20);
+		TS_ASSERT_EQUALS(scheduler.getTimeToNextWake(), 0x20);
+
+		clock.now += 0x20;
+		scheduler.step();
+		TS_ASSERT_EQUALS(s_logicTicks, 1);
+	}
+};
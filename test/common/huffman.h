@@ -0,0 +1,131 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bitstream.h"
+#include "common/huffman.h"
+#include "common/memstream.h"
+
+/**
+ * Unary codes: code i is i one bits followed by a zero bit, and the
+ * last code is 12 one bits. The longer codes need more than one table
+ * probe to resolve.
+ */
+static const uint8 kUnaryLengths[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 12 };
+
+class HuffmanTestSuite : public CxxTest::TestSuite {
+public:
+	void test_get_symbol() {
+		uint32 codes[]   = { 0, 2, 6, 7 };
+		uint8 lengths[]  = { 1, 2, 3, 3 };
+		uint32 symbols[] = { 'a', 'b', 'c', 'd' };
+
+		Common::Huffman h(0, 4, codes, lengths, symbols);
+
+		// a b c d a c: 0 10 110 111 0 110, padded with zeros
+		byte contents[] = { 0x5B, 0xB0 };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		Common::BitStream8MSB bs(ms);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), (uint32)'a');
+		TS_ASSERT_EQUALS(h.getSymbol(bs), (uint32)'b');
+		TS_ASSERT_EQUALS(h.getSymbol(bs), (uint32)'c');
+		TS_ASSERT_EQUALS(h.getSymbol(bs), (uint32)'d');
+		TS_ASSERT_EQUALS(h.getSymbol(bs), (uint32)'a');
+		TS_ASSERT_EQUALS(h.getSymbol(bs), (uint32)'c');
+		TS_ASSERT_EQUALS(bs.pos(), 13u);
+	}
+
+	void test_set_symbols() {
+		uint32 codes[]   = { 0, 2, 6, 7 };
+		uint8 lengths[]  = { 1, 2, 3, 3 };
+		uint32 symbols[] = { 'w', 'x', 'y', 'z' };
+
+		Common::Huffman h(0, 4, codes, lengths);
+
+		byte contents[] = { 0x5B, 0xB0 };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		Common::BitStream8MSB bs(ms);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 0u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 1u);
+
+		h.setSymbols(symbols);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), (uint32)'y');
+		TS_ASSERT_EQUALS(h.getSymbol(bs), (uint32)'z');
+	}
+
+	void test_long_codes_msb() {
+		uint32 codes[13];
+		for (uint32 i = 0; i < 12; i++)
+			codes[i] = (1 << (i + 1)) - 2;
+		codes[12] = 0xFFF;
+
+		Common::Huffman h(0, 13, codes, kUnaryLengths);
+
+		// 11 0 12 3
+		byte contents[] = { 0xFF, 0xE7, 0xFF, 0xF0 };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		Common::BitStream8MSB bs(ms);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 11u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 0u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 12u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 3u);
+		TS_ASSERT_EQUALS(bs.pos(), 29u);
+	}
+
+	void test_long_codes_lsb() {
+		// With the bits handed out LSB first, the first bit of a code is its LSB
+		uint32 codes[13];
+		for (uint32 i = 0; i < 12; i++)
+			codes[i] = (1 << i) - 1;
+		codes[12] = 0xFFF;
+
+		Common::Huffman h(0, 13, codes, kUnaryLengths);
+
+		// 11 0 12 3
+		byte contents[] = { 0xFF, 0xE7, 0xFF, 0x0F };
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		Common::BitStream8LSB bs(ms);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 11u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 0u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 12u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 3u);
+		TS_ASSERT_EQUALS(bs.pos(), 29u);
+	}
+
+	void test_both_bit_orders() {
+		// The codes are only read when a table is built, after they are gone
+		uint32 *codes = new uint32[4];
+		uint8 *lengths = new uint8[4];
+		for (uint32 i = 0; i < 4; i++) {
+			codes[i] = i;
+			lengths[i] = 2;
+		}
+
+		uint32 symbols[] = { 'a', 'b', 'c', 'd' };
+		Common::Huffman h(0, 4, codes, lengths, symbols);
+		delete[] codes;
+		delete[] lengths;
+
+		byte contents[] = { 0x1B };
+
+		Common::MemoryReadStream lsbStream(contents, sizeof(contents));
+		Common::BitStream8LSB lsb(lsbStream);
+		TS_ASSERT_EQUALS(h.getSymbol(lsb), (uint32)'d');
+		TS_ASSERT_EQUALS(h.getSymbol(lsb), (uint32)'c');
+
+		Common::MemoryReadStream msbStream(contents, sizeof(contents));
+		Common::BitStream8MSB msb(msbStream);
+		TS_ASSERT_EQUALS(h.getSymbol(msb), (uint32)'a');
+		TS_ASSERT_EQUALS(h.getSymbol(msb), (uint32)'b');
+		TS_ASSERT_EQUALS(h.getSymbol(lsb), (uint32)'b');
+		TS_ASSERT_EQUALS(h.getSymbol(msb), (uint32)'c');
+		TS_ASSERT_EQUALS(h.getSymbol(lsb), (uint32)'a');
+		TS_ASSERT_EQUALS(h.getSymbol(msb), (uint32)'d');
+	}
+};
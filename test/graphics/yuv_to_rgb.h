@@ -0,0 +1,227 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+/** A surface whose pitch is larger than its width, with the padding filled in. */
+class PaddedSurface : public Graphics::Surface {
+public:
+	PaddedSurface(int width, int height, const Graphics::PixelFormat &pixelFormat) {
+		w = width;
+		h = height;
+		format = pixelFormat;
+		pitch = w * format.bytesPerPixel + kPadding;
+		_buffer.resize(pitch * h);
+		memset(&_buffer[0], kFill, _buffer.size());
+		pixels = &_buffer[0];
+	}
+
+	uint32 getPixel(int x, int y) const {
+		const byte *src = (const byte *)getBasePtr(x, y);
+		if (format.bytesPerPixel == 1)
+			return *src;
+		if (format.bytesPerPixel == 2)
+			return *(const uint16 *)src;
+		return *(const uint32 *)src;
+	}
+
+	/** Whether the padding at the end of every row was left alone. */
+	bool isPaddingKept() const {
+		for (int y = 0; y < h; y++)
+			for (int i = 0; i < kPadding; i++)
+				if (_buffer[y * pitch + w * format.bytesPerPixel + i] != kFill)
+					return false;
+
+		return true;
+	}
+
+	enum {
+		kPadding = 12,
+		kFill = 0xCD
+	};
+
+private:
+	Common::Array<byte> _buffer;
+};
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_convert444() {
+		_seed = 1;
+
+		// Odd widths, which leave pixels to the table after the SIMD path
+		const int widths[] = { 1, 15, 16, 37, 53 };
+		for (int i = 0; i < ARRAYSIZE(widths); i++)
+			for (int f = 0; f < ARRAYSIZE(kFormats); f++)
+				for (int scale = 0; scale < 2; scale++)
+					checkConvert(false, widths[i], 6, kFormats[f], (Graphics::YUVToRGBManager::LuminanceScale)scale);
+	}
+
+	void test_convert420() {
+		_seed = 2;
+
+		// Widths which aren't a multiple of the 16 pixels of the SIMD path
+		const int widths[] = { 2, 14, 16, 38, 46 };
+		for (int i = 0; i < ARRAYSIZE(widths); i++)
+			for (int f = 0; f < ARRAYSIZE(kFormats); f++)
+				for (int scale = 0; scale < 2; scale++)
+					checkConvert(true, widths[i], 6, kFormats[f], (Graphics::YUVToRGBManager::LuminanceScale)scale);
+	}
+
+	void test_palette() {
+		_seed = 3;
+
+		byte palette[16 * 3];
+		for (int i = 0; i < ARRAYSIZE(palette); i++)
+			palette[i] = nextRandom();
+
+		YUVToRGBMan.setPalette(palette, 16);
+		checkConvert(false, 37, 6, Graphics::PixelFormat::createFormatCLUT8(), Graphics::YUVToRGBManager::kScaleFull, palette, 16);
+		checkConvert(true,  38, 6, Graphics::PixelFormat::createFormatCLUT8(), Graphics::YUVToRGBManager::kScaleITU, palette, 16);
+
+		// Converting to other formats in between doesn't disturb the palette
+		checkConvert(true, 38, 6, kFormats[0], Graphics::YUVToRGBManager::kScaleITU);
+		checkConvert(true, 38, 6, Graphics::PixelFormat::createFormatCLUT8(), Graphics::YUVToRGBManager::kScaleITU, palette, 16);
+
+		// A new palette, with fewer colors
+		palette[0] = palette[1] = palette[2] = 0;
+		YUVToRGBMan.setPalette(palette, 3);
+		checkConvert(false, 53, 6, Graphics::PixelFormat::createFormatCLUT8(), Graphics::YUVToRGBManager::kScaleFull, palette, 3);
+	}
+
+	void test_threads() {
+		_seed = 4;
+
+#ifdef USE_PTHREADS
+		TS_ASSERT_EQUALS(YUVToRGBMan.setThreadCount(4), 4u);
+#else
+		TS_ASSERT_EQUALS(YUVToRGBMan.setThreadCount(4), 1u);
+#endif
+
+		// Large enough for the workers, with bands of odd sizes
+		checkConvert(false, 263, 251, kFormats[0], Graphics::YUVToRGBManager::kScaleFull);
+		checkConvert(true,  262, 254, kFormats[2], Graphics::YUVToRGBManager::kScaleITU);
+
+		TS_ASSERT_EQUALS(YUVToRGBMan.setThreadCount(1), 1u);
+		checkConvert(true, 262, 254, kFormats[2], Graphics::YUVToRGBManager::kScaleITU);
+	}
+
+	private:
+	static const Graphics::PixelFormat kFormats[5];
+
+	uint32 _seed;
+
+	byte nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	/**
+	 * Compute a pixel the way the tables of the original conversion do. The
+	 * chroma terms are truncated, then the channels clipped to the luminance
+	 * scale and scaled to [0, 255].
+	 */
+	static void referenceRGB(Graphics::YUVToRGBManager::LuminanceScale scale, byte y, byte u, byte v, byte &r, byte &g, byte &b) {
+		int16 cr = v - 128, cb = u - 128;
+
+		r = referenceChannel(scale, y + (int16)( (0.419 / 0.299) * cr));
+		g = referenceChannel(scale, y + (int16)(-(0.299 / 0.419) * cr) + (int16)(-(0.114 / 0.331) * cb));
+		b = referenceChannel(scale, y + (int16)( (0.587 / 0.331) * cb));
+	}
+
+	static byte referenceChannel(Graphics::YUVToRGBManager::LuminanceScale scale, int x) {
+		if (scale == Graphics::YUVToRGBManager::kScaleFull)
+			return CLIP(x, 0, 255);
+
+		return (CLIP(x, 16, 235) - 16) * 255 / 219;
+	}
+
+	/** The palette color closest to the middle of the RGB555 color a pixel falls into. */
+	static byte referencePaletteIndex(const byte *palette, uint count, byte r, byte g, byte b) {
+		r = ((r >> 3) << 3) + 4;
+		g = ((g >> 3) << 3) + 4;
+		b = ((b >> 3) << 3) + 4;
+
+		int bestDistance = 0x7FFFFFFF;
+		byte best = 0;
+		for (uint i = 0; i < count; i++) {
+			int dr = r - palette[i * 3 + 0];
+			int dg = g - palette[i * 3 + 1];
+			int db = b - palette[i * 3 + 2];
+
+			if (dr * dr + dg * dg + db * db < bestDistance) {
+				bestDistance = dr * dr + dg * dg + db * db;
+				best = i;
+			}
+		}
+
+		return best;
+	}
+
+	/**
+	 * Convert random YUV planes, whose pitches are larger than their widths,
+	 * and compare each pixel to the reference.
+	 */
+	void checkConvert(bool yuv420, int width, int height, const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale, const byte *palette = 0, uint paletteCount = 0) {
+		const int yPitch = width + 5;
+		const int uvWidth = yuv420 ? width / 2 : width;
+		const int uvHeight = yuv420 ? height / 2 : height;
+		const int uvPitch = uvWidth + 3;
+
+		Common::Array<byte> yPlane, uPlane, vPlane;
+		yPlane.resize(yPitch * height);
+		uPlane.resize(uvPitch * uvHeight);
+		vPlane.resize(uvPitch * uvHeight);
+
+		// The extremes of the ranges in between the random values
+		const byte extremes[] = { 0, 16, 128, 235, 255 };
+		for (uint i = 0; i < yPlane.size(); i++)
+			yPlane[i] = (i % 7) ? nextRandom() : extremes[(i / 7) % ARRAYSIZE(extremes)];
+		for (uint i = 0; i < uPlane.size(); i++) {
+			uPlane[i] = (i % 5) ? nextRandom() : extremes[(i / 5) % ARRAYSIZE(extremes)];
+			vPlane[i] = (i % 3) ? nextRandom() : extremes[(i / 3) % ARRAYSIZE(extremes)];
+		}
+
+		PaddedSurface dst(width, height, format);
+		if (yuv420)
+			YUVToRGBMan.convert420(&dst, scale, &yPlane[0], &uPlane[0], &vPlane[0], width, height, yPitch, uvPitch);
+		else
+			YUVToRGBMan.convert444(&dst, scale, &yPlane[0], &uPlane[0], &vPlane[0], width, height, yPitch, uvPitch);
+
+		int mismatches = 0;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				const int uvOffset = yuv420 ? ((y / 2) * uvPitch + x / 2) : (y * uvPitch + x);
+
+				byte r, g, b;
+				referenceRGB(scale, yPlane[y * yPitch + x], uPlane[uvOffset], vPlane[uvOffset], r, g, b);
+
+				uint32 expected;
+				if (palette)
+					expected = referencePaletteIndex(palette, paletteCount, r, g, b);
+				else
+					expected = format.RGBToColor(r, g, b);
+
+				if (dst.getPixel(x, y) != expected && mismatches++ == 0)
+					TS_FAIL(Common::String::format("Pixel %d, %d of a %dx%d %s image to %dbpp: %08X instead of %08X",
+					        x, y, width, height, yuv420 ? "YUV420" : "YUV444", format.bytesPerPixel * 8, dst.getPixel(x, y), expected).c_str());
+			}
+		}
+
+		TS_ASSERT_EQUALS(mismatches, 0);
+		TS_ASSERT(dst.isPaddingKept());
+	}
+};
+
+const Graphics::PixelFormat YUVToRGBTestSuite::kFormats[5] = {
+	Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),  // RGB565
+	Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15), // ARGB1555
+	Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24), // ARGB8888, composed from bytes
+	Graphics::PixelFormat(4, 8, 8, 8, 0,  0, 8, 16, 0), // XBGR8888, composed from bytes
+	Graphics::PixelFormat(4, 6, 6, 6, 0, 12, 6, 0, 0)   // 18-bit color, composed from shifts
+};
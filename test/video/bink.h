@@ -0,0 +1,251 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+
+#include "video/bink_dct.h"
+
+class BinkTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_idct_matches_scalar() {
+		_seed = 1;
+
+		for (int i = 0; i < 2000; ++i) {
+			int16 block[64];
+			randomBlock(block, i % 4);
+
+			checkIDCT(block, Video::binkIDCTPut, Video::binkIDCTPutScalar, 8);
+			checkIDCT(block, Video::binkIDCTAdd, Video::binkIDCTAddScalar, 8);
+			checkIDCT(block, Video::binkIDCTPutScaled, Video::binkIDCTPutScaledScalar, 16);
+		}
+	}
+
+	void test_dc_only() {
+		_seed = 2;
+
+		// Blocks with only a DC coefficient are filled with a single value
+		const int16 dcs[] = { 0, 1, 0x7F, 0x80, 0x1234, 0x7FFF, -1, -0x80, -0x81, -0x100, -0x8000 };
+		for (int i = 0; i < ARRAYSIZE(dcs); ++i) {
+			const byte v = (dcs[i] + 0x7F) >> 8;
+			int16 block[64];
+
+			byte put[kPitch * 18];
+			memset(block, 0, sizeof(block));
+			block[0] = dcs[i];
+			memset(put, 0xAA, sizeof(put));
+			Video::binkIDCTPut(put + kPitch + 1, kPitch, block);
+			TS_ASSERT(isFilled(put + kPitch + 1, 8, v, 0xAA));
+
+			byte add[kPitch * 18];
+			memset(block, 0, sizeof(block));
+			block[0] = dcs[i];
+			memset(add, 0x40, sizeof(add));
+			Video::binkIDCTAdd(add + kPitch + 1, kPitch, block);
+			TS_ASSERT(isFilled(add + kPitch + 1, 8, (byte)(0x40 + v), 0x40));
+
+			byte scaled[kPitch * 18];
+			memset(block, 0, sizeof(block));
+			block[0] = dcs[i];
+			memset(scaled, 0xAA, sizeof(scaled));
+			Video::binkIDCTPutScaled(scaled + kPitch + 1, kPitch, block);
+			TS_ASSERT(isFilled(scaled + kPitch + 1, 16, v, 0xAA));
+
+			// The same as the full transform
+			memset(block, 0, sizeof(block));
+			block[0] = dcs[i];
+			checkIDCT(block, Video::binkIDCTPut, Video::binkIDCTPutScalar, 8);
+			checkIDCT(block, Video::binkIDCTAdd, Video::binkIDCTAddScalar, 8);
+			checkIDCT(block, Video::binkIDCTPutScaled, Video::binkIDCTPutScaledScalar, 16);
+		}
+	}
+
+	void test_queue_flushes() {
+		const uint32 pitch = 60;
+		Common::Array<byte> plane;
+		plane.resize(pitch * 64);
+		Video::BinkDCTQueue queue(pitch, 48, 1);
+
+		// The upper half of a 16x16 block, then a block in its lower half
+		TS_ASSERT(queue.canDefer(0, 0, 2, pitch));
+		queue.queue(0, 0, &plane[0], 0, pitch, true);
+		TS_ASSERT(queue.canDefer(2, 0, 1, pitch));
+		queue.queue(2, 0, &plane[16], 0, pitch, false);
+		TS_ASSERT_EQUALS(queue.getQueuedCount(), 2u);
+
+		TS_ASSERT(queue.canDefer(2, 1, 1, pitch));
+		TS_ASSERT_EQUALS(queue.getQueuedCount(), 2u);
+		TS_ASSERT(queue.canDefer(1, 1, 1, pitch));
+		TS_ASSERT_EQUALS(queue.getQueuedCount(), 0u);
+
+		// Blocks of the next plane don't overlap
+		queue.queue(1, 1, &plane[8 * pitch + 8], 0, pitch, false);
+		queue.startPlane();
+		TS_ASSERT(queue.canDefer(0, 0, 2, pitch));
+		TS_ASSERT_EQUALS(queue.getQueuedCount(), 1u);
+
+		// Blocks reaching past the right edge are run right away
+		TS_ASSERT(queue.canDefer(6, 0, 1, pitch));
+		TS_ASSERT(!queue.canDefer(7, 0, 1, pitch));
+		TS_ASSERT_EQUALS(queue.getQueuedCount(), 0u);
+		TS_ASSERT(!queue.canDefer(6, 2, 2, pitch));
+	}
+
+	void test_queue_matches_serial() {
+		_seed = 3;
+
+		for (uint threads = 1; threads <= 4; threads += 3) {
+			for (int i = 0; i < 20; ++i) {
+				// An odd width, so that the blocks of the last column wrap
+				// around, and many overlapping blocks
+				Video::BinkDCTQueue oddQueue(203, 90, threads);
+				checkQueue(oddQueue, 203, 90, 4);
+
+				// Few flushes, so that the worker threads have enough to do
+				Video::BinkDCTQueue queue(200, 90, threads);
+				checkQueue(queue, 200, 90, 64);
+			}
+		}
+	}
+
+	private:
+	enum {
+		kPitch = 37
+	};
+
+	typedef void (*IDCTFunc)(byte *dest, uint32 pitch, int16 *block);
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	/** Fill a block with random coefficients, of a kind from 0 to 3. */
+	void randomBlock(int16 *block, int kind) {
+		memset(block, 0, 64 * sizeof(int16));
+
+		switch (kind) {
+		case 0:
+			// DC only
+			block[0] = (int16)nextRandom();
+			break;
+		case 1:
+			// A few coefficients, like most blocks of a video
+			for (int i = nextRandom() % 4; i >= 0; --i)
+				block[nextRandom() % 64] = (int16)(nextRandom() % 512) - 256;
+			break;
+		case 2:
+			for (int i = 0; i < 64; ++i)
+				block[i] = (int16)(nextRandom() % 4096) - 2048;
+			break;
+		default:
+			// Overflowing the 16-bit intermediate results
+			for (int i = 0; i < 64; ++i)
+				block[i] = (int16)nextRandom();
+			break;
+		}
+	}
+
+	/** Check an IDCT against the scalar one, on random pixels and a pitch which isn't a multiple of the vector size. */
+	void checkIDCT(const int16 *block, IDCTFunc func, IDCTFunc scalar, int size) {
+		byte dest[kPitch * 18], expected[kPitch * 18];
+		for (int i = 0; i < ARRAYSIZE(dest); ++i)
+			dest[i] = expected[i] = nextRandom();
+
+		int16 coeffs[64];
+		memcpy(coeffs, block, sizeof(coeffs));
+		func(dest + kPitch + 3, kPitch, coeffs);
+		memcpy(coeffs, block, sizeof(coeffs));
+		scalar(expected + kPitch + 3, kPitch, coeffs);
+
+		TS_ASSERT_SAME_DATA(dest, expected, sizeof(dest));
+	}
+
+	/** Check that a size x size square is filled with a value, and its surroundings left alone. */
+	static bool isFilled(const byte *dest, int size, byte value, byte outside) {
+		for (int y = -1; y <= size; ++y) {
+			for (int x = -1; x <= size; ++x) {
+				const bool inside = (y >= 0) && (y < size) && (x >= 0) && (x < size);
+				if (dest[y * kPitch + x] != (inside ? value : outside))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Reconstruct the blocks of a random plane right away, and through the
+	 * queue, and compare the results. One in scaledChance blocks is a 16x16
+	 * one. These are placed anywhere, so that the blocks of the next line
+	 * overlap their lower half.
+	 */
+	void checkQueue(Video::BinkDCTQueue &queue, uint32 width, uint32 height, uint32 scaledChance) {
+		const uint32 blockWidth  = (width  + 7) >> 3;
+		const uint32 blockHeight = (height + 7) >> 3;
+
+		// Planes are allocated with some extra space, like in the decoder
+		const uint32 size = width * (height + 32);
+
+		Common::Array<byte> prev, serial, queued;
+		prev.resize(size);
+		serial.resize(size);
+		queued.resize(size);
+		for (uint32 i = 0; i < size; ++i)
+			prev[i] = serial[i] = queued[i] = nextRandom();
+
+		queue.startPlane();
+
+		for (uint32 blockY = 0; blockY < blockHeight; ++blockY) {
+			for (uint32 blockX = 0; blockX < blockWidth; ++blockX) {
+				const uint32 offset = blockY * 8 * width + blockX * 8;
+				const uint32 type = (nextRandom() % scaledChance == 0) ? 0 : (1 + nextRandom() % 3);
+
+				int16 block[64];
+				randomBlock(block, 1 + nextRandom() % 2);
+
+				const uint32 prevOffset = nextRandom() % (width * height - 8 * width);
+				const bool scaled = (type == 0);
+				const bool inter  = (type == 1);
+
+				// The reference, in decoding order
+				int16 coeffs[64];
+				memcpy(coeffs, block, sizeof(coeffs));
+				if (type == 3) {
+					for (int y = 0; y < 8; ++y)
+						memset(&serial[offset + y * width], coeffs[0], 8);
+				} else if (scaled) {
+					Video::binkIDCTPutScaled(&serial[offset], width, coeffs);
+				} else if (inter) {
+					Video::binkCopyBlock(&serial[offset], &prev[prevOffset], width);
+					Video::binkIDCTAdd(&serial[offset], width, coeffs);
+				} else {
+					Video::binkIDCTPut(&serial[offset], width, coeffs);
+				}
+
+				// Through the queue, where it allows to
+				const bool defer = queue.canDefer(blockX, blockY, scaled ? 2 : 1, width);
+				memcpy(coeffs, block, sizeof(coeffs));
+				if (type == 3) {
+					// Blocks without a DCT are drawn right away
+					for (int y = 0; y < 8; ++y)
+						memset(&queued[offset + y * width], coeffs[0], 8);
+				} else if (defer) {
+					int16 *dest = queue.queue(blockX, blockY, &queued[offset], inter ? &prev[prevOffset] : 0, width, scaled);
+					memcpy(dest, coeffs, sizeof(coeffs));
+				} else if (scaled) {
+					Video::binkIDCTPutScaled(&queued[offset], width, coeffs);
+				} else if (inter) {
+					Video::binkCopyBlock(&queued[offset], &prev[prevOffset], width);
+					Video::binkIDCTAdd(&queued[offset], width, coeffs);
+				} else {
+					Video::binkIDCTPut(&queued[offset], width, coeffs);
+				}
+			}
+		}
+
+		queue.flush();
+		TS_ASSERT_SAME_DATA(&queued[0], &serial[0], size);
+	}
+};
@@ -0,0 +1,230 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#ifdef USE_PTHREADS
+#include <sched.h>
+#endif
+
+#include "graphics/surface.h"
+#include "video/video_decoder.h"
+
+#include "../audio/helper.h"
+
+/**
+ * A video of kFrameCount frames at 10 frames per second. Every pixel of
+ * a frame holds its number. Frames 2, 6, 10 and so on change the palette,
+ * whose first entry is set to the frame number.
+ */
+class SyntheticVideoDecoder : public Video::VideoDecoder {
+public:
+	enum {
+		kFrameCount = 40,
+		kFrameTime = 100
+	};
+
+	~SyntheticVideoDecoder() { close(); }
+
+	bool loadStream(Common::SeekableReadStream *stream) {
+		close();
+		addTrack(new SyntheticVideoTrack());
+		return true;
+	}
+
+private:
+	class SyntheticVideoTrack : public FixedRateVideoTrack {
+	public:
+		SyntheticVideoTrack() : _curFrame(-1), _reversed(false), _dirtyPalette(false) {
+			_surface.create(9, 5, Graphics::PixelFormat::createFormatCLUT8());
+			memset(_palette, 0, sizeof(_palette));
+		}
+		~SyntheticVideoTrack() { _surface.free(); }
+
+		uint16 getWidth() const { return _surface.w; }
+		uint16 getHeight() const { return _surface.h; }
+		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
+		int getCurFrame() const { return _curFrame; }
+		int getFrameCount() const { return kFrameCount; }
+
+		bool isSeekable() const { return true; }
+		bool seek(const Audio::Timestamp &time) {
+			_curFrame = getFrameAtTime(time) - 1;
+			return true;
+		}
+
+		bool setReverse(bool reverse) {
+			_reversed = reverse;
+			return true;
+		}
+		bool isReversed() const { return _reversed; }
+		bool endOfTrack() const { return _reversed ? (_curFrame < 0) : FixedRateVideoTrack::endOfTrack(); }
+
+		const Graphics::Surface *decodeNextFrame() {
+			_curFrame += _reversed ? -1 : 1;
+			memset(_surface.pixels, _curFrame, _surface.pitch * _surface.h);
+
+			_dirtyPalette = (_curFrame % 4) == 2;
+			if (_dirtyPalette)
+				_palette[0] = _curFrame;
+
+			return &_surface;
+		}
+
+		const byte *getPalette() const {
+			_dirtyPalette = false;
+			return _palette;
+		}
+		bool hasDirtyPalette() const { return _dirtyPalette; }
+
+	protected:
+		Common::Rational getFrameRate() const { return 1000 / kFrameTime; }
+
+	private:
+		int _curFrame;
+		bool _reversed;
+		Graphics::Surface _surface;
+		byte _palette[256 * 3];
+		mutable bool _dirtyPalette;
+	};
+};
+
+class VideoDecoderTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_on_demand() {
+		StubSystem system;
+		SyntheticVideoDecoder decoder;
+		decoder.setDecodeAhead(0);
+		decoder.loadStream(0);
+
+		for (int i = 0; i < SyntheticVideoDecoder::kFrameCount; ++i) {
+			TS_ASSERT(!decoder.endOfVideo());
+			checkFrame(decoder.decodeNextFrame(), i);
+			TS_ASSERT_EQUALS(decoder.getCurFrame(), i);
+		}
+
+		TS_ASSERT(decoder.endOfVideo());
+		TS_ASSERT_EQUALS(decoder.getDecodeStats().framesDecoded, (uint32)SyntheticVideoDecoder::kFrameCount);
+		TS_ASSERT_EQUALS(decoder.getDecodeStats().framesDropped, 0u);
+	}
+
+	void test_dropped_frames() {
+#ifdef USE_PTHREADS
+		StubSystem system;
+		SyntheticVideoDecoder decoder;
+		decoder.setDecodeAhead(4);
+		decoder.loadStream(0);
+		decoder.start();
+
+		// Nothing is decoded before the first frame is asked for
+		checkFrame(decoder.decodeNextFrame(), 0);
+		TS_ASSERT_EQUALS(decoder.getDecodeStats().underruns, 1u);
+		waitForDecodedFrames(decoder, 5);
+
+		// Frames 1 and 2 are late, frame 3 is due. The palette of frame 2
+		// is kept, since frame 3 doesn't change it.
+		system.millis = 3 * SyntheticVideoDecoder::kFrameTime + 50;
+		checkFrame(decoder.decodeNextFrame(), 3);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 3);
+		TS_ASSERT_EQUALS(decoder.getDecodeStats().framesDropped, 2u);
+		TS_ASSERT(decoder.hasDirtyPalette());
+		TS_ASSERT_EQUALS(decoder.getPalette()[0], 2);
+
+		// On time, nothing is dropped
+		waitForDecodedFrames(decoder, 8);
+		system.millis = 4 * SyntheticVideoDecoder::kFrameTime;
+		checkFrame(decoder.decodeNextFrame(), 4);
+		TS_ASSERT(!decoder.hasDirtyPalette());
+
+		// The last frame is never dropped
+		system.millis = 100 * SyntheticVideoDecoder::kFrameTime;
+		int frames = 0;
+		while (!decoder.endOfVideo()) {
+			decoder.decodeNextFrame();
+			frames++;
+		}
+
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), SyntheticVideoDecoder::kFrameCount - 1);
+		Video::VideoDecoder::DecodeStats stats = decoder.getDecodeStats();
+		TS_ASSERT_EQUALS(stats.framesDecoded, (uint32)SyntheticVideoDecoder::kFrameCount);
+		TS_ASSERT_EQUALS(stats.framesDropped + frames + 3, (uint32)SyntheticVideoDecoder::kFrameCount);
+		decoder.stop();
+#else
+		TS_WARN("Threads are not available, frames are always decoded on demand");
+#endif
+	}
+
+	void test_seek_flushes() {
+		StubSystem system;
+		SyntheticVideoDecoder decoder;
+		decoder.setDecodeAhead(4);
+		decoder.loadStream(0);
+
+		checkFrame(decoder.decodeNextFrame(), 0);
+		waitForDecodedFrames(decoder, 5);
+
+		// The frames decoded ahead are dropped
+		TS_ASSERT(decoder.seekToFrame(20));
+		checkFrame(decoder.decodeNextFrame(), 20);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 20);
+		checkFrame(decoder.decodeNextFrame(), 21);
+		waitForDecodedFrames(decoder, 11);
+
+		TS_ASSERT(decoder.rewind());
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), -1);
+		checkFrame(decoder.decodeNextFrame(), 0);
+		checkFrame(decoder.decodeNextFrame(), 1);
+
+		// Stopped videos never drop frames
+		TS_ASSERT_EQUALS(decoder.getDecodeStats().framesDropped, 0u);
+	}
+
+	void test_set_reverse() {
+		StubSystem system;
+		SyntheticVideoDecoder decoder;
+		decoder.setDecodeAhead(4);
+		decoder.loadStream(0);
+
+		checkFrame(decoder.decodeNextFrame(), 0);
+		waitForDecodedFrames(decoder, 5);
+
+#ifdef USE_PTHREADS
+		// Frames decoded ahead can't be undone
+		TS_ASSERT(!decoder.setReverse(true));
+		checkFrame(decoder.decodeNextFrame(), 1);
+#endif
+
+		// After a seek, nothing is queued anymore
+		TS_ASSERT(decoder.seekToFrame(10));
+		TS_ASSERT(decoder.setReverse(true));
+
+		// Reversed videos are decoded on demand
+		const uint32 decoded = decoder.getDecodeStats().framesDecoded;
+		checkFrame(decoder.decodeNextFrame(), 8);
+		checkFrame(decoder.decodeNextFrame(), 7);
+		TS_ASSERT_EQUALS(decoder.getDecodeStats().framesDecoded, decoded + 2);
+
+		TS_ASSERT(decoder.setReverse(false));
+		checkFrame(decoder.decodeNextFrame(), 8);
+	}
+
+	private:
+	static void checkFrame(const Graphics::Surface *surface, int frame) {
+		TS_ASSERT(surface);
+		if (!surface)
+			return;
+
+		TS_ASSERT_EQUALS(*(const byte *)surface->getBasePtr(0, 0), frame);
+		TS_ASSERT_EQUALS(*(const byte *)surface->getBasePtr(surface->w - 1, surface->h - 1), frame);
+	}
+
+	/** Wait for the decode-ahead thread to have decoded a number of frames in total. */
+	static void waitForDecodedFrames(const Video::VideoDecoder &decoder, uint32 frames) {
+#ifdef USE_PTHREADS
+		for (int i = 0; i < 10000000 && decoder.getDecodeStats().framesDecoded < frames; ++i)
+			sched_yield();
+
+		TS_ASSERT_EQUALS(decoder.getDecodeStats().framesDecoded, frames);
+#endif
+	}
+};
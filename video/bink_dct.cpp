@@ -0,0 +1,529 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Based on eos' Bink decoder which is in turn
+// based quite heavily on the Bink decoder found in FFmpeg.
+// Many thanks to Kostya Shishkov for doing the hard work.
+
+#include "common/util.h"
+
+#include "video/bink_dct.h"
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define BINK_WASM_SIMD
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define BINK_SSE2
+#endif
+
+// Maximum number of threads reconstructing DCT blocks
+static const uint kMaxDCTThreads = 16;
+// Fewer queued DCT blocks than this are not worth waking the workers for
+static const uint32 kMinParallelDCTJobs = 64;
+
+namespace Video {
+
+#define A1  2896 /* (1/sqrt(2))<<12 */
+#define A2  2217
+#define A3  3784
+#define A4 -5352
+
+#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
+    const int a0 = (src)[s0] + (src)[s4]; \
+    const int a1 = (src)[s0] - (src)[s4]; \
+    const int a2 = (src)[s2] + (src)[s6]; \
+    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
+    const int a4 = (src)[s5] + (src)[s3]; \
+    const int a5 = (src)[s5] - (src)[s3]; \
+    const int a6 = (src)[s1] + (src)[s7]; \
+    const int a7 = (src)[s1] - (src)[s7]; \
+    const int b0 = a4 + a6; \
+    const int b1 = (A3*(a5 + a7)) >> 11; \
+    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
+    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
+    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
+    (dest)[d0] = munge(a0+a2   +b0); \
+    (dest)[d1] = munge(a1+a3-a2+b2); \
+    (dest)[d2] = munge(a1-a3+a2+b3); \
+    (dest)[d3] = munge(a0-a2   -b4); \
+    (dest)[d4] = munge(a0-a2   +b4); \
+    (dest)[d5] = munge(a1-a3+a2-b3); \
+    (dest)[d6] = munge(a1+a3-a2-b2); \
+    (dest)[d7] = munge(a0+a2   -b0); \
+}
+/* end IDCT_TRANSFORM macro */
+
+#define MUNGE_NONE(x) (x)
+#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
+
+#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
+#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
+
+static inline void IDCTCol(int16 *dest, const int16 *src) {
+	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
+		dest[ 0] =
+		dest[ 8] =
+		dest[16] =
+		dest[24] =
+		dest[32] =
+		dest[40] =
+		dest[48] =
+		dest[56] = src[0];
+	} else {
+		IDCT_COL(dest, src);
+	}
+}
+
+static void IDCT(int16 *block) {
+	int i;
+	int16 temp[64];
+
+	for (i = 0; i < 8; i++)
+		IDCTCol(&temp[i], &block[i]);
+	for (i = 0; i < 8; i++) {
+		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
+	}
+}
+
+void binkIDCTAddScalar(byte *dest, uint32 pitch, int16 *block) {
+	int i, j;
+
+	IDCT(block);
+	for (i = 0; i < 8; i++, dest += pitch, block += 8)
+		for (j = 0; j < 8; j++)
+			 dest[j] += block[j];
+}
+
+void binkIDCTPutScalar(byte *dest, uint32 pitch, int16 *block) {
+	int i;
+	int16 temp[64];
+	for (i = 0; i < 8; i++)
+		IDCTCol(&temp[i], &block[i]);
+	for (i = 0; i < 8; i++) {
+		IDCT_ROW( (&dest[i*pitch]), (&temp[8*i]) );
+	}
+}
+
+void binkIDCTPutScaledScalar(byte *dest, uint32 pitch, int16 *block) {
+	IDCT(block);
+
+	int16 *src   = block;
+	byte  *dest1 = dest;
+	byte  *dest2 = dest + pitch;
+	for (int j = 0; j < 8; j++, dest1 += (pitch << 1) - 16, dest2 += (pitch << 1) - 16, src += 8) {
+
+		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
+			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
+
+	}
+}
+
+#if defined(BINK_SSE2) || defined(BINK_WASM_SIMD)
+
+// The vector IDCT transforms eight columns, and then eight rows, at once.
+// All inputs of the transform are 16-bit, so each multiplication and sum of
+// two inputs is done exactly by a 16x16->32 bit multiply-add of interleaved
+// input pairs. Everything else is in 32-bit lanes too, so that the result
+// rounds and wraps around exactly like the scalar code. The column pass
+// result is truncated to 16 bits, like the int16 temp.
+
+#if defined(BINK_SSE2)
+
+typedef __m128i IDCTVector;
+
+static inline IDCTVector vecLoad(const int16 *src) { return _mm_loadu_si128((const __m128i *)src); }
+static inline IDCTVector vecPairs(int16 a, int16 b) { return _mm_set_epi16(b, a, b, a, b, a, b, a); }
+static inline IDCTVector vecInterleaveLo(IDCTVector a, IDCTVector b) { return _mm_unpacklo_epi16(a, b); }
+static inline IDCTVector vecInterleaveHi(IDCTVector a, IDCTVector b) { return _mm_unpackhi_epi16(a, b); }
+static inline IDCTVector vecMulAdd(IDCTVector a, IDCTVector b) { return _mm_madd_epi16(a, b); }
+static inline IDCTVector vecAdd(IDCTVector a, IDCTVector b) { return _mm_add_epi32(a, b); }
+static inline IDCTVector vecSub(IDCTVector a, IDCTVector b) { return _mm_sub_epi32(a, b); }
+static inline IDCTVector vecShr(IDCTVector a, int n) { return _mm_srai_epi32(a, n); }
+static inline IDCTVector vecSplat(int c) { return _mm_set1_epi32(c); }
+
+/** Pack two vectors of 32-bit values into one of their low 16 bits. */
+static inline IDCTVector vecTrunc16(IDCTVector lo, IDCTVector hi) {
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+}
+
+/** Pack two vectors of 32-bit values into one of their low 8 bits, as 16-bit lanes. */
+static inline IDCTVector vecTrunc8(IDCTVector lo, IDCTVector hi) {
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	return _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+}
+
+static inline void vecTranspose(IDCTVector *v) {
+	const __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+	const __m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+	const __m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+	const __m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+	const __m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+	const __m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+	const __m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+	const __m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+
+	const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	v[0] = _mm_unpacklo_epi64(b0, b4);
+	v[1] = _mm_unpackhi_epi64(b0, b4);
+	v[2] = _mm_unpacklo_epi64(b1, b5);
+	v[3] = _mm_unpackhi_epi64(b1, b5);
+	v[4] = _mm_unpacklo_epi64(b2, b6);
+	v[5] = _mm_unpackhi_epi64(b2, b6);
+	v[6] = _mm_unpacklo_epi64(b3, b7);
+	v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+static inline void vecPutRow(byte *dest, IDCTVector row) {
+	_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(row, row));
+}
+
+static inline void vecAddRow(byte *dest, IDCTVector row) {
+	const __m128i old = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)dest), _mm_setzero_si128());
+	const __m128i sum = _mm_and_si128(_mm_add_epi16(old, row), _mm_set1_epi16(0xFF));
+	_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(sum, sum));
+}
+
+static inline void vecPutRowScaled(byte *dest, uint32 pitch, IDCTVector row) {
+	const __m128i bytes = _mm_packus_epi16(row, row);
+	const __m128i wide  = _mm_unpacklo_epi8(bytes, bytes);
+	_mm_storeu_si128((__m128i *)dest, wide);
+	_mm_storeu_si128((__m128i *)(dest + pitch), wide);
+}
+
+static inline bool vecIsDCOnly(const int16 *block) {
+	__m128i ac = _mm_and_si128(_mm_loadu_si128((const __m128i *)block), _mm_set_epi16(-1, -1, -1, -1, -1, -1, -1, 0));
+	for (int i = 8; i < 64; i += 8)
+		ac = _mm_or_si128(ac, _mm_loadu_si128((const __m128i *)(block + i)));
+	return _mm_movemask_epi8(_mm_cmpeq_epi16(ac, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#elif defined(BINK_WASM_SIMD)
+
+typedef v128_t IDCTVector;
+
+static inline IDCTVector vecLoad(const int16 *src) { return wasm_v128_load(src); }
+static inline IDCTVector vecPairs(int16 a, int16 b) { return wasm_i16x8_make(a, b, a, b, a, b, a, b); }
+static inline IDCTVector vecInterleaveLo(IDCTVector a, IDCTVector b) { return wasm_i16x8_shuffle(a, b, 0, 8, 1, 9, 2, 10, 3, 11); }
+static inline IDCTVector vecInterleaveHi(IDCTVector a, IDCTVector b) { return wasm_i16x8_shuffle(a, b, 4, 12, 5, 13, 6, 14, 7, 15); }
+static inline IDCTVector vecMulAdd(IDCTVector a, IDCTVector b) { return wasm_i32x4_dot_i16x8(a, b); }
+static inline IDCTVector vecAdd(IDCTVector a, IDCTVector b) { return wasm_i32x4_add(a, b); }
+static inline IDCTVector vecSub(IDCTVector a, IDCTVector b) { return wasm_i32x4_sub(a, b); }
+static inline IDCTVector vecShr(IDCTVector a, int n) { return wasm_i32x4_shr(a, n); }
+static inline IDCTVector vecSplat(int c) { return wasm_i32x4_splat(c); }
+
+/** Pack two vectors of 32-bit values into one of their low 16 bits. */
+static inline IDCTVector vecTrunc16(IDCTVector lo, IDCTVector hi) {
+	return wasm_i16x8_shuffle(lo, hi, 0, 2, 4, 6, 8, 10, 12, 14);
+}
+
+/** Pack two vectors of 32-bit values into one of their low 8 bits, as 16-bit lanes. */
+static inline IDCTVector vecTrunc8(IDCTVector lo, IDCTVector hi) {
+	return wasm_v128_and(wasm_i16x8_shuffle(lo, hi, 0, 2, 4, 6, 8, 10, 12, 14), wasm_i16x8_splat(0xFF));
+}
+
+static inline void vecTranspose(IDCTVector *v) {
+	const v128_t a0 = wasm_i16x8_shuffle(v[0], v[1], 0, 8, 1, 9, 2, 10, 3, 11);
+	const v128_t a1 = wasm_i16x8_shuffle(v[0], v[1], 4, 12, 5, 13, 6, 14, 7, 15);
+	const v128_t a2 = wasm_i16x8_shuffle(v[2], v[3], 0, 8, 1, 9, 2, 10, 3, 11);
+	const v128_t a3 = wasm_i16x8_shuffle(v[2], v[3], 4, 12, 5, 13, 6, 14, 7, 15);
+	const v128_t a4 = wasm_i16x8_shuffle(v[4], v[5], 0, 8, 1, 9, 2, 10, 3, 11);
+	const v128_t a5 = wasm_i16x8_shuffle(v[4], v[5], 4, 12, 5, 13, 6, 14, 7, 15);
+	const v128_t a6 = wasm_i16x8_shuffle(v[6], v[7], 0, 8, 1, 9, 2, 10, 3, 11);
+	const v128_t a7 = wasm_i16x8_shuffle(v[6], v[7], 4, 12, 5, 13, 6, 14, 7, 15);
+
+	const v128_t b0 = wasm_i32x4_shuffle(a0, a2, 0, 4, 1, 5);
+	const v128_t b1 = wasm_i32x4_shuffle(a0, a2, 2, 6, 3, 7);
+	const v128_t b2 = wasm_i32x4_shuffle(a1, a3, 0, 4, 1, 5);
+	const v128_t b3 = wasm_i32x4_shuffle(a1, a3, 2, 6, 3, 7);
+	const v128_t b4 = wasm_i32x4_shuffle(a4, a6, 0, 4, 1, 5);
+	const v128_t b5 = wasm_i32x4_shuffle(a4, a6, 2, 6, 3, 7);
+	const v128_t b6 = wasm_i32x4_shuffle(a5, a7, 0, 4, 1, 5);
+	const v128_t b7 = wasm_i32x4_shuffle(a5, a7, 2, 6, 3, 7);
+
+	v[0] = wasm_i64x2_shuffle(b0, b4, 0, 2);
+	v[1] = wasm_i64x2_shuffle(b0, b4, 1, 3);
+	v[2] = wasm_i64x2_shuffle(b1, b5, 0, 2);
+	v[3] = wasm_i64x2_shuffle(b1, b5, 1, 3);
+	v[4] = wasm_i64x2_shuffle(b2, b6, 0, 2);
+	v[5] = wasm_i64x2_shuffle(b2, b6, 1, 3);
+	v[6] = wasm_i64x2_shuffle(b3, b7, 0, 2);
+	v[7] = wasm_i64x2_shuffle(b3, b7, 1, 3);
+}
+
+static inline void vecPutRow(byte *dest, IDCTVector row) {
+	wasm_v128_store64_lane(dest, wasm_u8x16_narrow_i16x8(row, row), 0);
+}
+
+static inline void vecAddRow(byte *dest, IDCTVector row) {
+	const v128_t old = wasm_u16x8_extend_low_u8x16(wasm_v128_load64_zero(dest));
+	const v128_t sum = wasm_v128_and(wasm_i16x8_add(old, row), wasm_i16x8_splat(0xFF));
+	wasm_v128_store64_lane(dest, wasm_u8x16_narrow_i16x8(sum, sum), 0);
+}
+
+static inline void vecPutRowScaled(byte *dest, uint32 pitch, IDCTVector row) {
+	const v128_t bytes = wasm_u8x16_narrow_i16x8(row, row);
+	const v128_t wide  = wasm_i8x16_shuffle(bytes, bytes, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+	wasm_v128_store(dest, wide);
+	wasm_v128_store(dest + pitch, wide);
+}
+
+static inline bool vecIsDCOnly(const int16 *block) {
+	v128_t ac = wasm_v128_and(wasm_v128_load(block), wasm_i16x8_make(0, -1, -1, -1, -1, -1, -1, -1));
+	for (int i = 8; i < 64; i += 8)
+		ac = wasm_v128_or(ac, wasm_v128_load(block + i));
+	return !wasm_v128_any_true(ac);
+}
+
+#endif
+
+/**
+ * Transform four columns of eight 16-bit values, given as the interleaved
+ * pairs of elements 0 and 4, 2 and 6, 5 and 3, and 1 and 7.
+ */
+static FORCEINLINE void IDCTTransformVector(IDCTVector p04, IDCTVector p26, IDCTVector p53, IDCTVector p17, IDCTVector *d) {
+	const IDCTVector a0 = vecMulAdd(p04, vecPairs(1,  1));
+	const IDCTVector a1 = vecMulAdd(p04, vecPairs(1, -1));
+	const IDCTVector a2 = vecMulAdd(p26, vecPairs(1,  1));
+	const IDCTVector a3 = vecShr(vecMulAdd(p26, vecPairs(A1, -A1)), 11);
+	const IDCTVector b0 = vecAdd(vecMulAdd(p53, vecPairs(1, 1)), vecMulAdd(p17, vecPairs(1, 1)));
+	const IDCTVector b1 = vecShr(vecAdd(vecMulAdd(p53, vecPairs(A3, -A3)), vecMulAdd(p17, vecPairs(A3, -A3))), 11);
+	const IDCTVector b2 = vecAdd(vecSub(vecShr(vecMulAdd(p53, vecPairs(A4, -A4)), 11), b0), b1);
+	const IDCTVector b3 = vecSub(vecShr(vecAdd(vecMulAdd(p17, vecPairs(A1, A1)), vecMulAdd(p53, vecPairs(-A1, -A1))), 11), b2);
+	const IDCTVector b4 = vecSub(vecAdd(vecShr(vecMulAdd(p17, vecPairs(A2, -A2)), 11), b3), b1);
+	d[0] = vecAdd(vecAdd(a0, a2), b0);
+	d[1] = vecAdd(vecSub(vecAdd(a1, a3), a2), b2);
+	d[2] = vecAdd(vecAdd(vecSub(a1, a3), a2), b3);
+	d[3] = vecSub(vecSub(a0, a2), b4);
+	d[4] = vecAdd(vecSub(a0, a2), b4);
+	d[5] = vecSub(vecAdd(vecSub(a1, a3), a2), b3);
+	d[6] = vecSub(vecSub(vecAdd(a1, a3), a2), b2);
+	d[7] = vecSub(vecAdd(a0, a2), b0);
+}
+
+/** Transform the eight vectors of 16-bit values along their index, in 32-bit lanes. */
+static FORCEINLINE void IDCTTransformVectors(const IDCTVector *s, IDCTVector *lo, IDCTVector *hi) {
+	IDCTTransformVector(vecInterleaveLo(s[0], s[4]), vecInterleaveLo(s[2], s[6]),
+	                    vecInterleaveLo(s[5], s[3]), vecInterleaveLo(s[1], s[7]), lo);
+	IDCTTransformVector(vecInterleaveHi(s[0], s[4]), vecInterleaveHi(s[2], s[6]),
+	                    vecInterleaveHi(s[5], s[3]), vecInterleaveHi(s[1], s[7]), hi);
+}
+
+/** Transform a block, returning the low bytes of each row of the result as 16-bit lanes. */
+static FORCEINLINE void IDCTVectorRows(const int16 *block, IDCTVector *rows) {
+	IDCTVector s[8], lo[8], hi[8];
+
+	// Columns: the block rows hold the elements of all eight columns
+	for (int k = 0; k < 8; k++)
+		s[k] = vecLoad(block + 8 * k);
+
+	IDCTTransformVectors(s, lo, hi);
+
+	// Rows: transposing the temp rows gives the elements of all eight rows
+	for (int k = 0; k < 8; k++)
+		s[k] = vecTrunc16(lo[k], hi[k]);
+
+	vecTranspose(s);
+	IDCTTransformVectors(s, lo, hi);
+
+	const IDCTVector round = vecSplat(0x7F);
+	for (int k = 0; k < 8; k++)
+		rows[k] = vecTrunc8(vecShr(vecAdd(lo[k], round), 8), vecShr(vecAdd(hi[k], round), 8));
+
+	vecTranspose(rows);
+}
+
+void binkIDCTAdd(byte *dest, uint32 pitch, int16 *block) {
+	if (vecIsDCOnly(block)) {
+		const byte v = (block[0] + 0x7F) >> 8;
+		for (int i = 0; i < 8; i++, dest += pitch)
+			for (int j = 0; j < 8; j++)
+				dest[j] += v;
+		return;
+	}
+
+	IDCTVector rows[8];
+	IDCTVectorRows(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vecAddRow(dest, rows[i]);
+}
+
+void binkIDCTPut(byte *dest, uint32 pitch, int16 *block) {
+	if (vecIsDCOnly(block)) {
+		const byte v = (block[0] + 0x7F) >> 8;
+		for (int i = 0; i < 8; i++, dest += pitch)
+			memset(dest, v, 8);
+		return;
+	}
+
+	IDCTVector rows[8];
+	IDCTVectorRows(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vecPutRow(dest, rows[i]);
+}
+
+void binkIDCTPutScaled(byte *dest, uint32 pitch, int16 *block) {
+	if (vecIsDCOnly(block)) {
+		const byte v = (block[0] + 0x7F) >> 8;
+		for (int i = 0; i < 16; i++, dest += pitch)
+			memset(dest, v, 16);
+		return;
+	}
+
+	IDCTVector rows[8];
+	IDCTVectorRows(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += 2 * pitch)
+		vecPutRowScaled(dest, pitch, rows[i]);
+}
+
+#else
+
+void binkIDCTAdd(byte *dest, uint32 pitch, int16 *block) {
+	binkIDCTAddScalar(dest, pitch, block);
+}
+
+void binkIDCTPut(byte *dest, uint32 pitch, int16 *block) {
+	binkIDCTPutScalar(dest, pitch, block);
+}
+
+void binkIDCTPutScaled(byte *dest, uint32 pitch, int16 *block) {
+	binkIDCTPutScaledScalar(dest, pitch, block);
+}
+
+#endif
+
+BinkDCTQueue::BinkDCTQueue(uint32 width, uint32 height, uint threadCount) {
+	_pool.setThreadCount(CLIP<uint>(threadCount, 1, kMaxDCTThreads));
+
+	// Each plane queues at most one job per 8x8 block before they are run
+	uint32 lumaBlocks   = ((width +  7) >> 3) * ((height +  7) >> 3);
+	uint32 chromaBlocks = ((width + 15) >> 4) * ((height + 15) >> 4);
+
+	_jobMax   = 2 * lumaBlocks + 2 * chromaBlocks;
+	_jobs     = new Job[_jobMax];
+	_jobCount = 0;
+
+	// A 16x16 block in the last column or row marks one past it
+	_pendingPitch = ((width + 7) >> 3) + 1;
+	_pending      = new uint32[_pendingPitch * (((height + 7) >> 3) + 1)];
+	memset(_pending, 0, _pendingPitch * (((height + 7) >> 3) + 1) * sizeof(uint32));
+	_epoch = 1;
+}
+
+BinkDCTQueue::~BinkDCTQueue() {
+	delete[] _jobs;
+	delete[] _pending;
+}
+
+void BinkDCTQueue::startPlane() {
+	_epoch++;
+}
+
+bool BinkDCTQueue::canDefer(uint32 blockX, uint32 blockY, uint32 size, uint32 pitch) {
+	// A block reaching past the right edge of the plane wraps around into
+	// the next lines, over its neighbours. Keep those in decoding order.
+	if ((blockX + size) * 8 > pitch) {
+		flush();
+		return false;
+	}
+
+	// Likewise for blocks overlapping a queued one, which only happens when
+	// a line of 8x8 blocks doesn't skip the lower half of a 16x16 block
+	for (uint32 y = 0; y < size; y++) {
+		const uint32 *pending = _pending + (blockY + y) * _pendingPitch + blockX;
+
+		for (uint32 x = 0; x < size; x++) {
+			if (pending[x] == _epoch) {
+				flush();
+				return true;
+			}
+		}
+	}
+
+	return true;
+}
+
+int16 *BinkDCTQueue::queue(uint32 blockX, uint32 blockY, byte *dest, const byte *prev, uint32 pitch, bool scaled) {
+	if (_jobCount == _jobMax)
+		flush();
+
+	uint32 size = scaled ? 2 : 1;
+	for (uint32 y = 0; y < size; y++)
+		for (uint32 x = 0; x < size; x++)
+			_pending[(blockY + y) * _pendingPitch + blockX + x] = _epoch;
+
+	Job &job = _jobs[_jobCount++];
+
+	job.dest   = dest;
+	job.prev   = prev;
+	job.pitch  = pitch;
+	job.scaled = scaled;
+
+	memset(job.block, 0, 64 * sizeof(int16));
+	return job.block;
+}
+
+void BinkDCTQueue::flush() {
+	if (_jobCount == 0)
+		return;
+
+	if ((_jobCount < kMinParallelDCTJobs) || !_pool.run(runJobs, this)) {
+		for (uint32 i = 0; i < _jobCount; i++)
+			runJob(_jobs[i]);
+	}
+
+	_jobCount = 0;
+	_epoch++;
+}
+
+void BinkDCTQueue::runJobs(void *param, uint thread) {
+	BinkDCTQueue *queue = (BinkDCTQueue *)param;
+	uint32 start = (queue->_jobCount *  thread     ) / queue->_pool.getThreadCount();
+	uint32 end   = (queue->_jobCount * (thread + 1)) / queue->_pool.getThreadCount();
+
+	for (uint32 i = start; i < end; i++)
+		runJob(queue->_jobs[i]);
+}
+
+void BinkDCTQueue::runJob(Job &job) {
+	if (job.scaled) {
+		binkIDCTPutScaled(job.dest, job.pitch, job.block);
+	} else if (job.prev) {
+		binkCopyBlock(job.dest, job.prev, job.pitch);
+		binkIDCTAdd(job.dest, job.pitch, job.block);
+	} else {
+		binkIDCTPut(job.dest, job.pitch, job.block);
+	}
+}
+
+} // End of namespace Video
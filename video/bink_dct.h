@@ -0,0 +1,144 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Reconstruction of the DCT blocks of Bink videos, used by the Bink decoder.
+
+#include "common/scummsys.h"
+
+#ifdef USE_BINK
+
+#ifndef VIDEO_BINK_DCT_H
+#define VIDEO_BINK_DCT_H
+
+#include "common/workerpool.h"
+
+namespace Video {
+
+/** Copy an 8x8 block. The fixed size memcpy() compiles to a single 8 byte move per line. */
+inline void binkCopyBlock(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 8; j++, dest += pitch, src += pitch)
+		memcpy(dest, src, 8);
+}
+
+/**
+ * Reconstruct an 8x8 block from its dequantized DCT coefficients.
+ * The coefficients may be overwritten.
+ */
+void binkIDCTPut(byte *dest, uint32 pitch, int16 *block);
+/** Reconstruct an 8x8 block, adding it to the pixels already there. */
+void binkIDCTAdd(byte *dest, uint32 pitch, int16 *block);
+/** Reconstruct an 8x8 block, scaled up to 16x16. */
+void binkIDCTPutScaled(byte *dest, uint32 pitch, int16 *block);
+
+/**
+ * The portable versions of the above. Where SSE2 or WebAssembly SIMD are
+ * available, the versions above use those and have to match these exactly.
+ */
+void binkIDCTPutScalar(byte *dest, uint32 pitch, int16 *block);
+void binkIDCTAddScalar(byte *dest, uint32 pitch, int16 *block);
+void binkIDCTPutScaledScalar(byte *dest, uint32 pitch, int16 *block);
+
+/**
+ * The DCT blocks of a Bink frame whose reconstruction is deferred, so that
+ * several threads can run them at once.
+ *
+ * Blocks are queued in decoding order. They are run when the queue is
+ * flushed, split into contiguous shares per thread. The result is the same
+ * as running each block right away: before a block is queued that would
+ * overlap one already queued, canDefer() runs the queue. Blocks reaching
+ * past the right edge of a plane, which wrap around over their neighbours,
+ * aren't queued at all.
+ */
+class BinkDCTQueue {
+public:
+	/**
+	 * Create a queue for the planes of a video with the given size, run by
+	 * up to threadCount threads including the calling one. Where threads
+	 * are not available, the calling thread runs all blocks.
+	 */
+	BinkDCTQueue(uint32 width, uint32 height, uint threadCount);
+	~BinkDCTQueue();
+
+	/** Return the number of threads running the queue, including the calling one. */
+	uint getThreadCount() const { return _pool.getThreadCount(); }
+
+	/** Return the number of blocks waiting to be run. */
+	uint32 getQueuedCount() const { return _jobCount; }
+
+	/** Start a new plane. Blocks queued for other planes can't overlap the ones of this one. */
+	void startPlane();
+
+	/**
+	 * Check whether the block at the given position of the plane can be
+	 * queued, running the queue first if it has to.
+	 *
+	 * @param blockX  column of the block, in 8 pixel units
+	 * @param blockY  row of the block, in 8 pixel units
+	 * @param size    1 for an 8x8 block, 2 for a 16x16 one
+	 * @param pitch   width of the plane
+	 */
+	bool canDefer(uint32 blockX, uint32 blockY, uint32 size, uint32 pitch);
+
+	/**
+	 * Queue a block, which canDefer() allowed. Returns the coefficients to
+	 * fill, set to 0.
+	 *
+	 * @param dest    top-left pixel of the block in the plane
+	 * @param prev    motion compensated source of an inter block, 0 for intra blocks
+	 * @param scaled  an intra block scaled up to 16x16
+	 */
+	int16 *queue(uint32 blockX, uint32 blockY, byte *dest, const byte *prev, uint32 pitch, bool scaled);
+
+	/** Reconstruct all queued blocks. */
+	void flush();
+
+private:
+	/** A queued block. */
+	struct Job {
+		int16 block[64];  ///< Dequantized coefficients.
+		byte *dest;
+		const byte *prev;
+		uint32 pitch;
+		bool scaled;
+	};
+
+	Common::WorkerPool _pool;
+
+	Job *_jobs;
+	uint32 _jobCount;
+	uint32 _jobMax;
+
+	uint32 *_pending;      ///< Per 8x8 block of a plane, the epoch it was last queued in.
+	uint32 _pendingPitch;
+	uint32 _epoch;         ///< Bumped whenever the queued blocks can't overlap later ones.
+
+	/** Run a thread's share of the queued blocks, a WorkerPool task. */
+	static void runJobs(void *queue, uint thread);
+	/** Run one queued block. */
+	static void runJob(Job &job);
+};
+
+} // End of namespace Video
+
+#endif // VIDEO_BINK_DCT_H
+
+#endif // USE_BINK
@@ -27,11 +27,11 @@
 #include "audio/audiostream.h"
 #include "audio/decoders/raw.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 #include "common/math.h"
 #include "common/stream.h"
-#include "common/substream.h"
 #include "common/file.h"
 #include "common/str.h"
 #include "common/bitstream.h"
@@ -44,6 +44,7 @@
 #include "graphics/surface.h"
 
 #include "video/binkdata.h"
+#include "video/bink_dct.h"
 #include "video/bink_decoder.h"
 
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
@@ -63,6 +64,10 @@ namespace Video {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+
+	_threadCount = 1;
+	if (ConfMan.hasKey("bink_threads"))
+		_threadCount = MAX(ConfMan.getInt("bink_threads"), 1);
 }
 
 BinkDecoder::~BinkDecoder() {
@@ -105,6 +110,9 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 	addTrack(new BinkVideoTrack(width, height, getDefaultHighColorFormat(), frameCount,
 			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id));
 
+	if (_threadCount > 1)
+		((BinkVideoTrack *)getTrack(0))->setThreadCount(_threadCount);
+
 	uint32 audioTrackCount = _bink->readUint32LE();
 
 	if (audioTrackCount > 0) {
@@ -156,6 +164,15 @@ void BinkDecoder::close() {
 	_frames.clear();
 }
 
+void BinkDecoder::setThreadCount(uint count) {
+	_threadCount = MAX<uint>(count, 1);
+
+	if (_bink) {
+		parkDecodeAhead();
+		((BinkVideoTrack *)getTrack(0))->setThreadCount(_threadCount);
+	}
+}
+
 void BinkDecoder::readNextPacket() {
 	BinkVideoTrack *videoTrack = (BinkVideoTrack *)getTrack(0);
 
@@ -182,14 +199,17 @@ void BinkDecoder::readNextPacket() {
 		if (audioPacketLength >= 4) {
 			// Get our track - audio index plus one as the first track is video
 			BinkAudioTrack *audioTrack = (BinkAudioTrack *)getTrack(i + 1);
-			uint32 audioPacketStart = _bink->pos();
-			uint32 audioPacketEnd   = _bink->pos() + audioPacketLength;
+			uint32 audioPacketEnd = _bink->pos() + audioPacketLength;
 
 			//                  Number of samples in bytes
 			audio.sampleCount = _bink->readUint32LE() / (2 * audio.channels);
 
-			audio.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-					audioPacketStart + 4, audioPacketEnd), true);
+			uint32 audioDataSize = audioPacketLength - 4;
+			byte *audioData = (byte *)malloc(audioDataSize);
+			_bink->read(audioData, audioDataSize);
+
+			audio.bits = new Common::BitStreamMemory32LELSB(new Common::BitStreamMemoryStream(audioData,
+					audioDataSize, DisposeAfterUse::YES), true);
 
 			audioTrack->decodePacket();
 
@@ -202,11 +222,11 @@ void BinkDecoder::readNextPacket() {
 		}
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
+	byte *videoData = (byte *)malloc(frameSize);
+	_bink->read(videoData, frameSize);
 
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), true);
+	frame.bits = new Common::BitStreamMemory32LELSB(new Common::BitStreamMemoryStream(videoData,
+			frameSize, DisposeAfterUse::YES), true);
 
 	videoTrack->decodePacket(frame);
 
@@ -303,9 +323,13 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 
 	initBundles();
 	initHuffman();
+
+	_dctQueue = 0;
 }
 
 BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
+	delete _dctQueue;
+
 	for (int i = 0; i < 4; i++) {
 		delete[] _curPlanes[i]; _curPlanes[i] = 0;
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
@@ -343,6 +367,9 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 			break;
 	}
 
+	if (_dctQueue)
+		_dctQueue->flush();
+
 	// Convert the YUV data we have to our format
 	// We're ignoring alpha for now
 	// The width used here is the surface-width, and not the video-width
@@ -389,6 +416,10 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 		readBundle(video, (Source) i);
 	}
 
+	if (_dctQueue)
+		_dctQueue->startPlane();
+	ctx.deferDCT = false;
+
 	for (ctx.blockY = 0; ctx.blockY < blockHeight; ctx.blockY++) {
 		readBlockTypes  (video, _bundles[kSourceBlockTypes]);
 		readBlockTypes  (video, _bundles[kSourceSubBlockTypes]);
@@ -414,6 +445,9 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 				continue;
 			}
 
+			if (_dctQueue)
+				ctx.deferDCT = _dctQueue->canDefer(ctx.blockX, ctx.blockY, (blockType == kBlockScaled) ? 2 : 1, ctx.pitch);
+
 			switch (blockType) {
 			case kBlockSkip:
 				blockSkip(ctx);
@@ -458,6 +492,27 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 
 }
 
+uint BinkDecoder::BinkVideoTrack::setThreadCount(uint count) {
+	if (_dctQueue && (count == _dctQueue->getThreadCount()))
+		return count;
+
+	delete _dctQueue;
+	_dctQueue = 0;
+
+	if (count <= 1)
+		return 1;
+
+	// Without worker threads, queueing the blocks only costs time
+	_dctQueue = new BinkDCTQueue(_surface.w, _surface.h, count);
+	if (_dctQueue->getThreadCount() == 1) {
+		delete _dctQueue;
+		_dctQueue = 0;
+		return 1;
+	}
+
+	return _dctQueue->getThreadCount();
+}
+
 void BinkDecoder::BinkVideoTrack::readBundle(VideoFrame &video, Source source) {
 	if (source == kSourceColors) {
 		for (int i = 0; i < 16; i++)
@@ -616,11 +671,7 @@ uint32 BinkDecoder::BinkVideoTrack::readBundleCount(VideoFrame &video, Bundle &b
 }
 
 void BinkDecoder::BinkVideoTrack::blockSkip(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev;
-
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	binkCopyBlock(ctx.dest, ctx.prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledSkip(DecodeContext &ctx) {
@@ -668,24 +719,20 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
-	int16 block[64];
-	memset(block, 0, 64 * sizeof(int16));
+	int16 localBlock[64];
+	int16 *block = localBlock;
+
+	if (ctx.deferDCT)
+		block = _dctQueue->queue(ctx.blockX, ctx.blockY, ctx.dest, 0, ctx.pitch, true);
+	else
+		memset(block, 0, 64 * sizeof(int16));
 
 	block[0] = getBundleValue(kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCT(block);
-
-	int16 *src   = block;
-	byte  *dest1 = ctx.dest;
-	byte  *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16, src += 8) {
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
-
-	}
+	if (!ctx.deferDCT)
+		binkIDCTPutScaled(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
@@ -755,17 +802,19 @@ void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
 	ctx.prev   += 8;
 }
 
-void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
+const byte *BinkDecoder::BinkVideoTrack::getMotionSource(DecodeContext &ctx) {
 	int8 xOff = getBundleValue(kSourceXOff);
 	int8 yOff = getBundleValue(kSourceYOff);
 
-	byte *dest = ctx.dest;
 	byte *prev = ctx.prev + yOff * ((int32) ctx.pitch) + xOff;
 	if ((prev < ctx.prevStart) || (prev > ctx.prevEnd))
 		error("Copy out of bounds (%d | %d)", ctx.blockX * 8 + xOff, ctx.blockY * 8 + yOff);
 
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	return prev;
+}
+
+void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
+	binkCopyBlock(ctx.dest, getMotionSource(ctx), ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
@@ -813,14 +862,20 @@ void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
-	int16 block[64];
-	memset(block, 0, 64 * sizeof(int16));
+	int16 localBlock[64];
+	int16 *block = localBlock;
+
+	if (ctx.deferDCT)
+		block = _dctQueue->queue(ctx.blockX, ctx.blockY, ctx.dest, 0, ctx.pitch, false);
+	else
+		memset(block, 0, 64 * sizeof(int16));
 
 	block[0] = getBundleValue(kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCTPut(ctx, block);
+	if (!ctx.deferDCT)
+		binkIDCTPut(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
@@ -832,16 +887,24 @@ void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
-	blockMotion(ctx);
+	const byte *prev = getMotionSource(ctx);
 
-	int16 block[64];
-	memset(block, 0, 64 * sizeof(int16));
+	int16 localBlock[64];
+	int16 *block = localBlock;
+
+	if (ctx.deferDCT) {
+		block = _dctQueue->queue(ctx.blockX, ctx.blockY, ctx.dest, prev, ctx.pitch, false);
+	} else {
+		binkCopyBlock(ctx.dest, prev, ctx.pitch);
+		memset(block, 0, 64 * sizeof(int16));
+	}
 
 	block[0] = getBundleValue(kSourceInterDC);
 
 	readDCTCoeffs(*ctx.video, block, false);
 
-	IDCTAdd(ctx, block);
+	if (!ctx.deferDCT)
+		binkIDCTAdd(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
@@ -1259,88 +1322,6 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	}
 }
 
-#define A1  2896 /* (1/sqrt(2))<<12 */
-#define A2  2217
-#define A3  3784
-#define A4 -5352
-
-#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
-    const int a0 = (src)[s0] + (src)[s4]; \
-    const int a1 = (src)[s0] - (src)[s4]; \
-    const int a2 = (src)[s2] + (src)[s6]; \
-    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
-    const int a4 = (src)[s5] + (src)[s3]; \
-    const int a5 = (src)[s5] - (src)[s3]; \
-    const int a6 = (src)[s1] + (src)[s7]; \
-    const int a7 = (src)[s1] - (src)[s7]; \
-    const int b0 = a4 + a6; \
-    const int b1 = (A3*(a5 + a7)) >> 11; \
-    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
-    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
-    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
-    (dest)[d0] = munge(a0+a2   +b0); \
-    (dest)[d1] = munge(a1+a3-a2+b2); \
-    (dest)[d2] = munge(a1-a3+a2+b3); \
-    (dest)[d3] = munge(a0-a2   -b4); \
-    (dest)[d4] = munge(a0-a2   +b4); \
-    (dest)[d5] = munge(a1-a3+a2-b3); \
-    (dest)[d6] = munge(a1+a3-a2-b2); \
-    (dest)[d7] = munge(a0+a2   -b0); \
-}
-/* end IDCT_TRANSFORM macro */
-
-#define MUNGE_NONE(x) (x)
-#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
-
-#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
-#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
-
-static inline void IDCTCol(int16 *dest, const int16 *src) {
-	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
-		dest[ 0] =
-		dest[ 8] =
-		dest[16] =
-		dest[24] =
-		dest[32] =
-		dest[40] =
-		dest[48] =
-		dest[56] = src[0];
-	} else {
-		IDCT_COL(dest, src);
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCT(int16 *block) {
-	int i;
-	int16 temp[64];
-
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int16 *block) {
-	int i, j;
-
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int16 *block) {
-	int i;
-	int16 temp[64];
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
-	}
-}
-
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio) : _audioInfo(&audio) {
 	_audioStream = Audio::makeQueuingAudioStream(_audioInfo->outSampleRate, _audioInfo->outChannels == 2);
 }
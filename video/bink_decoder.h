@@ -32,6 +32,7 @@
 #define VIDEO_BINK_DECODER_H
 
 #include "common/array.h"
+#include "common/bitstream.h"
 #include "common/rational.h"
 
 #include "video/video_decoder.h"
@@ -45,7 +46,6 @@ class QueuingAudioStream;
 
 namespace Common {
 class SeekableReadStream;
-class BitStream;
 class Huffman;
 
 class RDFT;
@@ -58,6 +58,8 @@ struct Surface;
 
 namespace Video {
 
+class BinkDCTQueue;
+
 /**
  * Decoder for Bink videos.
  *
@@ -72,6 +74,13 @@ public:
 	bool loadStream(Common::SeekableReadStream *stream);
 	void close();
 
+	/**
+	 * Set the number of threads reconstructing the DCT blocks of a frame,
+	 * including the decoding one. Defaults to the "bink_threads" config key.
+	 * Where threads are not available, one is always used.
+	 */
+	void setThreadCount(uint count);
+
 protected:
 	void readNextPacket();
 
@@ -98,7 +107,7 @@ private:
 
 		uint32 sampleCount;
 
-		Common::BitStream *bits;
+		Common::BitStreamMemory32LELSB *bits;
 
 		bool first;
 
@@ -131,7 +140,7 @@ private:
 		uint32 offset;
 		uint32 size;
 
-		Common::BitStream *bits;
+		Common::BitStreamMemory32LELSB *bits;
 
 		VideoFrame();
 		~VideoFrame();
@@ -152,6 +161,9 @@ private:
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
 
+		/** Set the number of threads reconstructing DCT blocks. Returns the number actually used. */
+		uint setThreadCount(uint count);
+
 	protected:
 		Common::Rational getFrameRate() const { return _frameRate; }
 
@@ -173,6 +185,8 @@ private:
 
 			uint32 pitch;
 
+			bool deferDCT; ///< Queue the DCT of the current block instead of reconstructing it.
+
 			int coordMap[64];
 			int coordScaledMap1[64];
 			int coordScaledMap2[64];
@@ -255,6 +269,9 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		/** DCT blocks whose reconstruction is deferred to worker threads, 0 when decoding serially. */
+		BinkDCTQueue *_dctQueue;
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -300,6 +317,9 @@ private:
 		void blockPattern      (DecodeContext &ctx);
 		void blockRaw          (DecodeContext &ctx);
 
+		/** Read a motion vector and return the block it points to in the last frame. */
+		const byte *getMotionSource(DecodeContext &ctx);
+
 		// Read the bundles
 		void readRuns        (VideoFrame &video, Bundle &bundle);
 		void readMotionValues(VideoFrame &video, Bundle &bundle);
@@ -309,11 +329,6 @@ private:
 		void readDCS         (VideoFrame &video, Bundle &bundle, int startBits, bool hasSign);
 		void readDCTCoeffs   (VideoFrame &video, int16 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
-
-		// Bink video IDCT
-		void IDCT(int16 *block);
-		void IDCTPut(DecodeContext &ctx, int16 *block);
-		void IDCTAdd(DecodeContext &ctx, int16 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
@@ -347,6 +362,8 @@ private:
 
 	Common::SeekableReadStream *_bink;
 
+	uint _threadCount; ///< Number of threads reconstructing DCT blocks.
+
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
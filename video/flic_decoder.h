@@ -55,6 +55,10 @@ public:
 	void clearDirtyRects();
 	void copyDirtyRectsToBuffer(uint8 *dst, uint pitch);
 
+protected:
+	// The dirty rects belong to the last decoded frame
+	bool supportsDecodeAhead() const { return false; }
+
 private:
 	class FlicVideoTrack : public VideoTrack {
 	public:
@@ -23,6 +23,7 @@ MODULE_OBJS := \
 
 ifdef USE_BINK
 MODULE_OBJS += \
+	bink_dct.o \
 	bink_decoder.o
 endif
 
@@ -70,6 +70,9 @@ public:
 	Audio::Timestamp getDuration() const { return Audio::Timestamp(0, _duration, _timeScale); }
 
 protected:
+	// Audio is buffered from the file on the main thread
+	bool supportsDecodeAhead() const { return false; }
+
 	Common::QuickTimeParser::SampleDesc *readSampleDesc(Common::QuickTimeParser::Track *track, uint32 format, uint32 descSize);
 
 private:
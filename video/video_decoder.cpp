@@ -25,14 +25,55 @@
 #include "audio/audiostream.h"
 #include "audio/mixer.h" // for kMaxChannelVolume
 
+#include "common/config-manager.h"
 #include "common/rational.h"
 #include "common/file.h"
 #include "common/system.h"
 
+#include "common/workerpool.h"
+
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+struct VideoDecoder::AheadFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	// Time at which the frame and the one after it should be shown
+	uint32 time;
+	uint32 nextTime;
+	// getCurFrame() once the frame is shown
+	int curFrame;
+	// Whether the video tracks ended with this frame
+	bool lastFrame;
+	bool dirtyPalette;
+	byte palette[256 * 3];
+};
+
+struct VideoDecoder::DecodeAhead {
+	// A single worker running decodeAheadMain()
+	Common::WorkerPool thread;
+	Common::WorkerCondition condition;
+	bool quit;
+	// Whether the thread may start decoding another frame
+	bool running;
+	// Whether the thread is decoding a frame, and thus owns the tracks
+	bool busy;
+	// Whether the thread decoded the last video frame
+	bool exhausted;
+
+	// Ring of decoded frames
+	AheadFrame *frames;
+	uint capacity;
+	uint head;
+	uint count;
+
+	// Surface returned by decodeNextFrame(), swapped with a decoded one
+	Graphics::Surface presented;
+	bool hasPresented;
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -47,6 +88,16 @@ VideoDecoder::VideoDecoder() {
 	_endTimeSet = false;
 	_nextVideoTrack = 0;
 
+	_ahead = 0;
+	_aheadFrames = 0;
+	_aheadActive = false;
+	_aheadCurFrame = -1;
+	_aheadNextTime = 0;
+	memset(&_stats, 0, sizeof(_stats));
+
+	if (ConfMan.hasKey("video_decode_ahead"))
+		setDecodeAhead(MAX(ConfMan.getInt("video_decode_ahead"), 0));
+
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
 
@@ -54,7 +105,13 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	stopDecodeAhead();
+}
+
 void VideoDecoder::close() {
+	flushDecodeAhead();
+
 	if (isPlaying())
 		stop();
 
@@ -73,6 +130,7 @@ void VideoDecoder::close() {
 	_endTime = 0;
 	_endTimeSet = false;
 	_nextVideoTrack = 0;
+	memset(&_stats, 0, sizeof(_stats));
 }
 
 bool VideoDecoder::loadFile(const Common::String &filename) {
@@ -103,6 +161,9 @@ void VideoDecoder::pauseVideo(bool pause) {
 		return;
 	}
 
+	// Queued frames stay valid, the thread resumes on the next decodeNextFrame()
+	parkDecodeAhead();
+
 	if (_pauseLevel == 1 && pause) {
 		_pauseStartTime = g_system->getMillis(); // Store the starting time from pausing to keep it for later
 
@@ -168,6 +229,11 @@ Graphics::PixelFormat VideoDecoder::getPixelFormat() const {
 const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 
+	if (useDecodeAhead() && (_aheadActive || startDecodeAhead()))
+		return presentAheadFrame();
+
+	uint32 startTime = g_system->getMillis();
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -176,6 +242,7 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 		return 0;
 
 	const Graphics::Surface *frame = _nextVideoTrack->decodeNextFrame();
+	recordDecodeTime(g_system->getMillis() - startTime);
 
 	if (_nextVideoTrack->hasDirtyPalette()) {
 		_palette = _nextVideoTrack->getPalette();
@@ -193,6 +260,16 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	parkDecodeAhead();
+
+	// Frames decoded ahead would have to be undone first
+	if (reverse && _aheadActive) {
+		if (hasQueuedAheadFrames())
+			return false;
+
+		flushDecodeAhead();
+	}
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -213,6 +290,14 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	// The tracks may be ahead of the frame last returned
+	if (_aheadActive)
+		return _aheadCurFrame;
+
+	return getTracksCurFrame();
+}
+
+int VideoDecoder::getTracksCurFrame() const {
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -254,13 +339,24 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	if (endOfVideo() || _needsUpdate)
+		return 0;
+
+	uint32 nextFrameStartTime;
+
+	if (_aheadActive) {
+		// The frame may still be decoding, decodeNextFrame() waits for it then
+		nextFrameStartTime = _aheadNextTime;
+	} else if (_nextVideoTrack) {
+		nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	} else {
 		return 0;
+	}
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
 
-	if (_nextVideoTrack->isReversed()) {
+	// Frames are never decoded ahead in reverse
+	if (!_aheadActive && _nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -276,9 +372,17 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
-	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
+	// The video tracks belong to the decode-ahead thread, ask its queue instead
+	if (_aheadActive && hasAheadFramesLeft())
+		return false;
+
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if (_aheadActive && (*it)->getTrackType() == Track::kTrackTypeVideo)
+			continue;
+
 		if (!(*it)->endOfTrack() && (!isPlaying() || (*it)->getTrackType() != Track::kTrackTypeVideo || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
 			return false;
+	}
 
 	return true;
 }
@@ -298,6 +402,8 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	flushDecodeAhead();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -332,6 +438,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	flushDecodeAhead();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -396,6 +504,9 @@ void VideoDecoder::stop() {
 	// Stop audio here so we don't have it affect getTime()
 	stopAudio();
 
+	// Queued frames stay valid, the thread resumes on the next decodeNextFrame()
+	parkDecodeAhead();
+
 	// Keep the time marked down in case we start up again
 	// We do this before _playbackRate is set so we don't get
 	// _lastTimeChange returned, but before _pauseLevel is
@@ -642,6 +753,8 @@ bool VideoDecoder::StreamFileAudioTrack::loadFromFile(const Common::String &base
 }
 
 void VideoDecoder::addTrack(Track *track) {
+	parkDecodeAhead();
+
 	_tracks.push_back(track);
 
 	if (track->getTrackType() == Track::kTrackTypeAudio) {
@@ -773,6 +886,9 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is similar to endOfVideo(), except it doesn't take Audio into account (and returns true if not the end of the video)
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
+	if (_aheadActive)
+		return hasAheadFramesLeft();
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack() && (!isPlaying() || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
 			return true;
@@ -788,4 +904,258 @@ bool VideoDecoder::hasAudio() const {
 	return false;
 }
 
+void VideoDecoder::recordDecodeTime(uint32 time) {
+	_stats.framesDecoded++;
+	_stats.decodeTime += time;
+	_stats.maxDecodeTime = MAX(_stats.maxDecodeTime, time);
+}
+
+bool VideoDecoder::useDecodeAhead() const {
+	if (_aheadActive)
+		return true;
+
+	return _aheadFrames != 0 && supportsDecodeAhead() && _nextVideoTrack && !_nextVideoTrack->isReversed();
+}
+
+bool VideoDecoder::decodeAheadFrame(AheadFrame &frame) {
+	// Same as the on demand path of decodeNextFrame(), but the result
+	// is copied since the track reuses its surface for the next frame
+	frame.time = _nextVideoTrack ? _nextVideoTrack->getNextFrameStartTime() : 0;
+
+	readNextPacket();
+
+	if (!_nextVideoTrack)
+		return false;
+
+	const Graphics::Surface *surface = _nextVideoTrack->decodeNextFrame();
+
+	frame.hasSurface = surface != 0;
+	if (surface) {
+		if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format) {
+			frame.surface.free();
+			frame.surface.create(surface->w, surface->h, surface->format);
+		}
+
+		for (int y = 0; y < surface->h; y++)
+			memcpy(frame.surface.getBasePtr(0, y), surface->getBasePtr(0, y), surface->w * surface->format.bytesPerPixel);
+	}
+
+	frame.dirtyPalette = _nextVideoTrack->hasDirtyPalette();
+	if (frame.dirtyPalette)
+		memcpy(frame.palette, _nextVideoTrack->getPalette(), sizeof(frame.palette));
+
+	findNextVideoTrack();
+	frame.nextTime = _nextVideoTrack ? _nextVideoTrack->getNextFrameStartTime() : 0;
+	frame.curFrame = getTracksCurFrame();
+	frame.lastFrame = !_nextVideoTrack;
+	return true;
+}
+
+void VideoDecoder::setDecodeAhead(uint frames) {
+	_aheadFrames = frames;
+}
+
+VideoDecoder::DecodeStats VideoDecoder::getDecodeStats() const {
+	if (!_ahead)
+		return _stats;
+
+	_ahead->condition.lock();
+	DecodeStats stats = _stats;
+	_ahead->condition.unlock();
+	return stats;
+}
+
+void VideoDecoder::decodeAheadMain(void *param, uint thread) {
+	VideoDecoder *decoder = (VideoDecoder *)param;
+	DecodeAhead *ahead = decoder->_ahead;
+
+	ahead->condition.lock();
+	for (;;) {
+		while (!ahead->quit && (!ahead->running || ahead->exhausted || ahead->count == ahead->capacity))
+			ahead->condition.wait();
+
+		if (ahead->quit)
+			break;
+
+		// The main thread only touches the queued frames and the presented one
+		AheadFrame &frame = ahead->frames[(ahead->head + ahead->count) % ahead->capacity];
+		ahead->busy = true;
+		ahead->condition.unlock();
+
+		uint32 startTime = g_system->getMillis();
+		bool decoded = decoder->decodeAheadFrame(frame);
+		uint32 decodeTime = g_system->getMillis() - startTime;
+
+		ahead->condition.lock();
+		ahead->busy = false;
+
+		if (decoded) {
+			ahead->count++;
+			ahead->exhausted = frame.lastFrame;
+			decoder->recordDecodeTime(decodeTime);
+		} else {
+			ahead->exhausted = true;
+		}
+
+		ahead->condition.notifyAll();
+	}
+	ahead->condition.unlock();
+}
+
+bool VideoDecoder::startDecodeAhead() {
+	if (_ahead && _ahead->capacity != _aheadFrames)
+		stopDecodeAhead();
+
+	if (!_ahead) {
+		_ahead = new DecodeAhead();
+		_ahead->quit = false;
+		_ahead->running = false;
+		_ahead->busy = false;
+		_ahead->exhausted = false;
+		_ahead->frames = new AheadFrame[_aheadFrames];
+		_ahead->capacity = _aheadFrames;
+		_ahead->head = 0;
+		_ahead->count = 0;
+		_ahead->hasPresented = false;
+
+		if (_ahead->thread.setThreadCount(2) != 2 || !_ahead->thread.start(decodeAheadMain, this)) {
+			warning("Failed to start the video decode-ahead thread");
+			delete[] _ahead->frames;
+			delete _ahead;
+			_ahead = 0;
+			_aheadFrames = 0;
+			return false;
+		}
+	}
+
+	// The tracks are in sync with the presented frame at this point
+	_aheadCurFrame = getTracksCurFrame();
+	_aheadNextTime = _nextVideoTrack ? _nextVideoTrack->getNextFrameStartTime() : 0;
+	_aheadActive = true;
+	return true;
+}
+
+void VideoDecoder::stopDecodeAhead() {
+	if (!_ahead)
+		return;
+
+	_ahead->condition.lock();
+	_ahead->quit = true;
+	_ahead->condition.notifyAll();
+	_ahead->condition.unlock();
+
+	_ahead->thread.wait();
+
+	for (uint i = 0; i < _ahead->capacity; i++)
+		_ahead->frames[i].surface.free();
+
+	_ahead->presented.free();
+	delete[] _ahead->frames;
+	delete _ahead;
+	_ahead = 0;
+	_aheadActive = false;
+}
+
+void VideoDecoder::parkDecodeAhead() {
+	if (!_ahead)
+		return;
+
+	_ahead->condition.lock();
+	_ahead->running = false;
+	while (_ahead->busy)
+		_ahead->condition.wait();
+	_ahead->condition.unlock();
+}
+
+void VideoDecoder::flushDecodeAhead() {
+	if (_ahead) {
+		parkDecodeAhead();
+
+		_ahead->condition.lock();
+		_ahead->head = 0;
+		_ahead->count = 0;
+		_ahead->exhausted = false;
+		_ahead->condition.unlock();
+	}
+
+	_aheadActive = false;
+}
+
+bool VideoDecoder::hasAheadFramesLeft() const {
+	if (isPlaying() && _endTimeSet && _aheadNextTime >= (uint)_endTime.msecs())
+		return false;
+
+	_ahead->condition.lock();
+	bool framesLeft = _ahead->count != 0 || !_ahead->exhausted;
+	_ahead->condition.unlock();
+	return framesLeft;
+}
+
+bool VideoDecoder::hasQueuedAheadFrames() const {
+	_ahead->condition.lock();
+	bool queued = _ahead->count != 0;
+	_ahead->condition.unlock();
+	return queued;
+}
+
+const Graphics::Surface *VideoDecoder::presentAheadFrame() {
+	// Frames whose successor is due are skipped when behind schedule
+	bool dropLate = isPlaying() && !isPaused();
+	uint32 currentTime = dropLate ? getTime() : 0;
+
+	_ahead->condition.lock();
+	_ahead->running = true;
+	_ahead->condition.notifyAll();
+
+	if (_ahead->count == 0 && !_ahead->exhausted) {
+		_stats.underruns++;
+
+		while (_ahead->count == 0 && !_ahead->exhausted)
+			_ahead->condition.wait();
+	}
+
+	if (_ahead->count == 0) {
+		_ahead->condition.unlock();
+		return 0;
+	}
+
+	while (dropLate && _ahead->count > 1) {
+		AheadFrame &late = _ahead->frames[_ahead->head];
+		AheadFrame &next = _ahead->frames[(_ahead->head + 1) % _ahead->capacity];
+
+		if (next.time > currentTime)
+			break;
+
+		// Keep the palette change of the skipped frame
+		if (late.dirtyPalette && !next.dirtyPalette) {
+			memcpy(next.palette, late.palette, sizeof(next.palette));
+			next.dirtyPalette = true;
+		}
+
+		_ahead->head = (_ahead->head + 1) % _ahead->capacity;
+		_ahead->count--;
+		_stats.framesDropped++;
+	}
+
+	// Recycle the previously presented surface for the next decoded frame
+	AheadFrame &frame = _ahead->frames[_ahead->head];
+	SWAP(frame.surface, _ahead->presented);
+	_ahead->hasPresented = frame.hasSurface;
+	_aheadCurFrame = frame.curFrame;
+	_aheadNextTime = frame.nextTime;
+
+	if (frame.dirtyPalette) {
+		memcpy(_aheadPalette, frame.palette, sizeof(_aheadPalette));
+		_palette = _aheadPalette;
+		_dirtyPalette = true;
+	}
+
+	_ahead->head = (_ahead->head + 1) % _ahead->capacity;
+	_ahead->count--;
+	_ahead->condition.notifyAll();
+	_ahead->condition.unlock();
+
+	return _ahead->hasPresented ? &_ahead->presented : 0;
+}
+
 } // End of namespace Video
@@ -48,11 +48,19 @@ namespace Video {
 
 /**
  * Generic interface for video decoder classes.
+ *
+ * Frames may be decoded ahead on a background thread, see setDecodeAhead().
+ * While that thread runs, it calls readNextPacket() and the methods of the
+ * video tracks, which then must not be used from the main thread. A
+ * subclass which accesses its tracks or the underlying stream from its own
+ * public methods must either call parkDecodeAhead() before doing so, or opt
+ * out by overriding supportsDecodeAhead() to return false. Frames are then
+ * always decoded on demand.
  */
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -365,6 +373,39 @@ public:
 	 */
 	bool setReverse(bool reverse);
 
+	/////////////////////////////////////////
+	// Decode-Ahead
+	/////////////////////////////////////////
+
+	/**
+	 * Statistics about the frames returned by decodeNextFrame().
+	 */
+	struct DecodeStats {
+		uint32 framesDecoded; ///< Frames decoded since the video was loaded
+		uint32 framesDropped; ///< Decoded frames skipped because they were already late
+		uint32 underruns;     ///< Times decodeNextFrame() had to wait for the decode-ahead thread
+		uint32 decodeTime;    ///< Total time spent decoding frames, in milliseconds
+		uint32 maxDecodeTime; ///< Longest time spent decoding one frame, in milliseconds
+	};
+
+	/**
+	 * Set the number of frames to decode ahead on a background thread.
+	 * Defaults to the "video_decode_ahead" config key; 0 decodes each
+	 * frame in decodeNextFrame().
+	 *
+	 * When enabled, decodeNextFrame() returns the oldest decoded frame,
+	 * skipping those whose successor is already due. A new value takes
+	 * effect when the video is loaded, rewound or seeked. Where threads
+	 * are not available, and for reversed playback, frames are always
+	 * decoded on demand.
+	 */
+	void setDecodeAhead(uint frames);
+
+	/**
+	 * Get the statistics of the frames decoded since the video was loaded.
+	 */
+	DecodeStats getDecodeStats() const;
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -820,6 +861,23 @@ protected:
 	 */
 	TrackListIterator getTrackListEnd() { return _tracks.end(); }
 
+	/**
+	 * Whether or not frames may be decoded ahead on a background thread.
+	 *
+	 * A subclass must override this to return false if it accesses its
+	 * tracks or the underlying stream from its public methods.
+	 */
+	virtual bool supportsDecodeAhead() const { return true; }
+
+	/**
+	 * Wait for the decode-ahead thread to finish the frame it is decoding
+	 * and keep it from starting another one until the next call to
+	 * decodeNextFrame(). The frames already decoded are kept.
+	 *
+	 * A subclass must call this before changing its tracks' state.
+	 */
+	void parkDecodeAhead();
+
 private:
 	// Tracks owned by this VideoDecoder
 	TrackList _tracks;
@@ -845,6 +903,29 @@ private:
 	bool hasFramesLeft() const;
 	bool hasAudio() const;
 
+	// Decode-ahead state, owned by the main thread unless noted
+	struct AheadFrame;
+	struct DecodeAhead;
+	DecodeAhead *_ahead;
+	uint _aheadFrames;
+	bool _aheadActive; // Whether the tracks may be ahead of the presented frame
+	int _aheadCurFrame;
+	uint32 _aheadNextTime;
+	byte _aheadPalette[256 * 3];
+	DecodeStats _stats; // Written by the decode-ahead thread while it runs
+
+	bool useDecodeAhead() const;
+	bool startDecodeAhead();
+	void flushDecodeAhead();
+	void stopDecodeAhead();
+	bool hasAheadFramesLeft() const;
+	bool hasQueuedAheadFrames() const;
+	const Graphics::Surface *presentAheadFrame();
+	bool decodeAheadFrame(AheadFrame &frame);
+	static void decodeAheadMain(void *param, uint thread);
+	void recordDecodeTime(uint32 time);
+	int getTracksCurFrame() const;
+
 	int32 _startTime;
 	uint32 _pauseLevel;
 	uint32 _pauseStartTime;